@@ -0,0 +1,36 @@
+// Example of parsing JSON text which arrives in chunks, e.g. from a socket.
+// Unlike parsebyparts, no thread is needed: each chunk is pushed to the parser
+// and the events of its complete tokens are delivered right away.
+
+#include "rapidjson/pushreader.h"
+#include "rapidjson/error/en.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/ostreamwrapper.h"
+#include <iostream>
+
+using namespace rapidjson;
+
+int main() {
+    const char json1[] = " { \"hello\" : \"world\", \"t\" : tr";
+    //const char json1[] = " { \"hello\" : \"world\", \"t\" : trX"; // For test parsing error
+    const char json2[] = "ue, \"f\" : false, \"n\": null, \"i\":123, \"pi\": 3.14";
+    const char json3[] = "16, \"a\":[1, 2, 3, 4] } ";
+
+    // Stringify the JSON to cout as it is parsed.
+    OStreamWrapper os(std::cout);
+    Writer<OStreamWrapper> writer(os);
+
+    PushReader reader;
+    reader.Feed(json1, sizeof(json1) - 1, writer);
+    reader.Feed(json2, sizeof(json2) - 1, writer);
+    reader.Feed(json3, sizeof(json3) - 1, writer);
+    reader.Finish(writer);
+    std::cout << std::endl;
+
+    if (reader.HasParseError()) {
+        std::cout << "Error at offset " << reader.GetErrorOffset() << ": " << GetParseError_En(reader.GetParseErrorCode()) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
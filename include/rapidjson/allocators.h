@@ -17,6 +17,14 @@
 
 #include "rapidjson.h"
 
+#if RAPIDJSON_HAS_CXX11_ATOMIC
+#include <atomic>
+#endif
+#if RAPIDJSON_HAS_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 RAPIDJSON_NAMESPACE_BEGIN
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -79,6 +87,20 @@ public:
     static void Free(void *ptr) { std::free(ptr); }
 };
 
+#if RAPIDJSON_MEMORY_STATS
+///////////////////////////////////////////////////////////////////////////////
+// AllocatorStats
+
+//! Statistics of a MemoryPoolAllocator since its construction (see \ref RAPIDJSON_MEMORY_STATS).
+struct AllocatorStats {
+    size_t allocationCount; //!< Number of memory blocks allocated, including the ones moved by Realloc().
+    size_t requestedBytes;  //!< Sum of the sizes requested by Malloc() and Realloc().
+    size_t wastedBytes;     //!< Bytes lost to alignment, to blocks moved by Realloc(), and to the unused ends of chunks when starting new ones.
+    size_t chunkCount;      //!< Current number of chunks, including the user buffer and the chunks kept by Reset().
+    size_t peakSize;        //!< Highest Size().
+};
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 // MemoryPoolAllocator
 
@@ -95,6 +117,10 @@ public:
 
     The user-buffer is not deallocated by this allocator.
 
+    Chunks have the capacity given to the constructor, or doubling from it up
+    to the one set by SetMaxChunkCapacity(). Reset() keeps the chunks for the
+    next allocations instead of deallocating them like Clear().
+
     \tparam BaseAllocator the allocator type for allocating memory chunks. Default is CrtAllocator.
     \note implements Allocator concept
 */
@@ -108,7 +134,11 @@ public:
         \param baseAllocator The allocator for allocating memory chunks.
     */
     MemoryPoolAllocator(size_t chunkSize = kDefaultChunkCapacity, BaseAllocator* baseAllocator = 0) : 
-        chunkHead_(0), chunk_capacity_(chunkSize), userBuffer_(0), baseAllocator_(baseAllocator), ownBaseAllocator_(0)
+        chunkHead_(0), freeChunks_(0), chunk_capacity_(chunkSize), next_chunk_capacity_(chunkSize), max_chunk_capacity_(chunkSize),
+        userBuffer_(0), baseAllocator_(baseAllocator), ownBaseAllocator_(0)
+#if RAPIDJSON_MEMORY_STATS
+        , stats_(), size_(0)
+#endif
     {
     }
 
@@ -123,7 +153,11 @@ public:
         \param baseAllocator The allocator for allocating memory chunks.
     */
     MemoryPoolAllocator(void *buffer, size_t size, size_t chunkSize = kDefaultChunkCapacity, BaseAllocator* baseAllocator = 0) :
-        chunkHead_(0), chunk_capacity_(chunkSize), userBuffer_(buffer), baseAllocator_(baseAllocator), ownBaseAllocator_(0)
+        chunkHead_(0), freeChunks_(0), chunk_capacity_(chunkSize), next_chunk_capacity_(chunkSize), max_chunk_capacity_(chunkSize),
+        userBuffer_(buffer), baseAllocator_(baseAllocator), ownBaseAllocator_(0)
+#if RAPIDJSON_MEMORY_STATS
+        , stats_(), size_(0)
+#endif
     {
         RAPIDJSON_ASSERT(buffer != 0);
         RAPIDJSON_ASSERT(size > sizeof(ChunkHeader));
@@ -150,15 +184,71 @@ public:
         }
         if (chunkHead_ && chunkHead_ == userBuffer_)
             chunkHead_->size = 0; // Clear user buffer
+        while (freeChunks_) {
+            ChunkHeader* next = freeChunks_->next;
+            baseAllocator_->Free(freeChunks_);
+            freeChunks_ = next;
+        }
+        next_chunk_capacity_ = chunk_capacity_;
+#if RAPIDJSON_MEMORY_STATS
+        size_ = 0;
+#endif
+    }
+
+    //! Frees all memory blocks, but keeps the memory chunks for the next allocations.
+    /*! \param maxCapacity Total capacity in bytes of the chunks to keep, excluding the
+            user-supplied buffer. The chunks beyond it are deallocated.
+    */
+    void Reset(size_t maxCapacity = ~size_t(0)) {
+        // Reverse the used chunks to reuse them in the order of allocation, followed by the unused ones.
+        ChunkHeader* chunks = freeChunks_;
+        while (chunkHead_ && chunkHead_ != userBuffer_) {
+            ChunkHeader* next = chunkHead_->next;
+            chunkHead_->size = 0;
+            chunkHead_->next = chunks;
+            chunks = chunkHead_;
+            chunkHead_ = next;
+        }
+        if (chunkHead_ && chunkHead_ == userBuffer_)
+            chunkHead_->size = 0; // Clear user buffer
+
+        size_t capacity = 0;
+        ChunkHeader** tail = &freeChunks_;
+        while (chunks) {
+            ChunkHeader* next = chunks->next;
+            if (capacity + chunks->capacity <= maxCapacity) {
+                capacity += chunks->capacity;
+                *tail = chunks;
+                tail = &chunks->next;
+            }
+            else
+                baseAllocator_->Free(chunks);
+            chunks = next;
+        }
+        *tail = 0;
+#if RAPIDJSON_MEMORY_STATS
+        size_ = 0;
+#endif
+    }
+
+    //! Lets the capacity of new chunks double up to a maximum.
+    /*! \param maxChunkSize The maximum capacity in bytes of memory chunks, starting from the chunkSize given to the constructor.
+    */
+    void SetMaxChunkCapacity(size_t maxChunkSize) {
+        max_chunk_capacity_ = maxChunkSize < chunk_capacity_ ? chunk_capacity_ : maxChunkSize;
+        if (next_chunk_capacity_ > max_chunk_capacity_)
+            next_chunk_capacity_ = max_chunk_capacity_;
     }
 
     //! Computes the total capacity of allocated memory chunks.
-    /*! \return total capacity in bytes.
+    /*! \return total capacity in bytes, including the chunks kept by Reset().
     */
     size_t Capacity() const {
         size_t capacity = 0;
         for (ChunkHeader* c = chunkHead_; c != 0; c = c->next)
             capacity += c->capacity;
+        for (ChunkHeader* c = freeChunks_; c != 0; c = c->next)
+            capacity += c->capacity;
         return capacity;
     }
 
@@ -172,18 +262,43 @@ public:
         return size;
     }
 
+#if RAPIDJSON_MEMORY_STATS
+    //! Get the statistics of allocations since construction.
+    AllocatorStats GetStats() const {
+        AllocatorStats stats = stats_;
+        for (ChunkHeader* c = chunkHead_; c != 0; c = c->next)
+            stats.chunkCount++;
+        for (ChunkHeader* c = freeChunks_; c != 0; c = c->next)
+            stats.chunkCount++;
+        return stats;
+    }
+#endif
+
     //! Allocates a memory block. (concept Allocator)
     void* Malloc(size_t size) {
         if (!size)
             return NULL;
 
+#if RAPIDJSON_MEMORY_STATS
+        stats_.allocationCount++;
+        stats_.requestedBytes += size;
+        stats_.wastedBytes += RAPIDJSON_ALIGN(size) - size;
+#endif
         size = RAPIDJSON_ALIGN(size);
-        if (chunkHead_ == 0 || chunkHead_->size + size > chunkHead_->capacity)
-            if (!AddChunk(chunk_capacity_ > size ? chunk_capacity_ : size))
+        if (chunkHead_ == 0 || chunkHead_->size + size > chunkHead_->capacity) {
+#if RAPIDJSON_MEMORY_STATS
+            if (chunkHead_)
+                stats_.wastedBytes += chunkHead_->capacity - chunkHead_->size;
+#endif
+            if (!AddChunk(size))
                 return NULL;
+        }
 
         void *buffer = reinterpret_cast<char *>(chunkHead_) + RAPIDJSON_ALIGN(sizeof(ChunkHeader)) + chunkHead_->size;
         chunkHead_->size += size;
+#if RAPIDJSON_MEMORY_STATS
+        AddSize(size);
+#endif
         return buffer;
     }
 
@@ -207,6 +322,10 @@ public:
             size_t increment = static_cast<size_t>(newSize - originalSize);
             if (chunkHead_->size + increment <= chunkHead_->capacity) {
                 chunkHead_->size += increment;
+#if RAPIDJSON_MEMORY_STATS
+                stats_.requestedBytes += increment;
+                AddSize(increment);
+#endif
                 return originalPtr;
             }
         }
@@ -215,6 +334,9 @@ public:
         if (void* newBuffer = Malloc(newSize)) {
             if (originalSize)
                 std::memcpy(newBuffer, originalPtr, originalSize);
+#if RAPIDJSON_MEMORY_STATS
+            stats_.wastedBytes += originalSize;
+#endif
             return newBuffer;
         }
         else
@@ -230,14 +352,34 @@ private:
     //! Copy assignment operator is not permitted.
     MemoryPoolAllocator& operator=(const MemoryPoolAllocator& rhs) /* = delete */;
 
-    //! Creates a new chunk.
-    /*! \param capacity Capacity of the chunk in bytes.
+#if RAPIDJSON_MEMORY_STATS
+    void AddSize(size_t size) {
+        size_ += size;
+        if (size_ > stats_.peakSize)
+            stats_.peakSize = size_;
+    }
+#endif
+
+    //! Creates a new chunk, or reuses one kept by Reset().
+    /*! \param size Minimum capacity of the chunk in bytes.
         \return true if success.
     */
-    bool AddChunk(size_t capacity) {
+    bool AddChunk(size_t size) {
+        for (ChunkHeader** c = &freeChunks_; *c != 0; c = &(*c)->next)
+            if ((*c)->capacity >= size) {
+                ChunkHeader* chunk = *c;
+                *c = chunk->next;
+                chunk->next = chunkHead_;
+                chunkHead_ = chunk;
+                return true;
+            }
+
         if (!baseAllocator_)
             ownBaseAllocator_ = baseAllocator_ = RAPIDJSON_NEW(BaseAllocator());
+        const size_t capacity = next_chunk_capacity_ > size ? next_chunk_capacity_ : size;
         if (ChunkHeader* chunk = reinterpret_cast<ChunkHeader*>(baseAllocator_->Malloc(RAPIDJSON_ALIGN(sizeof(ChunkHeader)) + capacity))) {
+            if (next_chunk_capacity_ < max_chunk_capacity_)
+                next_chunk_capacity_ = next_chunk_capacity_ > max_chunk_capacity_ / 2 ? max_chunk_capacity_ : next_chunk_capacity_ * 2;
             chunk->capacity = capacity;
             chunk->size = 0;
             chunk->next = chunkHead_;
@@ -260,12 +402,482 @@ private:
     };
 
     ChunkHeader *chunkHead_;    //!< Head of the chunk linked-list. Only the head chunk serves allocation.
+    ChunkHeader *freeChunks_;   //!< Empty chunks kept by Reset().
     size_t chunk_capacity_;     //!< The minimum capacity of chunk when they are allocated.
+    size_t next_chunk_capacity_;    //!< The minimum capacity of the next chunk allocated.
+    size_t max_chunk_capacity_;     //!< The limit of next_chunk_capacity_.
     void *userBuffer_;          //!< User supplied buffer.
     BaseAllocator* baseAllocator_;  //!< base allocator for allocating memory chunks.
     BaseAllocator* ownBaseAllocator_;   //!< base allocator created by this object.
+#if RAPIDJSON_MEMORY_STATS
+    AllocatorStats stats_;      //!< Statistics, with chunkCount computed by GetStats().
+    size_t size_;               //!< Same as Size().
+#endif
+};
+
+#if RAPIDJSON_HAS_CXX11_ATOMIC
+
+///////////////////////////////////////////////////////////////////////////////
+// ChunkPool
+
+//! Thread-safe pool of free memory chunks of equal capacity.
+/*! Chunks are allocated by BaseAllocator on demand and kept in a lock-free
+    list when released, so that they can be reused by any thread, e.g. by
+    the ConcurrentMemoryPoolAllocator of many documents in turn. They are
+    only deallocated when the pool is destructed.
+
+    Taking a chunk detaches the whole list for a moment, so another thread
+    taking a chunk at the same time may allocate a new one instead.
+
+    \tparam BaseAllocator the allocator type for allocating memory chunks, which must be thread-safe. Default is CrtAllocator.
+*/
+template <typename BaseAllocator = CrtAllocator>
+class ChunkPool {
+public:
+    //! Constructor with chunkSize.
+    /*! \param chunkSize The capacity of each memory chunk in bytes.
+        \param baseAllocator The allocator for allocating memory chunks.
+    */
+    ChunkPool(size_t chunkSize = kDefaultChunkCapacity, BaseAllocator* baseAllocator = 0) :
+        free_(0), chunk_capacity_(RAPIDJSON_ALIGN(chunkSize)), baseAllocator_(baseAllocator), ownBaseAllocator_(0)
+    {
+        RAPIDJSON_ASSERT(chunk_capacity_ >= sizeof(Chunk));
+        if (!baseAllocator_)
+            ownBaseAllocator_ = baseAllocator_ = RAPIDJSON_NEW(BaseAllocator());
+    }
+
+    //! Destructor.
+    /*! This deallocates all free chunks. Chunks still used by allocators must be released before.
+    */
+    ~ChunkPool() {
+        for (Chunk* c = free_.load(std::memory_order_acquire); c != 0; ) {
+            Chunk* next = c->next;
+            baseAllocator_->Free(c);
+            c = next;
+        }
+        RAPIDJSON_DELETE(ownBaseAllocator_);
+    }
+
+    //! Capacity of each chunk in bytes.
+    size_t ChunkCapacity() const { return chunk_capacity_; }
+
+    //! Get the allocator of the chunks.
+    BaseAllocator& GetBaseAllocator() { return *baseAllocator_; }
+
+    //! Takes a free chunk, or allocates a new one. (thread-safe)
+    /*! \return Chunk of ChunkCapacity() bytes, or null if the base allocator fails.
+    */
+    void* Acquire() {
+        Chunk* c = free_.exchange(0, std::memory_order_acquire);
+        if (!c)
+            return baseAllocator_->Malloc(chunk_capacity_);
+        if (Chunk* rest = c->next) {
+            // Put back the others, appending the chunks released meanwhile if any.
+            Chunk* expected = 0;
+            if (!free_.compare_exchange_strong(expected, rest, std::memory_order_release, std::memory_order_relaxed)) {
+                Chunk* last = rest;
+                while (last->next)
+                    last = last->next;
+                Push(rest, last);
+            }
+        }
+        return c;
+    }
+
+    //! Puts a chunk obtained by Acquire() back into the pool. (thread-safe)
+    void Release(void* chunk) {
+        if (chunk)
+            Push(static_cast<Chunk*>(chunk), static_cast<Chunk*>(chunk));
+    }
+
+private:
+    //! Copy constructor is not permitted.
+    ChunkPool(const ChunkPool& rhs) /* = delete */;
+    //! Copy assignment operator is not permitted.
+    ChunkPool& operator=(const ChunkPool& rhs) /* = delete */;
+
+    //! Free chunk, linked in place of its data.
+    struct Chunk {
+        Chunk* next;
+    };
+
+    //! Prepends the chunks from \c first to \c last, which are linked already.
+    void Push(Chunk* first, Chunk* last) {
+        Chunk* head = free_.load(std::memory_order_relaxed);
+        do {
+            last->next = head;
+        } while (!free_.compare_exchange_weak(head, first, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    static const int kDefaultChunkCapacity = 64 * 1024; //!< Default chunk capacity.
+
+    std::atomic<Chunk*> free_;          //!< Head of the list of free chunks.
+    size_t chunk_capacity_;             //!< Capacity of each chunk.
+    BaseAllocator* baseAllocator_;      //!< base allocator for allocating memory chunks.
+    BaseAllocator* ownBaseAllocator_;   //!< base allocator created by this object.
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// ConcurrentMemoryPoolAllocator
+
+//! Memory pool allocator which can be used by several threads at the same time.
+/*! Like MemoryPoolAllocator, this allocator allocates memory blocks from
+    memory chunks and does not free memory blocks, but each thread allocates
+    from its own chunk, so that several threads can build values for the same
+    document without locking, e.g.
+    \code
+    ChunkPool<> pool;
+    ConcurrentMemoryPoolAllocator<> allocator(&pool);
+    Document d(&allocator);
+    // Threads may now call Malloc() and Realloc() of d.GetAllocator() concurrently,
+    // e.g. to build values to be added to d later.
+    \endcode
+
+    The chunks are taken from a ChunkPool, which may be shared by allocators
+    of different threads and documents, and are released to it by Clear()
+    instead of being deallocated. Larger memory blocks are allocated by the
+    base allocator of the pool's type separately.
+
+    A thread caches its current chunk for the few allocators it used last.
+    When it returns to an allocator evicted from this cache, it resumes its
+    latest chunk of that allocator.
+
+    \note Clear(), Capacity(), Size() and the destructor must not run
+        concurrently with other member functions.
+    \tparam BaseAllocator the base allocator type of the ChunkPool. Default is CrtAllocator.
+    \note implements Allocator concept
+*/
+template <typename BaseAllocator = CrtAllocator>
+class ConcurrentMemoryPoolAllocator {
+public:
+    static const bool kNeedFree = false;    //!< Tell users that no need to call Free() with this allocator. (concept Allocator)
+
+    //! Constructor with chunk pool.
+    /*! \param pool The pool for taking and releasing memory chunks. If null, the allocator creates its own.
+    */
+    ConcurrentMemoryPoolAllocator(ChunkPool<BaseAllocator>* pool = 0) :
+        chunks_(0), id_(NewId()), pool_(pool), ownPool_(0)
+    {
+        if (!pool_)
+            ownPool_ = pool_ = RAPIDJSON_NEW(ChunkPool<BaseAllocator>());
+        RAPIDJSON_ASSERT(pool_->ChunkCapacity() > RAPIDJSON_ALIGN(sizeof(ChunkHeader)));
+    }
+
+    //! Destructor.
+    /*! This releases all memory chunks.
+    */
+    ~ConcurrentMemoryPoolAllocator() {
+        Clear();
+        RAPIDJSON_DELETE(ownPool_);
+    }
+
+    //! Releases all memory chunks to the pool and deallocates the larger blocks.
+    void Clear() {
+        ChunkHeader* c = chunks_.exchange(0, std::memory_order_acquire);
+        while (c) {
+            ChunkHeader* next = c->next;
+            if (c->capacity == ChunkCapacity())
+                pool_->Release(c);
+            else
+                pool_->GetBaseAllocator().Free(c);
+            c = next;
+        }
+        id_ = NewId(); // forget the current chunks of all threads
+    }
+
+    //! Computes the total capacity of allocated memory chunks.
+    /*! \return total capacity in bytes.
+    */
+    size_t Capacity() const {
+        size_t capacity = 0;
+        for (ChunkHeader* c = chunks_.load(std::memory_order_acquire); c != 0; c = c->next)
+            capacity += c->capacity;
+        return capacity;
+    }
+
+    //! Computes the memory blocks allocated.
+    /*! \return total used bytes.
+    */
+    size_t Size() const {
+        size_t size = 0;
+        for (ChunkHeader* c = chunks_.load(std::memory_order_acquire); c != 0; c = c->next)
+            size += c->size;
+        return size;
+    }
+
+    //! Allocates a memory block. (concept Allocator)
+    void* Malloc(size_t size) {
+        if (!size)
+            return NULL;
+
+        size = RAPIDJSON_ALIGN(size);
+        if (size > ChunkCapacity()) {
+            // Too large for a chunk of the pool, allocate it separately.
+            ChunkHeader* chunk = static_cast<ChunkHeader*>(pool_->GetBaseAllocator().Malloc(RAPIDJSON_ALIGN(sizeof(ChunkHeader)) + size));
+            if (!chunk)
+                return NULL;
+            chunk->capacity = chunk->size = size;
+            chunk->owner = 0;
+            AddChunk(chunk);
+            return reinterpret_cast<char*>(chunk) + RAPIDJSON_ALIGN(sizeof(ChunkHeader));
+        }
+
+        ChunkHeader*& chunk = LocalChunk();
+        if (chunk == 0 || chunk->size + size > chunk->capacity) {
+            chunk = static_cast<ChunkHeader*>(pool_->Acquire());
+            if (!chunk)
+                return NULL;
+            chunk->capacity = ChunkCapacity();
+            chunk->size = 0;
+            chunk->owner = LocalRegions();
+            AddChunk(chunk);
+        }
+
+        void *buffer = reinterpret_cast<char *>(chunk) + RAPIDJSON_ALIGN(sizeof(ChunkHeader)) + chunk->size;
+        chunk->size += size;
+        return buffer;
+    }
+
+    //! Resizes a memory block (concept Allocator)
+    void* Realloc(void* originalPtr, size_t originalSize, size_t newSize) {
+        if (originalPtr == 0)
+            return Malloc(newSize);
+
+        if (newSize == 0)
+            return NULL;
+
+        originalSize = RAPIDJSON_ALIGN(originalSize);
+        newSize = RAPIDJSON_ALIGN(newSize);
+
+        // Do not shrink if new size is smaller than original
+        if (originalSize >= newSize)
+            return originalPtr;
+
+        // Simply expand it if it is the last allocation of this thread and there is sufficient space
+        ChunkHeader* chunk = LocalChunk();
+        if (chunk && originalPtr == reinterpret_cast<char *>(chunk) + RAPIDJSON_ALIGN(sizeof(ChunkHeader)) + chunk->size - originalSize) {
+            size_t increment = static_cast<size_t>(newSize - originalSize);
+            if (chunk->size + increment <= chunk->capacity) {
+                chunk->size += increment;
+                return originalPtr;
+            }
+        }
+
+        // Realloc process: allocate and copy memory, do not free original buffer.
+        if (void* newBuffer = Malloc(newSize)) {
+            if (originalSize)
+                std::memcpy(newBuffer, originalPtr, originalSize);
+            return newBuffer;
+        }
+        else
+            return NULL;
+    }
+
+    //! Frees a memory block (concept Allocator)
+    static void Free(void *ptr) { (void)ptr; } // Do nothing
+
+private:
+    //! Copy constructor is not permitted.
+    ConcurrentMemoryPoolAllocator(const ConcurrentMemoryPoolAllocator& rhs) /* = delete */;
+    //! Copy assignment operator is not permitted.
+    ConcurrentMemoryPoolAllocator& operator=(const ConcurrentMemoryPoolAllocator& rhs) /* = delete */;
+
+    //! Chunk header for perpending to each chunk.
+    struct ChunkHeader {
+        size_t capacity;    //!< Capacity of the chunk in bytes (excluding the header itself).
+        size_t size;        //!< Current size of allocated memory in bytes, only changed by the thread allocating from it.
+        const void* owner;  //!< LocalRegions() of the thread allocating from the chunk, null for a larger block.
+        ChunkHeader *next;  //!< Next chunk in the linked list.
+    };
+
+    //! Current chunk of a thread for an allocator.
+    struct LocalRegion {
+        uint64_t id;        //!< ConcurrentMemoryPoolAllocator::id_ of the allocator, 0 if unused.
+        ChunkHeader* chunk; //!< Chunk which serves allocation of this thread, if any.
+    };
+
+    static const size_t kLocalRegionCount = 8;   //!< Number of allocators a thread keeps its current chunk for.
+
+    size_t ChunkCapacity() const { return pool_->ChunkCapacity() - RAPIDJSON_ALIGN(sizeof(ChunkHeader)); }
+
+    //! Current chunks of the calling thread, for the allocators it used last first.
+    static LocalRegion* LocalRegions() {
+        static thread_local LocalRegion regions[kLocalRegionCount];
+        return regions;
+    }
+
+    //! Current chunk of the calling thread for this allocator.
+    /*! Moves the allocator to the front of the thread's cache, evicting the least recently used one if missing.
+    */
+    ChunkHeader*& LocalChunk() {
+        LocalRegion* regions = LocalRegions();
+        if (RAPIDJSON_LIKELY(regions[0].id == id_))
+            return regions[0].chunk;
+
+        size_t i = 1;
+        while (i < kLocalRegionCount - 1 && regions[i].id != id_)
+            ++i;
+        LocalRegion r = regions[i];
+        if (r.id != id_) {
+            r.id = id_;
+            r.chunk = LatestChunk(regions);
+        }
+        for (; i > 0; --i)
+            regions[i] = regions[i - 1];
+        regions[0] = r;
+        return regions[0].chunk;
+    }
+
+    //! Latest chunk of this allocator owned by a thread, to resume it after an eviction.
+    /*! Only the owner allocates from a chunk, so it is safe to resume while other threads add chunks.
+    */
+    ChunkHeader* LatestChunk(const void* owner) const {
+        for (ChunkHeader* c = chunks_.load(std::memory_order_acquire); c != 0; c = c->next)
+            if (c->owner == owner)
+                return c;
+        return 0;
+    }
+
+    //! Links a chunk to the list of chunks of this allocator. (thread-safe)
+    void AddChunk(ChunkHeader* chunk) {
+        ChunkHeader* head = chunks_.load(std::memory_order_relaxed);
+        do {
+            chunk->next = head;
+        } while (!chunks_.compare_exchange_weak(head, chunk, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    //! Identifier never used by another allocator or before Clear(), nonzero.
+    static uint64_t NewId() {
+        static std::atomic<uint64_t> lastId(0);
+        return ++lastId;
+    }
+
+    std::atomic<ChunkHeader*> chunks_;  //!< All chunks of all threads, for Clear().
+    uint64_t id_;                       //!< Identifier of the current chunks of the threads.
+    ChunkPool<BaseAllocator>* pool_;    //!< Pool of memory chunks.
+    ChunkPool<BaseAllocator>* ownPool_; //!< Pool created by this object.
+};
+
+#endif // RAPIDJSON_HAS_CXX11_ATOMIC
+
+#if RAPIDJSON_HAS_MMAP
+
+///////////////////////////////////////////////////////////////////////////////
+// MmapAllocator
+
+//! Combination of flags of MmapAllocator.
+enum MmapFlag {
+    kMmapNoFlags = 0,                   //!< Pages of the default size, faulted in on first touch.
+    kMmapHugeTlbFlag = 1,               //!< Map explicit huge pages (MAP_HUGETLB) if reserved by the system, or pages of the default size otherwise.
+    kMmapTransparentHugePageFlag = 2,   //!< Advise transparent huge pages (madvise(MADV_HUGEPAGE)) for pages of the default size.
+    kMmapPrefaultFlag = 4               //!< Fault in all pages when mapping them, instead of on first touch.
+};
+
+//! Allocator mapping each memory block from the operating system.
+/*! Every Malloc() maps anonymous memory with \c mmap(), which is rounded up to
+    whole pages, so this allocator is meant for large blocks, e.g. as the
+    BaseAllocator of a MemoryPoolAllocator with a large chunk size, or as the
+    StackAllocator of a GenericDocument:
+    \code
+    typedef MemoryPoolAllocator<MmapAllocator<kMmapTransparentHugePageFlag> > Pool;
+    Pool allocator(64 * 1024 * 1024);
+    GenericDocument<UTF8<>, Pool, MmapAllocator<kMmapTransparentHugePageFlag> > d(&allocator);
+    \endcode
+
+    Huge pages reduce TLB misses on large documents. Prefaulting moves the
+    page faults of first touch to the allocation.
+
+    \tparam mmapFlags Combination of \ref MmapFlag.
+    \note implements Allocator concept
+*/
+template <unsigned mmapFlags = kMmapNoFlags>
+class MmapAllocator {
+public:
+    static const bool kNeedFree = true;
+    void* Malloc(size_t size) {
+        if (!size)
+            return NULL;
+        if (Header* h = Map(RAPIDJSON_ALIGN(sizeof(Header)) + size))
+            return reinterpret_cast<char*>(h) + RAPIDJSON_ALIGN(sizeof(Header));
+        return NULL;
+    }
+    void* Realloc(void* originalPtr, size_t originalSize, size_t newSize) {
+        if (newSize == 0) {
+            Free(originalPtr);
+            return NULL;
+        }
+        // The pages mapped may be enough already.
+        if (originalPtr && RAPIDJSON_ALIGN(sizeof(Header)) + newSize <= GetHeader(originalPtr)->length)
+            return originalPtr;
+        void* newBuffer = Malloc(newSize);
+        if (newBuffer && originalPtr) {
+            std::memcpy(newBuffer, originalPtr, originalSize < newSize ? originalSize : newSize);
+            Free(originalPtr);
+        }
+        return newBuffer;
+    }
+    static void Free(void *ptr) {
+        if (ptr) {
+            Header* h = GetHeader(ptr);
+            munmap(h, h->length);
+        }
+    }
+
+private:
+    //! Header of each mapping.
+    struct Header {
+        size_t length;  //!< Length of the mapping in bytes.
+    };
+
+    static const size_t kHugePageSize = 2 * 1024 * 1024;    //!< Default size of huge pages on x86-64.
+
+    static Header* GetHeader(void* ptr) {
+        return reinterpret_cast<Header*>(static_cast<char*>(ptr) - RAPIDJSON_ALIGN(sizeof(Header)));
+    }
+
+    static size_t RoundUp(size_t size, size_t pageSize) { return (size + pageSize - 1) / pageSize * pageSize; }
+
+    static Header* Map(size_t size) {
+        static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        int flags = MAP_PRIVATE | MAP_ANON;
+#ifdef MAP_POPULATE
+        // Pages advised as huge pages are faulted in by touching them below instead.
+        if ((mmapFlags & kMmapPrefaultFlag) && !(mmapFlags & kMmapTransparentHugePageFlag))
+            flags |= MAP_POPULATE;
+#endif
+        size_t length = 0;
+        void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        if (mmapFlags & kMmapHugeTlbFlag) {
+            length = RoundUp(size, kHugePageSize);
+            p = mmap(0, length, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+        }
+#endif
+        if (p == MAP_FAILED) {
+            length = RoundUp(size, pageSize);
+            p = mmap(0, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (p == MAP_FAILED)
+                return 0;
+#ifdef MADV_HUGEPAGE
+            if (mmapFlags & kMmapTransparentHugePageFlag)
+                madvise(p, length, MADV_HUGEPAGE);
+#endif
+        }
+#ifdef MAP_POPULATE
+        if ((mmapFlags & kMmapPrefaultFlag) && (mmapFlags & kMmapTransparentHugePageFlag))
+#else
+        if (mmapFlags & kMmapPrefaultFlag)
+#endif
+            for (size_t i = 0; i < length; i += pageSize)
+                static_cast<volatile char*>(p)[i] = 0;
+        Header* h = static_cast<Header*>(p);
+        h->length = length;
+        return h;
+    }
+};
+
+#endif // RAPIDJSON_HAS_MMAP
+
 RAPIDJSON_NAMESPACE_END
 
 #endif // RAPIDJSON_ENCODINGS_H_
@@ -0,0 +1,846 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_CBOR_H_
+#define RAPIDJSON_CBOR_H_
+
+/*! \file cbor.h */
+
+#include "reader.h"
+#include "memorystream.h"
+#include "internal/ieee754.h"
+#include "internal/strfunc.h"
+#include <cmath>
+#include <limits>
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(switch-enum)
+#endif
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+namespace internal {
+
+//! Whether a Handler has StartObject(SizeType) and StartArray(SizeType) for containers of known sizes, like GenericDocument.
+template <typename Handler>
+class IsSizedHandler {
+    typedef char Yes;
+    struct No { char c[2]; };
+    template <typename T, bool (T::*)(SizeType)> struct Check;
+    template <typename T> static Yes Test(Check<T, &T::StartObject>*, Check<T, &T::StartArray>*);
+    template <typename T> static No Test(...);
+public:
+    enum { Value = sizeof(Test<Handler>(0, 0)) == sizeof(Yes) };
+};
+
+//! Start an object or an array of a known size, passing the size to the handler if it takes it.
+template <typename Handler, bool = IsSizedHandler<Handler>::Value>
+struct SizedStart {
+    static bool StartObject(Handler& handler, SizeType) { return handler.StartObject(); }
+    static bool StartArray(Handler& handler, SizeType) { return handler.StartArray(); }
+};
+
+template <typename Handler>
+struct SizedStart<Handler, true> {
+    static bool StartObject(Handler& handler, SizeType memberCount) { return handler.StartObject(memberCount); }
+    static bool StartArray(Handler& handler, SizeType elementCount) { return handler.StartArray(elementCount); }
+};
+
+} // namespace internal
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericCborReader
+
+//! CBOR (RFC 8949) parser generating the SAX events of GenericReader.
+/*! A CBOR data item is parsed into the events GenericReader generates for the
+    equivalent JSON text, so any Handler works with it. Writer turns it into
+    JSON, and GenericDocument::Populate() builds a document:
+    \li false, true, null and undefined become Bool() and Null().
+    \li Integers become Uint() or Uint64() when they are not negative, and
+        Int() or Int64() otherwise, depending on whether they fit. Negative
+        integers below the range of \c int64_t become Double().
+    \li Half, single and double precision floats become Double().
+    \li Text strings, arrays and maps become String(), StartArray(),
+        EndArray(), StartObject(), Key() and EndObject(), of definite or
+        indefinite length.
+    \li Tags are ignored, and the tagged item is parsed.
+
+    Maps must have text string keys, otherwise parsing fails with
+    \ref kParseErrorObjectMissName. Byte strings and other simple values have
+    no JSON equivalent and fail with \ref kParseErrorValueInvalid, as do
+    truncated or malformed items.
+
+    Definite-length text strings are passed as pointers into the input, unless
+    they are transcoded to another TargetEncoding or validated with
+    \ref kParseValidateEncodingFlag. They are passed with \c copy set, unless
+    \ref kParseInsituFlag is given: then a GenericDocument refers to the
+    strings in the input, which must live as long as the document. Since they
+    are not null-terminated, their lengths must be used.
+
+    Definite-length arrays and maps are started with StartArray(SizeType) and
+    StartObject(SizeType), if the handler has them, so that GenericDocument
+    reserves its stack for the elements at once.
+
+    Nested arrays and maps are parsed iteratively, so that deep nesting does
+    not overflow the call stack. Supported \c parseFlags are
+    \ref kParseInsituFlag, \ref kParseValidateEncodingFlag and
+    \ref kParseStopWhenDoneFlag.
+
+    \tparam TargetEncoding Encoding of the strings of the events.
+    \tparam StackAllocator Allocator for the stack of nested arrays and maps, and for transcoded strings.
+    \see CborWriter, GenericMsgPackReader
+*/
+template <typename TargetEncoding = UTF8<>, typename StackAllocator = CrtAllocator>
+class GenericCborReader {
+public:
+    typedef typename TargetEncoding::Ch Ch; //!< Character type of the events.
+
+    //! Constructor.
+    /*! \param stackAllocator Optional allocator for allocating stack memory. (Only use for non-destructive parsing)
+        \param stackCapacity stack capacity in bytes for storing nesting levels and a single decoded string.
+    */
+    GenericCborReader(StackAllocator* stackAllocator = 0, size_t stackCapacity = kDefaultStackCapacity) :
+        stack_(stackAllocator, stackCapacity), parseResult_() {}
+
+    //! Parse a CBOR data item.
+    /*! \tparam parseFlags Combination of \ref ParseFlag.
+        \tparam Handler Type of handler, implementing Handler concept.
+        \param data CBOR data.
+        \param size Size of the data in bytes.
+        \param handler The handler to receive events.
+        \return Whether the parsing is successful, with the offset of an error in \c data.
+    */
+    template <unsigned parseFlags, typename Handler>
+    ParseResult Parse(const void* data, size_t size, Handler& handler) {
+        parseResult_.Clear();
+        ClearStackOnExit scope(*this);
+        Input in;
+        in.begin = in.p = static_cast<const uint8_t*>(data);
+        in.end = in.begin + size;
+        if (RAPIDJSON_UNLIKELY(size == 0))
+            RAPIDJSON_PARSE_ERROR_NORETURN(kParseErrorDocumentEmpty, 0);
+        else
+            ParseRoot<parseFlags>(in, handler);
+        return parseResult_;
+    }
+
+    //! Parse a CBOR data item (with \ref kParseDefaultFlags)
+    template <typename Handler>
+    ParseResult Parse(const void* data, size_t size, Handler& handler) {
+        return Parse<kParseDefaultFlags>(data, size, handler);
+    }
+
+    //! Whether a parse error has occurred in the last parsing.
+    bool HasParseError() const { return parseResult_.IsError(); }
+
+    //! Get the \ref ParseErrorCode of last parsing.
+    ParseErrorCode GetParseErrorCode() const { return parseResult_.Code(); }
+
+    //! Get the position of last parsing error in input, 0 otherwise.
+    size_t GetErrorOffset() const { return parseResult_.Offset(); }
+
+protected:
+    void SetParseError(ParseErrorCode code, size_t offset) { parseResult_.Set(code, offset); }
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    GenericCborReader(const GenericCborReader&);
+    GenericCborReader& operator=(const GenericCborReader&);
+
+    struct ClearStackOnExit {
+        explicit ClearStackOnExit(GenericCborReader& r) : r_(r) {}
+        ~ClearStackOnExit() { r_.stack_.Clear(); r_.stack_.ShrinkToFit(); }
+    private:
+        GenericCborReader& r_;
+        ClearStackOnExit(const ClearStackOnExit&);
+        ClearStackOnExit& operator=(const ClearStackOnExit&);
+    };
+
+    struct Input {
+        size_t Tell() const { return static_cast<size_t>(p - begin); }
+        size_t Left() const { return static_cast<size_t>(end - p); }
+
+        const uint8_t* begin;
+        const uint8_t* p;
+        const uint8_t* end;
+    };
+
+    //! An array or map being parsed.
+    struct Level {
+        SizeType count;     //!< Number of elements or members parsed.
+        SizeType remaining; //!< Number of elements or members not parsed yet, if of definite length.
+        bool map;
+        bool value;         //!< Whether the value of a member is next.
+        bool indefinite;    //!< Whether ended by a break.
+    };
+
+    //! Output stream of transcoded strings, on top of the levels in the stack.
+    class StackStream {
+    public:
+        typedef typename TargetEncoding::Ch Ch;
+
+        StackStream(internal::Stack<StackAllocator>& stack) : stack_(stack), length_(0) {}
+        RAPIDJSON_FORCEINLINE void Put(Ch c) {
+            *stack_.template Push<Ch>() = c;
+            ++length_;
+        }
+        SizeType Length() const { return length_; }
+        Ch* Pop() { return stack_.template Pop<Ch>(length_); }
+
+    private:
+        StackStream(const StackStream&);
+        StackStream& operator=(const StackStream&);
+
+        internal::Stack<StackAllocator>& stack_;
+        SizeType length_;
+    };
+
+    enum MajorType {
+        kUnsigned = 0,
+        kNegative = 1,
+        kByteString = 2,
+        kTextString = 3,
+        kArray = 4,
+        kMap = 5,
+        kTag = 6,
+        kSimple = 7
+    };
+
+    static const uint8_t kIndefinite = 31;  //!< Additional information of indefinite-length items.
+    static const uint8_t kBreak = 0xFF;
+
+    template <unsigned parseFlags, typename Handler>
+    void ParseRoot(Input& in, Handler& handler) {
+        ParseValue<parseFlags>(in, handler);
+        RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+        while (!stack_.Empty()) {
+            Level& level = *stack_.template Top<Level>();
+            if (level.value) {
+                level.value = false;
+                ParseValue<parseFlags>(in, handler);   // may push a level
+            }
+            else {
+                bool end;
+                if (level.indefinite) {
+                    if (RAPIDJSON_UNLIKELY(in.p == in.end))
+                        RAPIDJSON_PARSE_ERROR(kParseErrorValueInvalid, in.Tell());
+                    end = *in.p == kBreak;
+                    if (end)
+                        in.p++;
+                }
+                else
+                    end = level.remaining-- == 0;
+
+                if (end) {
+                    const bool map = level.map;
+                    const SizeType count = level.count;
+                    stack_.template Pop<Level>(1);
+                    if (RAPIDJSON_UNLIKELY(!(map ? handler.EndObject(count) : handler.EndArray(count))))
+                        RAPIDJSON_PARSE_ERROR(kParseErrorTermination, in.Tell());
+                }
+                else {
+                    level.count++;
+                    if (level.map) {
+                        level.value = true;
+                        ParseKey<parseFlags>(in, handler);
+                    }
+                    else
+                        ParseValue<parseFlags>(in, handler);   // may push a level
+                }
+            }
+            RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+        }
+        if (!(parseFlags & kParseStopWhenDoneFlag) && in.p != in.end)
+            RAPIDJSON_PARSE_ERROR(kParseErrorDocumentRootNotSingular, in.Tell());
+    }
+
+    //! Read the argument of the head starting at \c offset, which follows its initial byte \c c.
+    bool ReadArgument(Input& in, uint8_t c, size_t offset, uint64_t& value) {
+        const unsigned info = c & 0x1Fu;
+        if (info < 24) {
+            value = info;
+            return true;
+        }
+        const size_t n = size_t(1) << (info - 24);
+        if (RAPIDJSON_UNLIKELY(info > 27 || in.Left() < n)) {     // reserved, indefinite or truncated
+            RAPIDJSON_PARSE_ERROR_NORETURN(kParseErrorValueInvalid, offset);
+            return false;
+        }
+        value = 0;
+        for (size_t i = 0; i < n; i++)
+            value = (value << 8) | in.p[i];
+        in.p += n;
+        return true;
+    }
+
+    //! Read the initial byte of a data item, skipping its tags.
+    bool ReadInitialByte(Input& in, size_t offset, uint8_t& c) {
+        for (;;) {
+            if (RAPIDJSON_UNLIKELY(in.p == in.end)) {
+                RAPIDJSON_PARSE_ERROR_NORETURN(kParseErrorValueInvalid, offset);
+                return false;
+            }
+            c = *in.p++;
+            if ((c >> 5) != kTag)
+                return true;
+            uint64_t tag;
+            if (!ReadArgument(in, c, offset, tag))
+                return false;
+        }
+    }
+
+    template <unsigned parseFlags, typename Handler>
+    void ParseKey(Input& in, Handler& handler) {
+        const size_t offset = in.Tell();
+        uint8_t c;
+        if (!ReadInitialByte(in, offset, c))
+            return;
+        if (RAPIDJSON_UNLIKELY((c >> 5) != kTextString))
+            RAPIDJSON_PARSE_ERROR(kParseErrorObjectMissName, offset);
+        ParseString<parseFlags>(in, c, offset, handler, true);
+    }
+
+    template <unsigned parseFlags, typename Handler>
+    void ParseValue(Input& in, Handler& handler) {
+        const size_t offset = in.Tell();
+        uint8_t c;
+        if (!ReadInitialByte(in, offset, c))
+            return;
+        bool ok;
+        uint64_t u;
+        switch (c >> 5) {
+        case kUnsigned:
+            if (!ReadArgument(in, c, offset, u))
+                return;
+            ok = u <= 0xFFFFFFFFu ? handler.Uint(static_cast<unsigned>(u)) : handler.Uint64(u);
+            break;
+
+        case kNegative:     // -1 - u
+            if (!ReadArgument(in, c, offset, u))
+                return;
+            if (u <= 0x7FFFFFFFu)
+                ok = handler.Int(-1 - static_cast<int>(u));
+            else if (u <= RAPIDJSON_UINT64_C2(0x7FFFFFFF, 0xFFFFFFFF))
+                ok = handler.Int64(-1 - static_cast<int64_t>(u));
+            else
+                ok = handler.Double(-1.0 - static_cast<double>(u));
+            break;
+
+        case kTextString:
+            ParseString<parseFlags>(in, c, offset, handler, false);
+            return;
+
+        case kArray:
+        case kMap:
+            StartContainer(in, c, offset, handler);
+            return;
+
+        case kSimple:
+            switch (c & 0x1F) {
+            case 20: ok = handler.Bool(false); break;
+            case 21: ok = handler.Bool(true); break;
+            case 22: // null
+            case 23: ok = handler.Null(); break;    // undefined
+            case 25: case 26: case 27:
+                if (!ReadArgument(in, c, offset, u))
+                    return;
+                ok = handler.Double(DecodeFloat(c & 0x1F, u));
+                break;
+            default:    // unassigned simple values and break
+                RAPIDJSON_PARSE_ERROR(kParseErrorValueInvalid, offset);
+            }
+            break;
+
+        default:    // byte string
+            RAPIDJSON_PARSE_ERROR(kParseErrorValueInvalid, offset);
+        }
+        if (RAPIDJSON_UNLIKELY(!ok))
+            RAPIDJSON_PARSE_ERROR(kParseErrorTermination, offset);
+    }
+
+    //! Decode a half (25), single (26) or double (27) precision float.
+    static double DecodeFloat(unsigned info, uint64_t bits) {
+        if (info == 27) {
+            double d;
+            std::memcpy(&d, &bits, sizeof(d));
+            return d;
+        }
+        if (info == 26) {
+            const uint32_t bits32 = static_cast<uint32_t>(bits);
+            float f;
+            std::memcpy(&f, &bits32, sizeof(f));
+            return static_cast<double>(f);
+        }
+        const int exponent = static_cast<int>((bits >> 10) & 0x1F);
+        const double mantissa = static_cast<double>(bits & 0x3FF);
+        double d;
+        if (exponent == 0)
+            d = std::ldexp(mantissa, -24);
+        else if (exponent != 31)
+            d = std::ldexp(mantissa + 1024, exponent - 25);
+        else if ((bits & 0x3FF) == 0)
+            d = std::numeric_limits<double>::infinity();
+        else
+            d = std::numeric_limits<double>::quiet_NaN();
+        return (bits & 0x8000) ? -d : d;
+    }
+
+    template <typename Handler>
+    void StartContainer(Input& in, uint8_t c, size_t offset, Handler& handler) {
+        const bool map = (c >> 5) == kMap;
+        const bool indefinite = (c & 0x1F) == kIndefinite;
+        uint64_t count = 0;
+        bool ok;
+        if (indefinite)
+            ok = map ? handler.StartObject() : handler.StartArray();
+        else {
+            if (!ReadArgument(in, c, offset, count))
+                return;
+            // Each element takes at least one byte.
+            if (RAPIDJSON_UNLIKELY(count > in.Left() / (map ? 2 : 1)))
+                RAPIDJSON_PARSE_ERROR(kParseErrorValueInvalid, offset);
+            ok = map ?
+                internal::SizedStart<Handler>::StartObject(handler, static_cast<SizeType>(count)) :
+                internal::SizedStart<Handler>::StartArray(handler, static_cast<SizeType>(count));
+        }
+        if (RAPIDJSON_UNLIKELY(!ok))
+            RAPIDJSON_PARSE_ERROR(kParseErrorTermination, offset);
+        Level* level = stack_.template Push<Level>();
+        level->count = 0;
+        level->remaining = static_cast<SizeType>(count);
+        level->map = map;
+        level->value = false;
+        level->indefinite = indefinite;
+    }
+
+    template <unsigned parseFlags, typename Handler>
+    void ParseString(Input& in, uint8_t c, size_t offset, Handler& handler, bool isKey) {
+        const Ch* str;
+        SizeType length;
+        bool copy = true;
+        if ((c & 0x1F) != kIndefinite) {
+            uint64_t n;
+            if (!ReadArgument(in, c, offset, n))
+                return;
+            if (RAPIDJSON_UNLIKELY(n > in.Left()))
+                RAPIDJSON_PARSE_ERROR(kParseErrorValueInvalid, offset);
+            const char* s = reinterpret_cast<const char*>(in.p);
+            in.p += n;
+            if (!(parseFlags & kParseValidateEncodingFlag) && internal::IsSame<TargetEncoding, UTF8<> >::Value) {
+                str = reinterpret_cast<const Ch*>(s);
+                length = static_cast<SizeType>(n);
+                copy = !(parseFlags & kParseInsituFlag);
+            }
+            else {
+                StackStream os(stack_);
+                if (RAPIDJSON_UNLIKELY(!PutChunk<parseFlags>(os, s, static_cast<size_t>(n))))
+                    RAPIDJSON_PARSE_ERROR(kParseErrorStringInvalidEncoding, offset);
+                os.Put('\0');
+                length = os.Length() - 1;
+                str = os.Pop();
+            }
+        }
+        else {  // chunks of definite-length text strings
+            StackStream os(stack_);
+            for (;;) {
+                if (RAPIDJSON_UNLIKELY(in.p == in.end))
+                    RAPIDJSON_PARSE_ERROR(kParseErrorValueInvalid, offset);
+                const uint8_t chunk = *in.p++;
+                if (chunk == kBreak)
+                    break;
+                uint64_t n;
+                if (RAPIDJSON_UNLIKELY((chunk >> 5) != kTextString || (chunk & 0x1F) == kIndefinite))
+                    RAPIDJSON_PARSE_ERROR(kParseErrorValueInvalid, offset);
+                if (!ReadArgument(in, chunk, offset, n))
+                    return;
+                if (RAPIDJSON_UNLIKELY(n > in.Left()))
+                    RAPIDJSON_PARSE_ERROR(kParseErrorValueInvalid, offset);
+                if (RAPIDJSON_UNLIKELY(!PutChunk<parseFlags>(os, reinterpret_cast<const char*>(in.p), static_cast<size_t>(n))))
+                    RAPIDJSON_PARSE_ERROR(kParseErrorStringInvalidEncoding, offset);
+                in.p += n;
+            }
+            os.Put('\0');
+            length = os.Length() - 1;
+            str = os.Pop();
+        }
+        if (RAPIDJSON_UNLIKELY(!(isKey ? handler.Key(str, length, copy) : handler.String(str, length, copy))))
+            RAPIDJSON_PARSE_ERROR(kParseErrorTermination, offset);
+    }
+
+    //! Transcode a UTF-8 chunk of a string to the stack.
+    template <unsigned parseFlags>
+    static bool PutChunk(StackStream& os, const char* str, size_t length) {
+        MemoryStream is(str, length);
+        while (is.Tell() < length)
+            if (RAPIDJSON_UNLIKELY(!(parseFlags & kParseValidateEncodingFlag ?
+                    Transcoder<UTF8<>, TargetEncoding>::Validate(is, os) :
+                    Transcoder<UTF8<>, TargetEncoding>::Transcode(is, os)) || is.Tell() > length))
+                return false;
+        return true;
+    }
+
+    static const size_t kDefaultStackCapacity = 256;    //!< Default stack capacity in bytes for storing nesting levels and a single decoded string.
+    internal::Stack<StackAllocator> stack_;             //!< Stack for the nesting levels and a transcoded string.
+    ParseResult parseResult_;
+};
+
+//! CBOR reader with UTF8 encoding and default allocator.
+typedef GenericCborReader<UTF8<>, CrtAllocator> CborReader;
+
+///////////////////////////////////////////////////////////////////////////////
+// CborWriter
+
+//! CBOR (RFC 8949) writer
+/*! CborWriter implements the concept Handler, like Writer, and generates a
+    CBOR data item for the events, e.g. from Document::Accept() or
+    Reader::Parse(). Integers and lengths are written in their shortest form,
+    and each double in the shortest of half, single and double precision which
+    keeps its value, as in the preferred serialization of RFC 8949.
+
+    Arrays and maps are of definite length, so that readers can size them at
+    once. Since their heads contain their sizes, the content of a root array or
+    object is kept in an internal buffer until it ends, and then written to the
+    stream at once. Other roots are written right away.
+
+    \tparam OutputStream Type of output byte stream.
+    \tparam StackAllocator Type of allocator for allocating memory of the stack and of the buffer.
+    \note Strings are UTF-8. RawNumber() and RawValue() parse their JSON text.
+    \see GenericCborReader, MsgPackWriter
+*/
+template <typename OutputStream, typename StackAllocator = CrtAllocator>
+class CborWriter {
+public:
+    typedef char Ch;
+
+    //! Constructor
+    /*! \param os Output stream.
+        \param stackAllocator User supplied allocator. If it is null, it will create a private one.
+        \param levelDepth Initial capacity of stack.
+    */
+    explicit
+    CborWriter(OutputStream& os, StackAllocator* stackAllocator = 0, size_t levelDepth = kDefaultLevelDepth) :
+        os_(&os), level_stack_(stackAllocator, levelDepth * sizeof(Level)), buffer_(stackAllocator, 0), gaps_(stackAllocator, 0), hasRoot_(false) {}
+
+    explicit
+    CborWriter(StackAllocator* allocator = 0, size_t levelDepth = kDefaultLevelDepth) :
+        os_(0), level_stack_(allocator, levelDepth * sizeof(Level)), buffer_(allocator, 0), gaps_(allocator, 0), hasRoot_(false) {}
+
+    //! Reset the writer with a new stream.
+    /*! \see Writer::Reset() */
+    void Reset(OutputStream& os) {
+        os_ = &os;
+        hasRoot_ = false;
+        level_stack_.Clear();
+        buffer_.Clear();
+        gaps_.Clear();
+    }
+
+    //! Checks whether the output is a complete CBOR data item.
+    bool IsComplete() const {
+        return hasRoot_ && level_stack_.Empty();
+    }
+
+    /*!@name Implementation of Handler
+        \see Handler
+    */
+    //@{
+
+    bool Null()                 { Prefix(); return WriteHead(kSimple, 22); }
+    bool Bool(bool b)           { Prefix(); return WriteHead(kSimple, b ? 21 : 20); }
+    bool Int(int i)             { Prefix(); return WriteInt64(i); }
+    bool Uint(unsigned u)       { Prefix(); return WriteHead(kUnsigned, u); }
+    bool Int64(int64_t i64)     { Prefix(); return WriteInt64(i64); }
+    bool Uint64(uint64_t u64)   { Prefix(); return WriteHead(kUnsigned, u64); }
+
+    bool Double(double d) {
+        Prefix();
+        if (internal::Double(d).IsNan())
+            return WriteFloat(25, 0x7E00, 2);
+        const float f = static_cast<float>(d);
+        if (!(static_cast<double>(f) >= d && static_cast<double>(f) <= d)) {    // Prevent -Wfloat-equal
+            uint64_t u;
+            std::memcpy(&u, &d, sizeof(u));
+            return WriteFloat(27, u, 8);
+        }
+        uint32_t u;
+        std::memcpy(&u, &f, sizeof(u));
+        uint16_t h;
+        if (ToHalf(u, h))
+            return WriteFloat(25, h, 2);
+        return WriteFloat(26, u, 4);
+    }
+
+    //! Write a number in JSON text, e.g. from \ref kParseNumbersAsStringsFlag, as an integer or a float.
+    bool RawNumber(const Ch* str, SizeType length, bool copy = false) {
+        RAPIDJSON_ASSERT(str != 0);
+        (void)copy;
+        return RawValue(str, length, kNumberType);
+    }
+
+    bool String(const Ch* str, SizeType length, bool copy = false) {
+        RAPIDJSON_ASSERT(str != 0);
+        (void)copy;
+        Prefix();
+        return WriteString(str, length);
+    }
+
+#if RAPIDJSON_HAS_STDSTRING
+    bool String(const std::basic_string<Ch>& str) {
+        return String(str.data(), SizeType(str.size()));
+    }
+#endif
+
+    bool StartObject() { Prefix(); return StartLevel(false); }
+
+    bool Key(const Ch* str, SizeType length, bool copy = false) {
+        RAPIDJSON_ASSERT(str != 0);
+        (void)copy;
+        RAPIDJSON_ASSERT(!level_stack_.Empty() && !level_stack_.template Top<Level>()->inArray);
+        level_stack_.template Top<Level>()->count++;
+        return WriteString(str, length);
+    }
+
+    bool EndObject(SizeType memberCount = 0) {
+        (void)memberCount;
+        RAPIDJSON_ASSERT(!level_stack_.Empty() && !level_stack_.template Top<Level>()->inArray);
+        return EndLevel(kMap);
+    }
+
+    bool StartArray() { Prefix(); return StartLevel(true); }
+
+    bool EndArray(SizeType elementCount = 0) {
+        (void)elementCount;
+        RAPIDJSON_ASSERT(!level_stack_.Empty() && level_stack_.template Top<Level>()->inArray);
+        return EndLevel(kArray);
+    }
+    //@}
+
+    /*! @name Convenience extensions */
+    //@{
+
+    //! Simpler but slower overload.
+    bool String(const Ch* str) { return String(str, internal::StrLen(str)); }
+    bool Key(const Ch* str) { return Key(str, internal::StrLen(str)); }
+
+    //@}
+
+    //! Write a value given as JSON text.
+    /*! \param json A well-formed JSON value.
+        \param length Length of the json.
+        \param type Type of the root of json.
+        \return Whether \c json could be parsed.
+    */
+    bool RawValue(const Ch* json, size_t length, Type type) {
+        RAPIDJSON_ASSERT(json != 0);
+        (void)type;
+        MemoryStream is(json, length);
+        GenericReader<UTF8<>, UTF8<>, StackAllocator> reader;
+        return !reader.template Parse<kParseFullPrecisionFlag>(is, *this).IsError();
+    }
+
+protected:
+    //! Information for each nested level
+    struct Level {
+        size_t head;        //!< Offset of the space for the head in the buffer.
+        size_t gap;         //!< Index of the unused part of that space in the gaps.
+        SizeType count;     //!< Number of elements or members.
+        bool inArray;       //!< true if in array, otherwise in object
+    };
+
+    //! Bytes of the buffer not to be written.
+    struct Gap {
+        size_t offset;
+        size_t length;
+    };
+
+    enum MajorType {
+        kUnsigned = 0,
+        kNegative = 1,
+        kTextString = 3,
+        kArray = 4,
+        kMap = 5,
+        kSimple = 7
+    };
+
+    static const size_t kDefaultLevelDepth = 32;
+    static const size_t kMaxContainerHeadSize = 5;  //!< Size of the head of an array or a map with a 32-bit size.
+
+    void Prefix() {
+        if (RAPIDJSON_LIKELY(!level_stack_.Empty())) {
+            Level* level = level_stack_.template Top<Level>();
+            if (level->inArray)
+                level->count++;
+        }
+        else {
+            RAPIDJSON_ASSERT(!hasRoot_);    // Should only has one and only one root.
+            hasRoot_ = true;
+        }
+    }
+
+    void Put(const uint8_t* bytes, size_t n) {
+        if (RAPIDJSON_LIKELY(!level_stack_.Empty()))
+            std::memcpy(buffer_.template Push<uint8_t>(n), bytes, n);
+        else {
+            PutReserve(*os_, n);
+            for (size_t i = 0; i < n; i++)
+                PutUnsafe(*os_, static_cast<typename OutputStream::Ch>(bytes[i]));
+        }
+    }
+
+    //! Encode the shortest head of a data item.
+    static size_t EncodeHead(uint8_t* head, MajorType major, uint64_t value) {
+        size_t n;
+        uint8_t info;
+        if (value < 24)                 { info = static_cast<uint8_t>(value); n = 0; }
+        else if (value <= 0xFF)         { info = 24; n = 1; }
+        else if (value <= 0xFFFF)       { info = 25; n = 2; }
+        else if (value <= 0xFFFFFFFFu)  { info = 26; n = 4; }
+        else                            { info = 27; n = 8; }
+        head[0] = static_cast<uint8_t>((major << 5) | info);
+        for (size_t i = n; i > 0; i--, value >>= 8)
+            head[i] = static_cast<uint8_t>(value);
+        return n + 1;
+    }
+
+    bool WriteHead(MajorType major, uint64_t value) {
+        uint8_t head[9];
+        Put(head, EncodeHead(head, major, value));
+        return EndValue();
+    }
+
+    bool WriteInt64(int64_t i) {
+        if (i >= 0)
+            return WriteHead(kUnsigned, static_cast<uint64_t>(i));
+        return WriteHead(kNegative, ~static_cast<uint64_t>(i));    // -1 - i
+    }
+
+    bool WriteFloat(uint8_t info, uint64_t bits, size_t n) {
+        uint8_t bytes[9];
+        bytes[0] = static_cast<uint8_t>((kSimple << 5) | info);
+        for (size_t i = n; i > 0; i--, bits >>= 8)
+            bytes[i] = static_cast<uint8_t>(bits);
+        Put(bytes, n + 1);
+        return EndValue();
+    }
+
+    //! Convert the bits of a float to a half precision float, if it keeps the value.
+    static bool ToHalf(uint32_t bits, uint16_t& half) {
+        const uint32_t sign = (bits >> 16) & 0x8000u;
+        const int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127;
+        const uint32_t mantissa = bits & 0x7FFFFFu;
+        if (exponent == -127 && mantissa == 0)      // zero
+            half = static_cast<uint16_t>(sign);
+        else if (exponent == 128)                   // infinity, NaN is handled by the caller
+            half = static_cast<uint16_t>(sign | 0x7C00u);
+        else if (exponent >= -14 && exponent <= 15 && (mantissa & 0x1FFF) == 0)
+            half = static_cast<uint16_t>(sign | static_cast<uint32_t>(exponent + 15) << 10 | mantissa >> 13);
+        else if (exponent >= -24 && exponent < -14) {  // subnormal
+            const unsigned shift = static_cast<unsigned>(13 - 14 - exponent);
+            const uint32_t significand = mantissa | 0x800000u;
+            if ((significand & ((1u << shift) - 1)) != 0)
+                return false;
+            half = static_cast<uint16_t>(sign | significand >> shift);
+        }
+        else
+            return false;
+        return true;
+    }
+
+    bool WriteString(const Ch* str, SizeType length) {
+        uint8_t head[9];
+        const size_t n = EncodeHead(head, kTextString, length);
+        if (level_stack_.Empty()) {
+            PutReserve(*os_, n + length);
+            for (size_t i = 0; i < n; i++)
+                PutUnsafe(*os_, static_cast<typename OutputStream::Ch>(head[i]));
+            for (SizeType i = 0; i < length; i++)
+                PutUnsafe(*os_, static_cast<typename OutputStream::Ch>(str[i]));
+            return EndValue();
+        }
+        uint8_t* p = buffer_.template Push<uint8_t>(n + length);
+        std::memcpy(p, head, n);
+        std::memcpy(p + n, str, length);
+        return true;
+    }
+
+    bool StartLevel(bool inArray) {
+        Level* level = level_stack_.template Push<Level>();
+        level->head = buffer_.GetSize();
+        level->gap = gaps_.GetSize() / sizeof(Gap);
+        level->count = 0;
+        level->inArray = inArray;
+        buffer_.template Push<uint8_t>(kMaxContainerHeadSize);
+        Gap* gap = gaps_.template Push<Gap>();
+        gap->offset = level->head;
+        gap->length = 0;
+        return true;
+    }
+
+    //! Write the head of the ended array or map into the end of its space, and the buffer to the stream at the end of the root.
+    bool EndLevel(MajorType major) {
+        const Level level = *level_stack_.template Pop<Level>(1);
+        uint8_t head[9];
+        const size_t n = EncodeHead(head, major, level.count);
+        std::memcpy(buffer_.template Bottom<uint8_t>() + level.head + kMaxContainerHeadSize - n, head, n);
+        gaps_.template Bottom<Gap>()[level.gap].length = kMaxContainerHeadSize - n;
+        if (!level_stack_.Empty())
+            return true;
+
+        const uint8_t* bytes = buffer_.template Bottom<uint8_t>();
+        size_t offset = 0;
+        for (const Gap* gap = gaps_.template Bottom<Gap>(); gap != gaps_.template End<Gap>(); ++gap) {
+            Put(bytes + offset, gap->offset - offset);
+            offset = gap->offset + gap->length;
+        }
+        Put(bytes + offset, buffer_.GetSize() - offset);
+        buffer_.Clear();
+        gaps_.Clear();
+        return EndValue();
+    }
+
+    bool EndValue() {
+        if (RAPIDJSON_UNLIKELY(level_stack_.Empty()))   // end of root
+            os_->Flush();
+        return true;
+    }
+
+    OutputStream* os_;
+    internal::Stack<StackAllocator> level_stack_;
+    internal::Stack<StackAllocator> buffer_;    //!< Content of the root array or object.
+    internal::Stack<StackAllocator> gaps_;      //!< Unused head space in the buffer, in order.
+    bool hasRoot_;
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    CborWriter(const CborWriter&);
+    CborWriter& operator=(const CborWriter&);
+};
+
+RAPIDJSON_NAMESPACE_END
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_CBOR_H_
@@ -52,6 +52,39 @@ RAPIDJSON_DIAG_OFF(terminate) // ignore throwing RAPIDJSON_ASSERT in RAPIDJSON_N
 #include <utility> // std::move
 #endif
 
+/*! \def RAPIDJSON_MEMBER_INDEX
+    \ingroup RAPIDJSON_CONFIG
+    \brief Enable a hash index of the members of large objects.
+
+    By default, FindMember() searches the members one by one. Define it as 1
+    (identically in all translation units) to reserve a hash table of the
+    member names behind the member array of objects with a capacity of at
+    least \ref RAPIDJSON_MEMBER_INDEX_THRESHOLD members, so that FindMember()
+    takes constant time on average.
+
+    Members renamed or reordered through a \c MemberIterator are not seen by
+    the table; call GenericValue::RebuildMemberIndex() afterwards.
+
+    The table is filled by the first lookup of a member, which may be made
+    through a const reference. Like a \ref GenericDocument::ParseLazy()
+    "lazily parsed" value, such an object must then not be searched by
+    several threads at once before it has been searched once.
+*/
+#ifndef RAPIDJSON_MEMBER_INDEX
+#define RAPIDJSON_MEMBER_INDEX 0
+#endif
+
+/*! \def RAPIDJSON_MEMBER_INDEX_THRESHOLD
+    \ingroup RAPIDJSON_CONFIG
+    \brief Minimum member capacity of an object for a hash index of its members.
+
+    Only used with \ref RAPIDJSON_MEMBER_INDEX. Define it as a larger value
+    to save memory.
+*/
+#ifndef RAPIDJSON_MEMBER_INDEX_THRESHOLD
+#define RAPIDJSON_MEMBER_INDEX_THRESHOLD 32
+#endif
+
 RAPIDJSON_NAMESPACE_BEGIN
 
 // Forward declaration.
@@ -386,6 +419,103 @@ inline GenericStringRef<CharType> StringRef(const std::basic_string<CharType>& s
 }
 #endif
 
+///////////////////////////////////////////////////////////////////////////////
+// GenericKeyRef
+
+//! Reference to a constant string with a precomputed hash, for looking up object members
+/*!
+    \tparam CharType character type of the string
+
+    A GenericValue made from a key reference remembers the hash of its
+    characters. GenericValue::FindMember() then needs no hashing for a
+    \ref RAPIDJSON_MEMBER_INDEX "member index", and compares the
+    hashes of names before their characters, e.g. with names parsed with
+    \ref kParseInternKeysFlag.
+
+    Key references are usually created by \ref RAPIDJSON_KEY, which hashes
+    a string literal at compile time when \c constexpr is available:
+    \code
+    const Value& id = record[RAPIDJSON_KEY("id")];
+    \endcode
+
+    \see KeyRef, RAPIDJSON_KEY
+*/
+template<typename CharType>
+struct GenericKeyRef : GenericStringRef<CharType> {
+    //! Create key reference from \c const character array, hashing it
+    template<SizeType N>
+    explicit GenericKeyRef(const CharType (&str)[N]) RAPIDJSON_NOEXCEPT
+        : GenericStringRef<CharType>(str), hash(static_cast<SizeType>(internal::StrHash(str, N - 1))) {}
+
+    //! Create key reference from pointer, length and its \c internal::StrHash()
+    GenericKeyRef(const CharType* str, SizeType len, SizeType h)
+        : GenericStringRef<CharType>(str, len), hash(h) { RAPIDJSON_ASSERT(h == internal::StrHash(str, len)); }
+
+    GenericKeyRef(const GenericKeyRef& rhs) : GenericStringRef<CharType>(rhs), hash(rhs.hash) {}
+
+    const SizeType hash; //!< hash of the string
+
+private:
+    //! Disallow construction from non-const array
+    template<SizeType N>
+    GenericKeyRef(CharType (&str)[N]) /* = delete */;
+    //! Copy assignment operator not permitted - immutable type
+    GenericKeyRef& operator=(const GenericKeyRef& rhs) /* = delete */;
+};
+
+//! Mark a string literal as object member name with a precomputed hash
+/*! \tparam CharType character type of the string
+    \param str Constant string, lifetime assumed to be longer than the use of the string in e.g. a GenericValue
+    \return GenericKeyRef key reference object
+    \relatesalso GenericKeyRef
+    \see RAPIDJSON_KEY
+*/
+template<typename CharType, SizeType N>
+inline GenericKeyRef<CharType> KeyRef(const CharType (&str)[N]) {
+    return GenericKeyRef<CharType>(str);
+}
+
+//! Mark a character pointer as object member name
+/*! \tparam CharType character type of the string
+    \param str Constant string, lifetime assumed to be longer than the use of the string in e.g. a GenericValue
+    \param length The length of source string.
+    \return GenericKeyRef key reference object
+    \relatesalso GenericKeyRef
+*/
+template<typename CharType>
+inline GenericKeyRef<CharType> KeyRef(const CharType* str, size_t length) {
+    return GenericKeyRef<CharType>(str, SizeType(length), static_cast<SizeType>(internal::StrHash(str, SizeType(length))));
+}
+
+//! Mark a character pointer as object member name with a given hash
+/*! \tparam CharType character type of the string
+    \param str Constant string, lifetime assumed to be longer than the use of the string in e.g. a GenericValue
+    \param length The length of source string.
+    \param hash \c internal::StrHash() of the string, e.g. computed at compile time by \ref RAPIDJSON_KEY.
+    \return GenericKeyRef key reference object
+    \relatesalso GenericKeyRef
+*/
+template<typename CharType>
+inline GenericKeyRef<CharType> KeyRef(const CharType* str, size_t length, SizeType hash) {
+    return GenericKeyRef<CharType>(str, SizeType(length), hash);
+}
+
+/*! \def RAPIDJSON_KEY
+    \ingroup RAPIDJSON_CONFIG
+    \brief Key reference (\ref GenericKeyRef) of a string literal, hashed at compile time.
+
+    Without C++11 \c constexpr (\ref RAPIDJSON_HAS_CXX11_CONSTEXPR), the hash
+    is computed when the key reference is created, which compilers usually
+    fold for literals as well.
+*/
+#if RAPIDJSON_HAS_CXX11_CONSTEXPR
+#define RAPIDJSON_KEY(str) \
+    ::RAPIDJSON_NAMESPACE::KeyRef(str, sizeof(str) / sizeof(str[0]) - 1, \
+        ::RAPIDJSON_NAMESPACE::internal::StrHashConstant< ::RAPIDJSON_NAMESPACE::internal::StrHashLiteral(str, static_cast< ::RAPIDJSON_NAMESPACE::SizeType>(sizeof(str) / sizeof(str[0]) - 1))>::Value)
+#else
+#define RAPIDJSON_KEY(str) ::RAPIDJSON_NAMESPACE::KeyRef(str)
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 // GenericValue type traits
 namespace internal {
@@ -400,6 +530,29 @@ template <typename T> struct IsGenericValueImpl<T, typename Void<typename T::Enc
 // helper to match arbitrary GenericValue instantiations, including derived classes
 template <typename T> struct IsGenericValue : IsGenericValueImpl<T>::Type {};
 
+//! Whether a Handler has RawValue(), like Writer and GenericDocument, to take the text of a number of kParseLazyNumbersFlag verbatim.
+template <typename Handler, typename Ch>
+class IsRawValueHandler {
+    typedef char Yes;
+    struct No { char c[2]; };
+    template <typename T, bool (T::*)(const Ch*, size_t, Type)> struct Check;
+    template <typename T> static Yes Test(Check<T, &T::RawValue>*);
+    template <typename T> static No Test(...);
+public:
+    enum { Value = sizeof(Test<Handler>(0)) == sizeof(Yes) };
+};
+
+//! Pass the text of a number to the handler with RawValue(), if it has one.
+template <typename Handler, typename Ch, bool = IsRawValueHandler<Handler, Ch>::Value>
+struct RawNumberText {
+    static bool Accept(Handler&, const Ch*, SizeType) { RAPIDJSON_ASSERT(false); return false; }
+};
+
+template <typename Handler, typename Ch>
+struct RawNumberText<Handler, Ch, true> {
+    static bool Accept(Handler& handler, const Ch* str, SizeType length) { return handler.RawValue(str, length, kNumberType); }
+};
+
 } // namespace internal
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -545,6 +698,7 @@ public:
     typedef Allocator AllocatorType;                //!< Allocator type from template parameter.
     typedef typename Encoding::Ch Ch;               //!< Character type derived from Encoding.
     typedef GenericStringRef<Ch> StringRefType;     //!< Reference to a constant string
+    typedef GenericKeyRef<Ch> KeyRefType;           //!< Reference to a constant string with a precomputed hash
     typedef typename GenericMemberIterator<false,Encoding,Allocator>::Iterator MemberIterator;  //!< Member iterator for iterating in object.
     typedef typename GenericMemberIterator<true,Encoding,Allocator>::Iterator ConstMemberIterator;  //!< Constant member iterator for iterating in object.
     typedef GenericValue* ValueIterator;            //!< Value iterator for iterating in array.
@@ -678,6 +832,10 @@ public:
     //! Constructor for constant string (i.e. do not make a copy of string)
     explicit GenericValue(StringRefType s) RAPIDJSON_NOEXCEPT : data_() { SetStringRaw(s); }
 
+    //! Constructor for constant string with a precomputed hash (i.e. do not make a copy of string)
+    /*! \see RAPIDJSON_KEY */
+    explicit GenericValue(KeyRefType s) RAPIDJSON_NOEXCEPT : data_() { SetHashedStringRaw(s, s.hash); }
+
     //! Constructor for copy-string (i.e. do make a copy of string)
     GenericValue(const Ch* s, SizeType length, Allocator& allocator) : data_() { SetStringRaw(StringRef(s, length), allocator); }
 
@@ -735,6 +893,8 @@ public:
                 break;
 
             case kCopyStringFlag:
+            case kHashedCopyStringFlag:
+            case kLazyCopyNumberFlag:
                 Allocator::Free(const_cast<Ch*>(GetStringPointer()));
                 break;
 
@@ -854,6 +1014,8 @@ public:
         if (GetType() != rhs.GetType())
             return false;
 
+        Expand();
+        rhs.Expand();
         switch (GetType()) {
         case kObjectType: // Warning: O(n^2) inner-loop
             if (data_.o.size != rhs.data_.o.size)
@@ -877,6 +1039,8 @@ public:
             return StringEqual(rhs);
 
         case kNumberType:
+            Convert();
+            rhs.Convert();
             if (IsDouble() || rhs.IsDouble()) {
                 double a = GetDouble();     // May convert from integer to double.
                 double b = rhs.GetDouble(); // Ditto
@@ -938,14 +1102,14 @@ public:
     bool IsFalse()  const { return data_.f.flags == kFalseFlag; }
     bool IsTrue()   const { return data_.f.flags == kTrueFlag; }
     bool IsBool()   const { return (data_.f.flags & kBoolFlag) != 0; }
-    bool IsObject() const { return data_.f.flags == kObjectFlag; }
-    bool IsArray()  const { return data_.f.flags == kArrayFlag; }
+    bool IsObject() const { return GetType() == kObjectType; }
+    bool IsArray()  const { return GetType() == kArrayType; }
     bool IsNumber() const { return (data_.f.flags & kNumberFlag) != 0; }
-    bool IsInt()    const { return (data_.f.flags & kIntFlag) != 0; }
-    bool IsUint()   const { return (data_.f.flags & kUintFlag) != 0; }
-    bool IsInt64()  const { return (data_.f.flags & kInt64Flag) != 0; }
-    bool IsUint64() const { return (data_.f.flags & kUint64Flag) != 0; }
-    bool IsDouble() const { return (data_.f.flags & kDoubleFlag) != 0; }
+    bool IsInt()    const { Convert(); return (data_.f.flags & kIntFlag) != 0; }
+    bool IsUint()   const { Convert(); return (data_.f.flags & kUintFlag) != 0; }
+    bool IsInt64()  const { Convert(); return (data_.f.flags & kInt64Flag) != 0; }
+    bool IsUint64() const { Convert(); return (data_.f.flags & kUint64Flag) != 0; }
+    bool IsDouble() const { Convert(); return (data_.f.flags & kDoubleFlag) != 0; }
     bool IsString() const { return (data_.f.flags & kStringFlag) != 0; }
 
     // Checks whether a number can be losslessly converted to a double.
@@ -970,7 +1134,7 @@ public:
 
     // Checks whether a number is a float (possible lossy).
     bool IsFloat() const  {
-        if ((data_.f.flags & kDoubleFlag) == 0)
+        if (!IsDouble())
             return false;
         double d = GetDouble();
         return d >= -3.4028234e38 && d <= 3.4028234e38;
@@ -1013,10 +1177,10 @@ public:
     GenericValue& SetObject() { this->~GenericValue(); new (this) GenericValue(kObjectType); return *this; }
 
     //! Get the number of members in the object.
-    SizeType MemberCount() const { RAPIDJSON_ASSERT(IsObject()); return data_.o.size; }
+    SizeType MemberCount() const { RAPIDJSON_ASSERT(IsObject()); Expand(); return data_.o.size; }
 
     //! Check whether the object is empty.
-    bool ObjectEmpty() const { RAPIDJSON_ASSERT(IsObject()); return data_.o.size == 0; }
+    bool ObjectEmpty() const { RAPIDJSON_ASSERT(IsObject()); Expand(); return data_.o.size == 0; }
 
     //! Get a value from an object associated with the name.
     /*! \pre IsObject() == true
@@ -1025,7 +1189,7 @@ public:
         Since 0.2, if the name is not correct, it will assert.
         If user is unsure whether a member exists, user should use HasMember() first.
         A better approach is to use FindMember().
-        \note Linear time complexity.
+        \note Linear time complexity, or constant on average with a member index (see \ref RAPIDJSON_MEMBER_INDEX).
     */
     template <typename T>
     RAPIDJSON_DISABLEIF_RETURN((internal::NotExpr<internal::IsSame<typename internal::RemoveConst<T>::Type, Ch> >),(GenericValue&)) operator[](T* name) {
@@ -1033,7 +1197,10 @@ public:
         return (*this)[n];
     }
     template <typename T>
-    RAPIDJSON_DISABLEIF_RETURN((internal::NotExpr<internal::IsSame<typename internal::RemoveConst<T>::Type, Ch> >),(const GenericValue&)) operator[](T* name) const { return const_cast<GenericValue&>(*this)[name]; }
+    RAPIDJSON_DISABLEIF_RETURN((internal::NotExpr<internal::IsSame<typename internal::RemoveConst<T>::Type, Ch> >),(const GenericValue&)) operator[](T* name) const {
+        GenericValue n(StringRef(name));
+        return (*this)[n];
+    }
 
     //! Get a value from an object associated with the name.
     /*! \pre IsObject() == true
@@ -1042,27 +1209,20 @@ public:
         \note Compared to \ref operator[](T*), this version is faster because it does not need a StrLen().
         And it can also handle strings with embedded null characters.
 
-        \note Linear time complexity.
+        \note Linear time complexity, or constant on average with a member index (see \ref RAPIDJSON_MEMBER_INDEX).
     */
     template <typename SourceAllocator>
-    GenericValue& operator[](const GenericValue<Encoding, SourceAllocator>& name) {
-        MemberIterator member = FindMember(name);
-        if (member != MemberEnd())
-            return member->value;
-        else {
-            RAPIDJSON_ASSERT(false);    // see above note
-
-            // This will generate -Wexit-time-destructors in clang
-            // static GenericValue NullValue;
-            // return NullValue;
-
-            // Use static buffer and placement-new to prevent destruction
-            static char buffer[sizeof(GenericValue)];
-            return *new (buffer) GenericValue();
-        }
-    }
+    GenericValue& operator[](const GenericValue<Encoding, SourceAllocator>& name) { return MemberValue(DoFindMember(name)); }
     template <typename SourceAllocator>
-    const GenericValue& operator[](const GenericValue<Encoding, SourceAllocator>& name) const { return const_cast<GenericValue&>(*this)[name]; }
+    const GenericValue& operator[](const GenericValue<Encoding, SourceAllocator>& name) const {
+        GenericValue& v = const_cast<GenericValue&>(*this);
+        return v.MemberValue(v.DoFindMember(name));
+    }
+
+    //! Get a value from an object associated with the name of a key reference.
+    /*! \see RAPIDJSON_KEY */
+    GenericValue& operator[](const KeyRefType& name) { return (*this)[GenericValue(name)]; }
+    const GenericValue& operator[](const KeyRefType& name) const { return (*this)[GenericValue(name)]; }
 
 #if RAPIDJSON_HAS_STDSTRING
     //! Get a value from an object associated with name (string object).
@@ -1072,16 +1232,33 @@ public:
 
     //! Const member iterator
     /*! \pre IsObject() == true */
-    ConstMemberIterator MemberBegin() const { RAPIDJSON_ASSERT(IsObject()); return ConstMemberIterator(GetMembersPointer()); }
+    ConstMemberIterator MemberBegin() const { RAPIDJSON_ASSERT(IsObject()); Expand(); return ConstMemberIterator(GetMembersPointer()); }
     //! Const \em past-the-end member iterator
     /*! \pre IsObject() == true */
-    ConstMemberIterator MemberEnd() const   { RAPIDJSON_ASSERT(IsObject()); return ConstMemberIterator(GetMembersPointer() + data_.o.size); }
+    ConstMemberIterator MemberEnd() const   { RAPIDJSON_ASSERT(IsObject()); Expand(); return ConstMemberIterator(GetMembersPointer() + data_.o.size); }
     //! Member iterator
-    /*! \pre IsObject() == true */
-    MemberIterator MemberBegin()            { RAPIDJSON_ASSERT(IsObject()); return MemberIterator(GetMembersPointer()); }
+    /*! \pre IsObject() == true
+        \note After renaming or reordering (e.g. sorting) members through the returned
+            iterator, call RebuildMemberIndex() before the next lookup.
+    */
+    MemberIterator MemberBegin()            { RAPIDJSON_ASSERT(IsObject()); Expand(); return MemberIterator(GetMembersPointer()); }
     //! \em Past-the-end member iterator
     /*! \pre IsObject() == true */
-    MemberIterator MemberEnd()              { RAPIDJSON_ASSERT(IsObject()); return MemberIterator(GetMembersPointer() + data_.o.size); }
+    MemberIterator MemberEnd()              { RAPIDJSON_ASSERT(IsObject()); Expand(); return MemberIterator(GetMembersPointer() + data_.o.size); }
+
+    //! Rebuild the member index after members were renamed or reordered through iterators.
+    /*! Does nothing without a \ref RAPIDJSON_MEMBER_INDEX "member index". The other
+        member functions keep the index up to date.
+        \pre IsObject() == true
+        \note Linear time complexity.
+    */
+    GenericValue& RebuildMemberIndex() {
+        RAPIDJSON_ASSERT(IsObject());
+        Expand();
+        if (HasMemberIndex(data_.o.capacity))
+            BuildMemberIndex();
+        return *this;
+    }
 
     //! Check whether a member exists in the object.
     /*!
@@ -1089,7 +1266,7 @@ public:
         \pre IsObject() == true
         \return Whether a member with that name exists.
         \note It is better to use FindMember() directly if you need the obtain the value as well.
-        \note Linear time complexity.
+        \note Linear time complexity, or constant on average with a member index (see \ref RAPIDJSON_MEMBER_INDEX).
     */
     bool HasMember(const Ch* name) const { return FindMember(name) != MemberEnd(); }
 
@@ -1100,7 +1277,7 @@ public:
         \pre IsObject() == true
         \return Whether a member with that name exists.
         \note It is better to use FindMember() directly if you need the obtain the value as well.
-        \note Linear time complexity.
+        \note Linear time complexity, or constant on average with a member index (see \ref RAPIDJSON_MEMBER_INDEX).
     */
     bool HasMember(const std::basic_string<Ch>& name) const { return FindMember(name) != MemberEnd(); }
 #endif
@@ -1112,11 +1289,15 @@ public:
         \pre IsObject() == true
         \return Whether a member with that name exists.
         \note It is better to use FindMember() directly if you need the obtain the value as well.
-        \note Linear time complexity.
+        \note Linear time complexity, or constant on average with a member index (see \ref RAPIDJSON_MEMBER_INDEX).
     */
     template <typename SourceAllocator>
     bool HasMember(const GenericValue<Encoding, SourceAllocator>& name) const { return FindMember(name) != MemberEnd(); }
 
+    //! Check whether a member exists in the object with the name of a key reference.
+    /*! \see RAPIDJSON_KEY */
+    bool HasMember(const KeyRefType& name) const { return FindMember(name) != MemberEnd(); }
+
     //! Find member by name.
     /*!
         \param name Member name to be searched.
@@ -1127,14 +1308,17 @@ public:
         \note Earlier versions of Rapidjson returned a \c NULL pointer, in case
             the requested member doesn't exist. For consistency with e.g.
             \c std::map, this has been changed to MemberEnd() now.
-        \note Linear time complexity.
+        \note Linear time complexity, or constant on average with a member index (see \ref RAPIDJSON_MEMBER_INDEX).
     */
     MemberIterator FindMember(const Ch* name) {
         GenericValue n(StringRef(name));
         return FindMember(n);
     }
 
-    ConstMemberIterator FindMember(const Ch* name) const { return const_cast<GenericValue&>(*this).FindMember(name); }
+    ConstMemberIterator FindMember(const Ch* name) const {
+        GenericValue n(StringRef(name));
+        return FindMember(n);
+    }
 
     //! Find member by name.
     /*!
@@ -1147,19 +1331,21 @@ public:
         \note Earlier versions of Rapidjson returned a \c NULL pointer, in case
             the requested member doesn't exist. For consistency with e.g.
             \c std::map, this has been changed to MemberEnd() now.
-        \note Linear time complexity.
+        \note Linear time complexity, or constant on average with a member index (see \ref RAPIDJSON_MEMBER_INDEX).
     */
     template <typename SourceAllocator>
     MemberIterator FindMember(const GenericValue<Encoding, SourceAllocator>& name) {
-        RAPIDJSON_ASSERT(IsObject());
-        RAPIDJSON_ASSERT(name.IsString());
-        MemberIterator member = MemberBegin();
-        for ( ; member != MemberEnd(); ++member)
-            if (name.StringEqual(member->name))
-                break;
-        return member;
+        return MemberIterator(DoFindMember(name));
     }
-    template <typename SourceAllocator> ConstMemberIterator FindMember(const GenericValue<Encoding, SourceAllocator>& name) const { return const_cast<GenericValue&>(*this).FindMember(name); }
+    template <typename SourceAllocator> ConstMemberIterator FindMember(const GenericValue<Encoding, SourceAllocator>& name) const { return ConstMemberIterator(const_cast<GenericValue&>(*this).DoFindMember(name)); }
+
+    //! Find member by the name of a key reference.
+    /*! Compared to \ref FindMember(const Ch*), the name is not hashed again, and
+        is compared by hash first with names parsed with \ref kParseInternKeysFlag.
+        \see RAPIDJSON_KEY
+    */
+    MemberIterator FindMember(const KeyRefType& name) { return FindMember(GenericValue(name)); }
+    ConstMemberIterator FindMember(const KeyRefType& name) const { return FindMember(GenericValue(name)); }
 
 #if RAPIDJSON_HAS_STDSTRING
     //! Find member by string object name.
@@ -1186,23 +1372,30 @@ public:
     GenericValue& AddMember(GenericValue& name, GenericValue& value, Allocator& allocator) {
         RAPIDJSON_ASSERT(IsObject());
         RAPIDJSON_ASSERT(name.IsString());
+        Expand();
 
         ObjectData& o = data_.o;
+        bool grown = false;
         if (o.size >= o.capacity) {
             if (o.capacity == 0) {
                 o.capacity = kDefaultObjectCapacity;
-                SetMembersPointer(reinterpret_cast<Member*>(allocator.Malloc(o.capacity * sizeof(Member))));
+                SetMembersPointer(reinterpret_cast<Member*>(allocator.Malloc(MembersSize(o.capacity))));
             }
             else {
                 SizeType oldCapacity = o.capacity;
                 o.capacity += (oldCapacity + 1) / 2; // grow by factor 1.5
-                SetMembersPointer(reinterpret_cast<Member*>(allocator.Realloc(GetMembersPointer(), oldCapacity * sizeof(Member), o.capacity * sizeof(Member))));
+                SetMembersPointer(reinterpret_cast<Member*>(allocator.Realloc(GetMembersPointer(), MembersSize(oldCapacity), MembersSize(o.capacity))));
             }
+            grown = true;
         }
         Member* members = GetMembersPointer();
         members[o.size].name.RawAssign(name);
         members[o.size].value.RawAssign(value);
         o.size++;
+        if (grown)
+            InvalidateMemberIndex();    // built by the next lookup
+        else if (HasMemberIndex(o.capacity) && GetMemberIndex()->valid)
+            InsertMemberIndex(o.size - 1);
         return *this;
     }
 
@@ -1339,6 +1532,7 @@ public:
         for (MemberIterator m = MemberBegin(); m != MemberEnd(); ++m)
             m->~Member();
         data_.o.size = 0;
+        InvalidateMemberIndex();
     }
 
     //! Remove a member in object by its name.
@@ -1381,9 +1575,14 @@ public:
         RAPIDJSON_ASSERT(IsObject());
         RAPIDJSON_ASSERT(data_.o.size > 0);
         RAPIDJSON_ASSERT(GetMembersPointer() != 0);
-        RAPIDJSON_ASSERT(m >= MemberBegin() && m < MemberEnd());
+        RAPIDJSON_ASSERT(m >= MemberIterator(GetMembersPointer()) && m < MemberEnd());
 
         MemberIterator last(GetMembersPointer() + (data_.o.size - 1));
+        if (HasMemberIndex(data_.o.capacity) && GetMemberIndex()->valid) {
+            EraseMemberIndex(static_cast<SizeType>(&*m - GetMembersPointer()));
+            if (m != last)
+                MoveMemberIndex(data_.o.size - 1, static_cast<SizeType>(&*m - GetMembersPointer()));
+        }
         if (data_.o.size > 1 && m != last)
             *m = *last; // Move the last one to this place
         else
@@ -1418,15 +1617,16 @@ public:
         RAPIDJSON_ASSERT(IsObject());
         RAPIDJSON_ASSERT(data_.o.size > 0);
         RAPIDJSON_ASSERT(GetMembersPointer() != 0);
-        RAPIDJSON_ASSERT(first >= MemberBegin());
+        RAPIDJSON_ASSERT(first >= ConstMemberIterator(GetMembersPointer()));
         RAPIDJSON_ASSERT(first <= last);
         RAPIDJSON_ASSERT(last <= MemberEnd());
 
-        MemberIterator pos = MemberBegin() + (first - MemberBegin());
+        MemberIterator pos = MemberIterator(GetMembersPointer()) + (first - ConstMemberIterator(GetMembersPointer()));
         for (MemberIterator itr = pos; itr != last; ++itr)
             itr->~Member();
         std::memmove(&*pos, &*last, static_cast<size_t>(MemberEnd() - last) * sizeof(Member));
         data_.o.size -= static_cast<SizeType>(last - first);
+        InvalidateMemberIndex();        // the following members have moved
         return pos;
     }
 
@@ -1468,13 +1668,13 @@ public:
     GenericValue& SetArray() { this->~GenericValue(); new (this) GenericValue(kArrayType); return *this; }
 
     //! Get the number of elements in array.
-    SizeType Size() const { RAPIDJSON_ASSERT(IsArray()); return data_.a.size; }
+    SizeType Size() const { RAPIDJSON_ASSERT(IsArray()); Expand(); return data_.a.size; }
 
     //! Get the capacity of array.
-    SizeType Capacity() const { RAPIDJSON_ASSERT(IsArray()); return data_.a.capacity; }
+    SizeType Capacity() const { RAPIDJSON_ASSERT(IsArray()); Expand(); return data_.a.capacity; }
 
     //! Check whether the array is empty.
-    bool Empty() const { RAPIDJSON_ASSERT(IsArray()); return data_.a.size == 0; }
+    bool Empty() const { RAPIDJSON_ASSERT(IsArray()); Expand(); return data_.a.size == 0; }
 
     //! Remove all elements in the array.
     /*! This function do not deallocate memory in the array, i.e. the capacity is unchanged.
@@ -1482,6 +1682,7 @@ public:
     */
     void Clear() {
         RAPIDJSON_ASSERT(IsArray()); 
+        Expand();
         GenericValue* e = GetElementsPointer();
         for (GenericValue* v = e; v != e + data_.a.size; ++v)
             v->~GenericValue();
@@ -1495,6 +1696,7 @@ public:
     */
     GenericValue& operator[](SizeType index) {
         RAPIDJSON_ASSERT(IsArray());
+        Expand();
         RAPIDJSON_ASSERT(index < data_.a.size);
         return GetElementsPointer()[index];
     }
@@ -1502,10 +1704,10 @@ public:
 
     //! Element iterator
     /*! \pre IsArray() == true */
-    ValueIterator Begin() { RAPIDJSON_ASSERT(IsArray()); return GetElementsPointer(); }
+    ValueIterator Begin() { RAPIDJSON_ASSERT(IsArray()); Expand(); return GetElementsPointer(); }
     //! \em Past-the-end element iterator
     /*! \pre IsArray() == true */
-    ValueIterator End() { RAPIDJSON_ASSERT(IsArray()); return GetElementsPointer() + data_.a.size; }
+    ValueIterator End() { RAPIDJSON_ASSERT(IsArray()); Expand(); return GetElementsPointer() + data_.a.size; }
     //! Constant element iterator
     /*! \pre IsArray() == true */
     ConstValueIterator Begin() const { return const_cast<GenericValue&>(*this).Begin(); }
@@ -1521,6 +1723,7 @@ public:
     */
     GenericValue& Reserve(SizeType newCapacity, Allocator &allocator) {
         RAPIDJSON_ASSERT(IsArray());
+        Expand();
         if (newCapacity > data_.a.capacity) {
             SetElementsPointer(reinterpret_cast<GenericValue*>(allocator.Realloc(GetElementsPointer(), data_.a.capacity * sizeof(GenericValue), newCapacity * sizeof(GenericValue))));
             data_.a.capacity = newCapacity;
@@ -1540,6 +1743,7 @@ public:
     */
     GenericValue& PushBack(GenericValue& value, Allocator& allocator) {
         RAPIDJSON_ASSERT(IsArray());
+        Expand();
         if (data_.a.size >= data_.a.capacity)
             Reserve(data_.a.capacity == 0 ? kDefaultArrayCapacity : (data_.a.capacity + (data_.a.capacity + 1) / 2), allocator);
         GetElementsPointer()[data_.a.size++].RawAssign(value);
@@ -1642,16 +1846,20 @@ public:
     //!@name Number
     //@{
 
-    int GetInt() const          { RAPIDJSON_ASSERT(data_.f.flags & kIntFlag);   return data_.n.i.i;   }
-    unsigned GetUint() const    { RAPIDJSON_ASSERT(data_.f.flags & kUintFlag);  return data_.n.u.u;   }
-    int64_t GetInt64() const    { RAPIDJSON_ASSERT(data_.f.flags & kInt64Flag); return data_.n.i64; }
-    uint64_t GetUint64() const  { RAPIDJSON_ASSERT(data_.f.flags & kUint64Flag); return data_.n.u64; }
+    int GetInt() const          { Convert(); RAPIDJSON_ASSERT(data_.f.flags & kIntFlag);   return data_.n.i.i;   }
+    unsigned GetUint() const    { Convert(); RAPIDJSON_ASSERT(data_.f.flags & kUintFlag);  return data_.n.u.u;   }
+    int64_t GetInt64() const    { Convert(); RAPIDJSON_ASSERT(data_.f.flags & kInt64Flag); return data_.n.i64; }
+    uint64_t GetUint64() const  { Convert(); RAPIDJSON_ASSERT(data_.f.flags & kUint64Flag); return data_.n.u64; }
 
     //! Get the value as double type.
     /*! \note If the value is 64-bit integer type, it may lose precision. Use \c IsLosslessDouble() to check whether the converison is lossless.
+        \note A number parsed with \ref kParseLazyNumbersFlag is converted by the first
+            call to GetDouble(), GetInt(), IsDouble(), IsInt() and the like, and the
+            result replaces its text, even through a const accessor.
     */
     double GetDouble() const {
         RAPIDJSON_ASSERT(IsNumber());
+        Convert();
         if ((data_.f.flags & kDoubleFlag) != 0)                return data_.n.d;   // exact type, no conversion.
         if ((data_.f.flags & kIntFlag) != 0)                   return data_.n.i.i; // int -> double
         if ((data_.f.flags & kUintFlag) != 0)                  return data_.n.u.u; // unsigned -> double
@@ -1796,6 +2004,8 @@ public:
     
         default:
             RAPIDJSON_ASSERT(GetType() == kNumberType);
+            if (internal::IsRawValueHandler<Handler, Ch>::Value && (data_.f.flags & kLazyFlag))
+                return internal::RawNumberText<Handler, Ch>::Accept(handler, GetNumberText(), GetNumberTextLength());
             if (IsDouble())         return handler.Double(data_.n.d);
             else if (IsInt())       return handler.Int(data_.n.i.i);
             else if (IsUint())      return handler.Uint(data_.n.u.u);
@@ -1804,6 +2014,15 @@ public:
         }
     }
 
+    //! Compute the memory used by this value and its subtree.
+    /*! This counts the value itself, the members and elements buffers at their
+        capacity (including a member index), and the copied strings and number texts
+        of \ref kParseLazyNumbersFlag which are not stored inline. Names shared with
+        \ref kParseInternKeysFlag are counted for each member. Deferred objects and arrays of ParseLazy() are not expanded.
+        \return Bytes used, excluding the overhead of the allocator.
+    */
+    size_t GetMemoryUsage() const { return sizeof(GenericValue) + GetChildrenMemoryUsage(); }
+
 private:
     template <typename, typename> friend class GenericValue;
     template <typename, typename, typename> friend class GenericDocument;
@@ -1819,6 +2038,8 @@ private:
         kStringFlag     = 0x0400,
         kCopyFlag       = 0x0800,
         kInlineStrFlag  = 0x1000,
+        kLazyFlag       = 0x2000,
+        kHashedFlag     = 0x4000,   //!< String (not inline) with its internal::StrHash() in String::hashcode.
 
         // Initial flags of different types.
         kNullFlag = kNullType,
@@ -1833,8 +2054,15 @@ private:
         kConstStringFlag = kStringType | kStringFlag,
         kCopyStringFlag = kStringType | kStringFlag | kCopyFlag,
         kShortStringFlag = kStringType | kStringFlag | kCopyFlag | kInlineStrFlag,
+        kHashedConstStringFlag = kConstStringFlag | kHashedFlag,
+        kHashedCopyStringFlag = kCopyStringFlag | kHashedFlag,
         kObjectFlag = kObjectType,
         kArrayFlag = kArrayType,
+        kLazyObjectFlag = kObjectType | kLazyFlag,
+        kLazyArrayFlag = kArrayType | kLazyFlag,
+        kLazyNumberFlag = kNumberType | kNumberFlag | kLazyFlag,
+        kLazyCopyNumberFlag = kLazyNumberFlag | kCopyFlag,
+        kLazyShortNumberFlag = kLazyNumberFlag | kCopyFlag | kInlineStrFlag,
 
         kTypeMask = 0x07
     };
@@ -1855,7 +2083,7 @@ private:
 
     struct String {
         SizeType length;
-        SizeType hashcode;  //!< reserved
+        SizeType hashcode;  //!< internal::StrHash() of the string if kHashedFlag is set
         const Ch* str;
     };  // 12 bytes in 32-bit mode, 16 bytes in 64-bit mode
 
@@ -1914,12 +2142,38 @@ private:
         GenericValue* elements;
     };  // 12 bytes in 32-bit mode, 16 bytes in 64-bit mode
 
+    struct LazyContext;
+
+    // An object or array of a document parsed by GenericDocument::ParseLazy(), which is not parsed yet.
+    struct LazyData {
+        SizeType index;     //!< Index of the container in LazyContext::spans.
+        SizeType padding;
+        LazyContext* context;
+    };  // 12 bytes in 32-bit mode, 16 bytes in 64-bit mode
+
+    //! State shared by the deferred objects and arrays of a document parsed by GenericDocument::ParseLazy().
+    struct LazyContext {
+        //! Position of an object or array in the JSON text. Spans are in pre-order, i.e. in the order of the opening brackets.
+        struct Span {
+            SizeType begin;     //!< Offset of '{' or '['.
+            SizeType end;       //!< Offset of the matching '}' or ']'.
+            SizeType next;      //!< Index of the first span after this container and its descendants.
+        };
+
+        const Ch* json;
+        const Span* spans;
+        Allocator* allocator;
+        void (*expand)(GenericValue& value, LazyContext& context);
+        ParseResult result;     //!< First error found by expand.
+    };
+
     union Data {
         String s;
         ShortString ss;
         Number n;
         ObjectData o;
         ArrayData a;
+        LazyData l;
         Flag f;
     };  // 16 bytes in 32-bit mode, 24 bytes in 64-bit mode, 16 bytes in 64-bit with RAPIDJSON_48BITPOINTER_OPTIMIZATION
 
@@ -1929,6 +2183,105 @@ private:
     RAPIDJSON_FORCEINLINE GenericValue* SetElementsPointer(GenericValue* elements) { return RAPIDJSON_SETPOINTER(GenericValue, data_.a.elements, elements); }
     RAPIDJSON_FORCEINLINE Member* GetMembersPointer() const { return RAPIDJSON_GETPOINTER(Member, data_.o.members); }
     RAPIDJSON_FORCEINLINE Member* SetMembersPointer(Member* members) { return RAPIDJSON_SETPOINTER(Member, data_.o.members, members); }
+    RAPIDJSON_FORCEINLINE LazyContext* GetLazyContextPointer() const { return RAPIDJSON_GETPOINTER(LazyContext, data_.l.context); }
+    RAPIDJSON_FORCEINLINE LazyContext* SetLazyContextPointer(LazyContext* context) { return RAPIDJSON_SETPOINTER(LazyContext, data_.l.context, context); }
+
+    //! Memory used by the subtree of this value, excluding the value itself.
+    size_t GetChildrenMemoryUsage() const {
+        size_t size = 0;
+        if (data_.f.flags == kLazyCopyNumberFlag)
+            return (data_.s.length + 1) * sizeof(Ch);
+        if (data_.f.flags & kLazyFlag)
+            return size;
+        switch (data_.f.flags & kTypeMask) {
+        case kObjectType:
+            if (data_.o.capacity)
+                size += MembersSize(data_.o.capacity);
+            for (const Member* m = GetMembersPointer(); m != GetMembersPointer() + data_.o.size; ++m)
+                size += m->name.GetChildrenMemoryUsage() + m->value.GetChildrenMemoryUsage();
+            break;
+        case kArrayType:
+            size += data_.a.capacity * sizeof(GenericValue);
+            for (const GenericValue* v = GetElementsPointer(); v != GetElementsPointer() + data_.a.size; ++v)
+                size += v->GetChildrenMemoryUsage();
+            break;
+        case kStringType:
+            if ((data_.f.flags & kCopyFlag) && !(data_.f.flags & kInlineStrFlag))
+                size += (data_.s.length + 1) * sizeof(Ch);
+            break;
+        default:
+            break;
+        }
+        return size;
+    }
+
+    //! Parse the members or elements of a deferred object or array on first access.
+    RAPIDJSON_FORCEINLINE void Expand() const {
+        if (RAPIDJSON_UNLIKELY((data_.f.flags & (kLazyFlag | kNumberFlag)) == kLazyFlag)) {
+            LazyContext* context = GetLazyContextPointer();
+            context->expand(const_cast<GenericValue&>(*this), *context);
+        }
+    }
+
+    //! Handler of ConvertRaw(), receiving the value of a number.
+    struct NumberHandler : BaseReaderHandler<Encoding, NumberHandler> {
+        explicit NumberHandler(GenericValue* v) : value(v) {}
+
+        bool Int(int i) { new (value) GenericValue(i); return true; }
+        bool Uint(unsigned u) { new (value) GenericValue(u); return true; }
+        bool Int64(int64_t i) { new (value) GenericValue(i); return true; }
+        bool Uint64(uint64_t u) { new (value) GenericValue(u); return true; }
+        bool Double(double d) { new (value) GenericValue(d); return true; }
+        bool Default() { RAPIDJSON_ASSERT(false); return false; }
+
+        GenericValue* value;
+    };
+
+    //! Convert the text of a number parsed with kParseLazyNumbersFlag on first access.
+    RAPIDJSON_FORCEINLINE void Convert() const {
+        if (RAPIDJSON_UNLIKELY((data_.f.flags & (kLazyFlag | kNumberFlag)) == (kLazyFlag | kNumberFlag)))
+            const_cast<GenericValue&>(*this).ConvertRaw();
+    }
+
+    //! Replace the text of a number by its value, correctly rounded as with kParseFullPrecisionFlag.
+    void ConvertRaw() {
+        // The stack of the reader only holds the digits of the number.
+        union { char buffer[256]; uint64_t align; } stack;
+        MemoryPoolAllocator<> stackAllocator(stack.buffer, sizeof(stack.buffer));
+        GenericReader<Encoding, Encoding, MemoryPoolAllocator<> > reader(&stackAllocator, 64);
+        GenericStringStream<Encoding> is(GetNumberText());
+        GenericValue number;
+        NumberHandler handler(&number);
+        ParseResult result = reader.template Parse<kParseFullPrecisionFlag | kParseNanAndInfFlag | kParseStopWhenDoneFlag>(is, handler);
+        RAPIDJSON_ASSERT(!result.IsError() && is.Tell() == GetNumberTextLength());
+        (void)result;
+        this->~GenericValue();
+        RawAssign(number);
+    }
+
+    //! Text of a number parsed with kParseLazyNumbersFlag, which may not be null-terminated.
+    const Ch* GetNumberText() const { return (data_.f.flags & kInlineStrFlag) ? data_.ss.str : GetStringPointer(); }
+    SizeType GetNumberTextLength() const { return (data_.f.flags & kInlineStrFlag) ? data_.ss.GetLength() : data_.s.length; }
+
+    //! Initialize this value as number of kParseLazyNumbersFlag referring to its text, without calling destructor.
+    void SetLazyNumberRaw(StringRefType s) RAPIDJSON_NOEXCEPT {
+        SetStringRaw(s);
+        data_.f.flags = kLazyNumberFlag;
+    }
+
+    //! Initialize this value as number of kParseLazyNumbersFlag with a copy of its text, without calling destructor.
+    void SetLazyNumberRaw(StringRefType s, Allocator& allocator) {
+        SetStringRaw(s, allocator);
+        data_.f.flags = (data_.f.flags & kInlineStrFlag) ? kLazyShortNumberFlag : kLazyCopyNumberFlag;
+    }
+
+    //! Initialize this value as deferred object or array, without calling destructor.
+    void SetLazyRaw(Type type, SizeType index, LazyContext* context) {
+        RAPIDJSON_ASSERT(type == kObjectType || type == kArrayType);
+        data_.f.flags = type == kObjectType ? kLazyObjectFlag : kLazyArrayFlag;
+        data_.l.index = index;
+        SetLazyContextPointer(context);
+    }
 
     // Initialize this value as array with initial data, without calling destructor.
     void SetArrayRaw(GenericValue* values, SizeType count, Allocator& allocator) {
@@ -1947,13 +2300,167 @@ private:
     void SetObjectRaw(Member* members, SizeType count, Allocator& allocator) {
         data_.f.flags = kObjectFlag;
         if (count) {
-            Member* m = static_cast<Member*>(allocator.Malloc(count * sizeof(Member)));
+            Member* m = static_cast<Member*>(allocator.Malloc(MembersSize(count)));
             SetMembersPointer(m);
             std::memcpy(m, members, count * sizeof(Member));
         }
         else
             SetMembersPointer(0);
         data_.o.size = data_.o.capacity = count;
+        InvalidateMemberIndex();
+    }
+
+    // With RAPIDJSON_MEMBER_INDEX, objects with a capacity of at least RAPIDJSON_MEMBER_INDEX_THRESHOLD members
+    // have an open addressing hash table (with linear probing) of their member names behind the members.
+    struct MemberIndex {
+        SizeType mask;      //!< Number of slots - 1, the number of slots is a power of two.
+        SizeType valid;     //!< Whether the slots match the members. Cleared until the first lookup, and by changes which move members.
+    };
+
+    struct MemberIndexSlot {
+        SizeType hash;
+        SizeType index;     //!< Index of the member + 1, or 0 for an empty slot.
+    };
+
+    static bool HasMemberIndex(SizeType capacity) {
+#if RAPIDJSON_MEMBER_INDEX
+        return capacity >= static_cast<SizeType>(RAPIDJSON_MEMBER_INDEX_THRESHOLD);
+#else
+        (void)capacity;
+        return false;
+#endif
+    }
+
+    static SizeType MemberIndexSlotCount(SizeType capacity) {
+        SizeType n = 1;
+        while (n < capacity * 2)    // load factor at most 0.5
+            n *= 2;
+        return n;
+    }
+
+    //! Size in bytes of the members buffer of the given capacity.
+    static size_t MembersSize(SizeType capacity) {
+        size_t size = capacity * sizeof(Member);
+        if (HasMemberIndex(capacity))
+            size += sizeof(MemberIndex) + MemberIndexSlotCount(capacity) * sizeof(MemberIndexSlot);
+        return size;
+    }
+
+    MemberIndex* GetMemberIndex() const { return reinterpret_cast<MemberIndex*>(GetMembersPointer() + data_.o.capacity); }
+    MemberIndexSlot* GetMemberIndexSlots() const { return reinterpret_cast<MemberIndexSlot*>(GetMemberIndex() + 1); }
+
+    template <typename SourceAllocator>
+    static SizeType StringHash(const GenericValue<Encoding, SourceAllocator>& s) {
+        return (s.data_.f.flags & kHashedFlag) ? s.data_.s.hashcode : static_cast<SizeType>(internal::StrHash(s.GetString(), s.GetStringLength()));
+    }
+
+    static SizeType MemberNameHash(const Member& m) { return StringHash(m.name); }
+
+    void InvalidateMemberIndex() {
+        if (HasMemberIndex(data_.o.capacity))
+            GetMemberIndex()->valid = 0;
+    }
+
+    void BuildMemberIndex() {
+        MemberIndex* index = GetMemberIndex();
+        index->mask = MemberIndexSlotCount(data_.o.capacity) - 1;
+        index->valid = 1;
+        std::memset(static_cast<void*>(GetMemberIndexSlots()), 0, (index->mask + 1) * sizeof(MemberIndexSlot));
+        for (SizeType i = 0; i < data_.o.size; i++)
+            InsertMemberIndex(i);
+    }
+
+    void InsertMemberIndex(SizeType i) {
+        const Member& m = GetMembersPointer()[i];
+        if (!m.name.IsString())
+            return;     // only found by a linear search after the index is invalidated
+        const SizeType hash = MemberNameHash(m);
+        const SizeType mask = GetMemberIndex()->mask;
+        MemberIndexSlot* slots = GetMemberIndexSlots();
+        SizeType s = hash & mask;
+        while (slots[s].index != 0)
+            s = (s + 1) & mask;
+        slots[s].hash = hash;
+        slots[s].index = i + 1;
+    }
+
+    //! Find the slot of member i, or return mask + 1.
+    SizeType FindMemberIndexSlot(SizeType i) const {
+        const Member& m = GetMembersPointer()[i];
+        const SizeType mask = GetMemberIndex()->mask;
+        if (!m.name.IsString())
+            return mask + 1;
+        const MemberIndexSlot* slots = GetMemberIndexSlots();
+        for (SizeType s = MemberNameHash(m) & mask; slots[s].index != 0; s = (s + 1) & mask)
+            if (slots[s].index == i + 1)
+                return s;
+        return mask + 1;
+    }
+
+    void EraseMemberIndex(SizeType i) {
+        SizeType s = FindMemberIndexSlot(i);
+        const SizeType mask = GetMemberIndex()->mask;
+        if (s > mask)
+            return;
+        // Backward shift deletion: move later slots of the probe sequence into the hole.
+        MemberIndexSlot* slots = GetMemberIndexSlots();
+        for (SizeType t = (s + 1) & mask; slots[t].index != 0; t = (t + 1) & mask) {
+            const SizeType home = slots[t].hash & mask;
+            if (((t - home) & mask) >= ((t - s) & mask)) {
+                slots[s] = slots[t];
+                s = t;
+            }
+        }
+        slots[s].index = 0;
+    }
+
+    void MoveMemberIndex(SizeType from, SizeType to) {
+        SizeType s = FindMemberIndexSlot(from);
+        if (s <= GetMemberIndex()->mask)
+            GetMemberIndexSlots()[s].index = to + 1;
+    }
+
+    //! Value of a member found by DoFindMember().
+    GenericValue& MemberValue(Member* member) {
+        if (member != GetMembersPointer() + data_.o.size)
+            return member->value;
+        else {
+            RAPIDJSON_ASSERT(false);    // see the note of operator[](T*)
+
+            // This will generate -Wexit-time-destructors in clang
+            // static GenericValue NullValue;
+            // return NullValue;
+
+            // Use static buffer and placement-new to prevent destruction
+            static char buffer[sizeof(GenericValue)];
+            return *new (buffer) GenericValue();
+        }
+    }
+
+    //! Find a member by name, with the index if the object has one (building it first if needed).
+    template <typename SourceAllocator>
+    Member* DoFindMember(const GenericValue<Encoding, SourceAllocator>& name) {
+        RAPIDJSON_ASSERT(IsObject());
+        RAPIDJSON_ASSERT(name.IsString());
+        Expand();
+        Member* members = GetMembersPointer();
+        Member* end = members + data_.o.size;
+        if (HasMemberIndex(data_.o.capacity)) {
+            if (!GetMemberIndex()->valid)
+                BuildMemberIndex();
+            const SizeType hash = StringHash(name);
+            const SizeType mask = GetMemberIndex()->mask;
+            const MemberIndexSlot* slots = GetMemberIndexSlots();
+            for (SizeType s = hash & mask; slots[s].index != 0; s = (s + 1) & mask)
+                if (slots[s].hash == hash && name.StringEqual(members[slots[s].index - 1].name))
+                    return members + (slots[s].index - 1);
+            return end;
+        }
+        Member* member = members;
+        for ( ; member != end; ++member)
+            if (name.StringEqual(member->name))
+                break;
+        return member;
     }
 
     //! Initialize this value as constant string, without calling destructor.
@@ -1980,6 +2487,27 @@ private:
         str[s.length] = '\0';
     }
 
+    //! Initialize this value as string with a precomputed hash, without calling destructor.
+    /*! \param s Constant string, or with \c copy a string owned by the allocator of this value,
+            e.g. one shared by the object names interned by GenericDocument.
+        \param copy Whether the string is reported as copied by Accept().
+    */
+    void SetHashedStringRaw(StringRefType s, SizeType hash, bool copy = false) RAPIDJSON_NOEXCEPT {
+        data_.f.flags = copy ? kHashedCopyStringFlag : kHashedConstStringFlag;
+        SetStringPointer(s);
+        data_.s.length = s.length;
+        data_.s.hashcode = hash;
+    }
+
+    //! Initialize this value as copy string with a precomputed hash (unless it is short), without calling destructor.
+    void SetHashedStringRaw(StringRefType s, SizeType hash, Allocator& allocator) {
+        SetStringRaw(s, allocator);
+        if (!(data_.f.flags & kInlineStrFlag)) {
+            data_.f.flags |= kHashedFlag;
+            data_.s.hashcode = hash;
+        }
+    }
+
     //! Assignment without calling destructor
     void RawAssign(GenericValue& rhs) RAPIDJSON_NOEXCEPT {
         data_ = rhs.data_;
@@ -1996,9 +2524,11 @@ private:
         const SizeType len2 = rhs.GetStringLength();
         if(len1 != len2) { return false; }
 
+        if((data_.f.flags & rhs.data_.f.flags & kHashedFlag) && data_.s.hashcode != rhs.data_.s.hashcode) { return false; }
+
         const Ch* const str1 = GetString();
         const Ch* const str2 = rhs.GetString();
-        if(str1 == str2) { return true; } // fast path for constant string
+        if(str1 == str2) { return true; } // fast path for constant and interned strings
 
         return (std::memcmp(str1, str2, sizeof(Ch) * len1) == 0);
     }
@@ -2035,7 +2565,7 @@ public:
         \param stackAllocator   Optional allocator for allocating memory for stack.
     */
     explicit GenericDocument(Type type, Allocator* allocator = 0, size_t stackCapacity = kDefaultStackCapacity, StackAllocator* stackAllocator = 0) :
-        GenericValue<Encoding, Allocator>(type),  allocator_(allocator), ownAllocator_(0), stack_(stackAllocator, stackCapacity), parseResult_()
+        GenericValue<Encoding, Allocator>(type),  allocator_(allocator), ownAllocator_(0), stack_(stackAllocator, stackCapacity), parseResult_(), lazy_(0), keyPool_(0), lazyNumbers_(false)
     {
         if (!allocator_)
             ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator());
@@ -2048,7 +2578,7 @@ public:
         \param stackAllocator   Optional allocator for allocating memory for stack.
     */
     GenericDocument(Allocator* allocator = 0, size_t stackCapacity = kDefaultStackCapacity, StackAllocator* stackAllocator = 0) : 
-        allocator_(allocator), ownAllocator_(0), stack_(stackAllocator, stackCapacity), parseResult_()
+        allocator_(allocator), ownAllocator_(0), stack_(stackAllocator, stackCapacity), parseResult_(), lazy_(0), keyPool_(0), lazyNumbers_(false)
     {
         if (!allocator_)
             ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator());
@@ -2061,11 +2591,15 @@ public:
           allocator_(rhs.allocator_),
           ownAllocator_(rhs.ownAllocator_),
           stack_(std::move(rhs.stack_)),
-          parseResult_(rhs.parseResult_)
+          parseResult_(rhs.parseResult_),
+          lazy_(rhs.lazy_),
+          keyPool_(0),
+          lazyNumbers_(false)
     {
         rhs.allocator_ = 0;
         rhs.ownAllocator_ = 0;
         rhs.parseResult_ = ParseResult();
+        rhs.lazy_ = 0;
     }
 #endif
 
@@ -2088,10 +2622,12 @@ public:
         ownAllocator_ = rhs.ownAllocator_;
         stack_ = std::move(rhs.stack_);
         parseResult_ = rhs.parseResult_;
+        lazy_ = rhs.lazy_;
 
         rhs.allocator_ = 0;
         rhs.ownAllocator_ = 0;
         rhs.parseResult_ = ParseResult();
+        rhs.lazy_ = 0;
 
         return *this;
     }
@@ -2109,6 +2645,7 @@ public:
         internal::Swap(allocator_, rhs.allocator_);
         internal::Swap(ownAllocator_, rhs.ownAllocator_);
         internal::Swap(parseResult_, rhs.parseResult_);
+        internal::Swap(lazy_, rhs.lazy_);
         return *this;
     }
 
@@ -2137,6 +2674,7 @@ public:
         if (g(*this)) {
             RAPIDJSON_ASSERT(stack_.GetSize() == sizeof(ValueType)); // Got one and only one root object
             ValueType::operator=(*stack_.template Pop<ValueType>(1));// Move value from stack to document
+            FreeLazy();
         }
         return *this;
     }
@@ -2155,11 +2693,16 @@ public:
     GenericDocument& ParseStream(InputStream& is) {
         GenericReader<SourceEncoding, Encoding, StackAllocator> reader(
             stack_.HasAllocator() ? &stack_.GetAllocator() : 0);
+        KeyPool keyPool(stack_.HasAllocator() ? &stack_.GetAllocator() : 0);
+        if (parseFlags & kParseInternKeysFlag)
+            keyPool_ = &keyPool;
+        lazyNumbers_ = (parseFlags & kParseLazyNumbersFlag) != 0;
         ClearStackOnExit scope(*this);
-        parseResult_ = reader.template Parse<parseFlags>(is, *this);
+        parseResult_ = reader.template Parse<ReaderFlags<parseFlags>::Value>(is, *this);
         if (parseResult_) {
             RAPIDJSON_ASSERT(stack_.GetSize() == sizeof(ValueType)); // Got one and only one root object
             ValueType::operator=(*stack_.template Pop<ValueType>(1));// Move value from stack to document
+            FreeLazy();
         }
         return *this;
     }
@@ -2277,17 +2820,150 @@ public:
 
     //!@}
 
+    //!@name Parse with a projection
+    //!@{
+
+    //! Parse JSON text from an input stream, keeping only the values selected by a projection (with Encoding conversion)
+    /*! Objects and arrays on the paths to the selected values keep only the members
+        and elements on these paths, and everything else is skipped without decoding
+        strings or converting numbers (see GenericProjection).
+        \tparam parseFlags Combination of \ref ParseFlag.
+        \tparam SourceEncoding Encoding of input stream
+        \tparam InputStream Type of input stream, implementing Stream concept
+        \param is Input stream to be parsed.
+        \param projection The values to keep.
+        \return The document itself for fluent API.
+        \see GenericReader::Parse(InputStream&, Handler&, const GenericProjection<TargetEncoding, ProjectionAllocator>&)
+    */
+    template <unsigned parseFlags, typename SourceEncoding, typename InputStream, typename ProjectionAllocator>
+    GenericDocument& ParseStream(InputStream& is, const GenericProjection<Encoding, ProjectionAllocator>& projection) {
+        GenericReader<SourceEncoding, Encoding, StackAllocator> reader(
+            stack_.HasAllocator() ? &stack_.GetAllocator() : 0);
+        KeyPool keyPool(stack_.HasAllocator() ? &stack_.GetAllocator() : 0);
+        if (parseFlags & kParseInternKeysFlag)
+            keyPool_ = &keyPool;
+        lazyNumbers_ = (parseFlags & kParseLazyNumbersFlag) != 0;
+        ClearStackOnExit scope(*this);
+        parseResult_ = reader.template Parse<ReaderFlags<parseFlags>::Value>(is, *this, projection);
+        if (parseResult_) {
+            RAPIDJSON_ASSERT(stack_.GetSize() == sizeof(ValueType)); // Got one and only one root object
+            ValueType::operator=(*stack_.template Pop<ValueType>(1));// Move value from stack to document
+            FreeLazy();
+        }
+        return *this;
+    }
+
+    //! Parse JSON text from an input stream, keeping only the values selected by a projection
+    /*! \tparam parseFlags Combination of \ref ParseFlag.
+        \tparam InputStream Type of input stream, implementing Stream concept
+        \param is Input stream to be parsed.
+        \param projection The values to keep.
+        \return The document itself for fluent API.
+    */
+    template <unsigned parseFlags, typename InputStream, typename ProjectionAllocator>
+    GenericDocument& ParseStream(InputStream& is, const GenericProjection<Encoding, ProjectionAllocator>& projection) {
+        return ParseStream<parseFlags, Encoding, InputStream>(is, projection);
+    }
+
+    //! Parse JSON text from a read-only string, keeping only the values selected by a projection
+    /*! \tparam parseFlags Combination of \ref ParseFlag (must not contain \ref kParseInsituFlag).
+        \param str Read-only zero-terminated string to be parsed.
+        \param projection The values to keep.
+    */
+    template <unsigned parseFlags, typename ProjectionAllocator>
+    GenericDocument& Parse(const Ch* str, const GenericProjection<Encoding, ProjectionAllocator>& projection) {
+        RAPIDJSON_ASSERT(!(parseFlags & kParseInsituFlag));
+        GenericStringStream<Encoding> s(str);
+        return ParseStream<parseFlags, Encoding>(s, projection);
+    }
+
+    //! Parse JSON text from a read-only string, keeping only the values selected by a projection (with \ref kParseDefaultFlags)
+    /*! \param str Read-only zero-terminated string to be parsed.
+        \param projection The values to keep.
+    */
+    template <typename ProjectionAllocator>
+    GenericDocument& Parse(const Ch* str, const GenericProjection<Encoding, ProjectionAllocator>& projection) {
+        return Parse<kParseDefaultFlags>(str, projection);
+    }
+    //!@}
+
+    //!@name Parse lazily from read-only string
+    //!@{
+
+    //! Parse JSON text from a read-only string, deferring objects and arrays until they are accessed.
+    /*! A single fast pass checks the structure of the text (matching brackets
+        outside strings) and records the position of every object and array.
+        An object or array is parsed the first time its members or elements are
+        accessed, e.g. by FindMember(), operator[](), MemberBegin(), Begin(),
+        Size() or Accept(). Its own objects and arrays are deferred again, so
+        code which reads a few fields of a large document only parses and
+        allocates the path to them.
+
+        \tparam parseFlags Combination of \ref ParseFlag (must not contain \ref kParseInsituFlag or \ref kParseCommentsFlag).
+        \param str Read-only zero-terminated string to be parsed. It must not be
+            modified or freed before the document, as long as values may be expanded.
+        \return The document itself for fluent API.
+        \note Other syntax errors are found when the enclosing object or array is
+            expanded. The object or array is then left empty, and the error is
+            reported by HasParseError(), GetParseError() and GetErrorOffset().
+        \note Expanding modifies the value, even through a const accessor. A lazily
+            parsed document must not be read by several threads at the same time.
+        \note Deferred objects and arrays share a state owned by the document, which
+            is freed when the document is parsed, populated or compacted again, or destroyed.
+            A value moved out of the document (e.g. by assignment or Swap()) must not be
+            accessed after that, unless it has been copied (e.g. with CopyFrom()) before.
+    */
+    template <unsigned parseFlags>
+    GenericDocument& ParseLazy(const Ch* str) {
+        RAPIDJSON_ASSERT(!(parseFlags & (kParseInsituFlag | kParseCommentsFlag)));
+        const Ch* p = str;
+        while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+            ++p;
+        if (*p != '{' && *p != '[')
+            return Parse<parseFlags>(str); // Nothing to defer
+
+        internal::Stack<StackAllocator> spans(stack_.HasAllocator() ? &stack_.GetAllocator() : 0, kDefaultStackCapacity);
+        parseResult_ = ScanContainers(str, p, (parseFlags & kParseStopWhenDoneFlag) != 0, spans);
+        if (parseResult_) {
+            LazyState* state = RAPIDJSON_NEW(LazyState(&GetAllocator()));
+            state->spanStack.Swap(spans);
+            state->spanStack.ShrinkToFit();
+            state->json = str;
+            state->spans = state->spanStack.template Bottom<LazySpan>();
+            state->allocator = &GetAllocator();
+            state->expand = &ExpandLazy<(parseFlags | kParseStopWhenDoneFlag) & ~static_cast<unsigned>(kParseStructuralIndexFlag)>;
+            state->collector.lazyNumbers_ = (parseFlags & kParseLazyNumbersFlag) != 0;
+
+            ValueType root;
+            root.SetLazyRaw(*p == '{' ? kObjectType : kArrayType, 0, state);
+            ValueType::operator=(root);
+            FreeLazy();
+            lazy_ = state;
+        }
+        return *this;
+    }
+
+    //! Parse JSON text lazily from a read-only string (with \ref kParseDefaultFlags)
+    /*! \param str Read-only zero-terminated string to be parsed, which must outlive the document.
+        \see ParseLazy<parseFlags>(const Ch*)
+    */
+    GenericDocument& ParseLazy(const Ch* str) {
+        return ParseLazy<kParseDefaultFlags>(str);
+    }
+    //!@}
+
     //!@name Handling parse errors
     //!@{
 
     //! Whether a parse error has occured in the last parsing.
-    bool HasParseError() const { return parseResult_.IsError(); }
+    /*! After ParseLazy(), this includes errors found while expanding objects and arrays so far. */
+    bool HasParseError() const { return Result().IsError(); }
 
     //! Get the \ref ParseErrorCode of last parsing.
-    ParseErrorCode GetParseError() const { return parseResult_.Code(); }
+    ParseErrorCode GetParseError() const { return Result().Code(); }
 
     //! Get the position of last parsing error in input, 0 otherwise.
-    size_t GetErrorOffset() const { return parseResult_.Offset(); }
+    size_t GetErrorOffset() const { return Result().Offset(); }
 
     //! Implicit conversion to get the last parse result
 #ifndef __clang // -Wdocumentation
@@ -2301,7 +2977,7 @@ public:
         \endcode
      */
 #endif
-    operator ParseResult() const { return parseResult_; }
+    operator ParseResult() const { return Result(); }
     //!@}
 
     //! Get the allocator of this document.
@@ -2310,14 +2986,54 @@ public:
         return *allocator_;
     }
 
-    //! Get the capacity of stack in bytes.
+    //! Relocate the DOM into a fresh allocator and release the former one.
+    /*! Values removed from the DOM, and the buffers left behind by growing
+        objects, arrays and strings, are not freed by MemoryPoolAllocator.
+        Compact() copies the DOM in depth-first order into a new allocator,
+        with each object, array and copied string allocated at its exact size,
+        and then releases the old allocator if the document owns it. The
+        content of the document does not change.
+
+        \param allocator Optional allocator for the compacted DOM, which must not be
+            the current one. By default a new one is created and owned by the document.
+        \return The document itself for fluent API.
+        \note Objects and arrays deferred by ParseLazy() are expanded. Constant
+            strings (including those of ParseInsitu()) still refer to their buffer.
+        \note Any GenericValue or string pointer into the DOM, including iterators,
+            is invalidated.
+    */
+    GenericDocument& Compact(Allocator* allocator = 0) {
+        RAPIDJSON_ASSERT(!allocator || allocator != allocator_);
+        Allocator* ownAllocator = 0;
+        if (!allocator)
+            ownAllocator = allocator = RAPIDJSON_NEW(Allocator());
+        ValueType root;
+        {
+            KeyPool keyPool(stack_.HasAllocator() ? &stack_.GetAllocator() : 0);
+            CompactValue(root, *this, *allocator, keyPool);
+        }
+        ValueType::operator=(root);
+        parseResult_ = Result();
+        FreeLazy();
+        RAPIDJSON_DELETE(ownAllocator_);
+        allocator_ = allocator;
+        ownAllocator_ = ownAllocator;
+        return *this;
+    }
+
+    //! Get the capacity of stack in bytes.
     size_t GetStackCapacity() const { return stack_.GetCapacity(); }
 
+#if RAPIDJSON_MEMORY_STATS
+    //! Get the highest size in bytes of the stack of parsing (see \ref RAPIDJSON_MEMORY_STATS).
+    size_t GetStackPeakSize() const { return stack_.GetPeakSize(); }
+#endif
+
 private:
     // clear stack on any exit from ParseStream, e.g. due to exception
     struct ClearStackOnExit {
         explicit ClearStackOnExit(GenericDocument& d) : d_(d) {}
-        ~ClearStackOnExit() { d_.ClearStack(); }
+        ~ClearStackOnExit() { d_.ClearStack(); d_.keyPool_ = 0; d_.lazyNumbers_ = false; }
     private:
         ClearStackOnExit(const ClearStackOnExit&);
         ClearStackOnExit& operator=(const ClearStackOnExit&);
@@ -2339,6 +3055,19 @@ public:
     bool Double(double d) { new (stack_.template Push<ValueType>()) ValueType(d); return true; }
 
     bool RawNumber(const Ch* str, SizeType length, bool copy) { 
+        if (lazyNumbers_) {
+            ValueType* v = stack_.template Push<ValueType>();
+            const Ch last = str[length - 1];
+            if (last < '0' || last > '9') {     // NaN or infinity, which a Writer may not take verbatim
+                v->SetLazyNumberRaw(StringRef(str, length));
+                v->Convert();
+            }
+            else if (copy)
+                v->SetLazyNumberRaw(StringRef(str, length), GetAllocator());
+            else
+                v->SetLazyNumberRaw(StringRef(str, length));
+            return true;
+        }
         if (copy) 
             new (stack_.template Push<ValueType>()) ValueType(str, length, GetAllocator());
         else
@@ -2346,6 +3075,14 @@ public:
         return true;
     }
 
+    //! Copy of a number of kParseLazyNumbersFlag by Accept(), which stays unconverted.
+    bool RawValue(const Ch* str, size_t length, Type type) {
+        RAPIDJSON_ASSERT(type == kNumberType);
+        (void)type;
+        stack_.template Push<ValueType>()->SetLazyNumberRaw(StringRef(str, static_cast<SizeType>(length)), GetAllocator());
+        return true;
+    }
+
     bool String(const Ch* str, SizeType length, bool copy) { 
         if (copy) 
             new (stack_.template Push<ValueType>()) ValueType(str, length, GetAllocator());
@@ -2355,8 +3092,26 @@ public:
     }
 
     bool StartObject() { new (stack_.template Push<ValueType>()) ValueType(kObjectType); return true; }
+
+    //! Start an object of a known size, e.g. from CBOR, reserving the stack for its members.
+    bool StartObject(SizeType memberCount) {
+        stack_.template Reserve<ValueType>(1 + 2 * static_cast<size_t>(memberCount));
+        return StartObject();
+    }
     
-    bool Key(const Ch* str, SizeType length, bool copy) { return String(str, length, copy); }
+    bool Key(const Ch* str, SizeType length, bool copy) {
+        if (!keyPool_)
+            return String(str, length, copy);
+        const SizeType hash = static_cast<SizeType>(internal::StrHash(str, length));
+        ValueType* v = new (stack_.template Push<ValueType>()) ValueType();
+        if (!copy)
+            v->SetHashedStringRaw(StringRef(str, length), hash);
+        else if (!Allocator::kNeedFree)
+            v->SetHashedStringRaw(StringRef(keyPool_->Intern(str, length, hash, GetAllocator()), length), hash, true);
+        else
+            v->SetHashedStringRaw(StringRef(str, length), hash, GetAllocator());  // shared names could not be freed by each value
+        return true;
+    }
 
     bool EndObject(SizeType memberCount) {
         typename ValueType::Member* members = stack_.template Pop<typename ValueType::Member>(memberCount);
@@ -2365,6 +3120,12 @@ public:
     }
 
     bool StartArray() { new (stack_.template Push<ValueType>()) ValueType(kArrayType); return true; }
+
+    //! Start an array of a known size, e.g. from CBOR, reserving the stack for its elements.
+    bool StartArray(SizeType elementCount) {
+        stack_.template Reserve<ValueType>(1 + static_cast<size_t>(elementCount));
+        return StartArray();
+    }
     
     bool EndArray(SizeType elementCount) {
         ValueType* elements = stack_.template Pop<ValueType>(elementCount);
@@ -2378,6 +3139,300 @@ private:
     //! Prohibit assignment
     GenericDocument& operator=(const GenericDocument&);
 
+    typedef typename ValueType::LazyContext LazyContext;
+    typedef typename LazyContext::Span LazySpan;
+    struct LazyState;
+
+    //! Flags for GenericReader, which reports the numbers of kParseLazyNumbersFlag with RawNumber().
+    template <unsigned parseFlags>
+    struct ReaderFlags {
+        enum { Value = (parseFlags & kParseLazyNumbersFlag) ? (parseFlags | kParseNumbersAsStringsFlag) : parseFlags };
+    };
+
+    //! Hash set of the object names of a parse with kParseInternKeysFlag, allocated from the document's allocator.
+    class KeyPool {
+    public:
+        explicit KeyPool(StackAllocator* allocator) : allocator_(allocator), ownAllocator_(0), slots_(0), mask_(0), size_(0) {}
+
+        ~KeyPool() {
+            if (slots_)
+                allocator_->Free(slots_);
+            RAPIDJSON_DELETE(ownAllocator_);
+        }
+
+        //! Get the pooled copy of a name, copying it into the pool first if necessary.
+        const Ch* Intern(const Ch* str, SizeType length, SizeType hash, Allocator& allocator) {
+            if ((size_ + 1) * 2 > mask_ + 1 || !slots_)
+                Grow();
+            SizeType s = hash & mask_;
+            for (; slots_[s].str; s = (s + 1) & mask_)
+                if (slots_[s].hash == hash && slots_[s].length == length && std::memcmp(slots_[s].str, str, length * sizeof(Ch)) == 0)
+                    return slots_[s].str;
+            Ch* copy = static_cast<Ch*>(allocator.Malloc((length + 1) * sizeof(Ch)));
+            std::memcpy(copy, str, length * sizeof(Ch));
+            copy[length] = '\0';
+            slots_[s].str = copy;
+            slots_[s].length = length;
+            slots_[s].hash = hash;
+            size_++;
+            return copy;
+        }
+
+    private:
+        struct Slot {
+            const Ch* str;  //!< Pooled copy, or null for an empty slot.
+            SizeType length;
+            SizeType hash;
+        };
+
+        KeyPool(const KeyPool&);
+        KeyPool& operator=(const KeyPool&);
+
+        void Grow() {
+            if (!allocator_)
+                ownAllocator_ = allocator_ = RAPIDJSON_NEW(StackAllocator());
+            const SizeType count = slots_ ? (mask_ + 1) * 2 : 64;
+            Slot* slots = static_cast<Slot*>(allocator_->Malloc(count * sizeof(Slot)));
+            std::memset(static_cast<void*>(slots), 0, count * sizeof(Slot));
+            for (SizeType i = 0; slots_ && i <= mask_; i++)
+                if (slots_[i].str) {
+                    SizeType s = slots_[i].hash & (count - 1);
+                    while (slots[s].str)
+                        s = (s + 1) & (count - 1);
+                    slots[s] = slots_[i];
+                }
+            if (slots_)
+                allocator_->Free(slots_);
+            slots_ = slots;
+            mask_ = count - 1;
+        }
+
+        StackAllocator* allocator_;
+        StackAllocator* ownAllocator_;
+        Slot* slots_;
+        SizeType mask_;
+        SizeType size_;
+    };
+
+    //! Find the end of the object or array at \c p and record the spans of all containers within.
+    template <typename C>
+    static ParseResult ScanContainers(const C* str, const C* p, bool stopWhenDone, internal::Stack<StackAllocator>& spans) {
+        internal::Stack<StackAllocator> open(spans.HasAllocator() ? &spans.GetAllocator() : 0, 32 * sizeof(SizeType));
+        for (;; ++p) {
+            switch (*p) {
+            case '"':
+                for (++p; *p != '"'; ++p) {
+                    if (*p == '\0')
+                        return ScanResult(str, p, stopWhenDone, open, spans);
+                    if (*p == '\\' && p[1] != '\0')
+                        ++p;
+                }
+                break;
+            case '{': case '[': case '}': case ']':
+                if (!ScanBracket(str, p, open, spans))
+                    return ScanResult(str, p, stopWhenDone, open, spans);
+                if (open.Empty())
+                    return ScanResult(str, p + 1, stopWhenDone, open, spans);
+                break;
+            case '\0':
+                return ScanResult(str, p, stopWhenDone, open, spans);
+            default:
+                break;
+            }
+        }
+    }
+
+#if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
+    //! UTF-8 version, which only visits the structural characters found by internal::StructuralIndexer.
+    static ParseResult ScanContainers(const char* str, const char* p, bool stopWhenDone, internal::Stack<StackAllocator>& spans) {
+        internal::Stack<StackAllocator> open(spans.HasAllocator() ? &spans.GetAllocator() : 0, 32 * sizeof(SizeType));
+        internal::Stack<StackAllocator> index(spans.HasAllocator() ? &spans.GetAllocator() : 0, kDefaultStackCapacity);
+        internal::StructuralIndexer<StackAllocator> indexer(p, index);
+        for (const char* q = p; (q = indexer.Next(q)) != 0; ++q) {
+            const char c = *q;
+            if (c == '{' || c == '[' || c == '}' || c == ']') {
+                if (!ScanBracket(str, q, open, spans))
+                    return ScanResult(str, q, stopWhenDone, open, spans);
+                if (open.Empty())
+                    return ScanResult(str, q + 1, stopWhenDone, open, spans);
+            }
+        }
+        return ScanResult(str, str + internal::StrLen(str), stopWhenDone, open, spans);
+    }
+#endif
+
+    //! Open or close a container, return false if the bracket does not match.
+    template <typename C>
+    static bool ScanBracket(const C* str, const C* p, internal::Stack<StackAllocator>& open, internal::Stack<StackAllocator>& spans) {
+        RAPIDJSON_ASSERT(static_cast<size_t>(p - str) <= static_cast<SizeType>(~0u));  // offsets are SizeType
+        const SizeType offset = static_cast<SizeType>(p - str);
+        if (*p == '{' || *p == '[') {
+            *open.template Push<SizeType>() = static_cast<SizeType>(spans.GetSize() / sizeof(LazySpan));
+            LazySpan* s = spans.template Push<LazySpan>();
+            s->begin = offset;
+            s->end = s->next = 0;
+            return true;
+        }
+        if (open.Empty())
+            return false;
+        LazySpan& s = spans.template Bottom<LazySpan>()[*open.template Top<SizeType>()];
+        if ((str[s.begin] == '{') != (*p == '}'))
+            return false;
+        open.template Pop<SizeType>(1);
+        s.end = offset;
+        s.next = static_cast<SizeType>(spans.GetSize() / sizeof(LazySpan));
+        return true;
+    }
+
+    //! Result of the scan, stopped at \c p with the given containers still open.
+    template <typename C>
+    static ParseResult ScanResult(const C* str, const C* p, bool stopWhenDone, internal::Stack<StackAllocator>& open, internal::Stack<StackAllocator>& spans) {
+        if (open.Empty()) {
+            // The root is complete, only whitespace may follow.
+            while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+                ++p;
+            if (*p != '\0' && !stopWhenDone)
+                return ParseResult(kParseErrorDocumentRootNotSingular, static_cast<size_t>(p - str));
+            return ParseResult();
+        }
+        const bool object = str[spans.template Bottom<LazySpan>()[*open.template Top<SizeType>()].begin] == '{';
+        return ParseResult(object ? kParseErrorObjectMissCommaOrCurlyBracket : kParseErrorArrayMissCommaOrSquareBracket, static_cast<size_t>(p - str));
+    }
+
+    //! Parse the members or elements of a deferred object or array, deferring the containers within.
+    template <unsigned parseFlags>
+    static void ExpandLazy(ValueType& value, LazyContext& context) {
+        const LazySpan* spans = context.spans;
+        const SizeType index = value.data_.l.index;
+        const bool object = context.json[spans[index].begin] == '{';
+        const Ch close = object ? '}' : ']';
+
+        LazyState& state = static_cast<LazyState&>(context);
+        GenericDocument& d = state.collector;
+        GenericStringStream<Encoding> is(context.json);
+        is.src_ += spans[index].begin + 1;
+        SizeType child = index + 1;
+        SizeType count = 0;
+        ParseResult result;
+
+        SkipWhitespace(is);
+        if (is.Peek() == close)
+            is.Take();
+        else {
+            for (;;) {
+                if (object) {
+                    if (is.Peek() != '"') {
+                        result.Set(kParseErrorObjectMissName, is.Tell());
+                        break;
+                    }
+                    if (!(result = state.reader.template Parse<ReaderFlags<parseFlags>::Value>(is, d)))
+                        break;
+                    SkipWhitespace(is);
+                    if (is.Peek() != ':') {
+                        result.Set(kParseErrorObjectMissColon, is.Tell());
+                        break;
+                    }
+                    is.Take();
+                    SkipWhitespace(is);
+                }
+
+                const Ch c = is.Peek();
+                if (c == '{' || c == '[') {
+                    RAPIDJSON_ASSERT(spans[child].begin == is.Tell());
+                    d.stack_.template Push<ValueType>()->SetLazyRaw(c == '{' ? kObjectType : kArrayType, child, &context);
+                    is.src_ = context.json + spans[child].end + 1;
+                    child = spans[child].next;
+                }
+                else if (!(result = state.reader.template Parse<ReaderFlags<parseFlags>::Value>(is, d)))
+                    break;
+                ++count;
+
+                SkipWhitespace(is);
+                if (is.Peek() == ',') {
+                    is.Take();
+                    SkipWhitespace(is);
+                    if ((parseFlags & kParseTrailingCommasFlag) && is.Peek() == close) {
+                        is.Take();
+                        break;
+                    }
+                }
+                else if (is.Peek() == close) {
+                    is.Take();
+                    break;
+                }
+                else {
+                    result.Set(object ? kParseErrorObjectMissCommaOrCurlyBracket : kParseErrorArrayMissCommaOrSquareBracket, is.Tell());
+                    break;
+                }
+            }
+        }
+
+        if (result.IsError()) {
+            d.ClearStack();
+            count = 0;
+            if (!context.result.IsError())
+                context.result = result;
+        }
+        if (object)
+            value.SetObjectRaw(d.stack_.template Pop<typename ValueType::Member>(count), count, *context.allocator);
+        else
+            value.SetArrayRaw(d.stack_.template Pop<ValueType>(count), count, *context.allocator);
+    }
+
+    //! Copy the subtree of \c src into \c dst, allocating each container before its children, without calling destructor.
+    static void CompactValue(ValueType& dst, const ValueType& src, Allocator& allocator, KeyPool& keyPool) {
+        src.Expand();
+        switch (src.GetType()) {
+        case kObjectType: {
+                const SizeType count = src.data_.o.size;
+                typename ValueType::Member* m = count ? static_cast<typename ValueType::Member*>(allocator.Malloc(ValueType::MembersSize(count))) : 0;
+                const typename ValueType::Member* s = src.GetMembersPointer();
+                for (SizeType i = 0; i < count; i++) {
+                    CompactValue(m[i].name, s[i].name, allocator, keyPool);
+                    CompactValue(m[i].value, s[i].value, allocator, keyPool);
+                }
+                dst.data_.f.flags = ValueType::kObjectFlag;
+                dst.SetMembersPointer(m);
+                dst.data_.o.size = dst.data_.o.capacity = count;
+                dst.InvalidateMemberIndex();
+            }
+            break;
+        case kArrayType: {
+                const SizeType count = src.data_.a.size;
+                ValueType* e = count ? static_cast<ValueType*>(allocator.Malloc(count * sizeof(ValueType))) : 0;
+                const ValueType* s = src.GetElementsPointer();
+                for (SizeType i = 0; i < count; i++)
+                    CompactValue(e[i], s[i], allocator, keyPool);
+                dst.data_.f.flags = ValueType::kArrayFlag;
+                dst.SetElementsPointer(e);
+                dst.data_.a.size = dst.data_.a.capacity = count;
+            }
+            break;
+        case kStringType:
+            if (!(src.data_.f.flags & ValueType::kCopyFlag))
+                dst.data_ = src.data_;
+            else if (!(src.data_.f.flags & ValueType::kHashedFlag))
+                dst.SetStringRaw(StringRef(src.GetString(), src.GetStringLength()), allocator);
+            else if (!Allocator::kNeedFree)  // keep interned names shared
+                dst.SetHashedStringRaw(StringRef(keyPool.Intern(src.GetString(), src.GetStringLength(), src.data_.s.hashcode, allocator), src.GetStringLength()), src.data_.s.hashcode, true);
+            else
+                dst.SetHashedStringRaw(StringRef(src.GetString(), src.GetStringLength()), src.data_.s.hashcode, allocator);
+            break;
+        default:
+            if (src.data_.f.flags == ValueType::kLazyCopyNumberFlag)   // text owned by the old allocator
+                dst.SetLazyNumberRaw(StringRef(src.GetNumberText(), src.GetNumberTextLength()), allocator);
+            else
+                dst.data_ = src.data_;
+            break;
+        }
+    }
+
+    //! Free the state of the last ParseLazy() when the document no longer holds its values.
+    void FreeLazy() {
+        RAPIDJSON_DELETE(lazy_);
+        lazy_ = 0;
+    }
+
     void ClearStack() {
         if (Allocator::kNeedFree)
             while (stack_.GetSize() > 0)    // Here assumes all elements in stack array are GenericValue (Member is actually 2 GenericValue objects)
@@ -2388,14 +3443,31 @@ private:
     }
 
     void Destroy() {
+        FreeLazy();
         RAPIDJSON_DELETE(ownAllocator_);
     }
 
+    const ParseResult& Result() const { return (lazy_ && !parseResult_.IsError()) ? lazy_->result : parseResult_; }
+
     static const size_t kDefaultStackCapacity = 1024;
     Allocator* allocator_;
     Allocator* ownAllocator_;
     internal::Stack<StackAllocator> stack_;
     ParseResult parseResult_;
+    LazyState* lazy_;       //!< State of the ParseLazy() which the values of the document come from, if any.
+    KeyPool* keyPool_;      //!< Object names while parsing with kParseInternKeysFlag.
+    bool lazyNumbers_;      //!< Whether RawNumber() makes numbers of kParseLazyNumbersFlag while parsing.
+};
+
+// defined here as it holds a GenericDocument
+//! State of a ParseLazy(), shared by its deferred objects and arrays and reused by each expansion.
+template <typename Encoding, typename Allocator, typename StackAllocator>
+struct GenericDocument<Encoding, Allocator, StackAllocator>::LazyState : GenericDocument<Encoding, Allocator, StackAllocator>::LazyContext {
+    explicit LazyState(Allocator* allocator) : LazyContext(), spanStack(0, 0), collector(allocator), reader() {}
+
+    internal::Stack<StackAllocator> spanStack;  //!< Storage of LazyContext::spans.
+    GenericDocument collector;                  //!< Collects the members or elements of an expanded value on its stack.
+    GenericReader<Encoding, Encoding, StackAllocator> reader;
 };
 
 //! GenericDocument with UTF8 encoding
@@ -2416,7 +3488,7 @@ GenericValue<Encoding,Allocator>::GenericValue(const GenericValue<Encoding,Sourc
         }
         break;
     case kStringType:
-        if (rhs.data_.f.flags == kConstStringFlag) {
+        if ((rhs.data_.f.flags & ~kHashedFlag) == kConstStringFlag) {
             data_.f.flags = rhs.data_.f.flags;
             data_  = *reinterpret_cast<const Data*>(&rhs.data_);
         } else {
@@ -2424,12 +3496,573 @@ GenericValue<Encoding,Allocator>::GenericValue(const GenericValue<Encoding,Sourc
         }
         break;
     default:
-        data_.f.flags = rhs.data_.f.flags;
-        data_  = *reinterpret_cast<const Data*>(&rhs.data_);
+        if (rhs.data_.f.flags == kLazyCopyNumberFlag)
+            SetLazyNumberRaw(StringRef(rhs.GetNumberText(), rhs.GetNumberTextLength()), allocator);
+        else {
+            data_.f.flags = rhs.data_.f.flags;
+            data_  = *reinterpret_cast<const Data*>(&rhs.data_);
+        }
         break;
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// GenericColumnarDocument
+
+//! A document for parsing an array of flat objects into columns.
+/*!
+    \note implements Handler concept
+    \tparam Encoding Encoding for both parsing and string storage.
+    \tparam Allocator Allocator for allocating memory for the member names and strings.
+    \tparam StackAllocator Allocator for allocating memory for the columns and the stack during parsing.
+
+    A JSON text like
+    \code
+    [{"id": 1, "price": 9.5, "name": "a"}, {"id": 2, "price": null}, ...]
+    \endcode
+    is stored as one column per member name, each holding the values of all rows
+    in one contiguous array of \c int64_t, \c double, \c bool or string references,
+    with bitmaps of the rows where the value is null or the member is missing.
+    Scanning or aggregating one member over all rows then only touches its column:
+    \code
+    ColumnarDocument d;
+    d.Parse(json);
+    const ColumnarDocument::Column* price = d.FindColumn("price");
+    if (price && price->IsNumber())
+        total = price->Sum();
+    \endcode
+
+    Integers of a column are converted to doubles when the column also has a
+    double (or an unsigned integer beyond \c int64_t). Any other JSON text,
+    e.g. with nested objects or arrays, or a member having both strings and
+    numbers, stops parsing with \ref kParseErrorTermination and HasShapeError();
+    parse it with GenericDocument instead.
+
+    Accept() writes the rows back through a Handler, e.g. Writer, with the
+    members of each row in the order of the columns.
+*/
+template <typename Encoding, typename Allocator = MemoryPoolAllocator<>, typename StackAllocator = CrtAllocator>
+class GenericColumnarDocument {
+public:
+    typedef Encoding EncodingType;      //!< Encoding type from template parameter.
+    typedef typename Encoding::Ch Ch;   //!< Character type derived from Encoding.
+    typedef Allocator AllocatorType;    //!< Allocator type from template parameter.
+
+    //! Type of the values of a column.
+    enum ColumnType {
+        kNullColumn,    //!< No value other than null.
+        kBoolColumn,    //!< \c true and \c false.
+        kInt64Column,   //!< Integers fitting \c int64_t.
+        kDoubleColumn,  //!< Numbers, at least one of them not fitting \c int64_t.
+        kStringColumn   //!< Strings.
+    };
+
+    //! The values of one member name over all rows.
+    /*! Rows where the value is null or the member is missing hold 0, \c false
+        or an empty string in the arrays of values.
+    */
+    class Column {
+    public:
+        //! Member name of the column.
+        const Ch* GetName() const { return name_; }
+        //! Length of the member name of the column.
+        SizeType GetNameLength() const { return nameLength_; }
+        //! Type of the values of the column.
+        ColumnType GetType() const { return type_; }
+        //! Whether the values are \c int64_t or \c double.
+        bool IsNumber() const { return type_ == kInt64Column || type_ == kDoubleColumn; }
+
+        //! Number of rows, same as GenericColumnarDocument::Size().
+        SizeType Size() const { return size_; }
+        //! Number of rows where the value is null or the member is missing.
+        SizeType NullCount() const { return nullCount_; }
+
+        //! Whether the value of a row is null or missing.
+        bool IsNull(SizeType row) const { RAPIDJSON_ASSERT(row < size_); return TestBit(nulls_, row); }
+        //! Whether the member is missing in a row.
+        bool IsMissing(SizeType row) const { RAPIDJSON_ASSERT(row < size_); return TestBit(missing_, row); }
+
+        bool GetBool(SizeType row) const { RAPIDJSON_ASSERT(type_ == kBoolColumn && row < size_); return values_.template Bottom<bool>()[row]; }
+        int64_t GetInt64(SizeType row) const { RAPIDJSON_ASSERT(type_ == kInt64Column && row < size_); return values_.template Bottom<int64_t>()[row]; }
+        //! Get the value of a row of an \c int64_t or \c double column as \c double.
+        double GetDouble(SizeType row) const {
+            RAPIDJSON_ASSERT(IsNumber() && row < size_);
+            return type_ == kInt64Column ? static_cast<double>(values_.template Bottom<int64_t>()[row]) : values_.template Bottom<double>()[row];
+        }
+        const Ch* GetString(SizeType row) const { RAPIDJSON_ASSERT(type_ == kStringColumn && row < size_); return values_.template Bottom<StringRefType>()[row].s; }
+        SizeType GetStringLength(SizeType row) const { RAPIDJSON_ASSERT(type_ == kStringColumn && row < size_); return values_.template Bottom<StringRefType>()[row].length; }
+
+        //! Contiguous values of an \c int64_t column, one per row.
+        const int64_t* GetInt64Values() const { RAPIDJSON_ASSERT(type_ == kInt64Column); return values_.template Bottom<int64_t>(); }
+        //! Contiguous values of a \c double column, one per row.
+        const double* GetDoubleValues() const { RAPIDJSON_ASSERT(type_ == kDoubleColumn); return values_.template Bottom<double>(); }
+
+        //! Sum of the values of an \c int64_t or \c double column, as \c double.
+        double Sum() const {
+            RAPIDJSON_ASSERT(IsNumber());
+            double sum = 0;
+            if (type_ == kInt64Column)
+                for (const int64_t* v = values_.template Bottom<int64_t>(); v != values_.template End<int64_t>(); ++v)
+                    sum += static_cast<double>(*v);
+            else
+                for (const double* v = values_.template Bottom<double>(); v != values_.template End<double>(); ++v)
+                    sum += *v;
+            return sum;
+        }
+
+    private:
+        friend class GenericColumnarDocument;
+        typedef GenericStringRef<Ch> StringRefType;
+
+        Column(const Ch* name, SizeType nameLength, bool copy, StackAllocator* allocator)
+            : name_(name), nameLength_(nameLength), copy_(copy), type_(kNullColumn), size_(0), nullCount_(0),
+              values_(allocator, kDefaultColumnCapacity), nulls_(allocator, 0), missing_(allocator, 0) {}
+
+        Column(const Column&);
+        Column& operator=(const Column&);
+
+        static bool TestBit(const internal::Stack<StackAllocator>& bits, SizeType row) {
+            return row / 32 < bits.GetSize() / sizeof(uint32_t) && ((bits.template Bottom<uint32_t>()[row / 32] >> (row % 32)) & 1u) != 0;
+        }
+
+        static void SetBit(internal::Stack<StackAllocator>& bits, SizeType row) {
+            const size_t words = bits.GetSize() / sizeof(uint32_t);
+            if (row / 32 >= words) {
+                const size_t count = row / 32 + 1 - words;
+                std::memset(bits.template Push<uint32_t>(count), 0, count * sizeof(uint32_t));
+            }
+            bits.template Bottom<uint32_t>()[row / 32] |= 1u << (row % 32);
+        }
+
+        size_t ValueSize() const {
+            switch (type_) {
+            case kBoolColumn:   return sizeof(bool);
+            case kInt64Column:  return sizeof(int64_t);
+            case kDoubleColumn: return sizeof(double);
+            case kStringColumn: return sizeof(StringRefType);
+            default:            return 0;
+            }
+        }
+
+        //! Set the type of a column of nulls so far, with zero values for the rows filled.
+        void SetType(ColumnType type) {
+            RAPIDJSON_ASSERT(type_ == kNullColumn);
+            type_ = type;
+            if (size_)
+                std::memset(values_.template Push<char>(ValueSize() * size_), 0, ValueSize() * size_);
+        }
+
+        //! Append null or, with \c missing, no value.
+        void AppendNull(bool missing) {
+            if (type_ != kNullColumn)
+                std::memset(values_.template Push<char>(ValueSize()), 0, ValueSize());
+            SetBit(nulls_, size_);
+            if (missing)
+                SetBit(missing_, size_);
+            nullCount_++;
+            size_++;
+        }
+
+        //! Fill the rows before \c row, in which the member is missing.
+        void FillMissing(SizeType row) {
+            while (size_ < row)
+                AppendNull(true);
+        }
+
+        bool AppendBool(bool b) {
+            if (type_ == kNullColumn)
+                SetType(kBoolColumn);
+            if (type_ != kBoolColumn)
+                return false;
+            *values_.template Push<bool>() = b;
+            size_++;
+            return true;
+        }
+
+        bool AppendInt64(int64_t i) {
+            if (type_ == kNullColumn)
+                SetType(kInt64Column);
+            if (type_ == kInt64Column)
+                *values_.template Push<int64_t>() = i;
+            else if (type_ == kDoubleColumn)
+                *values_.template Push<double>() = static_cast<double>(i);
+            else
+                return false;
+            size_++;
+            return true;
+        }
+
+        bool AppendDouble(double d) {
+            if (type_ == kNullColumn)
+                SetType(kDoubleColumn);
+            else if (type_ == kInt64Column) {
+                // Same size, so convert in place.
+                type_ = kDoubleColumn;
+                for (char* v = values_.template Bottom<char>(); v != values_.template End<char>(); v += sizeof(double)) {
+                    int64_t i;
+                    std::memcpy(&i, v, sizeof(i));
+                    const double converted = static_cast<double>(i);
+                    std::memcpy(v, &converted, sizeof(converted));
+                }
+            }
+            if (type_ != kDoubleColumn)
+                return false;
+            *values_.template Push<double>() = d;
+            size_++;
+            return true;
+        }
+
+        bool AppendString(const Ch* str, SizeType length) {
+            if (type_ == kNullColumn)
+                SetType(kStringColumn);
+            if (type_ != kStringColumn)
+                return false;
+            new (values_.template Push<StringRefType>()) StringRefType(str, length);
+            size_++;
+            return true;
+        }
+
+        static const size_t kDefaultColumnCapacity = 256;
+
+        const Ch* name_;
+        SizeType nameLength_;
+        bool copy_;             //!< Whether the name and strings are owned by the allocator of the document.
+        ColumnType type_;
+        SizeType size_;
+        SizeType nullCount_;
+        internal::Stack<StackAllocator> values_;    //!< One value of ValueSize() bytes per row.
+        internal::Stack<StackAllocator> nulls_;     //!< Bitmap of rows with null or missing values, shorter if the last rows have values.
+        internal::Stack<StackAllocator> missing_;   //!< Bitmap of rows with the member missing, likewise.
+    };
+
+    //! Constructor
+    /*! Creates an empty document without rows or columns.
+        \param allocator        Optional allocator for allocating memory for the member names and strings.
+        \param stackCapacity    Optional initial capacity of stack in bytes.
+        \param stackAllocator   Optional allocator for allocating memory for the columns and stack.
+    */
+    GenericColumnarDocument(Allocator* allocator = 0, size_t stackCapacity = kDefaultStackCapacity, StackAllocator* stackAllocator = 0) :
+        allocator_(allocator), ownAllocator_(0), stackAllocator_(stackAllocator), stackCapacity_(stackCapacity),
+        columns_(stackAllocator, kDefaultStackCapacity), parseResult_(), size_(0), depth_(0), current_(0), next_(0), shapeError_(false)
+    {
+        if (!allocator_)
+            ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator());
+    }
+
+    ~GenericColumnarDocument() {
+        Clear();
+        RAPIDJSON_DELETE(ownAllocator_);
+    }
+
+    //! Remove all rows and columns.
+    /*! The member names and strings stay in the allocator until it is cleared. */
+    void Clear() {
+        while (!columns_.Empty()) {
+            Column* c = *columns_.template Pop<Column*>(1);
+            if (Allocator::kNeedFree && c->copy_) {
+                Allocator::Free(const_cast<Ch*>(c->name_));
+                if (c->type_ == kStringColumn)
+                    for (SizeType row = 0; row < c->size_; row++)
+                        Allocator::Free(const_cast<Ch*>(c->GetString(row)));
+            }
+            RAPIDJSON_DELETE(c);
+        }
+        size_ = 0;
+        depth_ = 0;
+        current_ = 0;
+        next_ = 0;
+        shapeError_ = false;
+    }
+
+    //!@name Parse from stream
+    //!@{
+
+    //! Parse JSON text from an input stream (with Encoding conversion)
+    /*! \tparam parseFlags Combination of \ref ParseFlag.
+        \tparam SourceEncoding Encoding of input stream
+        \tparam InputStream Type of input stream, implementing Stream concept
+        \param is Input stream to be parsed.
+        \return The document itself for fluent API.
+    */
+    template <unsigned parseFlags, typename SourceEncoding, typename InputStream>
+    GenericColumnarDocument& ParseStream(InputStream& is) {
+        Clear();
+        GenericReader<SourceEncoding, Encoding, StackAllocator> reader(stackAllocator_, stackCapacity_);
+        parseResult_ = reader.template Parse<parseFlags>(is, *this);
+        if (!parseResult_)
+            Clear();
+        shapeError_ = parseResult_.Code() == kParseErrorTermination;
+        return *this;
+    }
+
+    //! Parse JSON text from an input stream
+    template <unsigned parseFlags, typename InputStream>
+    GenericColumnarDocument& ParseStream(InputStream& is) {
+        return ParseStream<parseFlags, Encoding, InputStream>(is);
+    }
+
+    //! Parse JSON text from an input stream (with \ref kParseDefaultFlags)
+    template <typename InputStream>
+    GenericColumnarDocument& ParseStream(InputStream& is) {
+        return ParseStream<kParseDefaultFlags, Encoding, InputStream>(is);
+    }
+    //!@}
+
+    //!@name Parse in-place from mutable string
+    //!@{
+
+    //! Parse JSON text from a mutable string, referencing the strings and member names in it
+    template <unsigned parseFlags>
+    GenericColumnarDocument& ParseInsitu(Ch* str) {
+        GenericInsituStringStream<Encoding> s(str);
+        return ParseStream<parseFlags | kParseInsituFlag>(s);
+    }
+
+    //! Parse JSON text from a mutable string (with \ref kParseDefaultFlags)
+    GenericColumnarDocument& ParseInsitu(Ch* str) {
+        return ParseInsitu<kParseDefaultFlags>(str);
+    }
+    //!@}
+
+    //!@name Parse from read-only string
+    //!@{
+
+    //! Parse JSON text from a read-only string (with Encoding conversion)
+    template <unsigned parseFlags, typename SourceEncoding>
+    GenericColumnarDocument& Parse(const typename SourceEncoding::Ch* str) {
+        RAPIDJSON_ASSERT(!(parseFlags & kParseInsituFlag));
+        GenericStringStream<SourceEncoding> s(str);
+        return ParseStream<parseFlags, SourceEncoding>(s);
+    }
+
+    //! Parse JSON text from a read-only string
+    template <unsigned parseFlags>
+    GenericColumnarDocument& Parse(const Ch* str) {
+        return Parse<parseFlags, Encoding>(str);
+    }
+
+    //! Parse JSON text from a read-only string (with \ref kParseDefaultFlags)
+    GenericColumnarDocument& Parse(const Ch* str) {
+        return Parse<kParseDefaultFlags>(str);
+    }
+    //!@}
+
+    //!@name Handling parse errors
+    //!@{
+
+    //! Whether a parse error has occured in the last parsing.
+    bool HasParseError() const { return parseResult_.IsError(); }
+
+    //! Get the \ref ParseErrorCode of last parsing.
+    ParseErrorCode GetParseError() const { return parseResult_.Code(); }
+
+    //! Get the position of last parsing error in input, 0 otherwise.
+    size_t GetErrorOffset() const { return parseResult_.Offset(); }
+
+    //! Whether the last parsing stopped because the JSON text is not an array of flat objects with one type per member.
+    bool HasShapeError() const { return shapeError_; }
+
+    //! Implicit conversion to get the last parse result
+    operator ParseResult() const { return parseResult_; }
+    //!@}
+
+    //!@name Rows and columns
+    //!@{
+
+    //! Number of rows, i.e. objects in the array.
+    SizeType Size() const { return size_; }
+
+    //! Number of columns, i.e. distinct member names.
+    SizeType ColumnCount() const { return static_cast<SizeType>(columns_.GetSize() / sizeof(Column*)); }
+
+    //! Get a column, in the order of first occurrence of its member name.
+    const Column& GetColumn(SizeType index) const {
+        RAPIDJSON_ASSERT(index < ColumnCount());
+        return *columns_.template Bottom<Column*>()[index];
+    }
+
+    //! Find a column by member name, or null if no row has the member.
+    const Column* FindColumn(const Ch* name) const {
+        return FindColumn(name, internal::StrLen(name));
+    }
+
+    //! Find a column by member name with length, or null if no row has the member.
+    const Column* FindColumn(const Ch* name, SizeType length) const {
+        for (SizeType i = 0; i < ColumnCount(); i++) {
+            const Column& c = GetColumn(i);
+            if (c.nameLength_ == length && std::memcmp(c.name_, name, length * sizeof(Ch)) == 0)
+                return &c;
+        }
+        return 0;
+    }
+    //!@}
+
+    //! Generate SAX events of the array of rows.
+    /*! The members of each row are in the order of the columns, without the
+        members missing in the row.
+        \param handler An object implementing concept Handler.
+        \return Whether all events were accepted by the handler.
+    */
+    template <typename Handler>
+    bool Accept(Handler& handler) const {
+        if (RAPIDJSON_UNLIKELY(!handler.StartArray()))
+            return false;
+        const SizeType columnCount = ColumnCount();
+        for (SizeType row = 0; row < size_; row++) {
+            if (RAPIDJSON_UNLIKELY(!handler.StartObject()))
+                return false;
+            SizeType memberCount = 0;
+            for (SizeType i = 0; i < columnCount; i++) {
+                const Column& c = GetColumn(i);
+                if (c.IsMissing(row))
+                    continue;
+                if (RAPIDJSON_UNLIKELY(!handler.Key(c.name_, c.nameLength_, true)))
+                    return false;
+                bool ok;
+                if (c.IsNull(row))
+                    ok = handler.Null();
+                else {
+                    switch (c.type_) {
+                    case kBoolColumn:   ok = handler.Bool(c.GetBool(row)); break;
+                    case kInt64Column:  ok = handler.Int64(c.GetInt64(row)); break;
+                    case kDoubleColumn: ok = handler.Double(c.GetDouble(row)); break;
+                    default:
+                        RAPIDJSON_ASSERT(c.type_ == kStringColumn);
+                        ok = handler.String(c.GetString(row), c.GetStringLength(row), true);
+                        break;
+                    }
+                }
+                if (RAPIDJSON_UNLIKELY(!ok))
+                    return false;
+                memberCount++;
+            }
+            if (RAPIDJSON_UNLIKELY(!handler.EndObject(memberCount)))
+                return false;
+        }
+        return handler.EndArray(size_);
+    }
+
+    //! Get the allocator of the member names and strings.
+    Allocator& GetAllocator() {
+        RAPIDJSON_ASSERT(allocator_);
+        return *allocator_;
+    }
+
+    // Implementation of Handler
+    bool Null() {
+        if (!current_)
+            return false;
+        current_->AppendNull(false);
+        return EndValue();
+    }
+    bool Bool(bool b) { return current_ && current_->AppendBool(b) && EndValue(); }
+    bool Int(int i) { return Int64(i); }
+    bool Uint(unsigned i) { return Int64(i); }
+    bool Int64(int64_t i) { return current_ && current_->AppendInt64(i) && EndValue(); }
+    bool Uint64(uint64_t i) {
+        if (!(i & RAPIDJSON_UINT64_C2(0x80000000, 0x00000000)))
+            return Int64(static_cast<int64_t>(i));
+        return Double(static_cast<double>(i));
+    }
+    bool Double(double d) { return current_ && current_->AppendDouble(d) && EndValue(); }
+    bool RawNumber(const Ch*, SizeType, bool) { return false; }
+
+    bool String(const Ch* str, SizeType length, bool copy) {
+        return current_ && current_->AppendString(copy ? CopyString(str, length) : str, length) && EndValue();
+    }
+
+    bool StartObject() {
+        if (depth_ != 1)
+            return false;
+        depth_ = 2;
+        next_ = 0;
+        return true;
+    }
+
+    bool Key(const Ch* str, SizeType length, bool copy) {
+        RAPIDJSON_ASSERT(depth_ == 2);
+        Column** columns = columns_.template Bottom<Column*>();
+        const SizeType columnCount = ColumnCount();
+        // Rows usually have the same members in the same order, so try the column after the last one first.
+        SizeType i = next_;
+        if (i >= columnCount || !NameEquals(*columns[i], str, length))
+            for (i = 0; i < columnCount && !NameEquals(*columns[i], str, length); i++) {}
+        if (i == columnCount) {
+            const Ch* name = copy ? CopyString(str, length) : str;
+            Column* c = RAPIDJSON_NEW(Column(name, length, copy, stackAllocator_));
+            *columns_.template Push<Column*>() = c;
+            c->FillMissing(size_);
+            columns = columns_.template Bottom<Column*>();
+        }
+        else if (columns[i]->size_ > size_)
+            return false; // duplicated member name in this row
+        else
+            columns[i]->FillMissing(size_);
+        current_ = columns[i];
+        next_ = i + 1;
+        return true;
+    }
+
+    bool EndObject(SizeType) {
+        size_++;
+        Column** columns = columns_.template Bottom<Column*>();
+        for (SizeType i = 0; i < ColumnCount(); i++)
+            columns[i]->FillMissing(size_);
+        depth_ = 1;
+        return true;
+    }
+
+    bool StartArray() {
+        if (depth_ != 0)
+            return false;
+        depth_ = 1;
+        return true;
+    }
+
+    bool EndArray(SizeType) {
+        depth_ = 0;
+        return true;
+    }
+
+private:
+    // Prohibit copying
+    GenericColumnarDocument(const GenericColumnarDocument&);
+    GenericColumnarDocument& operator=(const GenericColumnarDocument&);
+
+    //! End of the value of a member.
+    bool EndValue() {
+        current_ = 0;
+        return true;
+    }
+
+    static bool NameEquals(const Column& c, const Ch* str, SizeType length) {
+        return c.nameLength_ == length && std::memcmp(c.name_, str, length * sizeof(Ch)) == 0;
+    }
+
+    const Ch* CopyString(const Ch* str, SizeType length) {
+        Ch* copy = static_cast<Ch*>(allocator_->Malloc((length + 1) * sizeof(Ch)));
+        std::memcpy(copy, str, length * sizeof(Ch));
+        copy[length] = '\0';
+        return copy;
+    }
+
+    static const size_t kDefaultStackCapacity = 1024;
+    Allocator* allocator_;
+    Allocator* ownAllocator_;
+    StackAllocator* stackAllocator_;
+    size_t stackCapacity_;
+    internal::Stack<StackAllocator> columns_;   //!< Column pointers in order of first occurrence.
+    ParseResult parseResult_;
+    SizeType size_;         //!< Number of rows.
+    unsigned depth_;        //!< 0 outside the array, 1 in the array, 2 in a row.
+    Column* current_;       //!< Column of the member whose value is parsed next, if any.
+    SizeType next_;         //!< Index of the column after the one of the last member name in the row.
+    bool shapeError_;
+};
+
+//! GenericColumnarDocument with UTF8 encoding
+typedef GenericColumnarDocument<UTF8<> > ColumnarDocument;
+
 //! Helper class for accessing Value of array type.
 /*!
     Instance of this helper class is obtained by \c GenericValue::GetArray().
@@ -41,6 +41,19 @@ class CrtAllocator;
 template <typename BaseAllocator>
 class MemoryPoolAllocator;
 
+#if RAPIDJSON_HAS_CXX11_ATOMIC
+template <typename BaseAllocator>
+class ChunkPool;
+
+template <typename BaseAllocator>
+class ConcurrentMemoryPoolAllocator;
+#endif
+
+#if RAPIDJSON_HAS_MMAP
+template <unsigned mmapFlags>
+class MmapAllocator;
+#endif
+
 // stream.h
 
 template <typename Encoding>
@@ -89,6 +102,13 @@ class GenericReader;
 
 typedef GenericReader<UTF8<char>, UTF8<char>, CrtAllocator> Reader;
 
+// pushreader.h
+
+template <typename SourceEncoding, typename TargetEncoding, typename StackAllocator>
+class GenericPushReader;
+
+typedef GenericPushReader<UTF8<char>, UTF8<char>, CrtAllocator> PushReader;
+
 // writer.h
 
 template<typename OutputStream, typename SourceEncoding, typename TargetEncoding, typename StackAllocator, unsigned writeFlags>
@@ -120,6 +140,50 @@ class GenericDocument;
 
 typedef GenericDocument<UTF8<char>, MemoryPoolAllocator<CrtAllocator>, CrtAllocator> Document;
 
+template <typename Encoding, typename Allocator, typename StackAllocator>
+class GenericColumnarDocument;
+
+typedef GenericColumnarDocument<UTF8<char>, MemoryPoolAllocator<CrtAllocator>, CrtAllocator> ColumnarDocument;
+
+// snapshot.h
+
+template <typename Encoding>
+class GenericSnapshotValue;
+
+typedef GenericSnapshotValue<UTF8<char> > SnapshotValue;
+
+template <typename Encoding, typename StackAllocator>
+class GenericSnapshotWriter;
+
+typedef GenericSnapshotWriter<UTF8<char>, CrtAllocator> SnapshotWriter;
+
+#if RAPIDJSON_HAS_MMAP
+template <typename Encoding>
+class GenericSnapshotFile;
+
+typedef GenericSnapshotFile<UTF8<char> > SnapshotFile;
+#endif
+
+// msgpack.h
+
+template <typename TargetEncoding, typename StackAllocator>
+class GenericMsgPackReader;
+
+typedef GenericMsgPackReader<UTF8<char>, CrtAllocator> MsgPackReader;
+
+template <typename OutputStream, typename StackAllocator>
+class MsgPackWriter;
+
+// cbor.h
+
+template <typename TargetEncoding, typename StackAllocator>
+class GenericCborReader;
+
+typedef GenericCborReader<UTF8<char>, CrtAllocator> CborReader;
+
+template <typename OutputStream, typename StackAllocator>
+class CborWriter;
+
 // pointer.h
 
 template <typename ValueType, typename Allocator>
@@ -127,6 +191,11 @@ class GenericPointer;
 
 typedef GenericPointer<Value, CrtAllocator> Pointer;
 
+template <typename Encoding, typename Allocator>
+class GenericProjection;
+
+typedef GenericProjection<UTF8<char>, CrtAllocator> Projection;
+
 // schema.h
 
 template <typename SchemaDocumentType>
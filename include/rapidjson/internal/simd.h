@@ -0,0 +1,747 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_INTERNAL_SIMD_H_
+#define RAPIDJSON_INTERNAL_SIMD_H_
+
+#include "../rapidjson.h"
+#include <cstring>
+
+// SIMD kernels, bound at runtime with RAPIDJSON_SIMD_DISPATCH, or picked by the
+// compile-time symbols otherwise (see ScanUnescaped() and ValidateUtf8()).
+// Every kernel is compiled for its own instruction set with a target attribute,
+// so the translation unit itself needs no -msse4.2/-mavx2 flags.
+
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) \
+    && (defined(__GNUC__) || defined(_MSC_VER))
+#define RAPIDJSON_SIMD_DISPATCH_X86 1
+#else
+#define RAPIDJSON_SIMD_DISPATCH_X86 0
+#endif
+
+#if RAPIDJSON_SIMD_DISPATCH_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#pragma intrinsic(_BitScanForward)
+#if defined(_M_X64)
+#pragma intrinsic(_BitScanForward64)
+#endif
+#endif
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) && !defined(_MSC_VER)
+#define RAPIDJSON_SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define RAPIDJSON_SIMD_TARGET(isa)
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+namespace internal {
+
+//! Instruction set levels known to the runtime dispatcher, in increasing order.
+enum SimdLevel {
+    kSimdNone = 0,  //!< Scalar code only.
+    kSimdSSE2,      //!< SSE2, 16 bytes per step.
+    kSimdSSE42,     //!< SSE4.2 (pcmpistrm for whitespace), 16 bytes per step.
+    kSimdAVX2,      //!< AVX2, 32 bytes per step.
+    kSimdAVX512     //!< AVX-512F + AVX-512BW, 64 bytes per step.
+};
+
+//! Query the running CPU (and OS register state support) for the widest usable level.
+inline SimdLevel DetectSimdLevel() {
+#if RAPIDJSON_SIMD_DISPATCH_X86 && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool sse2 = (info[3] & (1 << 26)) != 0;
+    const bool sse42 = (info[2] & (1 << 20)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    bool avx2 = false, avx512 = false;
+    if (maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+        avx512 = (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0 && (xcr0 & 0xE6) == 0xE6;
+    }
+    if (avx512) return kSimdAVX512;
+    if (avx2) return kSimdAVX2;
+    if (sse42) return kSimdSSE42;
+    if (sse2) return kSimdSSE2;
+    return kSimdNone;
+#elif RAPIDJSON_SIMD_DISPATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) return kSimdAVX512;
+    if (__builtin_cpu_supports("avx2")) return kSimdAVX2;
+    if (__builtin_cpu_supports("sse4.2")) return kSimdSSE42;
+    if (__builtin_cpu_supports("sse2")) return kSimdSSE2;
+    return kSimdNone;
+#else
+    return kSimdNone;
+#endif
+}
+
+//! Level detected once per process.
+inline SimdLevel GetSimdLevel() {
+    static const SimdLevel level = DetectSimdLevel();
+    return level;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Helpers
+
+inline bool SimdIsWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// Characters which stop an unescaped run: '"', '\\' and control characters.
+inline bool SimdIsSpecial(char c) {
+    return c == '\"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+inline unsigned SimdTrailingZeros(unsigned r) {
+    RAPIDJSON_ASSERT(r != 0);
+#ifdef _MSC_VER
+    unsigned long offset;
+    _BitScanForward(&offset, r);
+    return static_cast<unsigned>(offset);
+#else
+    return static_cast<unsigned>(__builtin_ctz(r));
+#endif
+}
+
+inline unsigned SimdTrailingZeros64(uint64_t r) {
+    RAPIDJSON_ASSERT(r != 0);
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long offset;
+    _BitScanForward64(&offset, r);
+    return static_cast<unsigned>(offset);
+#elif defined(_MSC_VER)
+    const unsigned lo = static_cast<unsigned>(r);
+    return lo != 0 ? SimdTrailingZeros(lo) : 32 + SimdTrailingZeros(static_cast<unsigned>(r >> 32));
+#else
+    return static_cast<unsigned>(__builtin_ctzll(r));
+#endif
+}
+
+template <size_t N>
+inline const char* SimdAlignDown(const char* p) {
+    return reinterpret_cast<const char*>(reinterpret_cast<size_t>(p) & ~static_cast<size_t>(N - 1));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Scalar kernels
+
+//! Skip whitespace of a null-terminated string.
+inline const char* SkipWhitespace_Scalar(const char* p) {
+    while (SimdIsWhitespace(*p))
+        ++p;
+    return p;
+}
+
+//! Skip whitespace in [p, end).
+inline const char* SkipWhitespace_Scalar(const char* p, const char* end) {
+    while (p != end && SimdIsWhitespace(*p))
+        ++p;
+    return p;
+}
+
+//! Find the first '"', '\\' or control character of a null-terminated string.
+inline const char* ScanUnescaped_Scalar(const char* p) {
+    while (!SimdIsSpecial(*p))
+        ++p;
+    return p;
+}
+
+//! Find the first '"', '\\' or control character in [p, end), or \c end.
+inline const char* ScanUnescaped_Scalar(const char* p, const char* end) {
+    while (p != end && !SimdIsSpecial(*p))
+        ++p;
+    return p;
+}
+
+//! Length of the valid UTF-8 sequence at p within [p, end), or 0.
+/*! Overlong forms, surrogates and code points above U+10FFFF are invalid, as in UTF8::Decode().
+*/
+inline ptrdiff_t Utf8SequenceLength_Scalar(const char* p, const char* end) {
+    const unsigned c = static_cast<unsigned char>(*p);
+    if (c < 0x80)
+        return 1;
+    unsigned lower = 0x80, upper = 0xBF;    // range of the second byte
+    ptrdiff_t length;
+    if (c >= 0xC2 && c <= 0xDF)
+        length = 2;
+    else if (c >= 0xE0 && c <= 0xEF) {
+        length = 3;
+        if (c == 0xE0) lower = 0xA0;        // overlong
+        if (c == 0xED) upper = 0x9F;        // surrogate
+    }
+    else if (c >= 0xF0 && c <= 0xF4) {
+        length = 4;
+        if (c == 0xF0) lower = 0x90;        // overlong
+        if (c == 0xF4) upper = 0x8F;        // above U+10FFFF
+    }
+    else
+        return 0;
+    if (end - p < length)
+        return 0;
+    const unsigned c1 = static_cast<unsigned char>(p[1]);
+    if (c1 < lower || c1 > upper)
+        return 0;
+    for (ptrdiff_t i = 2; i < length; i++)
+        if ((static_cast<unsigned char>(p[i]) & 0xC0) != 0x80)
+            return 0;
+    return length;
+}
+
+//! Find the first byte in [p, end) which does not start a valid UTF-8 sequence, or \c end.
+inline const char* FindInvalidUtf8_Scalar(const char* p, const char* end) {
+    while (p != end) {
+        const ptrdiff_t length = Utf8SequenceLength_Scalar(p, end);
+        if (length == 0)
+            return p;
+        p += length;
+    }
+    return p;
+}
+
+//! Validate UTF-8 in [p, end).
+inline bool ValidateUtf8_Scalar(const char* p, const char* end) {
+    return FindInvalidUtf8_Scalar(p, end) == end;
+}
+
+#if RAPIDJSON_SIMD_DISPATCH_X86
+
+// The null-terminated kernels start with the aligned block containing p, discarding the
+// bits before p, and use aligned loads afterwards, so that they never read across a page
+// boundary. The SSE4.2 whitespace kernel classifies that first block with the SSE2 mask,
+// since pcmpistrm stops at a null character that may precede p (e.g. in situ parsing).
+// The bounded kernels use unaligned loads which stay within [p, end).
+
+///////////////////////////////////////////////////////////////////////////////
+// SSE2
+
+RAPIDJSON_SIMD_TARGET("sse2")
+inline unsigned SimdWhitespaceMask_SSE2(__m128i s) {
+    __m128i x = _mm_cmpeq_epi8(s, _mm_set1_epi8(' '));
+    x = _mm_or_si128(x, _mm_cmpeq_epi8(s, _mm_set1_epi8('\n')));
+    x = _mm_or_si128(x, _mm_cmpeq_epi8(s, _mm_set1_epi8('\r')));
+    x = _mm_or_si128(x, _mm_cmpeq_epi8(s, _mm_set1_epi8('\t')));
+    return static_cast<unsigned>(~_mm_movemask_epi8(x)) & 0xFFFFu;    // non-whitespace bits
+}
+
+RAPIDJSON_SIMD_TARGET("sse2")
+inline unsigned SimdSpecialMask_SSE2(__m128i s) {
+    const __m128i sp = _mm_set1_epi8(0x19);
+    const __m128i t1 = _mm_cmpeq_epi8(s, _mm_set1_epi8('\"'));
+    const __m128i t2 = _mm_cmpeq_epi8(s, _mm_set1_epi8('\\'));
+    const __m128i t3 = _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x19) == 0x19
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(t1, t2), t3)));
+}
+
+RAPIDJSON_SIMD_TARGET("sse2")
+inline const char* SkipWhitespace_SSE2(const char* p) {
+    const char* block = SimdAlignDown<16>(p);
+    if (unsigned r = SimdWhitespaceMask_SSE2(_mm_load_si128(reinterpret_cast<const __m128i *>(block))) >> (p - block))
+        return p + SimdTrailingZeros(r);
+    for (p = block + 16;; p += 16)
+        if (unsigned r = SimdWhitespaceMask_SSE2(_mm_load_si128(reinterpret_cast<const __m128i *>(p))))
+            return p + SimdTrailingZeros(r);
+}
+
+RAPIDJSON_SIMD_TARGET("sse2")
+inline const char* SkipWhitespace_SSE2(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16)
+        if (unsigned r = SimdWhitespaceMask_SSE2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))))
+            return p + SimdTrailingZeros(r);
+    return SkipWhitespace_Scalar(p, end);
+}
+
+RAPIDJSON_SIMD_TARGET("sse2")
+inline const char* ScanUnescaped_SSE2(const char* p) {
+    const char* block = SimdAlignDown<16>(p);
+    if (unsigned r = SimdSpecialMask_SSE2(_mm_load_si128(reinterpret_cast<const __m128i *>(block))) >> (p - block))
+        return p + SimdTrailingZeros(r);
+    for (p = block + 16;; p += 16)
+        if (unsigned r = SimdSpecialMask_SSE2(_mm_load_si128(reinterpret_cast<const __m128i *>(p))))
+            return p + SimdTrailingZeros(r);
+}
+
+RAPIDJSON_SIMD_TARGET("sse2")
+inline const char* ScanUnescaped_SSE2(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16)
+        if (unsigned r = SimdSpecialMask_SSE2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))))
+            return p + SimdTrailingZeros(r);
+    return ScanUnescaped_Scalar(p, end);
+}
+
+//! Validate UTF-8, skipping ASCII 16 bytes at a time.
+RAPIDJSON_SIMD_TARGET("sse2")
+inline bool ValidateUtf8_SSE2(const char* p, const char* end) {
+    while (end - p >= 16) {
+        const unsigned r = static_cast<unsigned>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))));
+        if (r == 0) {
+            p += 16;
+            continue;
+        }
+        // Sequences starting in this block, the last one may extend beyond it.
+        const char* next = p + 16;
+        for (p += SimdTrailingZeros(r); p < next; ) {
+            const ptrdiff_t length = Utf8SequenceLength_Scalar(p, end);
+            if (length == 0)
+                return false;
+            p += length;
+        }
+    }
+    return ValidateUtf8_Scalar(p, end);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// UTF-8 validation with lookup tables, as in:
+// Keiser, John, and Daniel Lemire. "Validating UTF-8 in less than one instruction
+// per byte." Software: Practice and Experience 51.5 (2021): 950-964.
+//
+// Each byte is checked together with the byte before it by three 16-entry table
+// lookups (high nibble of the previous byte, its low nibble, high nibble of the
+// current byte): a bit survives in all three only for an invalid pair. Third and
+// fourth bytes of a sequence are checked separately, two and three bytes back.
+
+enum {
+    kUtf8TooShort     = 1 << 0, // 11______ 0_______, 11______ 11______
+    kUtf8TooLong      = 1 << 1, // 0_______ 10______
+    kUtf8Overlong3    = 1 << 2, // 11100000 100_____
+    kUtf8TooLarge     = 1 << 3, // 11110100 1001____, 11110100 101_____, 111101__ 10______ ...
+    kUtf8Surrogate    = 1 << 4, // 11101101 101_____
+    kUtf8Overlong2    = 1 << 5, // 1100000_ 10______
+    kUtf8TooLarge1000 = 1 << 6, // 11110101 1000____, 1111011_ 1000____, 11111___ 1000____
+    kUtf8Overlong4    = 1 << 6, // 11110000 1000____
+    kUtf8TwoConts     = 1 << 7, // 10______ 10______
+    kUtf8Carry        = kUtf8TooShort | kUtf8TooLong | kUtf8TwoConts
+};
+
+//! Lookup tables indexed by the high nibble of the previous byte, its low nibble and the high nibble of the current byte.
+/*! A class template, so that the static tables can be defined in a header. */
+#define RAPIDJSON_UTF8_TABLE(name) template <typename T> const unsigned char Utf8TablesT<T>::name
+template <typename T>
+struct Utf8TablesT {
+    static const unsigned char byte1High[16];
+    static const unsigned char byte1Low[16];
+    static const unsigned char byte2High[16];
+    static const unsigned char incompleteMax[32];
+};
+
+RAPIDJSON_UTF8_TABLE(byte1High)[16] = {
+    // 0_______: ASCII
+    kUtf8TooLong, kUtf8TooLong, kUtf8TooLong, kUtf8TooLong, kUtf8TooLong, kUtf8TooLong, kUtf8TooLong, kUtf8TooLong,
+    // 10______: continuation
+    kUtf8TwoConts, kUtf8TwoConts, kUtf8TwoConts, kUtf8TwoConts,
+    // 1100____, 1101____: two byte lead
+    kUtf8TooShort | kUtf8Overlong2,
+    kUtf8TooShort,
+    // 1110____: three byte lead
+    kUtf8TooShort | kUtf8Overlong3 | kUtf8Surrogate,
+    // 1111____: four byte lead
+    kUtf8TooShort | kUtf8TooLarge | kUtf8TooLarge1000 | kUtf8Overlong4
+};
+
+RAPIDJSON_UTF8_TABLE(byte1Low)[16] = {
+    kUtf8Carry | kUtf8Overlong3 | kUtf8Overlong2 | kUtf8Overlong4,  // ____0000
+    kUtf8Carry | kUtf8Overlong2,                                    // ____0001
+    kUtf8Carry,
+    kUtf8Carry,
+    kUtf8Carry | kUtf8TooLarge,                                     // ____0100
+    kUtf8Carry | kUtf8TooLarge | kUtf8TooLarge1000,
+    kUtf8Carry | kUtf8TooLarge | kUtf8TooLarge1000,
+    kUtf8Carry | kUtf8TooLarge | kUtf8TooLarge1000,
+    kUtf8Carry | kUtf8TooLarge | kUtf8TooLarge1000,
+    kUtf8Carry | kUtf8TooLarge | kUtf8TooLarge1000,
+    kUtf8Carry | kUtf8TooLarge | kUtf8TooLarge1000,
+    kUtf8Carry | kUtf8TooLarge | kUtf8TooLarge1000,
+    kUtf8Carry | kUtf8TooLarge | kUtf8TooLarge1000,
+    kUtf8Carry | kUtf8TooLarge | kUtf8TooLarge1000 | kUtf8Surrogate, // ____1101
+    kUtf8Carry | kUtf8TooLarge | kUtf8TooLarge1000,
+    kUtf8Carry | kUtf8TooLarge | kUtf8TooLarge1000
+};
+
+RAPIDJSON_UTF8_TABLE(byte2High)[16] = {
+    // 0_______: ASCII
+    kUtf8TooShort, kUtf8TooShort, kUtf8TooShort, kUtf8TooShort, kUtf8TooShort, kUtf8TooShort, kUtf8TooShort, kUtf8TooShort,
+    // 1000____
+    kUtf8TooLong | kUtf8Overlong2 | kUtf8TwoConts | kUtf8Overlong3 | kUtf8TooLarge1000 | kUtf8Overlong4,
+    // 1001____
+    kUtf8TooLong | kUtf8Overlong2 | kUtf8TwoConts | kUtf8Overlong3 | kUtf8TooLarge,
+    // 101_____
+    kUtf8TooLong | kUtf8Overlong2 | kUtf8TwoConts | kUtf8Surrogate | kUtf8TooLarge,
+    kUtf8TooLong | kUtf8Overlong2 | kUtf8TwoConts | kUtf8Surrogate | kUtf8TooLarge,
+    // 11______
+    kUtf8TooShort, kUtf8TooShort, kUtf8TooShort, kUtf8TooShort
+};
+
+// A block ends inside a sequence if any of its last three bytes exceeds these.
+RAPIDJSON_UTF8_TABLE(incompleteMax)[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF
+};
+#undef RAPIDJSON_UTF8_TABLE
+
+typedef Utf8TablesT<void> Utf8LookupTables;
+
+///////////////////////////////////////////////////////////////////////////////
+// SSE4.2 (whitespace and SSSE3 UTF-8 validation, string scanning uses the SSE2 kernels)
+
+RAPIDJSON_SIMD_TARGET("sse4.2")
+inline unsigned SimdWhitespaceMask_SSE42(__m128i s) {
+    static const char whitespace[16] = " \n\r\t";
+    const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespace[0]));
+    return static_cast<unsigned>(_mm_cvtsi128_si32(_mm_cmpistrm(w, s, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK | _SIDD_NEGATIVE_POLARITY)));
+}
+
+RAPIDJSON_SIMD_TARGET("sse4.2")
+inline const char* SkipWhitespace_SSE42(const char* p) {
+    const char* block = SimdAlignDown<16>(p);
+    if (unsigned r = SimdWhitespaceMask_SSE2(_mm_load_si128(reinterpret_cast<const __m128i *>(block))) >> (p - block))
+        return p + SimdTrailingZeros(r);
+    for (p = block + 16;; p += 16)
+        if (unsigned r = SimdWhitespaceMask_SSE42(_mm_load_si128(reinterpret_cast<const __m128i *>(p))))
+            return p + SimdTrailingZeros(r);
+}
+
+RAPIDJSON_SIMD_TARGET("sse4.2")
+inline const char* SkipWhitespace_SSE42(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16)
+        if (unsigned r = SimdWhitespaceMask_SSE42(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))))
+            return p + SimdTrailingZeros(r);
+    return SkipWhitespace_Scalar(p, end);
+}
+
+RAPIDJSON_SIMD_TARGET("sse4.2")
+inline __m128i SimdUtf8Lookup_SSE42(const unsigned char* table, __m128i index) {
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(table)), index);
+}
+
+//! Error bits of a 16-byte block, given the block before it.
+RAPIDJSON_SIMD_TARGET("sse4.2")
+inline __m128i SimdUtf8Errors_SSE42(__m128i input, __m128i prev) {
+    const __m128i low4 = _mm_set1_epi8(0x0F);
+    const __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+    const __m128i special =
+        _mm_and_si128(_mm_and_si128(
+            SimdUtf8Lookup_SSE42(Utf8LookupTables::byte1High, _mm_and_si128(_mm_srli_epi16(prev1, 4), low4)),
+            SimdUtf8Lookup_SSE42(Utf8LookupTables::byte1Low, _mm_and_si128(prev1, low4))),
+            SimdUtf8Lookup_SSE42(Utf8LookupTables::byte2High, _mm_and_si128(_mm_srli_epi16(input, 4), low4)));
+    // Bytes two or three after a three or four byte lead must be continuations: these are the only
+    // pairs with kUtf8TwoConts set legitimately, which the xor clears.
+    const __m128i third = _mm_subs_epu8(_mm_alignr_epi8(input, prev, 14), _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    const __m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(input, prev, 13), _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    const __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+    return _mm_xor_si128(must23, special);
+}
+
+RAPIDJSON_SIMD_TARGET("sse4.2")
+inline void SimdUtf8Block_SSE42(__m128i input, __m128i& prev, __m128i& prevIncomplete, __m128i& error) {
+    if (_mm_movemask_epi8(input) == 0)  // ASCII: only a sequence left open by the previous block is an error
+        error = _mm_or_si128(error, prevIncomplete);
+    else {
+        error = _mm_or_si128(error, SimdUtf8Errors_SSE42(input, prev));
+        prevIncomplete = _mm_subs_epu8(input, _mm_loadu_si128(reinterpret_cast<const __m128i *>(Utf8LookupTables::incompleteMax + 16)));
+    }
+    prev = input;
+}
+
+//! Validate UTF-8 16 bytes at a time with SSSE3 table lookups.
+RAPIDJSON_SIMD_TARGET("sse4.2")
+inline bool ValidateUtf8_SSE42(const char* p, const char* end) {
+    __m128i prev = _mm_setzero_si128(), prevIncomplete = _mm_setzero_si128(), error = _mm_setzero_si128();
+    for (; end - p >= 16; p += 16)
+        SimdUtf8Block_SSE42(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), prev, prevIncomplete, error);
+    if (p != end) {
+        char tail[16] = {};     // padded with ASCII
+        std::memcpy(tail, p, static_cast<size_t>(end - p));
+        SimdUtf8Block_SSE42(_mm_loadu_si128(reinterpret_cast<const __m128i *>(tail)), prev, prevIncomplete, error);
+    }
+    error = _mm_or_si128(error, prevIncomplete);
+    return _mm_testz_si128(error, error) != 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// AVX2
+
+RAPIDJSON_SIMD_TARGET("avx2")
+inline unsigned SimdWhitespaceMask_AVX2(__m256i s) {
+    __m256i x = _mm256_cmpeq_epi8(s, _mm256_set1_epi8(' '));
+    x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, _mm256_set1_epi8('\n')));
+    x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, _mm256_set1_epi8('\r')));
+    x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, _mm256_set1_epi8('\t')));
+    return ~static_cast<unsigned>(_mm256_movemask_epi8(x));
+}
+
+RAPIDJSON_SIMD_TARGET("avx2")
+inline unsigned SimdSpecialMask_AVX2(__m256i s) {
+    const __m256i sp = _mm256_set1_epi8(0x19);
+    const __m256i t1 = _mm256_cmpeq_epi8(s, _mm256_set1_epi8('\"'));
+    const __m256i t2 = _mm256_cmpeq_epi8(s, _mm256_set1_epi8('\\'));
+    const __m256i t3 = _mm256_cmpeq_epi8(_mm256_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x19) == 0x19
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(t1, t2), t3)));
+}
+
+RAPIDJSON_SIMD_TARGET("avx2")
+inline const char* SkipWhitespace_AVX2(const char* p) {
+    const char* block = SimdAlignDown<32>(p);
+    if (unsigned r = SimdWhitespaceMask_AVX2(_mm256_load_si256(reinterpret_cast<const __m256i *>(block))) >> (p - block))
+        return p + SimdTrailingZeros(r);
+    for (p = block + 32;; p += 32)
+        if (unsigned r = SimdWhitespaceMask_AVX2(_mm256_load_si256(reinterpret_cast<const __m256i *>(p))))
+            return p + SimdTrailingZeros(r);
+}
+
+RAPIDJSON_SIMD_TARGET("avx2")
+inline const char* SkipWhitespace_AVX2(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32)
+        if (unsigned r = SimdWhitespaceMask_AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p))))
+            return p + SimdTrailingZeros(r);
+    return SkipWhitespace_Scalar(p, end);
+}
+
+RAPIDJSON_SIMD_TARGET("avx2")
+inline const char* ScanUnescaped_AVX2(const char* p) {
+    const char* block = SimdAlignDown<32>(p);
+    if (unsigned r = SimdSpecialMask_AVX2(_mm256_load_si256(reinterpret_cast<const __m256i *>(block))) >> (p - block))
+        return p + SimdTrailingZeros(r);
+    for (p = block + 32;; p += 32)
+        if (unsigned r = SimdSpecialMask_AVX2(_mm256_load_si256(reinterpret_cast<const __m256i *>(p))))
+            return p + SimdTrailingZeros(r);
+}
+
+RAPIDJSON_SIMD_TARGET("avx2")
+inline const char* ScanUnescaped_AVX2(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32)
+        if (unsigned r = SimdSpecialMask_AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p))))
+            return p + SimdTrailingZeros(r);
+    return ScanUnescaped_Scalar(p, end);
+}
+
+RAPIDJSON_SIMD_TARGET("avx2")
+inline __m256i SimdUtf8Lookup_AVX2(const unsigned char* table, __m256i index) {
+    return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(table))), index);
+}
+
+//! Error bits of a 32-byte block, given the block before it. See SimdUtf8Errors_SSE42().
+RAPIDJSON_SIMD_TARGET("avx2")
+inline __m256i SimdUtf8Errors_AVX2(__m256i input, __m256i prev) {
+    const __m256i low4 = _mm256_set1_epi8(0x0F);
+    const __m256i shifted = _mm256_permute2x128_si256(prev, input, 0x21);   // upper half of prev, lower half of input
+    const __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+    const __m256i special =
+        _mm256_and_si256(_mm256_and_si256(
+            SimdUtf8Lookup_AVX2(Utf8LookupTables::byte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low4)),
+            SimdUtf8Lookup_AVX2(Utf8LookupTables::byte1Low, _mm256_and_si256(prev1, low4))),
+            SimdUtf8Lookup_AVX2(Utf8LookupTables::byte2High, _mm256_and_si256(_mm256_srli_epi16(input, 4), low4)));
+    const __m256i third = _mm256_subs_epu8(_mm256_alignr_epi8(input, shifted, 14), _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    const __m256i fourth = _mm256_subs_epu8(_mm256_alignr_epi8(input, shifted, 13), _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    const __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+    return _mm256_xor_si256(must23, special);
+}
+
+RAPIDJSON_SIMD_TARGET("avx2")
+inline void SimdUtf8Block_AVX2(__m256i input, __m256i& prev, __m256i& prevIncomplete, __m256i& error) {
+    if (_mm256_movemask_epi8(input) == 0)
+        error = _mm256_or_si256(error, prevIncomplete);
+    else {
+        error = _mm256_or_si256(error, SimdUtf8Errors_AVX2(input, prev));
+        prevIncomplete = _mm256_subs_epu8(input, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(Utf8LookupTables::incompleteMax)));
+    }
+    prev = input;
+}
+
+//! Validate UTF-8 32 bytes at a time with AVX2 table lookups.
+RAPIDJSON_SIMD_TARGET("avx2")
+inline bool ValidateUtf8_AVX2(const char* p, const char* end) {
+    __m256i prev = _mm256_setzero_si256(), prevIncomplete = _mm256_setzero_si256(), error = _mm256_setzero_si256();
+    for (; end - p >= 32; p += 32)
+        SimdUtf8Block_AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)), prev, prevIncomplete, error);
+    if (p != end) {
+        char tail[32] = {};     // padded with ASCII
+        std::memcpy(tail, p, static_cast<size_t>(end - p));
+        SimdUtf8Block_AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(tail)), prev, prevIncomplete, error);
+    }
+    error = _mm256_or_si256(error, prevIncomplete);
+    return _mm256_testz_si256(error, error) != 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// AVX-512BW
+
+RAPIDJSON_SIMD_TARGET("avx512f,avx512bw")
+inline uint64_t SimdWhitespaceMask_AVX512(__m512i s) {
+    const uint64_t x = _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8(' ')) | _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\n'))
+                     | _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\r')) | _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\t'));
+    return ~x;
+}
+
+RAPIDJSON_SIMD_TARGET("avx512f,avx512bw")
+inline uint64_t SimdSpecialMask_AVX512(__m512i s) {
+    return _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\"')) | _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\\'))
+         | _mm512_cmplt_epu8_mask(s, _mm512_set1_epi8(0x20));
+}
+
+RAPIDJSON_SIMD_TARGET("avx512f,avx512bw")
+inline const char* SkipWhitespace_AVX512(const char* p) {
+    const char* block = SimdAlignDown<64>(p);
+    if (uint64_t r = SimdWhitespaceMask_AVX512(_mm512_load_si512(reinterpret_cast<const void *>(block))) >> (p - block))
+        return p + SimdTrailingZeros64(r);
+    for (p = block + 64;; p += 64)
+        if (uint64_t r = SimdWhitespaceMask_AVX512(_mm512_load_si512(reinterpret_cast<const void *>(p))))
+            return p + SimdTrailingZeros64(r);
+}
+
+RAPIDJSON_SIMD_TARGET("avx512f,avx512bw")
+inline const char* SkipWhitespace_AVX512(const char* p, const char* end) {
+    for (; end - p >= 64; p += 64)
+        if (uint64_t r = SimdWhitespaceMask_AVX512(_mm512_loadu_si512(reinterpret_cast<const void *>(p))))
+            return p + SimdTrailingZeros64(r);
+    return SkipWhitespace_Scalar(p, end);
+}
+
+RAPIDJSON_SIMD_TARGET("avx512f,avx512bw")
+inline const char* ScanUnescaped_AVX512(const char* p) {
+    const char* block = SimdAlignDown<64>(p);
+    if (uint64_t r = SimdSpecialMask_AVX512(_mm512_load_si512(reinterpret_cast<const void *>(block))) >> (p - block))
+        return p + SimdTrailingZeros64(r);
+    for (p = block + 64;; p += 64)
+        if (uint64_t r = SimdSpecialMask_AVX512(_mm512_load_si512(reinterpret_cast<const void *>(p))))
+            return p + SimdTrailingZeros64(r);
+}
+
+RAPIDJSON_SIMD_TARGET("avx512f,avx512bw")
+inline const char* ScanUnescaped_AVX512(const char* p, const char* end) {
+    for (; end - p >= 64; p += 64)
+        if (uint64_t r = SimdSpecialMask_AVX512(_mm512_loadu_si512(reinterpret_cast<const void *>(p))))
+            return p + SimdTrailingZeros64(r);
+    return ScanUnescaped_Scalar(p, end);
+}
+
+#endif // RAPIDJSON_SIMD_DISPATCH_X86
+
+///////////////////////////////////////////////////////////////////////////////
+// Dispatch table
+
+//! Function pointers to the kernels of one \ref SimdLevel.
+struct SimdKernels {
+    SimdLevel level;
+    const char* (*skipWhitespace)(const char* p);
+    const char* (*skipWhitespaceBounded)(const char* p, const char* end);
+    const char* (*scanUnescaped)(const char* p);
+    const char* (*scanUnescapedBounded)(const char* p, const char* end);
+    bool (*validateUtf8)(const char* p, const char* end);
+};
+
+//! Bind the kernels of a given level. The caller must ensure the CPU supports it.
+inline SimdKernels MakeSimdKernels(SimdLevel level) {
+    SimdKernels k;
+    k.level = kSimdNone;
+    k.skipWhitespace = &SkipWhitespace_Scalar;
+    k.skipWhitespaceBounded = &SkipWhitespace_Scalar;
+    k.scanUnescaped = &ScanUnescaped_Scalar;
+    k.scanUnescapedBounded = &ScanUnescaped_Scalar;
+    k.validateUtf8 = &ValidateUtf8_Scalar;
+#if RAPIDJSON_SIMD_DISPATCH_X86
+    switch (level) {
+    case kSimdAVX512:
+        k.level = kSimdAVX512;
+        k.skipWhitespace = &SkipWhitespace_AVX512;
+        k.skipWhitespaceBounded = &SkipWhitespace_AVX512;
+        k.scanUnescaped = &ScanUnescaped_AVX512;
+        k.scanUnescapedBounded = &ScanUnescaped_AVX512;
+        k.validateUtf8 = &ValidateUtf8_AVX2;
+        break;
+    case kSimdAVX2:
+        k.level = kSimdAVX2;
+        k.skipWhitespace = &SkipWhitespace_AVX2;
+        k.skipWhitespaceBounded = &SkipWhitespace_AVX2;
+        k.scanUnescaped = &ScanUnescaped_AVX2;
+        k.scanUnescapedBounded = &ScanUnescaped_AVX2;
+        k.validateUtf8 = &ValidateUtf8_AVX2;
+        break;
+    case kSimdSSE42:
+        k.level = kSimdSSE42;
+        k.skipWhitespace = &SkipWhitespace_SSE42;
+        k.skipWhitespaceBounded = &SkipWhitespace_SSE42;
+        k.scanUnescaped = &ScanUnescaped_SSE2;
+        k.scanUnescapedBounded = &ScanUnescaped_SSE2;
+        k.validateUtf8 = &ValidateUtf8_SSE42;
+        break;
+    case kSimdSSE2:
+        k.level = kSimdSSE2;
+        k.skipWhitespace = &SkipWhitespace_SSE2;
+        k.skipWhitespaceBounded = &SkipWhitespace_SSE2;
+        k.scanUnescaped = &ScanUnescaped_SSE2;
+        k.scanUnescapedBounded = &ScanUnescaped_SSE2;
+        k.validateUtf8 = &ValidateUtf8_SSE2;
+        break;
+    default:
+        break;
+    }
+#else
+    (void)level;
+#endif
+    return k;
+}
+
+//! Kernels for the running CPU, bound once per process.
+inline const SimdKernels& GetSimdKernels() {
+    static const SimdKernels kernels = MakeSimdKernels(GetSimdLevel());
+    return kernels;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Kernels of the configured SIMD level
+
+// The runtime dispatcher if RAPIDJSON_SIMD_DISPATCH is defined, otherwise the widest
+// kernel allowed by the compile-time RAPIDJSON_SSE2/SSE42/AVX2/AVX512 symbols.
+
+//! Find the first '"', '\\' or control character of a null-terminated string.
+inline const char* ScanUnescaped(const char* p) {
+#if defined(RAPIDJSON_SIMD_DISPATCH)
+    return GetSimdKernels().scanUnescaped(p);
+#elif RAPIDJSON_SIMD_DISPATCH_X86 && defined(RAPIDJSON_AVX512)
+    return ScanUnescaped_AVX512(p);
+#elif RAPIDJSON_SIMD_DISPATCH_X86 && defined(RAPIDJSON_AVX2)
+    return ScanUnescaped_AVX2(p);
+#elif RAPIDJSON_SIMD_DISPATCH_X86 && (defined(RAPIDJSON_SSE42) || defined(RAPIDJSON_SSE2))
+    return ScanUnescaped_SSE2(p);
+#else
+    return ScanUnescaped_Scalar(p);
+#endif
+}
+
+//! Validate UTF-8 in [p, end).
+inline bool ValidateUtf8(const char* p, const char* end) {
+#if defined(RAPIDJSON_SIMD_DISPATCH)
+    return GetSimdKernels().validateUtf8(p, end);
+#elif RAPIDJSON_SIMD_DISPATCH_X86 && defined(RAPIDJSON_AVX2)
+    return ValidateUtf8_AVX2(p, end);
+#elif RAPIDJSON_SIMD_DISPATCH_X86 && defined(RAPIDJSON_SSE42)
+    return ValidateUtf8_SSE42(p, end);
+#elif RAPIDJSON_SIMD_DISPATCH_X86 && defined(RAPIDJSON_SSE2)
+    return ValidateUtf8_SSE2(p, end);
+#else
+    return ValidateUtf8_Scalar(p, end);
+#endif
+}
+
+} // namespace internal
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_INTERNAL_SIMD_H_
@@ -37,7 +37,11 @@ class Stack {
 public:
     // Optimization note: Do not allocate memory for stack_ in constructor.
     // Do it lazily when first Push() -> Expand() -> Resize().
-    Stack(Allocator* allocator, size_t stackCapacity) : allocator_(allocator), ownAllocator_(0), stack_(0), stackTop_(0), stackEnd_(0), initialCapacity_(stackCapacity) {
+    Stack(Allocator* allocator, size_t stackCapacity) : allocator_(allocator), ownAllocator_(0), stack_(0), stackTop_(0), stackEnd_(0), initialCapacity_(stackCapacity)
+#if RAPIDJSON_MEMORY_STATS
+        , peakSize_(0)
+#endif
+    {
     }
 
 #if RAPIDJSON_HAS_CXX11_RVALUE_REFS
@@ -48,6 +52,9 @@ public:
           stackTop_(rhs.stackTop_),
           stackEnd_(rhs.stackEnd_),
           initialCapacity_(rhs.initialCapacity_)
+#if RAPIDJSON_MEMORY_STATS
+          , peakSize_(rhs.peakSize_)
+#endif
     {
         rhs.allocator_ = 0;
         rhs.ownAllocator_ = 0;
@@ -74,6 +81,9 @@ public:
             stackTop_ = rhs.stackTop_;
             stackEnd_ = rhs.stackEnd_;
             initialCapacity_ = rhs.initialCapacity_;
+#if RAPIDJSON_MEMORY_STATS
+            peakSize_ = rhs.peakSize_;
+#endif
 
             rhs.allocator_ = 0;
             rhs.ownAllocator_ = 0;
@@ -93,6 +103,9 @@ public:
         internal::Swap(stackTop_, rhs.stackTop_);
         internal::Swap(stackEnd_, rhs.stackEnd_);
         internal::Swap(initialCapacity_, rhs.initialCapacity_);
+#if RAPIDJSON_MEMORY_STATS
+        internal::Swap(peakSize_, rhs.peakSize_);
+#endif
     }
 
     void Clear() { stackTop_ = stack_; }
@@ -129,6 +142,10 @@ public:
         RAPIDJSON_ASSERT(stackTop_ + sizeof(T) * count <= stackEnd_);
         T* ret = reinterpret_cast<T*>(stackTop_);
         stackTop_ += sizeof(T) * count;
+#if RAPIDJSON_MEMORY_STATS
+        if (GetSize() > peakSize_)
+            peakSize_ = GetSize();
+#endif
         return ret;
     }
 
@@ -175,6 +192,10 @@ public:
     bool Empty() const { return stackTop_ == stack_; }
     size_t GetSize() const { return static_cast<size_t>(stackTop_ - stack_); }
     size_t GetCapacity() const { return static_cast<size_t>(stackEnd_ - stack_); }
+#if RAPIDJSON_MEMORY_STATS
+    //! Highest size in bytes, not reset by Clear().
+    size_t GetPeakSize() const { return peakSize_; }
+#endif
 
 private:
     template<typename T>
@@ -218,6 +239,9 @@ private:
     char *stackTop_;
     char *stackEnd_;
     size_t initialCapacity_;
+#if RAPIDJSON_MEMORY_STATS
+    size_t peakSize_;
+#endif
 };
 
 } // namespace internal
@@ -34,6 +34,28 @@ inline SizeType StrLen(const Ch* s) {
     return SizeType(p - s);
 }
 
+//! Hash of a string for member lookup: 32-bit FNV-1a over its code units.
+template <typename Ch>
+inline uint32_t StrHash(const Ch* s, SizeType length) {
+    uint32_t h = 2166136261u;
+    for (SizeType i = 0; i < length; i++) {
+        h ^= static_cast<uint32_t>(sizeof(Ch) == 1 ? static_cast<unsigned char>(s[i]) : s[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+//! StrHash() of a string literal, usable in constant expressions (see \ref RAPIDJSON_KEY).
+template <typename Ch>
+RAPIDJSON_CONSTEXPR uint32_t StrHashLiteral(const Ch* s, SizeType length, uint32_t h = 2166136261u) {
+    return length == 0 ? h : StrHashLiteral(s + 1, length - 1,
+        (h ^ static_cast<uint32_t>(sizeof(Ch) == 1 ? static_cast<unsigned char>(*s) : *s)) * 16777619u);
+}
+
+//! Compile-time constant of a hash.
+template <uint32_t H>
+struct StrHashConstant { static const uint32_t Value = H; };
+
 //! Returns number of code points in a encoded string.
 template<typename Encoding>
 bool CountStringCodePoint(const typename Encoding::Ch* s, SizeType length, SizeType* outCount) {
@@ -0,0 +1,448 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// Stage one of kParseStructuralIndexFlag: locate the structural characters of
+// in-memory UTF-8 JSON text, 64 bytes at a time, with branch-free bit arithmetic
+// in the spirit of:
+// Langdale, Geoff, and Daniel Lemire. "Parsing gigabytes of JSON per second."
+// The VLDB Journal 28.6 (2019): 941-960.
+
+#ifndef RAPIDJSON_INTERNAL_STRUCTURAL_H_
+#define RAPIDJSON_INTERNAL_STRUCTURAL_H_
+
+#include "stack.h"
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#pragma intrinsic(_BitScanForward)
+#if defined(_M_X64)
+#pragma intrinsic(_BitScanForward64)
+#endif
+#endif
+#if defined(RAPIDJSON_AVX2) || defined(RAPIDJSON_AVX512)
+#include <immintrin.h>
+#elif defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
+#include <emmintrin.h>
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+namespace internal {
+
+//! Character class bitmaps of one 64-byte block, bit i for byte i.
+struct StructuralBlock {
+    uint64_t backslash;
+    uint64_t quote;
+    uint64_t whitespace;    //!< ' ', '\t', '\n', '\r'
+    uint64_t op;            //!< '{', '}', '[', ']', ':', ','
+    uint64_t control;       //!< characters below 0x20, which are not allowed in strings
+    uint64_t zero;          //!< '\0' terminator
+};
+
+inline unsigned StructuralTrailingZeros(uint64_t x) {
+    RAPIDJSON_ASSERT(x != 0);
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long offset;
+    _BitScanForward64(&offset, x);
+    return static_cast<unsigned>(offset);
+#elif defined(_MSC_VER)
+    unsigned long offset;
+    if (_BitScanForward(&offset, static_cast<unsigned long>(x)))
+        return static_cast<unsigned>(offset);
+    _BitScanForward(&offset, static_cast<unsigned long>(x >> 32));
+    return 32 + static_cast<unsigned>(offset);
+#elif defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#else
+    unsigned n = 0;
+    while (!(x & 1)) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+//! Bit i of the result is the XOR of bits 0..i of x.
+inline uint64_t PrefixXor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+//! Classify 64 bytes. \c p must be readable for 64 bytes.
+inline void ClassifyStructuralBlock(const char* p, StructuralBlock& b) {
+#if defined(RAPIDJSON_AVX512)
+    const __m512i s = _mm512_loadu_si512(reinterpret_cast<const void *>(p));
+    b.backslash  = _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\\'));
+    b.quote      = _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\"'));
+    b.whitespace = _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8(' ')) | _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\t'))
+                 | _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\n')) | _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\r'));
+    // '{' and '}' are '[' and ']' with bit 0x20 set
+    const __m512i t = _mm512_and_si512(s, _mm512_set1_epi8(static_cast<char>(0xDF)));
+    b.op         = _mm512_cmpeq_epi8_mask(t, _mm512_set1_epi8('[')) | _mm512_cmpeq_epi8_mask(t, _mm512_set1_epi8(']'))
+                 | _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8(':')) | _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8(','));
+    b.control    = _mm512_cmplt_epu8_mask(s, _mm512_set1_epi8(0x20));
+    b.zero       = _mm512_cmpeq_epi8_mask(s, _mm512_setzero_si512());
+#elif defined(RAPIDJSON_AVX2)
+    uint64_t m[6][2];
+    for (int i = 0; i < 2; i++) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i * 32));
+        const __m256i t = _mm256_and_si256(s, _mm256_set1_epi8(static_cast<char>(0xDF)));
+        m[0][i] = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(s, _mm256_set1_epi8('\\'))));
+        m[1][i] = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(s, _mm256_set1_epi8('\"'))));
+        m[2][i] = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(s, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(s, _mm256_set1_epi8('\t'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(s, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(s, _mm256_set1_epi8('\r'))))));
+        m[3][i] = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(t, _mm256_set1_epi8('[')), _mm256_cmpeq_epi8(t, _mm256_set1_epi8(']'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(s, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(s, _mm256_set1_epi8(','))))));
+        m[4][i] = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(s, _mm256_set1_epi8(0x1F)), s)));
+        m[5][i] = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(s, _mm256_setzero_si256())));
+    }
+    b.backslash  = m[0][0] | (m[0][1] << 32);
+    b.quote      = m[1][0] | (m[1][1] << 32);
+    b.whitespace = m[2][0] | (m[2][1] << 32);
+    b.op         = m[3][0] | (m[3][1] << 32);
+    b.control    = m[4][0] | (m[4][1] << 32);
+    b.zero       = m[5][0] | (m[5][1] << 32);
+#elif defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
+    b.backslash = b.quote = b.whitespace = b.op = b.control = b.zero = 0;
+    for (int i = 0; i < 4; i++) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i * 16));
+        const __m128i t = _mm_and_si128(s, _mm_set1_epi8(static_cast<char>(0xDF)));
+        const int shift = i * 16;
+        b.backslash  |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(s, _mm_set1_epi8('\\')))) << shift;
+        b.quote      |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(s, _mm_set1_epi8('\"')))) << shift;
+        b.whitespace |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(s, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(s, _mm_set1_epi8('\t'))),
+            _mm_or_si128(_mm_cmpeq_epi8(s, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(s, _mm_set1_epi8('\r')))))) << shift;
+        b.op         |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(t, _mm_set1_epi8('[')), _mm_cmpeq_epi8(t, _mm_set1_epi8(']'))),
+            _mm_or_si128(_mm_cmpeq_epi8(s, _mm_set1_epi8(':')), _mm_cmpeq_epi8(s, _mm_set1_epi8(',')))))) << shift;
+        b.control    |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(s, _mm_set1_epi8(0x1F)), s))) << shift;
+        b.zero       |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(s, _mm_setzero_si128()))) << shift;
+    }
+#else
+    b.backslash = b.quote = b.whitespace = b.op = b.control = b.zero = 0;
+    for (unsigned i = 0; i < 64; i++) {
+        const uint64_t bit = static_cast<uint64_t>(1) << i;
+        const unsigned char c = static_cast<unsigned char>(p[i]);
+        if (c < 0x20)
+            b.control |= bit;
+        switch (c) {
+            case '\\': b.backslash |= bit; break;
+            case '\"': b.quote |= bit; break;
+            case ' ': case '\t': case '\n': case '\r': b.whitespace |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',': b.op |= bit; break;
+            case '\0': b.zero |= bit; break;
+            default: break;
+        }
+    }
+#endif
+}
+
+//! Quotes of a classified block which are not escaped by an odd-length run of backslashes.
+/*! \param prevEscaped Whether the first character of the block is escaped, updated for the next block.
+*/
+inline uint64_t UnescapedQuotes(const StructuralBlock& b, uint64_t& prevEscaped) {
+    const uint64_t evenBits = RAPIDJSON_UINT64_C2(0x55555555, 0x55555555);
+    const uint64_t backslash = b.backslash & ~prevEscaped;
+    const uint64_t followsEscape = (backslash << 1) | prevEscaped;
+    const uint64_t oddStarts = backslash & ~evenBits & ~followsEscape;
+    const uint64_t sequencesStartingOnEvenBits = oddStarts + backslash;
+    prevEscaped = sequencesStartingOnEvenBits < oddStarts ? 1u : 0u;    // carry out of the block
+    const uint64_t escaped = (evenBits ^ (sequencesStartingOnEvenBits << 1)) & followsEscape;
+    return b.quote & ~escaped;
+}
+
+//! Classify the 64-byte block at \c block, of which only the bytes from \c head up to the terminator are read.
+/*! The bytes before \c head and from the terminator on are classified as whitespace.
+*/
+inline void ClassifyPartialStructuralBlock(const char* block, const char* head, StructuralBlock& b) {
+    char buffer[64];
+    std::memset(buffer, ' ', sizeof(buffer));
+    const char* p = head > block ? head : block;
+    size_t i = static_cast<size_t>(p - block);
+    for (; i < 64 && *p != '\0'; ++i, ++p)
+        buffer[i] = *p;
+    if (i < 64)
+        buffer[i] = '\0';
+    ClassifyStructuralBlock(buffer, b);
+}
+
+//! Part of a null-terminated text which is known to precede the terminator.
+/*! It is extended with memchr() in growing steps, so that whole blocks are only
+    loaded where they lie within the text, without measuring the text up front.
+*/
+class StructuralTextBound {
+public:
+    explicit StructuralTextBound(const char* head) : known_(head), step_(256) {}
+
+    //! Whether the 64 bytes at \c block, which must not precede the head, lie before the terminator.
+    bool Contains(const char* block) {
+        while (block + 64 > known_ && *known_ != '\0') {
+            const void* zero = std::memchr(known_, '\0', step_);
+            known_ = zero ? static_cast<const char*>(zero) : known_ + step_;
+            if (step_ < 65536)
+                step_ *= 2;
+        }
+        return block + 64 <= known_;
+    }
+
+private:
+    const char* known_;     //!< No terminator before this, or the terminator itself.
+    size_t step_;
+};
+
+//! Classify the 64-byte block at \c block of the text starting at \c head, reading nothing outside the text.
+inline void ClassifyTextBlock(const char* block, const char* head, StructuralTextBound& bound, StructuralBlock& b) {
+    if (block >= head && bound.Contains(block))
+        ClassifyStructuralBlock(block, b);
+    else
+        ClassifyPartialStructuralBlock(block, head, b);
+}
+
+//! Find the end of the string, object or array at \c p in a null-terminated UTF-8 buffer.
+/*! Only quotes, backslashes and brackets outside strings are looked at, 64 bytes at a
+    time: strings are neither unescaped nor validated, and scalars are not checked.
+    \param p Position of the opening quote or bracket, or just past the bracket \c opened.
+        On success, it is set past the closing quote or bracket. Otherwise it is set to
+        the terminator, or to the closing bracket which does not match.
+    \param open Stack of the open brackets. It is left at its size on entry.
+    \param opened The opening bracket ('{' or '[') which has already been consumed, or 0.
+    \return 0 on success, otherwise the opening character ('"', '{' or '[') of the
+        innermost value which is not closed.
+*/
+template <typename Allocator>
+char SkipStructural(const char*& p, Stack<Allocator>& open, char opened = 0) {
+    RAPIDJSON_ASSERT(opened ? (opened == '{' || opened == '[') : (*p == '"' || *p == '{' || *p == '['));
+    const size_t base = open.GetSize();
+    const bool string = !opened && *p == '"';
+    if (opened)
+        *open.template Push<char>() = opened;
+    const char* block = reinterpret_cast<const char*>(reinterpret_cast<uintptr_t>(p) & ~static_cast<uintptr_t>(63));
+    uint64_t prevEscaped = 0;
+    uint64_t prevInString = 0;
+    StructuralTextBound bound(p);
+    for (;; block += 64) {
+        StructuralBlock b;
+        ClassifyTextBlock(block, p, bound, b);
+        if (b.zero) {
+            const uint64_t valid = (b.zero & (0 - b.zero)) - 1;
+            b.backslash &= valid;
+            b.quote &= valid;
+            b.op &= valid;
+        }
+
+        const uint64_t quote = UnescapedQuotes(b, prevEscaped);
+        const uint64_t inString = PrefixXor(quote) ^ prevInString;
+        prevInString = 0 - (inString >> 63);
+
+        if (string) {
+            const uint64_t close = quote & ~inString;
+            if (close) {
+                p = block + StructuralTrailingZeros(close) + 1;
+                return 0;
+            }
+        }
+        else {
+            for (uint64_t op = b.op & ~inString; op; op &= op - 1) {
+                const char* q = block + StructuralTrailingZeros(op);
+                const char c = *q;
+                if (c == '{' || c == '[')
+                    *open.template Push<char>() = c;
+                else if (c == '}' || c == ']') {
+                    const char o = *open.template Top<char>();
+                    if ((o == '{') != (c == '}')) {
+                        open.template Pop<char>(open.GetSize() - base);
+                        p = q;
+                        return o;
+                    }
+                    open.template Pop<char>(1);
+                    if (open.GetSize() == base) {
+                        p = q + 1;
+                        return 0;
+                    }
+                }
+            }
+        }
+
+        if (b.zero) {
+            const unsigned i = StructuralTrailingZeros(b.zero);
+            const char o = string || ((inString >> i) & 1) ? '\"' : *open.template Top<char>();
+            open.template Pop<char>(open.GetSize() - base);
+            p = block + i;
+            return o;
+        }
+    }
+}
+
+//! Incremental structural index over a null-terminated UTF-8 buffer.
+/*! The index contains the position of every structural operator ('{', '}',
+    '[', ']', ':', ','), every opening quote, and every other non-whitespace
+    character outside strings which follows whitespace, an operator or a
+    closing quote (the first character of a literal or number). The closing
+    quote of a string without backslashes or control characters is indexed
+    as well, so that the string can be taken at once (see StringEnd()).
+
+    Consequently, if a parser stands on a whitespace character outside a
+    string, all characters up to the next indexed position are whitespace.
+
+    The input is indexed chunk by chunk on demand, so the index memory is
+    bounded and nothing is read beyond the null terminator.
+    \tparam Allocator Allocator of the index stack.
+*/
+template <typename Allocator>
+class StructuralIndexer {
+public:
+    StructuralIndexer(const char* head, Stack<Allocator>& index) :
+        index_(index), head_(head), bound_(head), block_(reinterpret_cast<const char*>(reinterpret_cast<uintptr_t>(head) & ~static_cast<uintptr_t>(63))),
+        chunkBase_(block_), cursor_(0), end_(0), prevEscaped_(0), prevInString_(0), prevBoundary_(1), stringDirty_(false), done_(false)
+    {
+        index_.Clear();
+    }
+
+    ~StructuralIndexer() {
+        index_.Clear();
+    }
+
+    //! Return the first indexed position at or after \c p, or null if there is none.
+    /*! If \c p lies beyond the indexed text (e.g. the parser skipped a long value),
+        indexing resumes at \c p, which must lie outside strings.
+    */
+    const char* Next(const char* p) {
+        for (;;) {
+            for (; cursor_ != end_; ++cursor_) {
+                const char* s = chunkBase_ + (*cursor_ & ~kStringEndFlag);
+                if (s >= p)
+                    return s;
+            }
+            if (done_)
+                return 0;
+            if (p > block_) {
+                head_ = p;
+                bound_ = StructuralTextBound(p);    // the parser may have written behind p (insitu)
+                block_ = reinterpret_cast<const char*>(reinterpret_cast<uintptr_t>(p) & ~static_cast<uintptr_t>(63));
+                prevEscaped_ = 0;
+                prevInString_ = 0;
+                prevBoundary_ = 1;
+                stringDirty_ = false;
+            }
+            Refill();
+        }
+    }
+
+    //! Return the closing quote of the string opening at \c p, if the string has no backslashes or control characters, otherwise null.
+    /*! \c p must be an indexed opening quote. Strings whose closing quote lies in the next chunk are not reported.
+    */
+    const char* StringEnd(const char* p) {
+        if (Next(p) != p || cursor_ + 1 == end_ || !(cursor_[1] & kStringEndFlag))
+            return 0;
+        return chunkBase_ + (cursor_[1] & ~kStringEndFlag);
+    }
+
+private:
+    StructuralIndexer(const StructuralIndexer&);
+    StructuralIndexer& operator=(const StructuralIndexer&);
+
+    static const size_t kChunkBlocks = 256; //!< Blocks (of 64 bytes) indexed per refill.
+    static const SizeType kStringEndFlag = 0x80000000u; //!< Marks the closing quote of a string without backslashes or control characters.
+
+    void Refill() {
+        index_.Clear();
+        chunkBase_ = block_;
+        for (size_t n = 0; n < kChunkBlocks && !done_; n++, block_ += 64)
+            IndexBlock();
+        cursor_ = index_.template Bottom<SizeType>();
+        end_ = index_.template End<SizeType>();
+    }
+
+    void IndexBlock() {
+        StructuralBlock b;
+        ClassifyTextBlock(block_, head_, bound_, b);
+
+        if (b.zero) {
+            // Treat everything from the terminator on as whitespace.
+            const uint64_t valid = (b.zero & (0 - b.zero)) - 1;
+            b.backslash &= valid;
+            b.quote &= valid;
+            b.op &= valid;
+            b.control &= valid;
+            b.whitespace |= ~valid;
+            done_ = true;
+        }
+
+        // Quotes toggle the string state; inString covers the opening quote but not the closing one.
+        const uint64_t quote = UnescapedQuotes(b, prevEscaped_);
+        const uint64_t inString = PrefixXor(quote) ^ prevInString_;
+        prevInString_ = 0 - (inString >> 63);
+
+        const uint64_t outside = ~inString;
+        const uint64_t op = b.op & outside;
+        const uint64_t boundary = op | (b.whitespace & outside) | (quote & outside);
+        const uint64_t scalar = outside & ~boundary;
+        const uint64_t scalarStart = scalar & ((boundary << 1) | prevBoundary_);
+        prevBoundary_ = boundary >> 63;
+
+        const uint64_t stringEnds = SimpleStringEnds(b, quote, inString);
+        uint64_t structurals = op | (quote & inString) | scalarStart | stringEnds;
+
+        SizeType* out = index_.template Push<SizeType>(64);
+        SizeType* q = out;
+        const SizeType base = static_cast<SizeType>(block_ - chunkBase_);
+        for (; structurals; structurals &= structurals - 1) {
+            const unsigned i = StructuralTrailingZeros(structurals);
+            *q++ = (base + static_cast<SizeType>(i)) | (static_cast<SizeType>((stringEnds >> i) & 1) << 31);
+        }
+        index_.template Pop<SizeType>(static_cast<size_t>(out + 64 - q));
+    }
+
+    //! Closing quotes of the strings without backslashes or control characters, which end in this block.
+    uint64_t SimpleStringEnds(const StructuralBlock& b, uint64_t quote, uint64_t inString) {
+        uint64_t dirty = (b.backslash | b.control) & inString;
+        uint64_t ends = 0;
+        for (; quote; quote &= quote - 1) {
+            const uint64_t bit = quote & (0 - quote);
+            if (inString & bit)     // opening quote
+                stringDirty_ = false;
+            else {
+                if (!stringDirty_ && !(dirty & (bit - 1)))
+                    ends |= bit;
+                dirty &= 0 - bit;   // keep the characters of the following strings
+            }
+        }
+        stringDirty_ = stringDirty_ || dirty != 0;
+        return ends;
+    }
+
+    Stack<Allocator>& index_;
+    const char* head_;
+    StructuralTextBound bound_;
+    const char* block_;         //!< Next block to index (64-byte aligned).
+    const char* chunkBase_;     //!< Offsets in the index are relative to this.
+    const SizeType* cursor_;
+    const SizeType* end_;
+    uint64_t prevEscaped_;      //!< Whether the first character of the next block is escaped.
+    uint64_t prevInString_;     //!< All ones if the previous block ended inside a string.
+    uint64_t prevBoundary_;     //!< Whether the previous block ended with a boundary character.
+    bool stringDirty_;          //!< The string open at the end of the previous block has a backslash or control character.
+    bool done_;                 //!< The terminator has been indexed.
+};
+
+} // namespace internal
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_INTERNAL_STRUCTURAL_H_
@@ -0,0 +1,702 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_MSGPACK_H_
+#define RAPIDJSON_MSGPACK_H_
+
+/*! \file msgpack.h */
+
+#include "reader.h"
+#include "memorystream.h"
+#include "internal/strfunc.h"
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(switch-enum)
+#endif
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericMsgPackReader
+
+//! MessagePack parser generating the SAX events of GenericReader.
+/*! A MessagePack buffer is parsed into the events GenericReader generates for
+    the equivalent JSON text, so any Handler, e.g. Writer or GenericDocument,
+    works with it. Integers and floats are binary and are passed on without
+    any conversion:
+    \li nil, true and false become Null() and Bool().
+    \li Integers become Uint() or Uint64() when they are not negative, and
+        Int() or Int64() otherwise, depending on whether they fit in 32 bits.
+    \li float 32 and float 64 become Double().
+    \li str and map become String(), StartObject(), Key() and EndObject();
+        array becomes StartArray() and EndArray().
+
+    Maps must have str keys, otherwise parsing fails with
+    \ref kParseErrorObjectMissName. bin and ext values have no JSON equivalent
+    and fail with \ref kParseErrorValueInvalid, as do truncated values.
+
+    Strings are passed as pointers into the input (with \c copy set), unless
+    they are transcoded to another TargetEncoding or validated with
+    \ref kParseValidateEncodingFlag. Nested arrays and maps are parsed
+    iteratively, so that deep nesting does not overflow the call stack.
+    Supported \c parseFlags are \ref kParseValidateEncodingFlag and
+    \ref kParseStopWhenDoneFlag.
+
+    A document is built from MessagePack with GenericDocument::Populate():
+    \code
+    struct MsgPackSource {
+        MsgPackSource(const void* data, size_t size) : data(data), size(size) {}
+        template <typename Handler>
+        bool operator()(Handler& handler) { return !MsgPackReader().Parse(data, size, handler).IsError(); }
+        const void* data;
+        size_t size;
+    };
+    MsgPackSource source(data, size);
+    Document d;
+    d.Populate(source);
+    \endcode
+
+    \tparam TargetEncoding Encoding of the strings of the events.
+    \tparam StackAllocator Allocator for the stack of nested arrays and maps, and for transcoded strings.
+    \see MsgPackWriter
+*/
+template <typename TargetEncoding = UTF8<>, typename StackAllocator = CrtAllocator>
+class GenericMsgPackReader {
+public:
+    typedef typename TargetEncoding::Ch Ch; //!< Character type of the events.
+
+    //! Constructor.
+    /*! \param stackAllocator Optional allocator for allocating stack memory. (Only use for non-destructive parsing)
+        \param stackCapacity stack capacity in bytes for storing nesting levels and a single decoded string.
+    */
+    GenericMsgPackReader(StackAllocator* stackAllocator = 0, size_t stackCapacity = kDefaultStackCapacity) :
+        stack_(stackAllocator, stackCapacity), parseResult_() {}
+
+    //! Parse MessagePack data.
+    /*! \tparam parseFlags Combination of \ref ParseFlag.
+        \tparam Handler Type of handler, implementing Handler concept.
+        \param data MessagePack data.
+        \param size Size of the data in bytes.
+        \param handler The handler to receive events.
+        \return Whether the parsing is successful, with the offset of an error in \c data.
+    */
+    template <unsigned parseFlags, typename Handler>
+    ParseResult Parse(const void* data, size_t size, Handler& handler) {
+        parseResult_.Clear();
+        ClearStackOnExit scope(*this);
+        Input in;
+        in.begin = in.p = static_cast<const uint8_t*>(data);
+        in.end = in.begin + size;
+        if (RAPIDJSON_UNLIKELY(size == 0))
+            RAPIDJSON_PARSE_ERROR_NORETURN(kParseErrorDocumentEmpty, 0);
+        else
+            ParseRoot<parseFlags>(in, handler);
+        return parseResult_;
+    }
+
+    //! Parse MessagePack data (with \ref kParseDefaultFlags)
+    template <typename Handler>
+    ParseResult Parse(const void* data, size_t size, Handler& handler) {
+        return Parse<kParseDefaultFlags>(data, size, handler);
+    }
+
+    //! Whether a parse error has occurred in the last parsing.
+    bool HasParseError() const { return parseResult_.IsError(); }
+
+    //! Get the \ref ParseErrorCode of last parsing.
+    ParseErrorCode GetParseErrorCode() const { return parseResult_.Code(); }
+
+    //! Get the position of last parsing error in input, 0 otherwise.
+    size_t GetErrorOffset() const { return parseResult_.Offset(); }
+
+protected:
+    void SetParseError(ParseErrorCode code, size_t offset) { parseResult_.Set(code, offset); }
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    GenericMsgPackReader(const GenericMsgPackReader&);
+    GenericMsgPackReader& operator=(const GenericMsgPackReader&);
+
+    struct ClearStackOnExit {
+        explicit ClearStackOnExit(GenericMsgPackReader& r) : r_(r) {}
+        ~ClearStackOnExit() { r_.stack_.Clear(); r_.stack_.ShrinkToFit(); }
+    private:
+        GenericMsgPackReader& r_;
+        ClearStackOnExit(const ClearStackOnExit&);
+        ClearStackOnExit& operator=(const ClearStackOnExit&);
+    };
+
+    struct Input {
+        size_t Tell() const { return static_cast<size_t>(p - begin); }
+        size_t Left() const { return static_cast<size_t>(end - p); }
+
+        const uint8_t* begin;
+        const uint8_t* p;
+        const uint8_t* end;
+    };
+
+    //! An array or map being parsed.
+    struct Level {
+        SizeType count;     //!< Number of elements or members.
+        SizeType remaining; //!< Number of elements or members not parsed yet.
+        bool map;
+        bool key;           //!< Whether the name of a member is next.
+    };
+
+    //! Output stream of transcoded strings, on top of the levels in the stack.
+    class StackStream {
+    public:
+        typedef typename TargetEncoding::Ch Ch;
+
+        StackStream(internal::Stack<StackAllocator>& stack) : stack_(stack), length_(0) {}
+        RAPIDJSON_FORCEINLINE void Put(Ch c) {
+            *stack_.template Push<Ch>() = c;
+            ++length_;
+        }
+        SizeType Length() const { return length_; }
+        Ch* Pop() { return stack_.template Pop<Ch>(length_); }
+
+    private:
+        StackStream(const StackStream&);
+        StackStream& operator=(const StackStream&);
+
+        internal::Stack<StackAllocator>& stack_;
+        SizeType length_;
+    };
+
+    static uint64_t ReadBigEndian(const uint8_t* p, size_t n) {
+        uint64_t v = 0;
+        for (size_t i = 0; i < n; i++)
+            v = (v << 8) | p[i];
+        return v;
+    }
+
+    template <unsigned parseFlags, typename Handler>
+    void ParseRoot(Input& in, Handler& handler) {
+        ParseValue<parseFlags>(in, handler);
+        RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+        while (!stack_.Empty()) {
+            Level& level = *stack_.template Top<Level>();
+            if (level.remaining == 0) {
+                const bool map = level.map;
+                const SizeType count = level.count;
+                stack_.template Pop<Level>(1);
+                if (RAPIDJSON_UNLIKELY(!(map ? handler.EndObject(count) : handler.EndArray(count))))
+                    RAPIDJSON_PARSE_ERROR(kParseErrorTermination, in.Tell());
+            }
+            else if (level.key) {
+                level.key = false;
+                ParseKey<parseFlags>(in, handler);
+            }
+            else {
+                level.remaining--;
+                level.key = level.map;
+                ParseValue<parseFlags>(in, handler);   // may push a level
+            }
+            RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+        }
+        if (!(parseFlags & kParseStopWhenDoneFlag) && in.p != in.end)
+            RAPIDJSON_PARSE_ERROR(kParseErrorDocumentRootNotSingular, in.Tell());
+    }
+
+    //! Read the big-endian length or value of \c n bytes after the type byte at \c offset.
+    bool ReadArgument(Input& in, size_t n, size_t offset, uint64_t& value) {
+        if (RAPIDJSON_UNLIKELY(in.Left() < n)) {
+            RAPIDJSON_PARSE_ERROR_NORETURN(kParseErrorValueInvalid, offset);
+            return false;
+        }
+        value = ReadBigEndian(in.p, n);
+        in.p += n;
+        return true;
+    }
+
+    template <unsigned parseFlags, typename Handler>
+    void ParseKey(Input& in, Handler& handler) {
+        const size_t offset = in.Tell();
+        if (RAPIDJSON_UNLIKELY(in.p == in.end))
+            RAPIDJSON_PARSE_ERROR(kParseErrorValueInvalid, offset);
+        const uint8_t c = *in.p++;
+        uint64_t length = c & 0x1F;
+        if ((c & 0xE0) != 0xA0) {
+            if (RAPIDJSON_UNLIKELY(c < 0xD9 || c > 0xDB))
+                RAPIDJSON_PARSE_ERROR(kParseErrorObjectMissName, offset);
+            if (!ReadArgument(in, size_t(1) << (c - 0xD9), offset, length))
+                return;
+        }
+        ParseString<parseFlags>(in, length, offset, handler, true);
+    }
+
+    template <unsigned parseFlags, typename Handler>
+    void ParseValue(Input& in, Handler& handler) {
+        const size_t offset = in.Tell();
+        if (RAPIDJSON_UNLIKELY(in.p == in.end))
+            RAPIDJSON_PARSE_ERROR(kParseErrorValueInvalid, offset);
+        const uint8_t c = *in.p++;
+        bool ok = true;
+        uint64_t u = 0;
+        if (c <= 0x7F)                  // positive fixint
+            ok = handler.Uint(c);
+        else if (c >= 0xE0)             // negative fixint
+            ok = handler.Int(static_cast<int8_t>(c));
+        else if (c >= 0xA0 && c <= 0xBF) {  // fixstr
+            ParseString<parseFlags>(in, c & 0x1F, offset, handler, false);
+            return;
+        }
+        else if (c <= 0x8F) {           // fixmap
+            StartContainer(in, c & 0x0F, true, offset, handler);
+            return;
+        }
+        else if (c <= 0x9F) {           // fixarray
+            StartContainer(in, c & 0x0F, false, offset, handler);
+            return;
+        }
+        else switch (c) {
+        case 0xC0: ok = handler.Null(); break;
+        case 0xC2: ok = handler.Bool(false); break;
+        case 0xC3: ok = handler.Bool(true); break;
+
+        case 0xCA: {    // float 32
+                if (!ReadArgument(in, 4, offset, u))
+                    return;
+                const uint32_t bits = static_cast<uint32_t>(u);
+                float f;
+                std::memcpy(&f, &bits, sizeof(f));
+                ok = handler.Double(static_cast<double>(f));
+            }
+            break;
+
+        case 0xCB: {    // float 64
+                if (!ReadArgument(in, 8, offset, u))
+                    return;
+                double d;
+                std::memcpy(&d, &u, sizeof(d));
+                ok = handler.Double(d);
+            }
+            break;
+
+        case 0xCC: case 0xCD: case 0xCE: case 0xCF:    // uint 8/16/32/64
+            if (!ReadArgument(in, size_t(1) << (c - 0xCC), offset, u))
+                return;
+            ok = u <= 0xFFFFFFFFu ? handler.Uint(static_cast<unsigned>(u)) : handler.Uint64(u);
+            break;
+
+        case 0xD0: case 0xD1: case 0xD2: case 0xD3: {  // int 8/16/32/64
+                const unsigned bits = 8u << (c - 0xD0);
+                if (!ReadArgument(in, bits / 8, offset, u))
+                    return;
+                if (bits < 64 && (u >> (bits - 1)))     // sign extension
+                    u |= ~uint64_t(0) << bits;
+                const int64_t i = static_cast<int64_t>(u);
+                if (i >= 0)
+                    ok = u <= 0xFFFFFFFFu ? handler.Uint(static_cast<unsigned>(u)) : handler.Uint64(u);
+                else
+                    ok = i >= -2147483647 - 1 ? handler.Int(static_cast<int>(i)) : handler.Int64(i);
+            }
+            break;
+
+        case 0xD9: case 0xDA: case 0xDB:    // str 8/16/32
+            if (ReadArgument(in, size_t(1) << (c - 0xD9), offset, u))
+                ParseString<parseFlags>(in, u, offset, handler, false);
+            return;
+
+        case 0xDC: case 0xDD:   // array 16/32
+            if (ReadArgument(in, size_t(2) << (c - 0xDC), offset, u))
+                StartContainer(in, u, false, offset, handler);
+            return;
+
+        case 0xDE: case 0xDF:   // map 16/32
+            if (ReadArgument(in, size_t(2) << (c - 0xDE), offset, u))
+                StartContainer(in, u, true, offset, handler);
+            return;
+
+        default:    // never used, bin and ext
+            RAPIDJSON_PARSE_ERROR(kParseErrorValueInvalid, offset);
+        }
+        if (RAPIDJSON_UNLIKELY(!ok))
+            RAPIDJSON_PARSE_ERROR(kParseErrorTermination, offset);
+    }
+
+    template <typename Handler>
+    void StartContainer(Input& in, uint64_t count, bool map, size_t offset, Handler& handler) {
+        // Each element takes at least one byte.
+        if (RAPIDJSON_UNLIKELY(count > in.Left() / (map ? 2 : 1)))
+            RAPIDJSON_PARSE_ERROR(kParseErrorValueInvalid, offset);
+        if (RAPIDJSON_UNLIKELY(!(map ? handler.StartObject() : handler.StartArray())))
+            RAPIDJSON_PARSE_ERROR(kParseErrorTermination, offset);
+        Level* level = stack_.template Push<Level>();
+        level->count = level->remaining = static_cast<SizeType>(count);
+        level->map = level->key = map;
+    }
+
+    template <unsigned parseFlags, typename Handler>
+    void ParseString(Input& in, uint64_t length, size_t offset, Handler& handler, bool isKey) {
+        if (RAPIDJSON_UNLIKELY(length > in.Left()))
+            RAPIDJSON_PARSE_ERROR(kParseErrorValueInvalid, offset);
+        const char* str = reinterpret_cast<const char*>(in.p);
+        in.p += length;
+        bool ok;
+        if (!(parseFlags & kParseValidateEncodingFlag) && internal::IsSame<TargetEncoding, UTF8<> >::Value) {
+            const Ch* s = reinterpret_cast<const Ch*>(str);
+            ok = isKey ? handler.Key(s, static_cast<SizeType>(length), true) : handler.String(s, static_cast<SizeType>(length), true);
+        }
+        else {
+            MemoryStream is(str, static_cast<size_t>(length));
+            StackStream os(stack_);
+            while (is.Tell() < length)
+                if (RAPIDJSON_UNLIKELY(!(parseFlags & kParseValidateEncodingFlag ?
+                        Transcoder<UTF8<>, TargetEncoding>::Validate(is, os) :
+                        Transcoder<UTF8<>, TargetEncoding>::Transcode(is, os)) || is.Tell() > length)) {
+                    os.Pop();
+                    RAPIDJSON_PARSE_ERROR(kParseErrorStringInvalidEncoding, offset);
+                }
+            const SizeType n = os.Length();
+            const Ch* s = os.Pop();
+            ok = isKey ? handler.Key(s, n, true) : handler.String(s, n, true);
+        }
+        if (RAPIDJSON_UNLIKELY(!ok))
+            RAPIDJSON_PARSE_ERROR(kParseErrorTermination, offset);
+    }
+
+    static const size_t kDefaultStackCapacity = 256;    //!< Default stack capacity in bytes for storing nesting levels and a single decoded string.
+    internal::Stack<StackAllocator> stack_;             //!< Stack for the nesting levels and a transcoded string.
+    ParseResult parseResult_;
+};
+
+//! MessagePack reader with UTF8 encoding and default allocator.
+typedef GenericMsgPackReader<UTF8<>, CrtAllocator> MsgPackReader;
+
+///////////////////////////////////////////////////////////////////////////////
+// MsgPackWriter
+
+//! MessagePack writer
+/*! MsgPackWriter implements the concept Handler, like Writer, and generates
+    MessagePack for the events, e.g. from Document::Accept() or Reader::Parse().
+    Each value is written in its smallest MessagePack format; all doubles are
+    written as float 64.
+
+    Since MessagePack arrays and maps start with their size, the content of a
+    root array or object is kept in an internal buffer until it ends, and then
+    written to the stream at once. Other roots are written right away.
+
+    \tparam OutputStream Type of output byte stream.
+    \tparam StackAllocator Type of allocator for allocating memory of the stack and of the buffer.
+    \note Strings are UTF-8. RawNumber() and RawValue() parse their JSON text.
+    \see GenericMsgPackReader
+*/
+template <typename OutputStream, typename StackAllocator = CrtAllocator>
+class MsgPackWriter {
+public:
+    typedef char Ch;
+
+    //! Constructor
+    /*! \param os Output stream.
+        \param stackAllocator User supplied allocator. If it is null, it will create a private one.
+        \param levelDepth Initial capacity of stack.
+    */
+    explicit
+    MsgPackWriter(OutputStream& os, StackAllocator* stackAllocator = 0, size_t levelDepth = kDefaultLevelDepth) :
+        os_(&os), level_stack_(stackAllocator, levelDepth * sizeof(Level)), buffer_(stackAllocator, 0), gaps_(stackAllocator, 0), hasRoot_(false) {}
+
+    explicit
+    MsgPackWriter(StackAllocator* allocator = 0, size_t levelDepth = kDefaultLevelDepth) :
+        os_(0), level_stack_(allocator, levelDepth * sizeof(Level)), buffer_(allocator, 0), gaps_(allocator, 0), hasRoot_(false) {}
+
+    //! Reset the writer with a new stream.
+    /*! \see Writer::Reset() */
+    void Reset(OutputStream& os) {
+        os_ = &os;
+        hasRoot_ = false;
+        level_stack_.Clear();
+        buffer_.Clear();
+        gaps_.Clear();
+    }
+
+    //! Checks whether the output is a complete MessagePack value.
+    bool IsComplete() const {
+        return hasRoot_ && level_stack_.Empty();
+    }
+
+    /*!@name Implementation of Handler
+        \see Handler
+    */
+    //@{
+
+    bool Null()                 { Prefix(); return WriteByte(0xC0); }
+    bool Bool(bool b)           { Prefix(); return WriteByte(b ? 0xC3 : 0xC2); }
+    bool Int(int i)             { Prefix(); return WriteInt64(i); }
+    bool Uint(unsigned u)       { Prefix(); return WriteUint64(u); }
+    bool Int64(int64_t i64)     { Prefix(); return WriteInt64(i64); }
+    bool Uint64(uint64_t u64)   { Prefix(); return WriteUint64(u64); }
+
+    bool Double(double d) {
+        Prefix();
+        uint64_t u;
+        std::memcpy(&u, &d, sizeof(u));
+        return WriteArgument(0xCB, u, 8);
+    }
+
+    //! Write a number in JSON text, e.g. from \ref kParseNumbersAsStringsFlag, as an integer or a double.
+    bool RawNumber(const Ch* str, SizeType length, bool copy = false) {
+        RAPIDJSON_ASSERT(str != 0);
+        (void)copy;
+        return RawValue(str, length, kNumberType);
+    }
+
+    bool String(const Ch* str, SizeType length, bool copy = false) {
+        RAPIDJSON_ASSERT(str != 0);
+        (void)copy;
+        Prefix();
+        return WriteString(str, length);
+    }
+
+#if RAPIDJSON_HAS_STDSTRING
+    bool String(const std::basic_string<Ch>& str) {
+        return String(str.data(), SizeType(str.size()));
+    }
+#endif
+
+    bool StartObject() { Prefix(); return StartLevel(false); }
+
+    bool Key(const Ch* str, SizeType length, bool copy = false) {
+        RAPIDJSON_ASSERT(str != 0);
+        (void)copy;
+        RAPIDJSON_ASSERT(!level_stack_.Empty() && !level_stack_.template Top<Level>()->inArray);
+        level_stack_.template Top<Level>()->count++;
+        return WriteString(str, length);
+    }
+
+    bool EndObject(SizeType memberCount = 0) {
+        (void)memberCount;
+        RAPIDJSON_ASSERT(!level_stack_.Empty() && !level_stack_.template Top<Level>()->inArray);
+        return EndLevel(0x80, 0xDE);
+    }
+
+    bool StartArray() { Prefix(); return StartLevel(true); }
+
+    bool EndArray(SizeType elementCount = 0) {
+        (void)elementCount;
+        RAPIDJSON_ASSERT(!level_stack_.Empty() && level_stack_.template Top<Level>()->inArray);
+        return EndLevel(0x90, 0xDC);
+    }
+    //@}
+
+    /*! @name Convenience extensions */
+    //@{
+
+    //! Simpler but slower overload.
+    bool String(const Ch* str) { return String(str, internal::StrLen(str)); }
+    bool Key(const Ch* str) { return Key(str, internal::StrLen(str)); }
+
+    //@}
+
+    //! Write a value given as JSON text.
+    /*! \param json A well-formed JSON value.
+        \param length Length of the json.
+        \param type Type of the root of json.
+        \return Whether \c json could be parsed.
+    */
+    bool RawValue(const Ch* json, size_t length, Type type) {
+        RAPIDJSON_ASSERT(json != 0);
+        (void)type;
+        MemoryStream is(json, length);
+        GenericReader<UTF8<>, UTF8<>, StackAllocator> reader;
+        return !reader.template Parse<kParseFullPrecisionFlag>(is, *this).IsError();
+    }
+
+protected:
+    //! Information for each nested level
+    struct Level {
+        size_t header;      //!< Offset of the space for the header in the buffer.
+        size_t gap;         //!< Index of the unused part of that space in the gaps.
+        SizeType count;     //!< Number of elements or members.
+        bool inArray;       //!< true if in array, otherwise in object
+    };
+
+    //! Bytes of the buffer not to be written.
+    struct Gap {
+        size_t offset;
+        size_t length;
+    };
+
+    static const size_t kDefaultLevelDepth = 32;
+    static const size_t kMaxHeaderSize = 5;     //!< Size of the header of array 32 and map 32.
+
+    void Prefix() {
+        if (RAPIDJSON_LIKELY(!level_stack_.Empty())) {
+            Level* level = level_stack_.template Top<Level>();
+            if (level->inArray)
+                level->count++;
+        }
+        else {
+            RAPIDJSON_ASSERT(!hasRoot_);    // Should only has one and only one root.
+            hasRoot_ = true;
+        }
+    }
+
+    void Put(const uint8_t* bytes, size_t n) {
+        if (RAPIDJSON_LIKELY(!level_stack_.Empty()))
+            std::memcpy(buffer_.template Push<uint8_t>(n), bytes, n);
+        else {
+            PutReserve(*os_, n);
+            for (size_t i = 0; i < n; i++)
+                PutUnsafe(*os_, static_cast<typename OutputStream::Ch>(bytes[i]));
+        }
+    }
+
+    bool WriteByte(uint8_t c) {
+        Put(&c, 1);
+        return EndValue();
+    }
+
+    //! Write a type byte followed by an argument in \c n big-endian bytes.
+    bool WriteArgument(uint8_t c, uint64_t u, size_t n) {
+        uint8_t bytes[9];
+        bytes[0] = c;
+        for (size_t i = n; i > 0; i--, u >>= 8)
+            bytes[i] = static_cast<uint8_t>(u);
+        Put(bytes, n + 1);
+        return EndValue();
+    }
+
+    bool WriteUint64(uint64_t u) {
+        if (u <= 0x7F)          return WriteByte(static_cast<uint8_t>(u));
+        if (u <= 0xFF)          return WriteArgument(0xCC, u, 1);
+        if (u <= 0xFFFF)        return WriteArgument(0xCD, u, 2);
+        if (u <= 0xFFFFFFFFu)   return WriteArgument(0xCE, u, 4);
+        return WriteArgument(0xCF, u, 8);
+    }
+
+    bool WriteInt64(int64_t i) {
+        if (i >= 0)                 return WriteUint64(static_cast<uint64_t>(i));
+        const uint64_t u = static_cast<uint64_t>(i);
+        if (i >= -32)               return WriteByte(static_cast<uint8_t>(u));
+        if (i >= -128)              return WriteArgument(0xD0, u, 1);
+        if (i >= -32768)            return WriteArgument(0xD1, u, 2);
+        if (i >= -2147483647 - 1)   return WriteArgument(0xD2, u, 4);
+        return WriteArgument(0xD3, u, 8);
+    }
+
+    bool WriteString(const Ch* str, SizeType length) {
+        uint8_t header[5];
+        size_t n;
+        if (length < 32) {
+            header[0] = static_cast<uint8_t>(0xA0 | length);
+            n = 1;
+        }
+        else
+            n = EncodeLength(header, length, 0xD9);
+        const bool root = level_stack_.Empty();
+        if (root) {
+            PutReserve(*os_, n + length);
+            for (size_t i = 0; i < n; i++)
+                PutUnsafe(*os_, static_cast<typename OutputStream::Ch>(header[i]));
+            for (SizeType i = 0; i < length; i++)
+                PutUnsafe(*os_, static_cast<typename OutputStream::Ch>(str[i]));
+            return EndValue();
+        }
+        uint8_t* p = buffer_.template Push<uint8_t>(n + length);
+        std::memcpy(p, header, n);
+        std::memcpy(p + n, str, length);
+        return true;
+    }
+
+    //! Encode a length with the smallest of the 8 (if \c c8 is given), 16 or 32-bit formats starting at \c c8.
+    static size_t EncodeLength(uint8_t* header, SizeType length, uint8_t c8) {
+        size_t n;
+        if (c8 && length <= 0xFF)   { header[0] = c8; n = 1; }
+        else if (length <= 0xFFFF)  { header[0] = static_cast<uint8_t>(c8 ? c8 + 1 : 0); n = 2; }
+        else                        { header[0] = static_cast<uint8_t>(c8 ? c8 + 2 : 0); n = 4; }
+        for (size_t i = n; i > 0; i--, length >>= 8)
+            header[i] = static_cast<uint8_t>(length);
+        return n + 1;
+    }
+
+    bool StartLevel(bool inArray) {
+        Level* level = level_stack_.template Push<Level>();
+        level->header = buffer_.GetSize();
+        level->gap = gaps_.GetSize() / sizeof(Gap);
+        level->count = 0;
+        level->inArray = inArray;
+        buffer_.template Push<uint8_t>(kMaxHeaderSize);
+        Gap* gap = gaps_.template Push<Gap>();
+        gap->offset = level->header;
+        gap->length = 0;
+        return true;
+    }
+
+    //! Write the header of the ended array or map into the end of its space, and the buffer to the stream at the end of the root.
+    bool EndLevel(uint8_t fix, uint8_t c16) {
+        const Level level = *level_stack_.template Pop<Level>(1);
+        uint8_t header[kMaxHeaderSize];
+        size_t n;
+        if (level.count < 16) {
+            header[0] = static_cast<uint8_t>(fix | level.count);
+            n = 1;
+        }
+        else {
+            n = EncodeLength(header, level.count, 0);
+            header[0] = static_cast<uint8_t>(n == 3 ? c16 : c16 + 1);
+        }
+        std::memcpy(buffer_.template Bottom<uint8_t>() + level.header + kMaxHeaderSize - n, header, n);
+        gaps_.template Bottom<Gap>()[level.gap].length = kMaxHeaderSize - n;
+        if (!level_stack_.Empty())
+            return true;
+
+        const uint8_t* bytes = buffer_.template Bottom<uint8_t>();
+        size_t offset = 0;
+        for (const Gap* gap = gaps_.template Bottom<Gap>(); gap != gaps_.template End<Gap>(); ++gap) {
+            Put(bytes + offset, gap->offset - offset);
+            offset = gap->offset + gap->length;
+        }
+        Put(bytes + offset, buffer_.GetSize() - offset);
+        buffer_.Clear();
+        gaps_.Clear();
+        return EndValue();
+    }
+
+    bool EndValue() {
+        if (RAPIDJSON_UNLIKELY(level_stack_.Empty()))   // end of root
+            os_->Flush();
+        return true;
+    }
+
+    OutputStream* os_;
+    internal::Stack<StackAllocator> level_stack_;
+    internal::Stack<StackAllocator> buffer_;    //!< Content of the root array or object.
+    internal::Stack<StackAllocator> gaps_;      //!< Unused header space in the buffer, in order.
+    bool hasRoot_;
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    MsgPackWriter(const MsgPackWriter&);
+    MsgPackWriter& operator=(const MsgPackWriter&);
+};
+
+RAPIDJSON_NAMESPACE_END
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_MSGPACK_H_
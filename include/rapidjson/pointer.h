@@ -1048,6 +1048,167 @@ private:
 //! GenericPointer for Value (UTF-8, default allocator).
 typedef GenericPointer<Value> Pointer;
 
+///////////////////////////////////////////////////////////////////////////////
+// GenericProjection
+
+//! A set of JSON pointers selecting the values to parse. Use Projection for UTF8 encoding and default allocator.
+/*!
+    A projection makes GenericReader::Parse() and GenericDocument::Parse() keep
+    only the values identified by a set of pointers, for applications which read
+    a few fields of large JSON texts:
+
+    \code
+    Pointer pointers[] = { Pointer("/user/id"), Pointer("/items/2/price") };
+    Projection projection(pointers, 2);
+    Document d;
+    d.Parse(json, projection);
+    \endcode
+
+    Objects and arrays on the paths to the selected values are kept with only
+    the members and elements on these paths. Array elements before an element
+    on a path are replaced by null, so that the pointers resolve to the same
+    values in the result as in the whole text. Everything else is skipped
+    without decoding strings or converting numbers.
+
+    The pointers are merged into a tree of tokens, which is copied, so the
+    pointers need not outlive the projection.
+
+    \tparam Encoding Encoding of the object names, which is the target encoding of the reader.
+    \tparam Allocator The allocator type for the tree.
+*/
+template <typename Encoding, typename Allocator = CrtAllocator>
+class GenericProjection {
+public:
+    typedef typename Encoding::Ch Ch;   //!< Character type from Encoding
+
+    //! Default constructor, which selects nothing.
+    /*! \param allocator User supplied allocator for the tree. If no allocator is provided, it creates a self-owned one.
+    */
+    explicit GenericProjection(Allocator* allocator = 0) : allocator_(allocator), ownAllocator_(), nodes_(), nodeCount_(), nodeCapacity_() {
+        AddNode(0, 0, kPointerInvalidIndex);
+    }
+
+    //! Constructor which selects the values identified by an array of pointers.
+    /*! \param pointers Valid pointers, with the same encoding as the projection.
+        \param count Number of pointers.
+        \param allocator User supplied allocator for the tree. If no allocator is provided, it creates a self-owned one.
+    */
+    template <typename ValueType, typename PointerAllocator>
+    GenericProjection(const GenericPointer<ValueType, PointerAllocator>* pointers, size_t count, Allocator* allocator = 0) : allocator_(allocator), ownAllocator_(), nodes_(), nodeCount_(), nodeCapacity_() {
+        AddNode(0, 0, kPointerInvalidIndex);
+        for (size_t i = 0; i < count; i++)
+            Add(pointers[i]);
+    }
+
+    //! Destructor.
+    ~GenericProjection() {
+        for (SizeType i = 0; i < nodeCount_; i++)
+            Allocator::Free(nodes_[i].name);
+        Allocator::Free(nodes_);
+        RAPIDJSON_DELETE(ownAllocator_);
+    }
+
+    //! Select the value identified by a pointer, with everything within it.
+    /*! \param pointer A valid pointer, with the same encoding as the projection.
+        \return The projection itself for fluent API.
+    */
+    template <typename ValueType, typename PointerAllocator>
+    GenericProjection& Add(const GenericPointer<ValueType, PointerAllocator>& pointer) {
+        RAPIDJSON_STATIC_ASSERT((internal::IsSame<typename ValueType::EncodingType, Encoding>::Value));
+        RAPIDJSON_ASSERT(pointer.IsValid());
+        SizeType node = 0;
+        const typename GenericPointer<ValueType, PointerAllocator>::Token* t = pointer.GetTokens();
+        for (size_t i = 0; i < pointer.GetTokenCount() && !nodes_[node].selected; i++, t++) {
+            SizeType child;
+            if (!FindMember(node, t->name, t->length, &child)) {
+                child = AddNode(t->name, t->length, t->index);
+                nodes_[child].next = nodes_[node].child;
+                nodes_[node].child = child;
+            }
+            node = child;
+        }
+        nodes_[node].selected = true;
+        return *this;
+    }
+
+    //!@name Tree lookup for GenericReader
+    //@{
+
+    //! The node of the root value.
+    SizeType Root() const { return 0; }
+
+    //! Whether the value of a node is selected with everything within it.
+    bool IsSelected(SizeType node) const { return nodes_[node].selected; }
+
+    //! Find the node of an object member, return false if the member is not on any path.
+    bool FindMember(SizeType node, const Ch* name, SizeType length, SizeType* child) const {
+        for (SizeType c = nodes_[node].child; c != kPointerInvalidIndex; c = nodes_[c].next)
+            if (nodes_[c].length == length && (length == 0 || std::memcmp(nodes_[c].name, name, length * sizeof(Ch)) == 0)) {
+                *child = c;
+                return true;
+            }
+        return false;
+    }
+
+    //! Find the node of an array element, return false if the element is not on any path.
+    bool FindElement(SizeType node, SizeType index, SizeType* child) const {
+        for (SizeType c = nodes_[node].child; c != kPointerInvalidIndex; c = nodes_[c].next)
+            if (nodes_[c].index == index) {
+                *child = c;
+                return true;
+            }
+        return false;
+    }
+
+    //@}
+
+private:
+    //! Prohibit copying
+    GenericProjection(const GenericProjection&);
+    //! Prohibit assignment
+    GenericProjection& operator=(const GenericProjection&);
+
+    struct Node {
+        Ch* name;           //!< Copy of the token name, null for the root.
+        SizeType length;    //!< Length of the name.
+        SizeType index;     //!< Array index of the token, or kPointerInvalidIndex.
+        SizeType child;     //!< First child, or kPointerInvalidIndex.
+        SizeType next;      //!< Next sibling, or kPointerInvalidIndex.
+        bool selected;      //!< The value is selected with everything within it.
+    };
+
+    SizeType AddNode(const Ch* name, SizeType length, SizeType index) {
+        if (!allocator_)
+            ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator());
+        if (nodeCount_ == nodeCapacity_) {
+            const SizeType capacity = nodeCapacity_ ? nodeCapacity_ * 2 : 8;
+            nodes_ = static_cast<Node*>(allocator_->Realloc(nodes_, nodeCapacity_ * sizeof(Node), capacity * sizeof(Node)));
+            nodeCapacity_ = capacity;
+        }
+        Node& n = nodes_[nodeCount_];
+        n.name = 0;
+        if (name) {
+            n.name = static_cast<Ch*>(allocator_->Malloc((length + 1) * sizeof(Ch)));
+            std::memcpy(n.name, name, length * sizeof(Ch));
+            n.name[length] = '\0';
+        }
+        n.length = length;
+        n.index = index;
+        n.child = n.next = kPointerInvalidIndex;
+        n.selected = false;
+        return nodeCount_++;
+    }
+
+    Allocator* allocator_;      //!< The current allocator. It is either user-supplied or equal to ownAllocator_.
+    Allocator* ownAllocator_;   //!< Allocator owned by this projection.
+    Node* nodes_;               //!< The tree, with the root at index 0.
+    SizeType nodeCount_;
+    SizeType nodeCapacity_;
+};
+
+//! GenericProjection for UTF-8 and default allocator.
+typedef GenericProjection<UTF8<> > Projection;
+
 //!@name Helper functions for GenericPointer
 //@{
 
@@ -0,0 +1,516 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_PUSHREADER_H_
+#define RAPIDJSON_PUSHREADER_H_
+
+/*! \file pushreader.h */
+
+#include "reader.h"
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(switch-enum)
+#endif
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericPushReader
+
+//! Resumable SAX parser fed with arbitrary chunks of JSON text.
+/*! The input is pushed with Feed() as it arrives (e.g. from a socket) and the
+    handler receives the events of every complete token right away. A token
+    split across chunks (a partial string, number, literal or comment) is kept
+    in an internal buffer until the rest of it arrives. Each chunk is scanned
+    for the end of that token where the previous scan stopped, so a long token
+    costs linear time. Every other token is parsed once, in place.
+    Finish() marks the end of the input.
+
+    The parser is driven by the token-by-token iterative parser of
+    GenericReader, so events, error codes and error offsets are the same as
+    for Parse<kParseIterativeFlag>() on the concatenated input. Error offsets
+    count from the first byte fed after construction or Reset().
+
+    With \ref kParseStopWhenDoneFlag, a sequence of JSON texts (e.g. one per
+    message) is parsed one after another instead of reporting
+    \ref kParseErrorDocumentRootNotSingular.
+
+    The same parseFlags and handler type must be used in all calls for one
+    input. \ref kParseInsituFlag is ignored, since chunks are not retained.
+    Since a value may span chunks, the handler cannot skip it: \ref kHandlerSkip
+    terminates the parse with \ref kParseErrorTermination.
+
+    \code
+    PushReader reader;
+    MyHandler handler;
+    while (size_t n = Receive(buffer, sizeof(buffer)))
+        if (!reader.Feed(buffer, n, handler))
+            break;
+    reader.Finish(handler);
+    \endcode
+
+    \tparam SourceEncoding Encoding of the input chunks.
+    \tparam TargetEncoding Encoding of the parse output.
+    \tparam StackAllocator Allocator type for the parse stack and the partial token buffer.
+*/
+template <typename SourceEncoding, typename TargetEncoding, typename StackAllocator = CrtAllocator>
+class GenericPushReader : private GenericReader<SourceEncoding, TargetEncoding, StackAllocator> {
+    typedef GenericReader<SourceEncoding, TargetEncoding, StackAllocator> Base;
+public:
+    typedef typename SourceEncoding::Ch Ch; //!< SourceEncoding character type
+
+    //! Constructor.
+    /*! \param stackAllocator Optional allocator for the parse stack and the partial token buffer.
+        \param stackCapacity Initial capacity in bytes of each of them.
+    */
+    GenericPushReader(StackAllocator* stackAllocator = 0, size_t stackCapacity = kDefaultStackCapacity) :
+        Base(stackAllocator, stackCapacity), pending_(stackAllocator, stackCapacity), consumed_(0), scanned_(0), scanState_(kScanSpace), scanDelimiter_(false), spaceState_(kScanSpace), finished_(false)
+    {
+        Base::IterativeParseInit();
+    }
+
+    //! Parse a chunk of JSON text.
+    /*! \tparam parseFlags Combination of \ref ParseFlag.
+        \tparam Handler Type of handler, implementing Handler concept.
+        \param data Chunk of JSON text. It need not be null-terminated and is not referenced after the call.
+        \param length Length of the chunk in characters.
+        \param handler The handler to receive events of the complete tokens in the chunk.
+        \return Whether the parsing is successful so far.
+    */
+    template <unsigned parseFlags, typename Handler>
+    ParseResult Feed(const Ch* data, size_t length, Handler& handler) {
+        RAPIDJSON_ASSERT(!finished_);
+        if (HasParseError())
+            return Result();
+
+        // Complete the token left over from the previous chunk: copy this chunk up to its end, found by a
+        // scan which resumes where the previous one stopped, and parse it once.
+        size_t start = 0;
+        while (!pending_.Empty() && start < length) {
+            bool complete;
+            const size_t n = ScanPending<parseFlags>(data + start, length - start, complete);
+            std::memcpy(pending_.template Push<Ch>(n), data + start, n * sizeof(Ch));
+            start += n;
+            if (!complete)
+                break;
+
+            const size_t size = pending_.GetSize() / sizeof(Ch);
+            const size_t consumed = ParseAvailable<parseFlags>(pending_.template Bottom<Ch>(), size, false, handler);
+            if (HasParseError())
+                return Result();
+
+            ResetScan();
+            const size_t remaining = size - consumed;
+            if (remaining <= start) {
+                // All unparsed characters are in this chunk, continue there without copying.
+                pending_.Clear();
+                start -= remaining;
+            }
+            else if (consumed > 0) {
+                Ch* buffer = pending_.template Bottom<Ch>();
+                std::memmove(buffer, buffer + consumed, remaining * sizeof(Ch));
+                pending_.template Pop<Ch>(consumed);
+            }
+            else {
+                // Not expected: the scan and the parser disagree on the end of the step. Keep the rest.
+                std::memcpy(pending_.template Push<Ch>(length - start), data + start, (length - start) * sizeof(Ch));
+                start = length;
+            }
+        }
+
+        if (pending_.Empty() && start < length) {
+            const size_t consumed = ParseAvailable<parseFlags>(data + start, length - start, false, handler);
+            if (HasParseError())
+                return Result();
+
+            // Keep the incomplete tail for the next chunk.
+            start += consumed;
+            ResetScan();
+            if (start < length)
+                std::memcpy(pending_.template Push<Ch>(length - start), data + start, (length - start) * sizeof(Ch));
+        }
+        return Result();
+    }
+
+    //! Parse a chunk of JSON text (with \ref kParseDefaultFlags)
+    /*! \tparam Handler Type of handler, implementing Handler concept.
+        \param data Chunk of JSON text. It need not be null-terminated and is not referenced after the call.
+        \param length Length of the chunk in characters.
+        \param handler The handler to receive events of the complete tokens in the chunk.
+        \return Whether the parsing is successful so far.
+    */
+    template <typename Handler>
+    ParseResult Feed(const Ch* data, size_t length, Handler& handler) {
+        return Feed<kParseDefaultFlags>(data, length, handler);
+    }
+
+    //! Mark the end of the JSON text.
+    /*! Parses the remaining buffered characters and reports errors of
+        incomplete input, e.g. \ref kParseErrorDocumentEmpty or an unclosed array.
+        \return Whether the whole text has been parsed successfully.
+    */
+    template <unsigned parseFlags, typename Handler>
+    ParseResult Finish(Handler& handler) {
+        RAPIDJSON_ASSERT(!finished_);
+        finished_ = true;
+        if (!HasParseError()) {
+            ParseAvailable<parseFlags>(pending_.template Bottom<Ch>(), pending_.GetSize() / sizeof(Ch), true, handler);
+            pending_.Clear();
+        }
+        return Result();
+    }
+
+    //! Mark the end of the JSON text (with \ref kParseDefaultFlags)
+    template <typename Handler>
+    ParseResult Finish(Handler& handler) {
+        return Finish<kParseDefaultFlags>(handler);
+    }
+
+    //! Discard all state and start a new JSON text.
+    void Reset() {
+        Base::IterativeParseInit();
+        pending_.Clear();
+        consumed_ = 0;
+        ResetScan();
+        spaceState_ = kScanSpace;
+        finished_ = false;
+    }
+
+    //! Whether a root value has been parsed completely.
+    /*! With \ref kParseStopWhenDoneFlag, this is the state of the latest root. */
+    bool IsRootComplete() const { return Base::IterativeParseComplete() && !HasParseError(); }
+
+    //! Number of characters buffered for a token which is split across chunks.
+    size_t GetPendingLength() const { return pending_.GetSize() / sizeof(Ch); }
+
+    using Base::HasParseError;
+    using Base::GetParseErrorCode;
+    using Base::GetErrorOffset;
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    GenericPushReader(const GenericPushReader&);
+    GenericPushReader& operator=(const GenericPushReader&);
+
+    static const size_t kDefaultStackCapacity = 256;
+
+    // States of the scans of whitespace and comments after a root (the first four) and of a step split
+    // across chunks: an optional ',' or ':' delimiter followed by one token.
+    enum ScanState {
+        kScanSpace,
+        kScanLineComment,
+        kScanBlockComment,
+        kScanBlockCommentStar,
+        kScanSlash,
+        kScanString,
+        kScanStringEscape,
+        kScanScalar
+    };
+
+    ParseResult Result() const { return ParseResult(GetParseErrorCode(), GetErrorOffset()); }
+
+    //! Stream over a chunk, which reads '\0' at its end.
+    struct ChunkStream {
+        typedef typename SourceEncoding::Ch Ch;
+
+        ChunkStream(const Ch* begin, const Ch* end, bool final) : src_(begin), begin_(begin), end_(end), final_(final), exhausted_(false) {}
+
+        Ch Peek() const {
+            if (RAPIDJSON_UNLIKELY(src_ == end_)) {
+                exhausted_ = true;
+                return Ch('\0');
+            }
+            return *src_;
+        }
+        Ch Take() { Ch c = Peek(); if (RAPIDJSON_LIKELY(src_ != end_)) ++src_; return c; }
+        size_t Tell() const { return static_cast<size_t>(src_ - begin_); }
+
+        Ch* PutBegin() { RAPIDJSON_ASSERT(false); return 0; }
+        void Put(Ch) { RAPIDJSON_ASSERT(false); }
+        void Flush() { RAPIDJSON_ASSERT(false); }
+        size_t PutEnd(Ch*) { RAPIDJSON_ASSERT(false); return 0; }
+
+        //! Whether the current token has read past the chunk, which is not the end of the text.
+        bool Incomplete() const { return exhausted_ && !final_; }
+
+        const Ch* src_;
+        const Ch* begin_;
+        const Ch* end_;
+        bool final_;
+        mutable bool exhausted_;
+    };
+
+    void ResetScan() {
+        scanned_ = 0;
+        scanState_ = kScanSpace;
+        scanDelimiter_ = false;
+    }
+
+    static bool IsScalarEnd(Ch c) {
+        switch (c) {
+            case ' ': case '\n': case '\r': case '\t':
+            case ',': case ':': case '[': case ']': case '{': case '}': case '\"': case '/': case '\0':
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    //! Scan the step split across chunks, which begins the pending characters, for its end.
+    /*! \param complete Receives whether the step ends within the pending characters and the returned part of \c data.
+        \return Number of characters of \c data to append to the pending ones: up to the end of the step, or all.
+    */
+    template <unsigned parseFlags>
+    size_t ScanPending(const Ch* data, size_t length, bool& complete) {
+        complete = true;
+        if (Base::IterativeParseComplete())
+            return 1;   // a '/' after the root, which the next character tells from a comment
+
+        const Ch* pending = pending_.template Bottom<Ch>();
+        const size_t size = pending_.GetSize() / sizeof(Ch);
+        if (scanned_ < size) {
+            // The tail left by ParseAvailable() is scanned once.
+            const bool found = ScanStep<parseFlags>(pending + scanned_, pending + size) != 0;
+            scanned_ = size;
+            if (found)
+                return 0;
+        }
+        const Ch* stepEnd = ScanStep<parseFlags>(data, data + length);
+        complete = stepEnd != 0;
+        const size_t n = complete ? static_cast<size_t>(stepEnd - data) : length;
+        scanned_ += n;
+        return n;
+    }
+
+    //! Advance the scan of the split step over [p, end).
+    /*! \return One past the character which ends the step, i.e. the closing quote, the bracket, or the
+        character after a number or literal (which the reader peeks at), or null if more input is needed.
+    */
+    template <unsigned parseFlags>
+    const Ch* ScanStep(const Ch* p, const Ch* end) {
+        for (; p != end; ++p) {
+            const Ch c = *p;
+            switch (scanState_) {
+            case kScanSpace:
+                if (c == ' ' || c == '\n' || c == '\r' || c == '\t')
+                    continue;
+                if ((parseFlags & kParseCommentsFlag) && c == '/') {
+                    scanState_ = kScanSlash;
+                    continue;
+                }
+                if ((c == ',' || c == ':') && !scanDelimiter_) {
+                    scanDelimiter_ = true;
+                    continue;
+                }
+                switch (c) {
+                    case '\"': scanState_ = kScanString; continue;
+                    case '[': case ']': case '{': case '}': case ',': case ':': return p + 1;
+                    default: scanState_ = kScanScalar; continue;
+                }
+            case kScanString:
+                if (c == '\\')
+                    scanState_ = kScanStringEscape;
+                else if (c == '\"')
+                    return p + 1;
+                continue;
+            case kScanStringEscape:
+                scanState_ = kScanString;
+                continue;
+            case kScanScalar:
+                if (IsScalarEnd(c))
+                    return p + 1;
+                continue;
+            case kScanSlash:
+                if (c == '/')
+                    scanState_ = kScanLineComment;
+                else if (c == '*')
+                    scanState_ = kScanBlockComment;
+                else
+                    return p + 1;   // invalid comment, reported by the reader
+                continue;
+            case kScanLineComment:
+                if (c == '\n')
+                    scanState_ = kScanSpace;
+                continue;
+            case kScanBlockComment:
+                if (c == '*')
+                    scanState_ = kScanBlockCommentStar;
+                continue;
+            default:
+                RAPIDJSON_ASSERT(scanState_ == kScanBlockCommentStar);
+                scanState_ = c == '/' ? kScanSpace : (c == '*' ? kScanBlockCommentStar : kScanBlockComment);
+                continue;
+            }
+        }
+        return 0;
+    }
+
+    //! Skip whitespace and comments after a root, resuming a comment split across chunks.
+    /*! \return Whether a token follows, false if more input is needed. A '/' at the end
+        of the input is left for the next chunk, which tells whether it starts a comment.
+    */
+    template <unsigned parseFlags>
+    bool SkipSpace(ChunkStream& is) {
+        const Ch* p = is.src_;
+        const Ch* const end = is.end_;
+        for (; p != end; ++p) {
+            const Ch c = *p;
+            switch (spaceState_) {
+            case kScanSpace:
+                if (c == ' ' || c == '\n' || c == '\r' || c == '\t')
+                    continue;
+                if (!(parseFlags & kParseCommentsFlag) || c != '/')
+                    break;
+                if (p + 1 == end)
+                    break;
+                if (p[1] == '/')
+                    spaceState_ = kScanLineComment;
+                else if (p[1] == '*')
+                    spaceState_ = kScanBlockComment;
+                else
+                    break;  // invalid comment, reported by the caller
+                ++p;
+                continue;
+            case kScanLineComment:
+                if (c == '\n')
+                    spaceState_ = kScanSpace;
+                continue;
+            case kScanBlockComment:
+                if (c == '*')
+                    spaceState_ = kScanBlockCommentStar;
+                continue;
+            default:
+                RAPIDJSON_ASSERT(spaceState_ == kScanBlockCommentStar);
+                spaceState_ = c == '/' ? kScanSpace : (c == '*' ? kScanBlockCommentStar : kScanBlockComment);
+                continue;
+            }
+            break;
+        }
+        is.src_ = p;
+        return p != end && !(p + 1 == end && (parseFlags & kParseCommentsFlag) && *p == '/');
+    }
+
+    //! Parse all complete tokens in [begin, begin + length) and return the number of characters consumed.
+    /*! The tokens are parsed in place. A token which runs into the end of the
+        input before the end of the text is parsed again with the next chunk:
+        its event is withheld and the parser state restored to its start.
+    */
+    template <unsigned parseFlags, typename Handler>
+    size_t ParseAvailable(const Ch* begin, size_t length, bool final, Handler& handler) {
+        ChunkStream is(begin, begin + length, final);
+        NoSkipHandler<Handler> h(handler, is);
+        while (!HasParseError()) {
+            if (Base::IterativeParseComplete()) {
+                if (!SkipSpace<parseFlags>(is)) {
+                    if (final && !(parseFlags & kParseStopWhenDoneFlag) && (spaceState_ == kScanBlockComment || spaceState_ == kScanBlockCommentStar || is.src_ != is.end_))
+                        Base::SetParseError(kParseErrorUnspecificSyntaxError, consumed_ + length);    // unterminated comment
+                    else if (final)
+                        is.src_ = is.end_;
+                    break;
+                }
+                if (!(parseFlags & kParseStopWhenDoneFlag)) {
+                    // Report what SkipWhitespaceAndComments() and Parse() would.
+                    if ((parseFlags & kParseCommentsFlag) && *is.src_ == '/')
+                        Base::SetParseError(kParseErrorUnspecificSyntaxError, consumed_ + is.Tell() + 1);
+                    else
+                        Base::SetParseError(kParseErrorDocumentRootNotSingular, consumed_ + is.Tell());
+                    break;
+                }
+                // The next text of a sequence.
+                Base::IterativeParseInit();
+            }
+
+            const Ch* const start = is.src_;
+            const typename Base::IterativeParsingCheckpoint checkpoint = Base::SaveIterativeParsing();
+            is.exhausted_ = false;
+            if (!Base::template IterativeParseNext<(parseFlags | kParseStopWhenDoneFlag) & ~static_cast<unsigned>(kParseInsituFlag)>(is, h)) {
+                if (is.Incomplete()) {
+                    Base::RestoreIterativeParsing(checkpoint);
+                    is.src_ = start;
+                }
+                else
+                    Base::SetParseError(GetParseErrorCode(), consumed_ + GetErrorOffset());
+                break;
+            }
+            RAPIDJSON_ASSERT(!is.Incomplete());
+        }
+
+        const size_t consumed = static_cast<size_t>(is.src_ - begin);
+        consumed_ += consumed;
+        return consumed;
+    }
+
+    //! Forwards the events of complete tokens to a handler, turning kHandlerSkip into termination.
+    /*! A token which ran out of input (e.g. "12" of "123" in the next chunk) is not reported. */
+    template <typename Handler>
+    struct NoSkipHandler {
+        typedef typename TargetEncoding::Ch Ch;
+
+        NoSkipHandler(Handler& handler, const ChunkStream& is) : handler_(handler), is_(is) {}
+
+        bool Null() { return Complete() && handler_.Null(); }
+        bool Bool(bool b) { return Complete() && handler_.Bool(b); }
+        bool Int(int i) { return Complete() && handler_.Int(i); }
+        bool Uint(unsigned u) { return Complete() && handler_.Uint(u); }
+        bool Int64(int64_t i) { return Complete() && handler_.Int64(i); }
+        bool Uint64(uint64_t u) { return Complete() && handler_.Uint64(u); }
+        bool Double(double d) { return Complete() && handler_.Double(d); }
+        bool RawNumber(const Ch* str, SizeType length, bool copy) { return Complete() && handler_.RawNumber(str, length, copy); }
+        bool String(const Ch* str, SizeType length, bool copy) { return Complete() && handler_.String(str, length, copy); }
+        bool StartObject() { return Complete() && Continue(handler_.StartObject()); }
+        bool Key(const Ch* str, SizeType length, bool copy) { return Complete() && Continue(handler_.Key(str, length, copy)); }
+        bool EndObject(SizeType memberCount) { return Complete() && handler_.EndObject(memberCount); }
+        bool StartArray() { return Complete() && Continue(handler_.StartArray()); }
+        bool EndArray(SizeType elementCount) { return Complete() && handler_.EndArray(elementCount); }
+
+        bool Complete() const { return !is_.Incomplete(); }
+        static bool Continue(bool b) { return b; }
+        static bool Continue(HandlerResult result) { return result == kHandlerContinue; }
+
+        Handler& handler_;
+        const ChunkStream& is_;
+
+    private:
+        NoSkipHandler& operator=(const NoSkipHandler&);
+    };
+
+    internal::Stack<StackAllocator> pending_;   //!< Unparsed characters of a token split across chunks.
+    size_t consumed_;           //!< Number of characters parsed so far, for error offsets.
+    size_t scanned_;            //!< Number of pending characters scanned for the end of the split step.
+    ScanState scanState_;       //!< State of the scan of the split step.
+    bool scanDelimiter_;        //!< The scanned part of the split step contains its delimiter.
+    ScanState spaceState_;      //!< State of skipping whitespace and comments after a root.
+    bool finished_;
+};
+
+//! Push reader with UTF8 encoding and default allocator.
+typedef GenericPushReader<UTF8<>, UTF8<> > PushReader;
+
+RAPIDJSON_NAMESPACE_END
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_PUSHREADER_H_
@@ -320,35 +320,86 @@
 #endif
 
 ///////////////////////////////////////////////////////////////////////////////
-// RAPIDJSON_SSE2/RAPIDJSON_SSE42/RAPIDJSON_SIMD
+// RAPIDJSON_SSE2/RAPIDJSON_SSE42/RAPIDJSON_AVX2/RAPIDJSON_AVX512/RAPIDJSON_SIMD
 
 /*! \def RAPIDJSON_SIMD
     \ingroup RAPIDJSON_CONFIG
-    \brief Enable SSE2/SSE4.2 optimization.
+    \brief Enable SSE2/SSE4.2/AVX2/AVX-512 optimization.
 
     RapidJSON supports optimized implementations for some parsing operations
-    based on the SSE2 or SSE4.2 SIMD extensions on modern Intel-compatible
-    processors.
+    based on the SSE2, SSE4.2, AVX2 or AVX-512 SIMD extensions on modern
+    Intel-compatible processors.
 
-    To enable these optimizations, two different symbols can be defined;
+    To enable these optimizations, four different symbols can be defined;
     \code
     // Enable SSE2 optimization.
     #define RAPIDJSON_SSE2
 
     // Enable SSE4.2 optimization.
     #define RAPIDJSON_SSE42
+
+    // Enable AVX2 optimization (32 bytes per step).
+    #define RAPIDJSON_AVX2
+
+    // Enable AVX-512 (AVX512BW) optimization (64 bytes per step).
+    #define RAPIDJSON_AVX512
     \endcode
 
-    \c RAPIDJSON_SSE42 takes precedence, if both are defined.
+    The widest instruction set takes precedence, if several are defined.
+    \c RAPIDJSON_AVX512 implies \c RAPIDJSON_AVX2, which in turn implies
+    \c RAPIDJSON_SSE42 for the code paths without a wider variant.
 
     If any of these symbols is defined, RapidJSON defines the macro
     \c RAPIDJSON_SIMD to indicate the availability of the optimized code.
 */
+/*! \def RAPIDJSON_SIMD_DISPATCH
+    \ingroup RAPIDJSON_CONFIG
+    \brief Select the SIMD code paths at runtime.
+
+    The symbols above are compile-time settings: running such an executable
+    on a machine without the instruction set will make it crash. Defining
+    \code
+    #define RAPIDJSON_SIMD_DISPATCH
+    \endcode
+    instead compiles the SSE2, SSE4.2, AVX2 and AVX-512 kernels of whitespace
+    skipping, string scanning, UTF-8 validation and \ref rapidjson::Writer
+    string escaping side by side, detects the CPU features once (\c cpuid or
+    \c __builtin_cpu_supports) and binds the widest supported kernels
+    through function pointers. No target-specific compiler flags are needed.
+    On other architectures or compilers the scalar code is used.
+
+    \c RAPIDJSON_SIMD_DISPATCH takes precedence over the compile-time
+    symbols.
+*/
+#if defined(RAPIDJSON_AVX512) && !defined(RAPIDJSON_AVX2)
+#define RAPIDJSON_AVX2
+#endif
+#if defined(RAPIDJSON_AVX2) && !defined(RAPIDJSON_SSE42)
+#define RAPIDJSON_SSE42
+#endif
+
 #if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42) \
-    || defined(RAPIDJSON_DOXYGEN_RUNNING)
+    || defined(RAPIDJSON_SIMD_DISPATCH) || defined(RAPIDJSON_DOXYGEN_RUNNING)
 #define RAPIDJSON_SIMD
 #endif
 
+///////////////////////////////////////////////////////////////////////////////
+// RAPIDJSON_MEMORY_STATS
+
+/*! \def RAPIDJSON_MEMORY_STATS
+    \ingroup RAPIDJSON_CONFIG
+    \brief Collect memory statistics of allocators and stacks.
+
+    Defining this symbol as 1 adds MemoryPoolAllocator::GetStats(),
+    GenericDocument::GetStackPeakSize() and Writer::GetLevelStackPeakSize(),
+    at the cost of some counting in allocation and push operations. By
+    default (0), none of them is compiled. GenericValue::GetMemoryUsage()
+    does not depend on it.
+*/
+#ifndef RAPIDJSON_MEMORY_STATS
+#define RAPIDJSON_MEMORY_STATS 0
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 // RAPIDJSON_NO_SIZETYPEDEFINE
 
@@ -576,6 +627,41 @@ RAPIDJSON_NAMESPACE_END
 #endif
 #endif // RAPIDJSON_HAS_CXX11_RANGE_FOR
 
+#ifndef RAPIDJSON_HAS_CXX11_CONSTEXPR
+#if defined(__clang__)
+#define RAPIDJSON_HAS_CXX11_CONSTEXPR __has_feature(cxx_constexpr)
+#elif (defined(RAPIDJSON_GNUC) && (RAPIDJSON_GNUC >= RAPIDJSON_VERSION_CODE(4,6,0)) && defined(__GXX_EXPERIMENTAL_CXX0X__)) || \
+      (defined(_MSC_VER) && _MSC_VER >= 1900)
+#define RAPIDJSON_HAS_CXX11_CONSTEXPR 1
+#else
+#define RAPIDJSON_HAS_CXX11_CONSTEXPR 0
+#endif
+#endif // RAPIDJSON_HAS_CXX11_CONSTEXPR
+#if RAPIDJSON_HAS_CXX11_CONSTEXPR
+#define RAPIDJSON_CONSTEXPR constexpr
+#else
+#define RAPIDJSON_CONSTEXPR inline
+#endif
+
+#ifndef RAPIDJSON_HAS_CXX11_ATOMIC
+#if defined(__clang__)
+#define RAPIDJSON_HAS_CXX11_ATOMIC __has_feature(cxx_thread_local)
+#elif (defined(RAPIDJSON_GNUC) && (RAPIDJSON_GNUC >= RAPIDJSON_VERSION_CODE(4,8,0)) && defined(__GXX_EXPERIMENTAL_CXX0X__)) || \
+      (defined(_MSC_VER) && _MSC_VER >= 1900)
+#define RAPIDJSON_HAS_CXX11_ATOMIC 1
+#else
+#define RAPIDJSON_HAS_CXX11_ATOMIC 0
+#endif
+#endif // RAPIDJSON_HAS_CXX11_ATOMIC
+
+#ifndef RAPIDJSON_HAS_MMAP
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#define RAPIDJSON_HAS_MMAP 1
+#else
+#define RAPIDJSON_HAS_MMAP 0
+#endif
+#endif // RAPIDJSON_HAS_MMAP
+
 //!@endcond
 
 ///////////////////////////////////////////////////////////////////////////////
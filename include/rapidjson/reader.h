@@ -23,13 +23,25 @@
 #include "internal/meta.h"
 #include "internal/stack.h"
 #include "internal/strtod.h"
+#include "internal/dtoa.h"
+#include "internal/structural.h"
 #include <limits>
 
 #if defined(RAPIDJSON_SIMD) && defined(_MSC_VER)
 #include <intrin.h>
 #pragma intrinsic(_BitScanForward)
+#ifdef RAPIDJSON_AVX512
+#pragma intrinsic(_BitScanForward64)
 #endif
-#ifdef RAPIDJSON_SSE42
+#endif
+#ifdef RAPIDJSON_SIMD
+#include "internal/simd.h"
+#endif
+#ifdef RAPIDJSON_SIMD_DISPATCH
+// All kernels come from internal/simd.h
+#elif defined(RAPIDJSON_AVX2) || defined(RAPIDJSON_AVX512)
+#include <immintrin.h>
+#elif defined(RAPIDJSON_SSE42)
 #include <nmmintrin.h>
 #elif defined(RAPIDJSON_SSE2)
 #include <emmintrin.h>
@@ -153,6 +165,10 @@ enum ParseFlag {
     kParseNumbersAsStringsFlag = 64,    //!< Parse all numbers (ints/doubles) as strings.
     kParseTrailingCommasFlag = 128, //!< Allow trailing commas at the end of objects and arrays.
     kParseNanAndInfFlag = 256,      //!< Allow parsing NaN, Inf, Infinity, -Inf and -Infinity as doubles.
+    kParseStructuralIndexFlag = 512,    //!< Iterative parsing driven by a SIMD index of structural characters (StringStream/InsituStringStream, no comments, RAPIDJSON_SSE2 or wider). Otherwise parsed as with kParseIterativeFlag.
+    kParseInternKeysFlag = 1024,    //!< GenericDocument only: equal object names share one copy with a precomputed hash (see GenericKeyRef).
+    kParseLazyNumbersFlag = 2048,   //!< GenericDocument only: numbers keep their text and are converted on first access (see GenericValue::GetDouble()).
+    kParseStringRefsFlag = 4096,    //!< Strings without escapes refer to the read-only input (StringStream only), which must outlive them. They are not null-terminated.
     kParseDefaultFlags = RAPIDJSON_PARSE_DEFAULT_FLAGS  //!< Default parse flags. Can be customized by defining RAPIDJSON_PARSE_DEFAULT_FLAGS
 };
 
@@ -163,6 +179,10 @@ enum ParseFlag {
     \brief Concept for receiving events from GenericReader upon parsing.
     The functions return true if no error occurs. If they return false,
     the event publisher should terminate the process.
+
+    StartObject(), StartArray() and Key() may instead return a \ref HandlerResult,
+    to let GenericReader skip the object, the array or the value of the member
+    with \ref kHandlerSkip.
 \code
 concept Handler {
     typename Ch;
@@ -185,6 +205,25 @@ concept Handler {
 };
 \endcode
 */
+
+//! Result of a handler function which can skip a value.
+/*! StartObject(), StartArray() and Key() of a handler may return it instead of bool.
+    \see Handler
+*/
+enum HandlerResult {
+    kHandlerTerminate = 0,  //!< Terminate parsing with kParseErrorTermination, like false.
+    kHandlerContinue = 1,   //!< Continue parsing, like true.
+    //! Skip the object or array just started, or the value of the member whose name was just reported.
+    /*! The skipped value generates no events (not even EndObject() or EndArray()),
+        and is not counted in the memberCount or elementCount of its parent. Its
+        strings are neither decoded nor validated, and its numbers are not converted:
+        only unmatched brackets and unterminated strings are reported as errors.
+        For in-memory UTF-8 text (StringStream and InsituStringStream without
+        \ref kParseCommentsFlag), the skip examines 64 bytes at a time.
+    */
+    kHandlerSkip = 2
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // BaseReaderHandler
 
@@ -258,7 +297,7 @@ private:
 
 //! Skip the JSON white spaces in a stream.
 /*! \param is A input stream for skipping white spaces.
-    \note This function has SSE2/SSE4.2 specialization.
+    \note This function has SSE2/SSE4.2/AVX2/AVX-512 specialization.
 */
 template<typename InputStream>
 void SkipWhitespace(InputStream& is) {
@@ -276,7 +315,176 @@ inline const char* SkipWhitespace(const char* p, const char* end) {
     return p;
 }
 
-#ifdef RAPIDJSON_SSE42
+#ifdef RAPIDJSON_SIMD_DISPATCH
+//! Skip whitespace with the widest SIMD kernel supported by the running CPU.
+/*! Most skips stop at the first or second character, which are tested inline to save the indirect call.
+*/
+inline const char *SkipWhitespace_SIMD(const char* p) {
+    if (*p != ' ' && *p != '\n' && *p != '\r' && *p != '\t')
+        return p;
+    ++p;
+    if (*p != ' ' && *p != '\n' && *p != '\r' && *p != '\t')
+        return p;
+    return internal::GetSimdKernels().skipWhitespace(p);
+}
+
+inline const char *SkipWhitespace_SIMD(const char* p, const char* end) {
+    if (p == end || (*p != ' ' && *p != '\n' && *p != '\r' && *p != '\t'))
+        return p;
+    ++p;
+    if (p == end || (*p != ' ' && *p != '\n' && *p != '\r' && *p != '\t'))
+        return p;
+    return internal::GetSimdKernels().skipWhitespaceBounded(p, end);
+}
+
+#elif defined(RAPIDJSON_AVX512)
+//! Skip whitespace with AVX-512BW instructions, testing 64 8-byte characters at once.
+inline const char *SkipWhitespace_SIMD(const char* p) {
+    // Fast return for single non-whitespace
+    if (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+        ++p;
+    else
+        return p;
+
+    // 64-byte align to the next boundary
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 63) & static_cast<size_t>(~63));
+    while (p != nextAligned)
+        if (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+            ++p;
+        else
+            return p;
+
+    // The rest of string using SIMD
+    const __m512i w0 = _mm512_set1_epi8(' ');
+    const __m512i w1 = _mm512_set1_epi8('\n');
+    const __m512i w2 = _mm512_set1_epi8('\r');
+    const __m512i w3 = _mm512_set1_epi8('\t');
+
+    for (;; p += 64) {
+        const __m512i s = _mm512_load_si512(reinterpret_cast<const void *>(p));
+        const uint64_t x = _mm512_cmpeq_epi8_mask(s, w0) | _mm512_cmpeq_epi8_mask(s, w1) | _mm512_cmpeq_epi8_mask(s, w2) | _mm512_cmpeq_epi8_mask(s, w3);
+        const uint64_t r = ~x;
+        if (r != 0) {   // some of characters is non-whitespace
+#ifdef _MSC_VER         // Find the index of first non-whitespace
+            unsigned long offset;
+            _BitScanForward64(&offset, r);
+            return p + offset;
+#else
+            return p + __builtin_ffsll(static_cast<long long>(r)) - 1;
+#endif
+        }
+    }
+}
+
+inline const char *SkipWhitespace_SIMD(const char* p, const char* end) {
+    // Fast return for single non-whitespace
+    if (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+        ++p;
+    else
+        return p;
+
+    // The middle of string using SIMD
+    const __m512i w0 = _mm512_set1_epi8(' ');
+    const __m512i w1 = _mm512_set1_epi8('\n');
+    const __m512i w2 = _mm512_set1_epi8('\r');
+    const __m512i w3 = _mm512_set1_epi8('\t');
+
+    for (; p <= end - 64; p += 64) {
+        const __m512i s = _mm512_loadu_si512(reinterpret_cast<const void *>(p));
+        const uint64_t x = _mm512_cmpeq_epi8_mask(s, w0) | _mm512_cmpeq_epi8_mask(s, w1) | _mm512_cmpeq_epi8_mask(s, w2) | _mm512_cmpeq_epi8_mask(s, w3);
+        const uint64_t r = ~x;
+        if (r != 0) {   // some of characters is non-whitespace
+#ifdef _MSC_VER         // Find the index of first non-whitespace
+            unsigned long offset;
+            _BitScanForward64(&offset, r);
+            return p + offset;
+#else
+            return p + __builtin_ffsll(static_cast<long long>(r)) - 1;
+#endif
+        }
+    }
+
+    return SkipWhitespace(p, end);
+}
+
+#elif defined(RAPIDJSON_AVX2)
+
+//! Skip whitespace with AVX2 instructions, testing 32 8-byte characters at once.
+inline const char *SkipWhitespace_SIMD(const char* p) {
+    // Fast return for single non-whitespace
+    if (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+        ++p;
+    else
+        return p;
+
+    // 32-byte align to the next boundary
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 31) & static_cast<size_t>(~31));
+    while (p != nextAligned)
+        if (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+            ++p;
+        else
+            return p;
+
+    // The rest of string using SIMD
+    const __m256i w0 = _mm256_set1_epi8(' ');
+    const __m256i w1 = _mm256_set1_epi8('\n');
+    const __m256i w2 = _mm256_set1_epi8('\r');
+    const __m256i w3 = _mm256_set1_epi8('\t');
+
+    for (;; p += 32) {
+        const __m256i s = _mm256_load_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i x = _mm256_cmpeq_epi8(s, w0);
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w1));
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w2));
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w3));
+        const unsigned r = ~static_cast<unsigned>(_mm256_movemask_epi8(x));
+        if (r != 0) {   // some of characters is non-whitespace
+#ifdef _MSC_VER         // Find the index of first non-whitespace
+            unsigned long offset;
+            _BitScanForward(&offset, r);
+            return p + offset;
+#else
+            return p + __builtin_ffs(static_cast<int>(r)) - 1;
+#endif
+        }
+    }
+}
+
+inline const char *SkipWhitespace_SIMD(const char* p, const char* end) {
+    // Fast return for single non-whitespace
+    if (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+        ++p;
+    else
+        return p;
+
+    // The middle of string using SIMD
+    const __m256i w0 = _mm256_set1_epi8(' ');
+    const __m256i w1 = _mm256_set1_epi8('\n');
+    const __m256i w2 = _mm256_set1_epi8('\r');
+    const __m256i w3 = _mm256_set1_epi8('\t');
+
+    for (; p <= end - 32; p += 32) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i x = _mm256_cmpeq_epi8(s, w0);
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w1));
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w2));
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w3));
+        const unsigned r = ~static_cast<unsigned>(_mm256_movemask_epi8(x));
+        if (r != 0) {   // some of characters is non-whitespace
+#ifdef _MSC_VER         // Find the index of first non-whitespace
+            unsigned long offset;
+            _BitScanForward(&offset, r);
+            return p + offset;
+#else
+            return p + __builtin_ffs(static_cast<int>(r)) - 1;
+#endif
+        }
+    }
+
+    return SkipWhitespace(p, end);
+}
+
+#elif defined(RAPIDJSON_SSE42)
 //! Skip whitespace with SSE 4.2 pcmpistrm instruction, testing 16 8-byte characters at once.
 inline const char *SkipWhitespace_SIMD(const char* p) {
     // Fast return for single non-whitespace
@@ -443,6 +651,116 @@ template<> inline void SkipWhitespace(EncodedInputStream<UTF8<>, MemoryStream>&
 }
 #endif // RAPIDJSON_SIMD
 
+///////////////////////////////////////////////////////////////////////////////
+// TakeDigits8
+
+namespace internal {
+
+//! Tests whether all eight characters packed in a little-endian word are decimal digits (SWAR).
+inline bool IsDigits8(uint64_t x) {
+    const uint64_t high = RAPIDJSON_UINT64_C2(0xF0F0F0F0, 0xF0F0F0F0);
+    return ((x & high) | (((x + RAPIDJSON_UINT64_C2(0x06060606, 0x06060606)) & high) >> 4)) == RAPIDJSON_UINT64_C2(0x33333333, 0x33333333);
+}
+
+//! Converts eight decimal digits packed in a little-endian word, first character in the lowest byte (SWAR).
+inline uint32_t ParseDigits8(uint64_t x) {
+    const uint64_t mask = RAPIDJSON_UINT64_C2(0x000000FF, 0x000000FF);
+    x -= RAPIDJSON_UINT64_C2(0x30303030, 0x30303030);
+    x = (x * 10) + (x >> 8);    // pairs of digits in the even bytes
+    x = (((x & mask) * RAPIDJSON_UINT64_C2(1000000, 100)) + (((x >> 16) & mask) * RAPIDJSON_UINT64_C2(10000, 1))) >> 32;
+    return static_cast<uint32_t>(x);
+}
+
+#if RAPIDJSON_ENDIAN == RAPIDJSON_LITTLEENDIAN
+inline uint64_t Load8(const char* p) {
+    uint64_t x;
+    std::memcpy(&x, p, 8);
+    return x;
+}
+
+//! Loads eight digits from a null-terminated string.
+/*! Only aligned words are read, and the second one only if the first ends with digits,
+    so no read crosses a page boundary past the terminator.
+
+    \return false if any of the eight characters is not a digit.
+*/
+inline bool LoadDigits8(const char* p, uint64_t* word) {
+    const char* aligned = reinterpret_cast<const char*>(reinterpret_cast<size_t>(p) & static_cast<size_t>(~7));
+    const unsigned shift = static_cast<unsigned>(p - aligned) * 8;
+    uint64_t x = Load8(aligned) >> shift;
+    if (shift != 0) {
+        if (!IsDigits8(x | (RAPIDJSON_UINT64_C2(0x30303030, 0x30303030) << (64 - shift))))
+            return false;
+        x |= Load8(aligned + 8) << (64 - shift);
+    }
+    if (!IsDigits8(x))
+        return false;
+    *word = x;
+    return true;
+}
+
+//! Loads eight digits from a bounded buffer.
+inline bool LoadDigits8(const char* p, const char* end, uint64_t* word) {
+    if (end - p < 8)
+        return false;
+    const uint64_t x = Load8(p);
+    if (!IsDigits8(x))
+        return false;
+    *word = x;
+    return true;
+}
+#endif
+
+} // namespace internal
+
+//! Take eight decimal digits at once from a memory-backed stream.
+/*! \param is An input stream.
+    \param word Receives the eight characters packed in a little-endian word.
+    \return false, consuming nothing, if the next eight characters are not all digits
+            or the stream cannot be read ahead.
+    \note This function has SWAR specialization for StringStream, InsituStringStream and MemoryStream
+          on little-endian machines.
+*/
+template<typename InputStream>
+inline bool TakeDigits8(InputStream& is, uint64_t* word) {
+    (void)is;
+    (void)word;
+    return false;
+}
+
+#if RAPIDJSON_ENDIAN == RAPIDJSON_LITTLEENDIAN
+//! Template function specialization for StringStream
+template<> inline bool TakeDigits8(StringStream& is, uint64_t* word) {
+    if (!internal::LoadDigits8(is.src_, word))
+        return false;
+    is.src_ += 8;
+    return true;
+}
+
+//! Template function specialization for InsituStringStream
+template<> inline bool TakeDigits8(InsituStringStream& is, uint64_t* word) {
+    if (!internal::LoadDigits8(is.src_, word))
+        return false;
+    is.src_ += 8;
+    return true;
+}
+
+//! Template function specialization for MemoryStream
+template<> inline bool TakeDigits8(MemoryStream& is, uint64_t* word) {
+    if (!internal::LoadDigits8(is.src_, is.end_, word))
+        return false;
+    is.src_ += 8;
+    return true;
+}
+
+template<> inline bool TakeDigits8(EncodedInputStream<UTF8<>, MemoryStream>& is, uint64_t* word) {
+    return TakeDigits8(is.is_, word);
+}
+#endif
+
+template <typename Encoding, typename Allocator>
+class GenericProjection;
+
 ///////////////////////////////////////////////////////////////////////////////
 // GenericReader
 
@@ -471,7 +789,11 @@ public:
     /*! \param stackAllocator Optional allocator for allocating stack memory. (Only use for non-destructive parsing)
         \param stackCapacity stack capacity in bytes for storing a single decoded string.  (Only use for non-destructive parsing)
     */
-    GenericReader(StackAllocator* stackAllocator = 0, size_t stackCapacity = kDefaultStackCapacity) : stack_(stackAllocator, stackCapacity), parseResult_() {}
+    GenericReader(StackAllocator* stackAllocator = 0, size_t stackCapacity = kDefaultStackCapacity) : stack_(stackAllocator, stackCapacity), structuralIndex_(0), indexedStringEnd_(0), parseResult_(), state_(IterativeParsingStartState), skipped_() {}
+
+    ~GenericReader() {
+        RAPIDJSON_DELETE(structuralIndex_);
+    }
 
     //! Parse JSON text.
     /*! \tparam parseFlags Combination of \ref ParseFlag.
@@ -483,10 +805,14 @@ public:
     */
     template <unsigned parseFlags, typename InputStream, typename Handler>
     ParseResult Parse(InputStream& is, Handler& handler) {
+        if (parseFlags & kParseStructuralIndexFlag)
+            return StructuralIndexParse<parseFlags>(is, handler);
+
         if (parseFlags & kParseIterativeFlag)
             return IterativeParse<parseFlags>(is, handler);
 
         parseResult_.Clear();
+        skipped_ = false;
 
         ClearStackOnExit scope(*this);
 
@@ -527,6 +853,173 @@ public:
         return Parse<kParseDefaultFlags>(is, handler);
     }
 
+    //! Parse JSON text, keeping only the values selected by a projection.
+    /*! The handler receives the events of the selected values and of the objects
+        and arrays on the paths to them, as described in GenericProjection. Other
+        values are skipped by matching quotes and brackets: their strings are
+        neither decoded nor validated, and their numbers are not converted. For
+        in-memory UTF-8 text (StringStream and InsituStringStream without
+        \ref kParseCommentsFlag), the skip examines 64 bytes at a time with SIMD.
+
+        \tparam parseFlags Combination of \ref ParseFlag. \ref kParseIterativeFlag and
+            \ref kParseStructuralIndexFlag make the selected values be parsed iteratively.
+        \tparam InputStream Type of input stream, implementing Stream concept.
+        \tparam Handler Type of handler, implementing Handler concept.
+        \param is Input stream to be parsed.
+        \param handler The handler to receive events.
+        \param projection The values to keep, with object names in the target encoding.
+        \return Whether the parsing is successful.
+        \note Within skipped values, only unmatched brackets and unterminated strings
+            are reported as errors.
+    */
+    template <unsigned parseFlags, typename InputStream, typename Handler, typename ProjectionAllocator>
+    ParseResult Parse(InputStream& is, Handler& handler, const GenericProjection<TargetEncoding, ProjectionAllocator>& projection) {
+        parseResult_.Clear();
+        skipped_ = false;
+
+        ClearStackOnExit scope(*this);
+
+        SkipWhitespaceAndComments<parseFlags>(is);
+        RAPIDJSON_PARSE_ERROR_EARLY_RETURN(parseResult_);
+
+        if (RAPIDJSON_UNLIKELY(is.Peek() == '\0')) {
+            RAPIDJSON_PARSE_ERROR_NORETURN(kParseErrorDocumentEmpty, is.Tell());
+            RAPIDJSON_PARSE_ERROR_EARLY_RETURN(parseResult_);
+        }
+        else {
+            ParseProjectedValue<parseFlags>(is, handler, projection, projection.Root());
+            RAPIDJSON_PARSE_ERROR_EARLY_RETURN(parseResult_);
+
+            if (!(parseFlags & kParseStopWhenDoneFlag)) {
+                SkipWhitespaceAndComments<parseFlags>(is);
+                RAPIDJSON_PARSE_ERROR_EARLY_RETURN(parseResult_);
+
+                if (RAPIDJSON_UNLIKELY(is.Peek() != '\0')) {
+                    RAPIDJSON_PARSE_ERROR_NORETURN(kParseErrorDocumentRootNotSingular, is.Tell());
+                    RAPIDJSON_PARSE_ERROR_EARLY_RETURN(parseResult_);
+                }
+            }
+        }
+
+        return parseResult_;
+    }
+
+    //! Parse JSON text, keeping only the values selected by a projection (with \ref kParseDefaultFlags)
+    /*! \tparam InputStream Type of input stream, implementing Stream concept.
+        \tparam Handler Type of handler, implementing Handler concept.
+        \param is Input stream to be parsed.
+        \param handler The handler to receive events.
+        \param projection The values to keep, with object names in the target encoding.
+        \return Whether the parsing is successful.
+    */
+    template <typename InputStream, typename Handler, typename ProjectionAllocator>
+    ParseResult Parse(InputStream& is, Handler& handler, const GenericProjection<TargetEncoding, ProjectionAllocator>& projection) {
+        return Parse<kParseDefaultFlags>(is, handler, projection);
+    }
+
+    //! Check that JSON text is well-formed, without generating events.
+    /*! The result, including the error offset, is the same as for Parse() with a
+        handler which accepts every event, but no value is materialized: strings
+        are checked without being decoded or copied (with \ref kParseValidateEncodingFlag,
+        UTF-8 runs are validated in bulk), and numbers are scanned without being copied
+        or converted, except for the range check. For StringStream and
+        InsituStringStream, runs of unescaped characters are scanned with SIMD
+        (see internal::ScanUnescaped()); \ref kParseStructuralIndexFlag classifies
+        the structural characters with SIMD as well.
+
+        \tparam parseFlags Combination of \ref ParseFlag. \ref kParseInsituFlag,
+            \ref kParseFullPrecisionFlag and \ref kParseNumbersAsStringsFlag are ignored.
+        \tparam InputStream Type of input stream, implementing Stream concept.
+        \param is Input stream to be checked. It is not modified.
+        \return Whether the text is well-formed.
+    */
+    template <unsigned parseFlags, typename InputStream>
+    ParseResult Validate(InputStream& is) {
+        ValidationHandler handler;
+        return Parse<parseFlags & ~static_cast<unsigned>(kParseInsituFlag)>(is, handler);
+    }
+
+    //! Check that JSON text is well-formed (with \ref kParseDefaultFlags)
+    /*! \tparam InputStream Type of input stream, implementing Stream concept.
+        \param is Input stream to be checked.
+        \return Whether the text is well-formed.
+    */
+    template <typename InputStream>
+    ParseResult Validate(InputStream& is) {
+        return Validate<kParseDefaultFlags>(is);
+    }
+
+    //! Initialize JSON text token-by-token parsing
+    /*! Call IterativeParseNext() afterwards until IterativeParseComplete() returns true.
+        \see IterativeParseNext, IterativeParseComplete
+    */
+    void IterativeParseInit() {
+        parseResult_.Clear();
+        stack_.Clear();
+        state_ = IterativeParsingStartState;
+    }
+
+    //! Parse one token from JSON text
+    /*! Consumes input up to and including the next value, key, or start/end of
+        object or array, and reports it to the handler with exactly one call.
+        Delimiters (',' and ':') are consumed silently. The parse can be
+        abandoned after any call; the next IterativeParseInit() starts over.
+
+        \tparam parseFlags Combination of \ref ParseFlag. kParseIterativeFlag is implied, kParseStructuralIndexFlag is ignored.
+        \tparam InputStream Type of input stream, implementing Stream concept.
+        \tparam Handler Type of handler, implementing Handler concept.
+        \param is Input stream to be parsed. It must be the same stream across calls.
+        \param handler The handler to receive the event.
+        \return Whether the parsing is successful so far (and not terminated by the handler).
+    */
+    template <unsigned parseFlags, typename InputStream, typename Handler>
+    bool IterativeParseNext(InputStream& is, Handler& handler) {
+        while (!IsIterativeParsingCompleteState(state_)) {
+            SkipWhitespaceAndComments<parseFlags>(is);
+            if (RAPIDJSON_UNLIKELY(HasParseError()))
+                return IterativeParseFail();
+
+            if (RAPIDJSON_UNLIKELY(is.Peek() == '\0')) {
+                // The end of the stream in any other state than finish is an error.
+                HandleError(state_, is);
+                return IterativeParseFail();
+            }
+
+            Token t = Tokenize(is.Peek());
+            IterativeParsingState n = Predict(state_, t);
+            IterativeParsingState d = Transit<parseFlags>(state_, t, n, is, handler);
+
+            if (RAPIDJSON_UNLIKELY(d == IterativeParsingErrorState)) {
+                HandleError(state_, is);
+                return IterativeParseFail();
+            }
+
+            state_ = d;
+
+            if (d == IterativeParsingFinishState) {
+                // Like Parse(), reject anything but whitespace after the root unless told to stop.
+                if (!(parseFlags & kParseStopWhenDoneFlag)) {
+                    SkipWhitespaceAndComments<parseFlags>(is);
+                    if (!HasParseError() && is.Peek() != '\0')
+                        HandleError(state_, is);
+                    if (HasParseError())
+                        return IterativeParseFail();
+                }
+                return true;
+            }
+
+            // Delimiters do not call the handler; continue to the next token.
+            if (!IsIterativeParsingDelimiterState(n))
+                return true;
+        }
+        return !HasParseError();
+    }
+
+    //! Check whether token-by-token parsing has finished, either successfully or with an error.
+    bool IterativeParseComplete() const {
+        return IsIterativeParsingCompleteState(state_);
+    }
+
     //! Whether a parse error has occured in the last parsing.
     bool HasParseError() const { return parseResult_.IsError(); }
 
@@ -549,7 +1042,7 @@ private:
     // clear stack on any exit from ParseStream, e.g. due to exception
     struct ClearStackOnExit {
         explicit ClearStackOnExit(GenericReader& r) : r_(r) {}
-        ~ClearStackOnExit() { r_.ClearStack(); }
+        ~ClearStackOnExit() { r_.ClearStack(); r_.indexedStringEnd_ = 0; }
     private:
         GenericReader& r_;
         ClearStackOnExit(const ClearStackOnExit&);
@@ -590,8 +1083,14 @@ private:
         RAPIDJSON_ASSERT(is.Peek() == '{');
         is.Take();  // Skip '{'
 
-        if (RAPIDJSON_UNLIKELY(!handler.StartObject()))
-            RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+        const HandlerResult result = ToHandlerResult(handler.StartObject());
+        if (RAPIDJSON_UNLIKELY(result != kHandlerContinue)) {
+            if (result == kHandlerTerminate)
+                RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+            SkipNestedValue<parseFlags>(is, '{');
+            skipped_ = true;
+            return;
+        }
 
         SkipWhitespaceAndComments<parseFlags>(is);
         RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
@@ -618,13 +1117,19 @@ private:
             SkipWhitespaceAndComments<parseFlags>(is);
             RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
 
-            ParseValue<parseFlags>(is, handler);
+            if (RAPIDJSON_UNLIKELY(skipped_))   // Key() asked to skip the value
+                SkipValue<parseFlags>(is);
+            else
+                ParseValue<parseFlags>(is, handler);
             RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
 
             SkipWhitespaceAndComments<parseFlags>(is);
             RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
 
-            ++memberCount;
+            if (RAPIDJSON_UNLIKELY(skipped_))
+                skipped_ = false;
+            else
+                ++memberCount;
 
             switch (is.Peek()) {
                 case ',':
@@ -658,8 +1163,14 @@ private:
         RAPIDJSON_ASSERT(is.Peek() == '[');
         is.Take();  // Skip '['
 
-        if (RAPIDJSON_UNLIKELY(!handler.StartArray()))
-            RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+        const HandlerResult result = ToHandlerResult(handler.StartArray());
+        if (RAPIDJSON_UNLIKELY(result != kHandlerContinue)) {
+            if (result == kHandlerTerminate)
+                RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+            SkipNestedValue<parseFlags>(is, '[');
+            skipped_ = true;
+            return;
+        }
 
         SkipWhitespaceAndComments<parseFlags>(is);
         RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
@@ -674,7 +1185,10 @@ private:
             ParseValue<parseFlags>(is, handler);
             RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
 
-            ++elementCount;
+            if (RAPIDJSON_UNLIKELY(skipped_))   // StartObject() or StartArray() asked to skip the value
+                skipped_ = false;
+            else
+                ++elementCount;
             SkipWhitespaceAndComments<parseFlags>(is);
             RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
 
@@ -701,21 +1215,301 @@ private:
         }
     }
 
-    template<unsigned parseFlags, typename InputStream, typename Handler>
-    void ParseNull(InputStream& is, Handler& handler) {
-        RAPIDJSON_ASSERT(is.Peek() == 'n');
-        is.Take();
-
-        if (RAPIDJSON_LIKELY(Consume(is, 'u') && Consume(is, 'l') && Consume(is, 'l'))) {
-            if (RAPIDJSON_UNLIKELY(!handler.Null()))
-                RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+    // Parse a value on the paths of a projection: objects and arrays which are not
+    // selected as a whole keep only the members and elements on these paths.
+    template<unsigned parseFlags, typename InputStream, typename Handler, typename Projection>
+    void ParseProjectedValue(InputStream& is, Handler& handler, const Projection& projection, SizeType node) {
+        if (!projection.IsSelected(node)) {
+            if (is.Peek() == '{') {
+                ParseProjectedObject<parseFlags>(is, handler, projection, node);
+                return;
+            }
+            if (is.Peek() == '[') {
+                ParseProjectedArray<parseFlags>(is, handler, projection, node);
+                return;
+            }
         }
+        if (parseFlags & (kParseIterativeFlag | kParseStructuralIndexFlag))
+            IterativeParse<parseFlags | kParseStopWhenDoneFlag>(is, handler);
         else
-            RAPIDJSON_PARSE_ERROR(kParseErrorValueInvalid, is.Tell());
+            ParseValue<parseFlags>(is, handler);
     }
 
-    template<unsigned parseFlags, typename InputStream, typename Handler>
-    void ParseTrue(InputStream& is, Handler& handler) {
+    // Forwards the object names which are on the paths of a projection to the handler.
+    template <typename Handler, typename Projection>
+    struct ProjectedKeyHandler {
+        typedef typename TargetEncoding::Ch Ch;
+
+        ProjectedKeyHandler(Handler& handler, const Projection& projection, SizeType node) : handler_(handler), projection_(projection), node_(node), child_(), found_() {}
+
+        bool Key(const Ch* str, SizeType length, bool copy) {
+            found_ = projection_.FindMember(node_, str, length, &child_);
+            if (!found_)
+                return true;
+            const HandlerResult result = ToHandlerResult(handler_.Key(str, length, copy));
+            found_ = result == kHandlerContinue;
+            return result != kHandlerTerminate;
+        }
+        bool String(const Ch*, SizeType, bool) { RAPIDJSON_ASSERT(false); return false; }
+
+        Handler& handler_;
+        const Projection& projection_;
+        SizeType node_;
+        SizeType child_;
+        bool found_;
+
+    private:
+        ProjectedKeyHandler& operator=(const ProjectedKeyHandler&);
+    };
+
+    template<unsigned parseFlags, typename InputStream, typename Handler, typename Projection>
+    void ParseProjectedObject(InputStream& is, Handler& handler, const Projection& projection, SizeType node) {
+        RAPIDJSON_ASSERT(is.Peek() == '{');
+        is.Take();  // Skip '{'
+
+        const HandlerResult result = ToHandlerResult(handler.StartObject());
+        if (RAPIDJSON_UNLIKELY(result != kHandlerContinue)) {
+            if (result == kHandlerTerminate)
+                RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+            SkipNestedValue<parseFlags>(is, '{');
+            skipped_ = true;
+            return;
+        }
+
+        SkipWhitespaceAndComments<parseFlags>(is);
+        RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+
+        SizeType memberCount = 0;
+        if (!Consume(is, '}')) {
+            for (;;) {
+                if (RAPIDJSON_UNLIKELY(is.Peek() != '"'))
+                    RAPIDJSON_PARSE_ERROR(kParseErrorObjectMissName, is.Tell());
+
+                ProjectedKeyHandler<Handler, Projection> key(handler, projection, node);
+                ParseString<parseFlags>(is, key, true);
+                RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+
+                SkipWhitespaceAndComments<parseFlags>(is);
+                RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+
+                if (RAPIDJSON_UNLIKELY(!Consume(is, ':')))
+                    RAPIDJSON_PARSE_ERROR(kParseErrorObjectMissColon, is.Tell());
+
+                SkipWhitespaceAndComments<parseFlags>(is);
+                RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+
+                if (key.found_) {
+                    ParseProjectedValue<parseFlags>(is, handler, projection, key.child_);
+                    RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+                    if (RAPIDJSON_UNLIKELY(skipped_))
+                        skipped_ = false;
+                    else
+                        ++memberCount;
+                }
+                else
+                    SkipValue<parseFlags>(is);
+                RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+
+                SkipWhitespaceAndComments<parseFlags>(is);
+                RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+
+                if (Consume(is, ',')) {
+                    SkipWhitespaceAndComments<parseFlags>(is);
+                    RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+                    if ((parseFlags & kParseTrailingCommasFlag) && Consume(is, '}'))
+                        break;
+                }
+                else if (Consume(is, '}'))
+                    break;
+                else
+                    RAPIDJSON_PARSE_ERROR(kParseErrorObjectMissCommaOrCurlyBracket, is.Tell());
+            }
+        }
+
+        if (RAPIDJSON_UNLIKELY(!handler.EndObject(memberCount)))
+            RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+    }
+
+    template<unsigned parseFlags, typename InputStream, typename Handler, typename Projection>
+    void ParseProjectedArray(InputStream& is, Handler& handler, const Projection& projection, SizeType node) {
+        RAPIDJSON_ASSERT(is.Peek() == '[');
+        is.Take();  // Skip '['
+
+        const HandlerResult result = ToHandlerResult(handler.StartArray());
+        if (RAPIDJSON_UNLIKELY(result != kHandlerContinue)) {
+            if (result == kHandlerTerminate)
+                RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+            SkipNestedValue<parseFlags>(is, '[');
+            skipped_ = true;
+            return;
+        }
+
+        SkipWhitespaceAndComments<parseFlags>(is);
+        RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+
+        SizeType elementCount = 0;
+        if (!Consume(is, ']')) {
+            for (SizeType index = 0;; ++index) {
+                SizeType child;
+                if (projection.FindElement(node, index, &child)) {
+                    // Elements skipped before this one become null, so that it keeps its index.
+                    for (; elementCount < index; ++elementCount)
+                        if (RAPIDJSON_UNLIKELY(!handler.Null()))
+                            RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+                    ParseProjectedValue<parseFlags>(is, handler, projection, child);
+                    RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+                    if (RAPIDJSON_UNLIKELY(skipped_))
+                        skipped_ = false;
+                    else
+                        ++elementCount;
+                }
+                else
+                    SkipValue<parseFlags>(is);
+                RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+
+                SkipWhitespaceAndComments<parseFlags>(is);
+                RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+
+                if (Consume(is, ',')) {
+                    SkipWhitespaceAndComments<parseFlags>(is);
+                    RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+                    if ((parseFlags & kParseTrailingCommasFlag) && Consume(is, ']'))
+                        break;
+                }
+                else if (Consume(is, ']'))
+                    break;
+                else
+                    RAPIDJSON_PARSE_ERROR(kParseErrorArrayMissCommaOrSquareBracket, is.Tell());
+            }
+        }
+
+        if (RAPIDJSON_UNLIKELY(!handler.EndArray(elementCount)))
+            RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+    }
+
+    // Skip a value without decoding strings or converting numbers. Only quotes and
+    // brackets are matched; the characters of literals and numbers are not checked.
+    template<unsigned parseFlags, typename InputStream>
+    void SkipValue(InputStream& is) {
+        const typename InputStream::Ch c = is.Peek();
+        if (c == '"' || c == '{' || c == '[')
+            SkipNestedValue<parseFlags>(is, 0);
+        else {
+            if (RAPIDJSON_UNLIKELY(!IsLiteralCharacter(c)))
+                RAPIDJSON_PARSE_ERROR(kParseErrorValueInvalid, is.Tell());
+            do
+                is.Take();
+            while (IsLiteralCharacter(is.Peek()));
+        }
+    }
+
+    // Skip a string, object or array, or the rest of the object or array whose
+    // opening bracket \c opened has been consumed.
+    template<unsigned parseFlags, typename InputStream>
+    void SkipNestedValue(InputStream& is, char opened) {
+        const char open = SkipNested<parseFlags>(is, opened);
+        RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+        if (open == '"')
+            RAPIDJSON_PARSE_ERROR(kParseErrorStringMissQuotationMark, is.Tell());
+        else if (open == '{')
+            RAPIDJSON_PARSE_ERROR(kParseErrorObjectMissCommaOrCurlyBracket, is.Tell());
+        else if (open == '[')
+            RAPIDJSON_PARSE_ERROR(kParseErrorArrayMissCommaOrSquareBracket, is.Tell());
+    }
+
+    // Characters of true, false, null, numbers, NaN and Infinity.
+    template <typename CharType>
+    static bool IsLiteralCharacter(CharType c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '-' || c == '+' || c == '.';
+    }
+
+    // Skip the string, object or array at the stream position, or the rest of the
+    // one opened by \c opened, with the same result as internal::SkipStructural():
+    // 0 on success, otherwise the opening character of the innermost value which is not closed.
+    template<unsigned parseFlags, typename InputStream>
+    char SkipNested(InputStream& is, char opened) {
+        const size_t base = stack_.GetSize();
+        if (opened)
+            *stack_.template Push<char>() = opened;
+        do {
+            const typename InputStream::Ch c = is.Peek();
+            if (c == '"') {
+                is.Take();
+                for (typename InputStream::Ch d; (d = is.Peek()) != '"';) {
+                    if (d == '\0') {
+                        stack_.template Pop<char>(stack_.GetSize() - base);
+                        return '"';
+                    }
+                    is.Take();
+                    if (d == '\\' && is.Peek() != '\0')
+                        is.Take();
+                }
+                is.Take();
+            }
+            else if (c == '{' || c == '[') {
+                *stack_.template Push<char>() = static_cast<char>(c);
+                is.Take();
+            }
+            else if (c == '}' || c == ']' || c == '\0') {
+                const char open = *stack_.template Top<char>();
+                if (c == '\0' || (open == '{') != (c == '}')) {
+                    stack_.template Pop<char>(stack_.GetSize() - base);
+                    return open;
+                }
+                stack_.template Pop<char>(1);
+                is.Take();
+            }
+            else if ((parseFlags & kParseCommentsFlag) && c == '/') {
+                SkipWhitespaceAndComments<parseFlags>(is);
+                if (HasParseError()) {
+                    stack_.template Pop<char>(stack_.GetSize() - base);
+                    return 0;
+                }
+            }
+            else
+                is.Take();
+        } while (stack_.GetSize() > base);
+        return 0;
+    }
+
+#if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
+    // In-memory UTF-8 text is skipped 64 bytes at a time (comments are not recognized).
+    template<unsigned parseFlags>
+    char SkipNested(GenericStringStream<UTF8<> >& is, char opened) {
+        if (parseFlags & kParseCommentsFlag)
+            return SkipNested<parseFlags, GenericStringStream<UTF8<> > >(is, opened);
+        const char* p = is.src_;
+        const char open = internal::SkipStructural(p, stack_, opened);
+        is.src_ = p;
+        return open;
+    }
+
+    template<unsigned parseFlags>
+    char SkipNested(GenericInsituStringStream<UTF8<> >& is, char opened) {
+        if (parseFlags & kParseCommentsFlag)
+            return SkipNested<parseFlags, GenericInsituStringStream<UTF8<> > >(is, opened);
+        const char* p = is.src_;
+        const char open = internal::SkipStructural(p, stack_, opened);
+        is.src_ += p - is.src_;
+        return open;
+    }
+#endif
+
+    template<unsigned parseFlags, typename InputStream, typename Handler>
+    void ParseNull(InputStream& is, Handler& handler) {
+        RAPIDJSON_ASSERT(is.Peek() == 'n');
+        is.Take();
+
+        if (RAPIDJSON_LIKELY(Consume(is, 'u') && Consume(is, 'l') && Consume(is, 'l'))) {
+            if (RAPIDJSON_UNLIKELY(!handler.Null()))
+                RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+        }
+        else
+            RAPIDJSON_PARSE_ERROR(kParseErrorValueInvalid, is.Tell());
+    }
+
+    template<unsigned parseFlags, typename InputStream, typename Handler>
+    void ParseTrue(InputStream& is, Handler& handler) {
         RAPIDJSON_ASSERT(is.Peek() == 't');
         is.Take();
 
@@ -778,138 +1572,660 @@ private:
     public:
         typedef CharType Ch;
 
-        StackStream(internal::Stack<StackAllocator>& stack) : stack_(stack), length_(0) {}
-        RAPIDJSON_FORCEINLINE void Put(Ch c) {
-            *stack_.template Push<Ch>() = c;
-            ++length_;
+        StackStream(internal::Stack<StackAllocator>& stack) : stack_(stack), length_(0) {}
+        RAPIDJSON_FORCEINLINE void Put(Ch c) {
+            *stack_.template Push<Ch>() = c;
+            ++length_;
+        }
+
+        RAPIDJSON_FORCEINLINE void* Push(SizeType count) {
+            length_ += count;
+            return stack_.template Push<Ch>(count);
+        }
+
+        size_t Length() const { return length_; }
+
+        Ch* Pop() {
+            return stack_.template Pop<Ch>(length_);
+        }
+
+    private:
+        StackStream(const StackStream&);
+        StackStream& operator=(const StackStream&);
+
+        internal::Stack<StackAllocator>& stack_;
+        SizeType length_;
+    };
+
+    // Parse string and generate String or Key event. Different code paths for kParseInsituFlag.
+    // skipped_ tells whether Key() asked to skip the value of the member.
+    template<unsigned parseFlags, typename InputStream, typename Handler>
+    void ParseString(InputStream& is, Handler& handler, bool isKey = false) {
+        internal::StreamLocalCopy<InputStream> copy(is);
+        InputStream& s(copy.s);
+
+        RAPIDJSON_ASSERT(s.Peek() == '\"');
+        s.Take();  // Skip '\"'
+
+        HandlerResult result = kHandlerTerminate;
+        const typename TargetEncoding::Ch* ref;
+        SizeType refLength;
+        if ((parseFlags & kParseStructuralIndexFlag) && indexedStringEnd_)
+            result = ParseIndexedString<parseFlags>(s, handler, isKey);
+        else if (parseFlags & kParseInsituFlag) {
+            typename InputStream::Ch *head = s.PutBegin();
+            ParseStringToStream<parseFlags, SourceEncoding, SourceEncoding>(s, s);
+            RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+            size_t length = s.PutEnd(head) - 1;
+            RAPIDJSON_ASSERT(length <= 0xFFFFFFFF);
+            const typename TargetEncoding::Ch* const str = reinterpret_cast<typename TargetEncoding::Ch*>(head);
+            result = isKey ? ToHandlerResult(handler.Key(str, SizeType(length), false)) : ToHandlerResult(handler.String(str, SizeType(length), false));
+        }
+        else if ((parseFlags & kParseStringRefsFlag) && (ref = ScanStringRef<parseFlags>(s, refLength)) != 0)
+            result = isKey ? ToHandlerResult(handler.Key(ref, refLength, false)) : ToHandlerResult(handler.String(ref, refLength, false));
+        else {
+            StackStream<typename TargetEncoding::Ch> stackStream(stack_);
+            ParseStringToStream<parseFlags, SourceEncoding, TargetEncoding>(s, stackStream);
+            RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+            SizeType length = static_cast<SizeType>(stackStream.Length()) - 1;
+            const typename TargetEncoding::Ch* const str = stackStream.Pop();
+            result = isKey ? ToHandlerResult(handler.Key(str, length, true)) : ToHandlerResult(handler.String(str, length, true));
+        }
+        if (RAPIDJSON_UNLIKELY(result == kHandlerTerminate))
+            RAPIDJSON_PARSE_ERROR(kParseErrorTermination, s.Tell());
+        skipped_ = isKey && result == kHandlerSkip;
+    }
+
+    // For kParseStructuralIndexFlag: a UTF-8 string in memory, which stage one found free of
+    // backslashes and control characters and which ends at indexedStringEnd_, is taken at once.
+    template<unsigned parseFlags, typename InputStream, typename Handler>
+    HandlerResult ParseIndexedString(InputStream&, Handler&, bool) {
+        RAPIDJSON_ASSERT(false);
+        return kHandlerTerminate;
+    }
+
+#if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
+    template<unsigned parseFlags, typename Handler>
+    HandlerResult ParseIndexedString(GenericStringStream<UTF8<> >& is, Handler& handler, bool isKey) {
+        const char* head = is.src_;
+        const SizeType length = static_cast<SizeType>(indexedStringEnd_ - head);
+        is.src_ = indexedStringEnd_ + 1;
+        indexedStringEnd_ = 0;
+        if (parseFlags & kParseStringRefsFlag) {
+            const typename TargetEncoding::Ch* const str = reinterpret_cast<const typename TargetEncoding::Ch*>(head);
+            return isKey ? ToHandlerResult(handler.Key(str, length, false)) : ToHandlerResult(handler.String(str, length, false));
+        }
+        char* buffer = stack_.template Push<char>(length + 1);
+        std::memcpy(buffer, head, length);
+        buffer[length] = '\0';
+        const typename TargetEncoding::Ch* const str = reinterpret_cast<const typename TargetEncoding::Ch*>(stack_.template Pop<char>(length + 1));
+        return isKey ? ToHandlerResult(handler.Key(str, length, true)) : ToHandlerResult(handler.String(str, length, true));
+    }
+
+    template<unsigned parseFlags, typename Handler>
+    HandlerResult ParseIndexedString(GenericInsituStringStream<UTF8<> >& is, Handler& handler, bool isKey) {
+        char* head = is.src_;
+        char* end = head + (indexedStringEnd_ - head);
+        *end = '\0';
+        is.src_ = end + 1;
+        indexedStringEnd_ = 0;
+        const SizeType length = static_cast<SizeType>(end - head);
+        const typename TargetEncoding::Ch* const str = reinterpret_cast<const typename TargetEncoding::Ch*>(head);
+        return isKey ? ToHandlerResult(handler.Key(str, length, false)) : ToHandlerResult(handler.String(str, length, false));
+    }
+#endif
+
+    // For kParseStringRefsFlag: the characters of a string in memory which need neither unescaping
+    // nor transcoding, after which it is moved past the closing quote. Otherwise 0, and the string
+    // is copied (or its error reported) as usual.
+    template<unsigned parseFlags, typename InputStream>
+    static const typename TargetEncoding::Ch* ScanStringRef(InputStream&, SizeType&) {
+        return 0;
+    }
+
+    template<unsigned parseFlags>
+    static const typename TargetEncoding::Ch* ScanStringRef(GenericStringStream<SourceEncoding>& is, SizeType& length) {
+        typedef typename SourceEncoding::Ch SourceCh;
+        if (!internal::IsSame<SourceEncoding, TargetEncoding>::Value)
+            return 0;
+        const SourceCh* p = is.src_;
+        const SourceCh* q = ScanUnescapedRun(p);
+        if (*q != '"' || ((parseFlags & kParseValidateEncodingFlag) && !ValidateRun(p, q)))
+            return 0;
+        is.src_ = q + 1;
+        length = static_cast<SizeType>(q - p);
+        return reinterpret_cast<const typename TargetEncoding::Ch*>(p);
+    }
+
+    // The first '"', '\\' or control character from p.
+    template<typename CharType>
+    static RAPIDJSON_FORCEINLINE const CharType* ScanUnescapedRun(const CharType* p) {
+        while (*p != '"' && *p != '\\' && static_cast<unsigned>(*p) >= 0x20)
+            ++p;
+        return p;
+    }
+
+    // Whether [p, end) is valid in SourceEncoding.
+    template<typename CharType>
+    static bool ValidateRun(const CharType* p, const CharType* end) {
+        GenericStringStream<SourceEncoding> is(p);
+        DiscardStream<typename SourceEncoding::Ch> os;
+        while (is.src_ < end)
+            if (!Transcoder<SourceEncoding, SourceEncoding>::Validate(is, os))
+                return false;
+        return true;
+    }
+
+#ifdef RAPIDJSON_SIMD
+    static RAPIDJSON_FORCEINLINE const char* ScanUnescapedRun(const char* p) {
+        return internal::ScanUnescaped(p);
+    }
+
+    static bool ValidateRun(const char* p, const char* end) {
+        return internal::IsSame<SourceEncoding, UTF8<> >::Value ? internal::ValidateUtf8(p, end) : ValidateRun<char>(p, end);
+    }
+#endif
+
+    // Handler functions return bool or HandlerResult.
+    static HandlerResult ToHandlerResult(bool b) { return b ? kHandlerContinue : kHandlerTerminate; }
+    static HandlerResult ToHandlerResult(HandlerResult result) { return result; }
+
+    // Handler of Validate(), for which strings and numbers are not materialized.
+    struct ValidationHandler {
+        typedef typename TargetEncoding::Ch Ch;
+
+        bool Null() { return true; }
+        bool Bool(bool) { return true; }
+        bool Int(int) { return true; }
+        bool Uint(unsigned) { return true; }
+        bool Int64(int64_t) { return true; }
+        bool Uint64(uint64_t) { return true; }
+        bool Double(double) { return true; }
+        bool RawNumber(const Ch*, SizeType, bool) { return true; }
+        bool String(const Ch*, SizeType, bool) { return true; }
+        bool StartObject() { return true; }
+        bool Key(const Ch*, SizeType, bool) { return true; }
+        bool EndObject(SizeType) { return true; }
+        bool StartArray() { return true; }
+        bool EndArray(SizeType) { return true; }
+    };
+
+    // Output of strings which are only checked.
+    template <typename CharType>
+    struct DiscardStream {
+        typedef CharType Ch;
+
+        RAPIDJSON_FORCEINLINE void Put(Ch) {}
+    };
+
+    // Check a string without decoding it, with the same errors as the other overload.
+    template<unsigned parseFlags, typename InputStream>
+    void ParseString(InputStream& is, ValidationHandler&, bool = false) {
+        internal::StreamLocalCopy<InputStream> copy(is);
+        InputStream& s(copy.s);
+
+        RAPIDJSON_ASSERT(s.Peek() == '\"');
+        s.Take();  // Skip '\"'
+
+        DiscardStream<typename TargetEncoding::Ch> os;
+        ParseStringToStream<parseFlags, SourceEncoding, TargetEncoding>(s, os);
+    }
+
+    // Parse string to an output is
+    // This function handles the prefix/suffix double quotes, escaping, and optional encoding validation.
+    template<unsigned parseFlags, typename SEncoding, typename TEncoding, typename InputStream, typename OutputStream>
+    RAPIDJSON_FORCEINLINE void ParseStringToStream(InputStream& is, OutputStream& os) {
+//!@cond RAPIDJSON_HIDDEN_FROM_DOXYGEN
+#define Z16 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+        static const char escape[256] = {
+            Z16, Z16, 0, 0,'\"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,'/',
+            Z16, Z16, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,'\\', 0, 0, 0,
+            0, 0,'\b', 0, 0, 0,'\f', 0, 0, 0, 0, 0, 0, 0,'\n', 0,
+            0, 0,'\r', 0,'\t', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            Z16, Z16, Z16, Z16, Z16, Z16, Z16, Z16
+        };
+#undef Z16
+//!@endcond
+
+        for (;;) {
+            // Scan and copy string before "\\\"" or < 0x20. This is an optional optimzation.
+            if (!(parseFlags & kParseValidateEncodingFlag))
+                ScanCopyUnescapedString(is, os);
+            else if (internal::IsSame<SEncoding, UTF8<> >::Value && internal::IsSame<TEncoding, UTF8<> >::Value)
+                ScanCopyValidUnescapedString(is, os);
+
+            Ch c = is.Peek();
+            if (RAPIDJSON_UNLIKELY(c == '\\')) {    // Escape
+                size_t escapeOffset = is.Tell();    // For invalid escaping, report the inital '\\' as error offset
+                is.Take();
+                Ch e = is.Peek();
+                if ((sizeof(Ch) == 1 || unsigned(e) < 256) && RAPIDJSON_LIKELY(escape[static_cast<unsigned char>(e)])) {
+                    is.Take();
+                    os.Put(static_cast<typename TEncoding::Ch>(escape[static_cast<unsigned char>(e)]));
+                }
+                else if (RAPIDJSON_LIKELY(e == 'u')) {    // Unicode
+                    is.Take();
+                    unsigned codepoint = ParseHex4(is, escapeOffset);
+                    RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+                    if (RAPIDJSON_UNLIKELY(codepoint >= 0xD800 && codepoint <= 0xDBFF)) {
+                        // Handle UTF-16 surrogate pair
+                        if (RAPIDJSON_UNLIKELY(!Consume(is, '\\') || !Consume(is, 'u')))
+                            RAPIDJSON_PARSE_ERROR(kParseErrorStringUnicodeSurrogateInvalid, escapeOffset);
+                        unsigned codepoint2 = ParseHex4(is, escapeOffset);
+                        RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+                        if (RAPIDJSON_UNLIKELY(codepoint2 < 0xDC00 || codepoint2 > 0xDFFF))
+                            RAPIDJSON_PARSE_ERROR(kParseErrorStringUnicodeSurrogateInvalid, escapeOffset);
+                        codepoint = (((codepoint - 0xD800) << 10) | (codepoint2 - 0xDC00)) + 0x10000;
+                    }
+                    TEncoding::Encode(os, codepoint);
+                }
+                else
+                    RAPIDJSON_PARSE_ERROR(kParseErrorStringEscapeInvalid, escapeOffset);
+            }
+            else if (RAPIDJSON_UNLIKELY(c == '"')) {    // Closing double quote
+                is.Take();
+                os.Put('\0');   // null-terminate the string
+                return;
+            }
+            else if (RAPIDJSON_UNLIKELY(static_cast<unsigned>(c) < 0x20)) { // RFC 4627: unescaped = %x20-21 / %x23-5B / %x5D-10FFFF
+                if (c == '\0')
+                    RAPIDJSON_PARSE_ERROR(kParseErrorStringMissQuotationMark, is.Tell());
+                else
+                    RAPIDJSON_PARSE_ERROR(kParseErrorStringEscapeInvalid, is.Tell());
+            }
+            else {
+                size_t offset = is.Tell();
+                if (RAPIDJSON_UNLIKELY((parseFlags & kParseValidateEncodingFlag ?
+                    !Transcoder<SEncoding, TEncoding>::Validate(is, os) :
+                    !Transcoder<SEncoding, TEncoding>::Transcode(is, os))))
+                    RAPIDJSON_PARSE_ERROR(kParseErrorStringInvalidEncoding, offset);
+            }
+        }
+    }
+
+    template<typename InputStream, typename OutputStream>
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(InputStream&, OutputStream&) {
+            // Do nothing for generic version
+    }
+
+    // Same as ScanCopyUnescapedString(), for UTF-8 with kParseValidateEncodingFlag.
+    // The whole run is validated before it is copied. An invalid sequence ends the run,
+    // so that the loop in ParseStringToStream() reports it at its own offset.
+    template<typename InputStream, typename OutputStream>
+    static RAPIDJSON_FORCEINLINE void ScanCopyValidUnescapedString(InputStream&, OutputStream&) {
+            // Do nothing for generic version
+    }
+
+#ifdef RAPIDJSON_SIMD
+    // StringStream -> DiscardStream<char> (and likewise for InsituStringStream, which is not written)
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(StringStream& is, DiscardStream<char>&) {
+        is.src_ = internal::ScanUnescaped(is.src_);
+    }
+
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(InsituStringStream& is, DiscardStream<char>&) {
+        is.src_ += internal::ScanUnescaped(is.src_) - is.src_;
+    }
+
+    static RAPIDJSON_FORCEINLINE void ScanCopyValidUnescapedString(StringStream& is, DiscardStream<char>&) {
+        const char* p = is.src_;
+        const char* q = internal::ScanUnescaped(p);
+        if (RAPIDJSON_UNLIKELY(!internal::ValidateUtf8(p, q)))
+            q = internal::FindInvalidUtf8_Scalar(p, q);
+        is.src_ = q;
+    }
+
+    static RAPIDJSON_FORCEINLINE void ScanCopyValidUnescapedString(InsituStringStream& is, DiscardStream<char>&) {
+        const char* p = is.src_;
+        const char* q = internal::ScanUnescaped(p);
+        if (RAPIDJSON_UNLIKELY(!internal::ValidateUtf8(p, q)))
+            q = internal::FindInvalidUtf8_Scalar(p, q);
+        is.src_ += q - p;
+    }
+
+    // StringStream -> StackStream<char>
+    static RAPIDJSON_FORCEINLINE void ScanCopyValidUnescapedString(StringStream& is, StackStream<char>& os) {
+        const char* p = is.src_;
+        const char* q = internal::ScanUnescaped(p);
+        if (RAPIDJSON_UNLIKELY(!internal::ValidateUtf8(p, q)))
+            q = internal::FindInvalidUtf8_Scalar(p, q);
+        const SizeType length = static_cast<SizeType>(q - p);
+        if (length != 0)
+            std::memcpy(os.Push(length), p, length);
+        is.src_ = q;
+    }
+
+    // InsituStringStream -> InsituStringStream
+    static RAPIDJSON_FORCEINLINE void ScanCopyValidUnescapedString(InsituStringStream& is, InsituStringStream& os) {
+        RAPIDJSON_ASSERT(&is == &os);
+        (void)os;
+
+        char* p = is.src_;
+        const char* q = internal::ScanUnescaped(p);
+        if (RAPIDJSON_UNLIKELY(!internal::ValidateUtf8(p, q)))
+            q = internal::FindInvalidUtf8_Scalar(p, q);
+        const size_t length = static_cast<size_t>(q - p);
+        if (is.src_ != is.dst_)
+            std::memmove(is.dst_, p, length);   // destination trails the source after an escape
+        is.src_ += length;
+        is.dst_ += length;
+    }
+#endif // RAPIDJSON_SIMD
+
+#if defined(RAPIDJSON_SIMD_DISPATCH)
+    //! Find the first '"', '\\' or control character, testing the first character inline to save the indirect call for empty strings and escapes.
+    static RAPIDJSON_FORCEINLINE const char* ScanUnescaped(const char* p) {
+        if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned char>(*p) < 0x20))
+            return p;
+        return internal::GetSimdKernels().scanUnescaped(p);
+    }
+
+    // StringStream -> StackStream<char>
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(StringStream& is, StackStream<char>& os) {
+        const char* p = is.src_;
+        const char* q = ScanUnescaped(p);
+        const SizeType length = static_cast<SizeType>(q - p);
+        if (length != 0)
+            std::memcpy(os.Push(length), p, length);
+        is.src_ = q;
+    }
+
+    // InsituStringStream -> InsituStringStream
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(InsituStringStream& is, InsituStringStream& os) {
+        RAPIDJSON_ASSERT(&is == &os);
+        (void)os;
+
+        char* p = is.src_;
+        char* q = const_cast<char*>(ScanUnescaped(p));
+        const size_t length = static_cast<size_t>(q - p);
+        if (is.src_ != is.dst_)
+            std::memmove(is.dst_, p, length);   // destination trails the source after an escape
+        is.src_ = q;
+        is.dst_ += length;
+    }
+
+#elif defined(RAPIDJSON_AVX512)
+    // StringStream -> StackStream<char>
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(StringStream& is, StackStream<char>& os) {
+        const char* p = is.src_;
+
+        // Scan one by one until alignment (unaligned load may cross page boundary and cause crash)
+        const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 63) & static_cast<size_t>(~63));
+        while (p != nextAligned)
+            if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(*p) < 0x20)) {
+                is.src_ = p;
+                return;
+            }
+            else
+                os.Put(*p++);
+
+        // The rest of string using SIMD
+        const __m512i dq = _mm512_set1_epi8('\"');
+        const __m512i bs = _mm512_set1_epi8('\\');
+        const __m512i sp = _mm512_set1_epi8(0x20);
+
+        for (;; p += 64) {
+            const __m512i s = _mm512_load_si512(reinterpret_cast<const void *>(p));
+            const uint64_t r = _mm512_cmpeq_epi8_mask(s, dq) | _mm512_cmpeq_epi8_mask(s, bs) | _mm512_cmplt_epu8_mask(s, sp);
+            if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
+                SizeType length;
+#ifdef _MSC_VER         // Find the index of first escaped
+                unsigned long offset;
+                _BitScanForward64(&offset, r);
+                length = offset;
+#else
+                length = static_cast<SizeType>(__builtin_ffsll(static_cast<long long>(r)) - 1);
+#endif
+                char* q = reinterpret_cast<char*>(os.Push(length));
+                for (size_t i = 0; i < length; i++)
+                    q[i] = p[i];
+
+                p += length;
+                break;
+            }
+            _mm512_storeu_si512(reinterpret_cast<void *>(os.Push(64)), s);
+        }
+
+        is.src_ = p;
+    }
+
+    // InsituStringStream -> InsituStringStream
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(InsituStringStream& is, InsituStringStream& os) {
+        RAPIDJSON_ASSERT(&is == &os);
+        (void)os;
+
+        if (is.src_ == is.dst_) {
+            SkipUnescapedString(is);
+            return;
+        }
+
+        char* p = is.src_;
+        char *q = is.dst_;
+
+        // Scan one by one until alignment (unaligned load may cross page boundary and cause crash)
+        const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 63) & static_cast<size_t>(~63));
+        while (p != nextAligned)
+            if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(*p) < 0x20)) {
+                is.src_ = p;
+                is.dst_ = q;
+                return;
+            }
+            else
+                *q++ = *p++;
+
+        // The rest of string using SIMD
+        const __m512i dq = _mm512_set1_epi8('\"');
+        const __m512i bs = _mm512_set1_epi8('\\');
+        const __m512i sp = _mm512_set1_epi8(0x20);
+
+        for (;; p += 64, q += 64) {
+            const __m512i s = _mm512_load_si512(reinterpret_cast<const void *>(p));
+            const uint64_t r = _mm512_cmpeq_epi8_mask(s, dq) | _mm512_cmpeq_epi8_mask(s, bs) | _mm512_cmplt_epu8_mask(s, sp);
+            if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
+                size_t length;
+#ifdef _MSC_VER         // Find the index of first escaped
+                unsigned long offset;
+                _BitScanForward64(&offset, r);
+                length = offset;
+#else
+                length = static_cast<size_t>(__builtin_ffsll(static_cast<long long>(r)) - 1);
+#endif
+                for (const char* pend = p + length; p != pend; )
+                    *q++ = *p++;
+                break;
+            }
+            _mm512_storeu_si512(reinterpret_cast<void *>(q), s);
+        }
+
+        is.src_ = p;
+        is.dst_ = q;
+    }
+
+    // When read/write pointers are the same for insitu stream, just skip unescaped characters
+    static RAPIDJSON_FORCEINLINE void SkipUnescapedString(InsituStringStream& is) {
+        RAPIDJSON_ASSERT(is.src_ == is.dst_);
+        char* p = is.src_;
+
+        // Scan one by one until alignment (unaligned load may cross page boundary and cause crash)
+        const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 63) & static_cast<size_t>(~63));
+        for (; p != nextAligned; p++)
+            if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(*p) < 0x20)) {
+                is.src_ = is.dst_ = p;
+                return;
+            }
+
+        // The rest of string using SIMD
+        const __m512i dq = _mm512_set1_epi8('\"');
+        const __m512i bs = _mm512_set1_epi8('\\');
+        const __m512i sp = _mm512_set1_epi8(0x20);
+
+        for (;; p += 64) {
+            const __m512i s = _mm512_load_si512(reinterpret_cast<const void *>(p));
+            const uint64_t r = _mm512_cmpeq_epi8_mask(s, dq) | _mm512_cmpeq_epi8_mask(s, bs) | _mm512_cmplt_epu8_mask(s, sp);
+            if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
+                size_t length;
+#ifdef _MSC_VER         // Find the index of first escaped
+                unsigned long offset;
+                _BitScanForward64(&offset, r);
+                length = offset;
+#else
+                length = static_cast<size_t>(__builtin_ffsll(static_cast<long long>(r)) - 1);
+#endif
+                p += length;
+                break;
+            }
+        }
+
+        is.src_ = is.dst_ = p;
+    }
+
+#elif defined(RAPIDJSON_AVX2)
+    // StringStream -> StackStream<char>
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(StringStream& is, StackStream<char>& os) {
+        const char* p = is.src_;
+
+        // Scan one by one until alignment (unaligned load may cross page boundary and cause crash)
+        const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 31) & static_cast<size_t>(~31));
+        while (p != nextAligned)
+            if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(*p) < 0x20)) {
+                is.src_ = p;
+                return;
+            }
+            else
+                os.Put(*p++);
+
+        // The rest of string using SIMD
+        const __m256i dq = _mm256_set1_epi8('\"');
+        const __m256i bs = _mm256_set1_epi8('\\');
+        const __m256i sp = _mm256_set1_epi8(0x19);
+
+        for (;; p += 32) {
+            const __m256i s = _mm256_load_si256(reinterpret_cast<const __m256i *>(p));
+            const __m256i t1 = _mm256_cmpeq_epi8(s, dq);
+            const __m256i t2 = _mm256_cmpeq_epi8(s, bs);
+            const __m256i t3 = _mm256_cmpeq_epi8(_mm256_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x19) == 0x19
+            const __m256i x = _mm256_or_si256(_mm256_or_si256(t1, t2), t3);
+            const unsigned r = static_cast<unsigned>(_mm256_movemask_epi8(x));
+            if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
+                SizeType length;
+#ifdef _MSC_VER         // Find the index of first escaped
+                unsigned long offset;
+                _BitScanForward(&offset, r);
+                length = offset;
+#else
+                length = static_cast<SizeType>(__builtin_ffs(static_cast<int>(r)) - 1);
+#endif
+                char* q = reinterpret_cast<char*>(os.Push(length));
+                for (size_t i = 0; i < length; i++)
+                    q[i] = p[i];
+
+                p += length;
+                break;
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(os.Push(32)), s);
         }
 
-        RAPIDJSON_FORCEINLINE void* Push(SizeType count) {
-            length_ += count;
-            return stack_.template Push<Ch>(count);
-        }
+        is.src_ = p;
+    }
 
-        size_t Length() const { return length_; }
+    // InsituStringStream -> InsituStringStream
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(InsituStringStream& is, InsituStringStream& os) {
+        RAPIDJSON_ASSERT(&is == &os);
+        (void)os;
 
-        Ch* Pop() {
-            return stack_.template Pop<Ch>(length_);
+        if (is.src_ == is.dst_) {
+            SkipUnescapedString(is);
+            return;
         }
 
-    private:
-        StackStream(const StackStream&);
-        StackStream& operator=(const StackStream&);
-
-        internal::Stack<StackAllocator>& stack_;
-        SizeType length_;
-    };
-
-    // Parse string and generate String event. Different code paths for kParseInsituFlag.
-    template<unsigned parseFlags, typename InputStream, typename Handler>
-    void ParseString(InputStream& is, Handler& handler, bool isKey = false) {
-        internal::StreamLocalCopy<InputStream> copy(is);
-        InputStream& s(copy.s);
+        char* p = is.src_;
+        char *q = is.dst_;
 
-        RAPIDJSON_ASSERT(s.Peek() == '\"');
-        s.Take();  // Skip '\"'
+        // Scan one by one until alignment (unaligned load may cross page boundary and cause crash)
+        const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 31) & static_cast<size_t>(~31));
+        while (p != nextAligned)
+            if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(*p) < 0x20)) {
+                is.src_ = p;
+                is.dst_ = q;
+                return;
+            }
+            else
+                *q++ = *p++;
 
-        bool success = false;
-        if (parseFlags & kParseInsituFlag) {
-            typename InputStream::Ch *head = s.PutBegin();
-            ParseStringToStream<parseFlags, SourceEncoding, SourceEncoding>(s, s);
-            RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
-            size_t length = s.PutEnd(head) - 1;
-            RAPIDJSON_ASSERT(length <= 0xFFFFFFFF);
-            const typename TargetEncoding::Ch* const str = reinterpret_cast<typename TargetEncoding::Ch*>(head);
-            success = (isKey ? handler.Key(str, SizeType(length), false) : handler.String(str, SizeType(length), false));
-        }
-        else {
-            StackStream<typename TargetEncoding::Ch> stackStream(stack_);
-            ParseStringToStream<parseFlags, SourceEncoding, TargetEncoding>(s, stackStream);
-            RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
-            SizeType length = static_cast<SizeType>(stackStream.Length()) - 1;
-            const typename TargetEncoding::Ch* const str = stackStream.Pop();
-            success = (isKey ? handler.Key(str, length, true) : handler.String(str, length, true));
+        // The rest of string using SIMD
+        const __m256i dq = _mm256_set1_epi8('\"');
+        const __m256i bs = _mm256_set1_epi8('\\');
+        const __m256i sp = _mm256_set1_epi8(0x19);
+
+        for (;; p += 32, q += 32) {
+            const __m256i s = _mm256_load_si256(reinterpret_cast<const __m256i *>(p));
+            const __m256i t1 = _mm256_cmpeq_epi8(s, dq);
+            const __m256i t2 = _mm256_cmpeq_epi8(s, bs);
+            const __m256i t3 = _mm256_cmpeq_epi8(_mm256_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x19) == 0x19
+            const __m256i x = _mm256_or_si256(_mm256_or_si256(t1, t2), t3);
+            const unsigned r = static_cast<unsigned>(_mm256_movemask_epi8(x));
+            if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
+                size_t length;
+#ifdef _MSC_VER         // Find the index of first escaped
+                unsigned long offset;
+                _BitScanForward(&offset, r);
+                length = offset;
+#else
+                length = static_cast<size_t>(__builtin_ffs(static_cast<int>(r)) - 1);
+#endif
+                for (const char* pend = p + length; p != pend; )
+                    *q++ = *p++;
+                break;
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(q), s);
         }
-        if (RAPIDJSON_UNLIKELY(!success))
-            RAPIDJSON_PARSE_ERROR(kParseErrorTermination, s.Tell());
-    }
 
-    // Parse string to an output is
-    // This function handles the prefix/suffix double quotes, escaping, and optional encoding validation.
-    template<unsigned parseFlags, typename SEncoding, typename TEncoding, typename InputStream, typename OutputStream>
-    RAPIDJSON_FORCEINLINE void ParseStringToStream(InputStream& is, OutputStream& os) {
-//!@cond RAPIDJSON_HIDDEN_FROM_DOXYGEN
-#define Z16 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
-        static const char escape[256] = {
-            Z16, Z16, 0, 0,'\"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,'/',
-            Z16, Z16, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,'\\', 0, 0, 0,
-            0, 0,'\b', 0, 0, 0,'\f', 0, 0, 0, 0, 0, 0, 0,'\n', 0,
-            0, 0,'\r', 0,'\t', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-            Z16, Z16, Z16, Z16, Z16, Z16, Z16, Z16
-        };
-#undef Z16
-//!@endcond
+        is.src_ = p;
+        is.dst_ = q;
+    }
 
-        for (;;) {
-            // Scan and copy string before "\\\"" or < 0x20. This is an optional optimzation.
-            if (!(parseFlags & kParseValidateEncodingFlag))
-                ScanCopyUnescapedString(is, os);
+    // When read/write pointers are the same for insitu stream, just skip unescaped characters
+    static RAPIDJSON_FORCEINLINE void SkipUnescapedString(InsituStringStream& is) {
+        RAPIDJSON_ASSERT(is.src_ == is.dst_);
+        char* p = is.src_;
 
-            Ch c = is.Peek();
-            if (RAPIDJSON_UNLIKELY(c == '\\')) {    // Escape
-                size_t escapeOffset = is.Tell();    // For invalid escaping, report the inital '\\' as error offset
-                is.Take();
-                Ch e = is.Peek();
-                if ((sizeof(Ch) == 1 || unsigned(e) < 256) && RAPIDJSON_LIKELY(escape[static_cast<unsigned char>(e)])) {
-                    is.Take();
-                    os.Put(static_cast<typename TEncoding::Ch>(escape[static_cast<unsigned char>(e)]));
-                }
-                else if (RAPIDJSON_LIKELY(e == 'u')) {    // Unicode
-                    is.Take();
-                    unsigned codepoint = ParseHex4(is, escapeOffset);
-                    RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
-                    if (RAPIDJSON_UNLIKELY(codepoint >= 0xD800 && codepoint <= 0xDBFF)) {
-                        // Handle UTF-16 surrogate pair
-                        if (RAPIDJSON_UNLIKELY(!Consume(is, '\\') || !Consume(is, 'u')))
-                            RAPIDJSON_PARSE_ERROR(kParseErrorStringUnicodeSurrogateInvalid, escapeOffset);
-                        unsigned codepoint2 = ParseHex4(is, escapeOffset);
-                        RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
-                        if (RAPIDJSON_UNLIKELY(codepoint2 < 0xDC00 || codepoint2 > 0xDFFF))
-                            RAPIDJSON_PARSE_ERROR(kParseErrorStringUnicodeSurrogateInvalid, escapeOffset);
-                        codepoint = (((codepoint - 0xD800) << 10) | (codepoint2 - 0xDC00)) + 0x10000;
-                    }
-                    TEncoding::Encode(os, codepoint);
-                }
-                else
-                    RAPIDJSON_PARSE_ERROR(kParseErrorStringEscapeInvalid, escapeOffset);
-            }
-            else if (RAPIDJSON_UNLIKELY(c == '"')) {    // Closing double quote
-                is.Take();
-                os.Put('\0');   // null-terminate the string
+        // Scan one by one until alignment (unaligned load may cross page boundary and cause crash)
+        const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 31) & static_cast<size_t>(~31));
+        for (; p != nextAligned; p++)
+            if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(*p) < 0x20)) {
+                is.src_ = is.dst_ = p;
                 return;
             }
-            else if (RAPIDJSON_UNLIKELY(static_cast<unsigned>(c) < 0x20)) { // RFC 4627: unescaped = %x20-21 / %x23-5B / %x5D-10FFFF
-                if (c == '\0')
-                    RAPIDJSON_PARSE_ERROR(kParseErrorStringMissQuotationMark, is.Tell());
-                else
-                    RAPIDJSON_PARSE_ERROR(kParseErrorStringEscapeInvalid, is.Tell());
-            }
-            else {
-                size_t offset = is.Tell();
-                if (RAPIDJSON_UNLIKELY((parseFlags & kParseValidateEncodingFlag ?
-                    !Transcoder<SEncoding, TEncoding>::Validate(is, os) :
-                    !Transcoder<SEncoding, TEncoding>::Transcode(is, os))))
-                    RAPIDJSON_PARSE_ERROR(kParseErrorStringInvalidEncoding, offset);
+
+        // The rest of string using SIMD
+        const __m256i dq = _mm256_set1_epi8('\"');
+        const __m256i bs = _mm256_set1_epi8('\\');
+        const __m256i sp = _mm256_set1_epi8(0x19);
+
+        for (;; p += 32) {
+            const __m256i s = _mm256_load_si256(reinterpret_cast<const __m256i *>(p));
+            const __m256i t1 = _mm256_cmpeq_epi8(s, dq);
+            const __m256i t2 = _mm256_cmpeq_epi8(s, bs);
+            const __m256i t3 = _mm256_cmpeq_epi8(_mm256_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x19) == 0x19
+            const __m256i x = _mm256_or_si256(_mm256_or_si256(t1, t2), t3);
+            const unsigned r = static_cast<unsigned>(_mm256_movemask_epi8(x));
+            if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
+                size_t length;
+#ifdef _MSC_VER         // Find the index of first escaped
+                unsigned long offset;
+                _BitScanForward(&offset, r);
+                length = offset;
+#else
+                length = static_cast<size_t>(__builtin_ffs(static_cast<int>(r)) - 1);
+#endif
+                p += length;
+                break;
             }
         }
-    }
 
-    template<typename InputStream, typename OutputStream>
-    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(InputStream&, OutputStream&) {
-            // Do nothing for generic version
+        is.src_ = is.dst_ = p;
     }
 
-#if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
+#elif defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
     // StringStream -> StackStream<char>
     static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(StringStream& is, StackStream<char>& os) {
         const char* p = is.src_;
@@ -1082,6 +2398,14 @@ private:
         RAPIDJSON_FORCEINLINE Ch Take() { return is.Take(); }
 		  RAPIDJSON_FORCEINLINE void Push(char) {}
 
+        RAPIDJSON_FORCEINLINE bool TakePushDigits8(uint32_t* value) {
+            uint64_t word;
+            if (!TakeDigits8(is, &word))
+                return false;
+            *value = internal::ParseDigits8(word);
+            return true;
+        }
+
         size_t Tell() { return is.Tell(); }
         size_t Length() { return 0; }
         const char* Pop() { return 0; }
@@ -1108,6 +2432,15 @@ private:
             stackStream.Put(c);
         }
 
+        RAPIDJSON_FORCEINLINE bool TakePushDigits8(uint32_t* value) {
+            uint64_t word;
+            if (!TakeDigits8(Base::is, &word))
+                return false;
+            std::memcpy(stackStream.Push(8), &word, 8);
+            *value = internal::ParseDigits8(word);
+            return true;
+        }
+
         size_t Length() { return stackStream.Length(); }
 
         const char* Pop() {
@@ -1151,6 +2484,7 @@ private:
         uint64_t i64 = 0;
         bool use64bit = false;
         int significandDigit = 0;
+        uint32_t digits8;
         if (RAPIDJSON_UNLIKELY(s.Peek() == '0')) {
             i = 0;
             s.TakePush();
@@ -1158,6 +2492,12 @@ private:
         else if (RAPIDJSON_LIKELY(s.Peek() >= '1' && s.Peek() <= '9')) {
             i = static_cast<unsigned>(s.TakePush() - '0');
 
+            // One digit followed by eight cannot reach the overflow checks below.
+            if (s.TakePushDigits8(&digits8)) {
+                i = i * 100000000u + digits8;
+                significandDigit += 8;
+            }
+
             if (minus)
                 while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
                     if (RAPIDJSON_UNLIKELY(i >= 214748364)) { // 2^31 = 2147483648
@@ -1204,6 +2544,12 @@ private:
         // Parse 64bit int
         bool useDouble = false;
         if (use64bit) {
+            // At most ten digits followed by eight cannot reach the overflow checks below.
+            if (s.TakePushDigits8(&digits8)) {
+                i64 = i64 * 100000000u + digits8;
+                significandDigit += 8;
+            }
+
             if (minus)
                 while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
                      if (RAPIDJSON_UNLIKELY(i64 >= RAPIDJSON_UINT64_C2(0x0CCCCCCC, 0xCCCCCCCC))) // 2^63 = 9223372036854775808
@@ -1252,6 +2598,16 @@ private:
                 if (!use64bit)
                     i64 = i;
 
+                // Eight digits at once while the last of them would still pass the check below.
+                while (i64 < 900719925 && s.TakePushDigits8(&digits8)) {
+                    if (i64 != 0)
+                        significandDigit += 8;
+                    else if (digits8 != 0)
+                        significandDigit += static_cast<int>(internal::CountDecimalDigit32(digits8));
+                    i64 = i64 * 100000000u + digits8;
+                    expFrac -= 8;
+                }
+
                 while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
                     if (i64 > RAPIDJSON_UINT64_C2(0x1FFFFF, 0xFFFFFFFF)) // 2^53 - 1 for fast path
                         break;
@@ -1340,16 +2696,20 @@ private:
                 cont = handler.RawNumber(str, SizeType(length), false);
             }
             else {
-                SizeType numCharsToCopy = static_cast<SizeType>(s.Length());
-                StringStream srcStream(s.Pop());
-                StackStream<typename TargetEncoding::Ch> dstStream(stack_);
-                while (numCharsToCopy--) {
-                    Transcoder<UTF8<>, TargetEncoding>::Transcode(srcStream, dstStream);
+                // The characters of a number are ASCII, which are widened to TargetEncoding::Ch in place.
+                // Going backwards, each one is read before the copies of the others overwrite it.
+                typedef typename TargetEncoding::Ch TargetCh;
+                const SizeType length = static_cast<SizeType>(s.Length());
+                stack_.template Reserve<TargetCh>(length + 1);
+                const char* src = s.Pop();
+                TargetCh* str = reinterpret_cast<TargetCh*>(const_cast<char*>(src));
+                if (sizeof(TargetCh) > 1) {
+                    stack_.template Push<TargetCh>(length + 1);
+                    for (SizeType i = length + 1; i-- > 0; )
+                        str[i] = static_cast<TargetCh>(src[i]);
+                    stack_.template Pop<TargetCh>(length + 1);
                 }
-                dstStream.Put('\0');
-                const typename TargetEncoding::Ch* str = dstStream.Pop();
-                const SizeType length = static_cast<SizeType>(dstStream.Length()) - 1;
-                cont = handler.RawNumber(str, SizeType(length), true);
+                cont = handler.RawNumber(str, length, true);
             }
         }
         else {
@@ -1387,6 +2747,13 @@ private:
             RAPIDJSON_PARSE_ERROR(kParseErrorTermination, startOffset);
     }
 
+    // Check a number with the same errors as the other overload, without copying it
+    // or converting it precisely (the conversion result is discarded).
+    template<unsigned parseFlags, typename InputStream>
+    void ParseNumber(InputStream& is, ValidationHandler& handler) {
+        ParseNumber<parseFlags & ~static_cast<unsigned>(kParseFullPrecisionFlag | kParseNumbersAsStringsFlag), InputStream, ValidationHandler>(is, handler);
+    }
+
     // Parse any JSON value
     template<unsigned parseFlags, typename InputStream, typename Handler>
     void ParseValue(InputStream& is, Handler& handler) {
@@ -1668,12 +3035,25 @@ private:
             // Initialize and push the member/element count.
             *stack_.template Push<SizeType>(1) = 0;
             // Call handler
-            bool hr = (dst == IterativeParsingObjectInitialState) ? handler.StartObject() : handler.StartArray();
+            HandlerResult hr = (dst == IterativeParsingObjectInitialState) ? ToHandlerResult(handler.StartObject()) : ToHandlerResult(handler.StartArray());
             // On handler short circuits the parsing.
-            if (!hr) {
+            if (hr == kHandlerTerminate) {
                 RAPIDJSON_PARSE_ERROR_NORETURN(kParseErrorTermination, is.Tell());
                 return IterativeParsingErrorState;
             }
+            else if (hr == kHandlerSkip) {
+                // Drop the frame, skip the whole value and uncount it in the enclosing scope.
+                stack_.template Pop<SizeType>(2);
+                SkipNestedValue<parseFlags>(is, 0);
+                if (HasParseError())
+                    return IterativeParsingErrorState;
+                if (n == IterativeParsingStartState) {
+                    skipped_ = true;    // for a projection (see ParseProjectedValue())
+                    return IterativeParsingFinishState;
+                }
+                *stack_.template Top<SizeType>() = *stack_.template Top<SizeType>() - 1;
+                return n;
+            }
             else {
                 is.Take();
                 return dst;
@@ -1684,8 +3064,25 @@ private:
             ParseString<parseFlags>(is, handler, true);
             if (HasParseError())
                 return IterativeParsingErrorState;
-            else
-                return dst;
+            if (skipped_) {
+                // Skip the colon and the value, which is not counted.
+                skipped_ = false;
+                SkipWhitespaceAndComments<parseFlags>(is);
+                if (HasParseError())
+                    return IterativeParsingErrorState;
+                if (!Consume(is, ':')) {
+                    RAPIDJSON_PARSE_ERROR_NORETURN(kParseErrorObjectMissColon, is.Tell());
+                    return IterativeParsingErrorState;
+                }
+                SkipWhitespaceAndComments<parseFlags>(is);
+                if (!HasParseError())
+                    SkipValue<parseFlags>(is);
+                if (HasParseError())
+                    return IterativeParsingErrorState;
+                *stack_.template Top<SizeType>() = *stack_.template Top<SizeType>() - 1;
+                return IterativeParsingMemberValueState;
+            }
+            return dst;
 
         case IterativeParsingKeyValueDelimiterState:
             RAPIDJSON_ASSERT(token == ColonToken);
@@ -1818,6 +3215,51 @@ private:
         }
     }
 
+    static bool IsIterativeParsingDelimiterState(IterativeParsingState s) {
+        return s == IterativeParsingKeyValueDelimiterState || s == IterativeParsingMemberDelimiterState || s == IterativeParsingElementDelimiterState;
+    }
+
+    static bool IsIterativeParsingCompleteState(IterativeParsingState s) {
+        return s == IterativeParsingFinishState || s == IterativeParsingErrorState;
+    }
+
+    // Keeps the stack for RestoreIterativeParsing(); IterativeParseInit() clears it.
+    bool IterativeParseFail() {
+        state_ = IterativeParsingErrorState;
+        return false;
+    }
+
+protected:
+    //! State of token-by-token parsing before a call of IterativeParseNext().
+    struct IterativeParsingCheckpoint {
+        IterativeParsingState state;
+        size_t stackSize;
+        SizeType count;     //!< Member or element count of the innermost object or array.
+    };
+
+    IterativeParsingCheckpoint SaveIterativeParsing() const {
+        IterativeParsingCheckpoint c;
+        c.state = state_;
+        c.stackSize = stack_.GetSize();
+        c.count = stack_.Empty() ? 0 : *stack_.template Top<SizeType>();
+        return c;
+    }
+
+    //! Undo a call of IterativeParseNext() which failed or did not finish an object or array.
+    /*! Used by GenericPushReader to parse a token again when it has run out of input.
+        The events reported by the call cannot be undone.
+    */
+    void RestoreIterativeParsing(const IterativeParsingCheckpoint& c) {
+        RAPIDJSON_ASSERT(stack_.GetSize() >= c.stackSize);
+        parseResult_.Clear();
+        state_ = c.state;
+        stack_.template Pop<char>(stack_.GetSize() - c.stackSize);
+        if (!stack_.Empty())
+            *stack_.template Top<SizeType>() = c.count;
+    }
+
+private:
+
     template <unsigned parseFlags, typename InputStream, typename Handler>
     ParseResult IterativeParse(InputStream& is, Handler& handler) {
         parseResult_.Clear();
@@ -1853,9 +3295,90 @@ private:
         return parseResult_;
     }
 
+    // The structural index needs the whole text in memory, other streams are parsed iteratively.
+    // So are all streams without SIMD, for which classifying the text costs more than it saves.
+    template <unsigned parseFlags, typename InputStream, typename Handler>
+    ParseResult StructuralIndexParse(InputStream& is, Handler& handler) {
+        return IterativeParse<parseFlags>(is, handler);
+    }
+
+#if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
+    template <unsigned parseFlags, typename Handler>
+    ParseResult StructuralIndexParse(GenericStringStream<UTF8<> >& is, Handler& handler) {
+        return StructuralIndexParseString<parseFlags>(is, handler);
+    }
+
+    template <unsigned parseFlags, typename Handler>
+    ParseResult StructuralIndexParse(GenericInsituStringStream<UTF8<> >& is, Handler& handler) {
+        return StructuralIndexParseString<parseFlags>(is, handler);
+    }
+
+    // Stage one locates the structural characters (see internal::StructuralIndexer),
+    // stage two runs the iterative state machine and jumps from one structural character
+    // to the next instead of skipping whitespace byte by byte. Strings without backslashes
+    // or control characters are taken at once, unless they must be transcoded or validated.
+    template <unsigned parseFlags, typename InputStream, typename Handler>
+    ParseResult StructuralIndexParseString(InputStream& is, Handler& handler) {
+        if (parseFlags & kParseCommentsFlag)    // comments are not indexed
+            return IterativeParse<parseFlags>(is, handler);
+
+        const bool indexStrings = internal::IsSame<SourceEncoding, UTF8<> >::Value && internal::IsSame<TargetEncoding, UTF8<> >::Value
+            && !(parseFlags & kParseValidateEncodingFlag);
+        if (!structuralIndex_)
+            structuralIndex_ = RAPIDJSON_NEW(internal::Stack<StackAllocator>(stack_.HasAllocator() ? &stack_.GetAllocator() : 0, kDefaultStackCapacity));
+        parseResult_.Clear();
+        ClearStackOnExit scope(*this);
+        internal::StructuralIndexer<StackAllocator> indexer(is.src_, *structuralIndex_);
+        IterativeParsingState state = IterativeParsingStartState;
+
+        SkipToStructural(is, indexer);
+        while (is.Peek() != '\0') {
+            Token t = Tokenize(is.Peek());
+            IterativeParsingState n = Predict(state, t);
+            indexedStringEnd_ = indexStrings && t == StringToken ? indexer.StringEnd(is.src_) : 0;
+            IterativeParsingState d = Transit<parseFlags>(state, t, n, is, handler);
+
+            if (d == IterativeParsingErrorState) {
+                HandleError(state, is);
+                break;
+            }
+
+            state = d;
+
+            // Do not further consume streams if a root JSON has been parsed.
+            if ((parseFlags & kParseStopWhenDoneFlag) && state == IterativeParsingFinishState)
+                break;
+
+            SkipToStructural(is, indexer);
+        }
+
+        // Handle the end of file.
+        if (state != IterativeParsingFinishState)
+            HandleError(state, is);
+
+        return parseResult_;
+    }
+
+    // Only whitespace lies between a whitespace character and the next structural character.
+    // Anything else is left to SkipWhitespace() and the state machine, so errors are reported
+    // at the same offsets as by IterativeParse().
+    template <typename InputStream>
+    void SkipToStructural(InputStream& is, internal::StructuralIndexer<StackAllocator>& indexer) {
+        const char* s = indexer.Next(is.src_);
+        if (s && (s == is.src_ || *is.src_ == ' ' || *is.src_ == '\n' || *is.src_ == '\r' || *is.src_ == '\t'))
+            is.src_ += s - is.src_;
+        else
+            SkipWhitespace(is);
+    }
+#endif
+
     static const size_t kDefaultStackCapacity = 256;    //!< Default stack capacity in bytes for storing a single decoded string.
     internal::Stack<StackAllocator> stack_;  //!< A stack for storing decoded string temporarily during non-destructive parsing.
+    internal::Stack<StackAllocator>* structuralIndex_;  //!< Positions of structural characters for kParseStructuralIndexFlag, allocated on first use.
+    const char* indexedStringEnd_;  //!< Closing quote of the next string for kParseStructuralIndexFlag (see ParseIndexedString()), if known.
     ParseResult parseResult_;
+    IterativeParsingState state_;   //!< State of token-by-token parsing.
+    bool skipped_;                  //!< The handler asked to skip the current value (see kHandlerSkip).
 }; // class GenericReader
 
 //! Reader with UTF8 encoding and default allocator.
@@ -0,0 +1,639 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_SNAPSHOT_H_
+#define RAPIDJSON_SNAPSHOT_H_
+
+/*! \file snapshot.h */
+
+#include "document.h"
+
+#if RAPIDJSON_HAS_MMAP
+#include <fcntl.h>      // open
+#include <sys/stat.h>   // fstat
+#endif
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(switch-enum)
+#endif
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+template <typename Encoding>
+struct GenericSnapshotMember;
+
+template <typename Encoding, typename StackAllocator>
+class GenericSnapshotWriter;
+
+namespace internal {
+
+//! Header at the start of a snapshot image.
+struct SnapshotHeader {
+    char magic[4];      //!< "RJSS"
+    uint16_t byteOrder; //!< kSnapshotByteOrder in the byte order of the writer.
+    uint8_t version;    //!< kSnapshotVersion
+    uint8_t charSize;   //!< sizeof(Ch) of the encoding.
+    uint64_t size;      //!< Size of the image in bytes, including this header.
+};
+
+static const uint16_t kSnapshotByteOrder = 0x0102;
+static const uint8_t kSnapshotVersion = 1;
+
+} // namespace internal
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericSnapshotValue
+
+//! Read-only JSON value in a snapshot image written by GenericSnapshotWriter.
+/*! A snapshot image holds a whole value tree in one position-independent
+    buffer: every value is a 16-byte node, the elements of an array and the
+    members of an object are contiguous nodes, and objects, arrays and strings
+    refer to their contents by offsets from their own node. Strings (and object
+    names) are stored in the image, short ones inside their node.
+
+    So an image can be written to a file once and then used where it is loaded
+    or mapped into memory (see GenericSnapshotFile), without parsing or any
+    allocation. Values are only accessed through references into the image,
+    with the const query API of GenericValue:
+    \code
+    SnapshotWriter writer;
+    writer.Write(d);
+    fwrite(writer.GetImage(), 1, writer.GetSize(), fp);
+    // ...
+    SnapshotFile file("reference.snapshot");
+    if (file.IsOpen()) {
+        const SnapshotValue& root = file.GetRoot();
+        SnapshotValue::ConstMemberIterator itr = root.FindMember("hello");
+        // ...
+    }
+    \endcode
+
+    Objects with at least \ref RAPIDJSON_MEMBER_INDEX_THRESHOLD members have
+    a hash table of their names in the image, so that FindMember() takes
+    constant time on average.
+
+    \tparam Encoding Encoding of the strings.
+    \note An image can only be read with the byte order and \c sizeof(Ch) it
+        was written with, which Load() checks. The content of an image is
+        trusted; only load images written by GenericSnapshotWriter.
+*/
+template <typename Encoding>
+class GenericSnapshotValue {
+public:
+    typedef Encoding EncodingType;                              //!< Encoding type from template parameter.
+    typedef typename Encoding::Ch Ch;                           //!< Character type derived from Encoding.
+    typedef GenericSnapshotMember<Encoding> Member;             //!< Name-value pair in an object.
+    typedef const Member* ConstMemberIterator;                  //!< Constant member iterator for iterating in object.
+    typedef const GenericSnapshotValue* ConstValueIterator;     //!< Constant value iterator for iterating in array.
+    typedef GenericKeyRef<Ch> KeyRefType;                       //!< Reference to an object name with its hash.
+
+    //! Get the root value of a snapshot image.
+    /*! \param image Image written by GenericSnapshotWriter, aligned to 8 bytes.
+        \param size Size of the buffer of \c image in bytes.
+        \return The root value, or null if \c image is not a snapshot image
+            of this encoding and byte order, or is truncated.
+    */
+    static const GenericSnapshotValue* Load(const void* image, size_t size) {
+        const internal::SnapshotHeader* header = static_cast<const internal::SnapshotHeader*>(image);
+        if (!image || (reinterpret_cast<size_t>(image) & 7) != 0 ||
+            size < sizeof(internal::SnapshotHeader) + sizeof(GenericSnapshotValue) ||
+            std::memcmp(header->magic, "RJSS", 4) != 0 ||
+            header->byteOrder != internal::kSnapshotByteOrder ||
+            header->version != internal::kSnapshotVersion ||
+            header->charSize != sizeof(Ch) ||
+            header->size > size)
+            return 0;
+        return reinterpret_cast<const GenericSnapshotValue*>(header + 1);
+    }
+
+    //!@name Type
+    //@{
+
+    Type GetType()   const { return static_cast<Type>(flags_ & kTypeMask); }
+    bool IsNull()    const { return GetType() == kNullType; }
+    bool IsFalse()   const { return GetType() == kFalseType; }
+    bool IsTrue()    const { return GetType() == kTrueType; }
+    bool IsBool()    const { return IsFalse() || IsTrue(); }
+    bool IsObject()  const { return GetType() == kObjectType; }
+    bool IsArray()   const { return GetType() == kArrayType; }
+    bool IsNumber()  const { return GetType() == kNumberType; }
+    bool IsInt()     const { return (flags_ & kIntFlag) != 0; }
+    bool IsUint()    const { return (flags_ & kUintFlag) != 0; }
+    bool IsInt64()   const { return (flags_ & kInt64Flag) != 0; }
+    bool IsUint64()  const { return (flags_ & kUint64Flag) != 0; }
+    bool IsDouble()  const { return (flags_ & kDoubleFlag) != 0; }
+    bool IsString()  const { return GetType() == kStringType; }
+
+    //@}
+
+    //!@name Bool, Number and String
+    //@{
+
+    bool GetBool() const { RAPIDJSON_ASSERT(IsBool()); return IsTrue(); }
+
+    int GetInt() const          { RAPIDJSON_ASSERT(IsInt());    return static_cast<int>(static_cast<int64_t>(n_.u64)); }
+    unsigned GetUint() const    { RAPIDJSON_ASSERT(IsUint());   return static_cast<unsigned>(n_.u64); }
+    int64_t GetInt64() const    { RAPIDJSON_ASSERT(IsInt64());  return static_cast<int64_t>(n_.u64); }
+    uint64_t GetUint64() const  { RAPIDJSON_ASSERT(IsUint64()); return n_.u64; }
+
+    //! Get the value as double type.
+    /*! \note If the value is 64-bit integer type, it may lose precision.
+    */
+    double GetDouble() const {
+        RAPIDJSON_ASSERT(IsNumber());
+        if (IsDouble()) return n_.d;
+        if (IsInt64())  return static_cast<double>(static_cast<int64_t>(n_.u64));
+        return static_cast<double>(n_.u64);
+    }
+
+    float GetFloat() const { return static_cast<float>(GetDouble()); }
+
+    const Ch* GetString() const {
+        RAPIDJSON_ASSERT(IsString());
+        return (flags_ & kInlineFlag) ? n_.str : Data<Ch>();
+    }
+
+    //! Get the length of string.
+    SizeType GetStringLength() const { RAPIDJSON_ASSERT(IsString()); return length_; }
+
+    //@}
+
+    //!@name Array
+    //@{
+
+    SizeType Size() const { RAPIDJSON_ASSERT(IsArray()); return length_; }
+    bool Empty() const { RAPIDJSON_ASSERT(IsArray()); return length_ == 0; }
+
+    const GenericSnapshotValue& operator[](SizeType index) const {
+        RAPIDJSON_ASSERT(IsArray());
+        RAPIDJSON_ASSERT(index < length_);
+        return Begin()[index];
+    }
+
+    ConstValueIterator Begin() const { RAPIDJSON_ASSERT(IsArray()); return Data<GenericSnapshotValue>(); }
+    ConstValueIterator End() const { RAPIDJSON_ASSERT(IsArray()); return Data<GenericSnapshotValue>() + length_; }
+
+    //@}
+
+    //!@name Object
+    //@{
+
+    SizeType MemberCount() const { RAPIDJSON_ASSERT(IsObject()); return length_; }
+    bool ObjectEmpty() const { RAPIDJSON_ASSERT(IsObject()); return length_ == 0; }
+
+    ConstMemberIterator MemberBegin() const { RAPIDJSON_ASSERT(IsObject()); return Data<Member>(); }
+    ConstMemberIterator MemberEnd() const { RAPIDJSON_ASSERT(IsObject()); return Data<Member>() + length_; }
+
+    //! Find member by name.
+    /*! \param name Member name to be searched.
+        \return Iterator to member, if it exists. Otherwise returns \ref MemberEnd().
+        \note Linear time complexity, or constant on average with a member index (see \ref RAPIDJSON_MEMBER_INDEX_THRESHOLD).
+    */
+    ConstMemberIterator FindMember(const Ch* name) const { return DoFindMember(name, internal::StrLen(name)); }
+
+    //! Find member by name with its precomputed hash, e.g. from \ref RAPIDJSON_KEY.
+    ConstMemberIterator FindMember(const KeyRefType& name) const { return DoFindMember(name.s, name.length, name.hash); }
+
+    //! Find member by name, which may contain null characters.
+    template <typename SourceAllocator>
+    ConstMemberIterator FindMember(const GenericValue<Encoding, SourceAllocator>& name) const { return DoFindMember(name.GetString(), name.GetStringLength()); }
+
+    //! Find member by name of another snapshot.
+    ConstMemberIterator FindMember(const GenericSnapshotValue& name) const { return DoFindMember(name.GetString(), name.GetStringLength()); }
+
+#if RAPIDJSON_HAS_STDSTRING
+    //! Find member by string object name (with \ref RAPIDJSON_HAS_STDSTRING).
+    ConstMemberIterator FindMember(const std::basic_string<Ch>& name) const { return DoFindMember(name.data(), SizeType(name.size())); }
+#endif
+
+    //! Check whether a member exists in the object.
+    /*! \see FindMember() */
+    bool HasMember(const Ch* name) const { return FindMember(name) != MemberEnd(); }
+    bool HasMember(const KeyRefType& name) const { return FindMember(name) != MemberEnd(); }
+    template <typename SourceAllocator>
+    bool HasMember(const GenericValue<Encoding, SourceAllocator>& name) const { return FindMember(name) != MemberEnd(); }
+#if RAPIDJSON_HAS_STDSTRING
+    bool HasMember(const std::basic_string<Ch>& name) const { return FindMember(name) != MemberEnd(); }
+#endif
+
+    //! Get a value from an object associated with the name.
+    /*! \note The member must exist, as for GenericValue::operator[].
+        \see FindMember()
+    */
+    template <typename T>
+    RAPIDJSON_DISABLEIF_RETURN((internal::NotExpr<internal::IsSame<typename internal::RemoveConst<T>::Type, Ch> >),(const GenericSnapshotValue&)) operator[](T* name) const {
+        return MemberValue(FindMember(name));
+    }
+    const GenericSnapshotValue& operator[](const KeyRefType& name) const { return MemberValue(FindMember(name)); }
+    template <typename SourceAllocator>
+    const GenericSnapshotValue& operator[](const GenericValue<Encoding, SourceAllocator>& name) const { return MemberValue(FindMember(name)); }
+#if RAPIDJSON_HAS_STDSTRING
+    const GenericSnapshotValue& operator[](const std::basic_string<Ch>& name) const { return MemberValue(FindMember(name)); }
+#endif
+
+    //@}
+
+    //! Generate events of this value to a Handler.
+    /*! Strings are reported as copied, since they live in the image.
+        \param handler An object implementing concept Handler.
+    */
+    template <typename Handler>
+    bool Accept(Handler& handler) const {
+        switch (GetType()) {
+        case kNullType:     return handler.Null();
+        case kFalseType:    return handler.Bool(false);
+        case kTrueType:     return handler.Bool(true);
+
+        case kObjectType:
+            if (RAPIDJSON_UNLIKELY(!handler.StartObject()))
+                return false;
+            for (ConstMemberIterator m = MemberBegin(); m != MemberEnd(); ++m) {
+                if (RAPIDJSON_UNLIKELY(!handler.Key(m->name.GetString(), m->name.GetStringLength(), true)))
+                    return false;
+                if (RAPIDJSON_UNLIKELY(!m->value.Accept(handler)))
+                    return false;
+            }
+            return handler.EndObject(length_);
+
+        case kArrayType:
+            if (RAPIDJSON_UNLIKELY(!handler.StartArray()))
+                return false;
+            for (ConstValueIterator v = Begin(); v != End(); ++v)
+                if (RAPIDJSON_UNLIKELY(!v->Accept(handler)))
+                    return false;
+            return handler.EndArray(length_);
+
+        case kStringType:
+            return handler.String(GetString(), GetStringLength(), true);
+
+        default:
+            RAPIDJSON_ASSERT(GetType() == kNumberType);
+            if (IsDouble())         return handler.Double(n_.d);
+            else if (IsInt())       return handler.Int(GetInt());
+            else if (IsUint())      return handler.Uint(GetUint());
+            else if (IsInt64())     return handler.Int64(GetInt64());
+            else                    return handler.Uint64(n_.u64);
+        }
+    }
+
+private:
+    template <typename, typename> friend class GenericSnapshotWriter;
+
+    enum {
+        kTypeMask   = 0x07,     //!< Type of the value.
+        kIntFlag    = 0x08,     //!< Same number flags as GenericValue.
+        kUintFlag   = 0x10,
+        kInt64Flag  = 0x20,
+        kUint64Flag = 0x40,
+        kDoubleFlag = 0x80,
+        kInlineFlag = 0x100,    //!< String in n_.str.
+        kIndexFlag  = 0x200     //!< Object with a hash table of its names behind the members.
+    };
+
+    // Number of characters of a string in n_.str, including the terminating null.
+    static const SizeType kInlineCapacity = sizeof(uint64_t) / sizeof(Ch);
+
+    // Hash table behind the members of an object with kIndexFlag, followed by mask + 1 slots.
+    struct MemberIndex {
+        uint32_t mask;      //!< Number of slots - 1, the number of slots is a power of two.
+        uint32_t reserved;
+    };
+
+    struct MemberIndexSlot {
+        uint32_t hash;
+        uint32_t index;     //!< Index of the member + 1, or 0 for an empty slot.
+    };
+
+    GenericSnapshotValue() : flags_(kNullType), length_(0) { n_.u64 = 0; }
+
+    // A value is only valid at its place in the image.
+    GenericSnapshotValue(const GenericSnapshotValue&);
+    GenericSnapshotValue& operator=(const GenericSnapshotValue&);
+
+    template <typename T>
+    const T* Data() const { return reinterpret_cast<const T*>(reinterpret_cast<const char*>(this) + n_.offset); }
+
+    const GenericSnapshotValue& MemberValue(ConstMemberIterator m) const {
+        if (m != MemberEnd())
+            return m->value;
+        RAPIDJSON_ASSERT(false);    // see GenericValue::operator[]
+        static const GenericSnapshotValue nullValue;
+        return nullValue;
+    }
+
+    ConstMemberIterator DoFindMember(const Ch* name, SizeType length) const {
+        RAPIDJSON_ASSERT(IsObject());
+        if (flags_ & kIndexFlag)
+            return DoFindMember(name, length, static_cast<SizeType>(internal::StrHash(name, length)));
+        for (ConstMemberIterator m = MemberBegin(); m != MemberEnd(); ++m)
+            if (m->name.length_ == length && std::memcmp(m->name.GetString(), name, length * sizeof(Ch)) == 0)
+                return m;
+        return MemberEnd();
+    }
+
+    ConstMemberIterator DoFindMember(const Ch* name, SizeType length, SizeType hash) const {
+        RAPIDJSON_ASSERT(IsObject());
+        if (!(flags_ & kIndexFlag))
+            return DoFindMember(name, length);
+        const Member* members = MemberBegin();
+        const MemberIndex* index = reinterpret_cast<const MemberIndex*>(members + length_);
+        const MemberIndexSlot* slots = reinterpret_cast<const MemberIndexSlot*>(index + 1);
+        for (uint32_t s = hash & index->mask; slots[s].index; s = (s + 1) & index->mask) {
+            const Member* m = members + slots[s].index - 1;
+            if (slots[s].hash == hash && m->name.length_ == length && std::memcmp(m->name.GetString(), name, length * sizeof(Ch)) == 0)
+                return m;
+        }
+        return MemberEnd();
+    }
+
+    uint32_t flags_;        //!< Type and flags.
+    uint32_t length_;       //!< Length of a string, or size of an array or object.
+    union {
+        int64_t offset;             //!< Offset of the contents of a string, array or object from this node.
+        uint64_t u64;               //!< Integer, as uint64_t bits of its int64_t if signed.
+        double d;
+        Ch str[kInlineCapacity];    //!< String with kInlineFlag.
+    } n_;
+};
+
+//! Name-value pair in an object of a snapshot image.
+template <typename Encoding>
+struct GenericSnapshotMember {
+    GenericSnapshotValue<Encoding> name;    //!< name of member (must be a string)
+    GenericSnapshotValue<Encoding> value;   //!< value of member.
+};
+
+//! GenericSnapshotValue with UTF8 encoding
+typedef GenericSnapshotValue<UTF8<> > SnapshotValue;
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericSnapshotWriter
+
+//! Writer of a value tree into a snapshot image.
+/*! \tparam Encoding Encoding of the strings, which is the encoding of the written values.
+    \tparam StackAllocator Allocator for the buffer of the image.
+    \see GenericSnapshotValue
+*/
+template <typename Encoding, typename StackAllocator = CrtAllocator>
+class GenericSnapshotWriter {
+public:
+    typedef typename Encoding::Ch Ch;                       //!< Character type derived from Encoding.
+    typedef GenericSnapshotValue<Encoding> SnapshotValueType;   //!< Value type of the image.
+
+    //! Constructor
+    /*! \param allocator Optional allocator for the buffer of the image.
+        \param capacity Initial capacity of the buffer in bytes.
+    */
+    explicit GenericSnapshotWriter(StackAllocator* allocator = 0, size_t capacity = kDefaultCapacity) : image_(allocator, capacity) {}
+
+    //! Write the image of a value and its subtree, replacing the previous image.
+    /*! Objects and arrays deferred by GenericDocument::ParseLazy() are expanded. */
+    template <typename SourceAllocator>
+    void Write(const GenericValue<Encoding, SourceAllocator>& value) {
+        image_.Clear();
+        internal::SnapshotHeader* header = image_.template Push<internal::SnapshotHeader>();
+        std::memcpy(header->magic, "RJSS", 4);
+        header->byteOrder = internal::kSnapshotByteOrder;
+        header->version = internal::kSnapshotVersion;
+        header->charSize = sizeof(Ch);
+        header->size = 0;
+        WriteValue(value, Allocate(sizeof(SnapshotValueType)));
+        image_.template Bottom<internal::SnapshotHeader>()->size = image_.GetSize();
+    }
+
+    //! Get the image, to be stored or passed to GenericSnapshotValue::Load().
+    const void* GetImage() const { return image_.template Bottom<char>(); }
+
+    //! Get the size of the image in bytes.
+    size_t GetSize() const { return image_.GetSize(); }
+
+    //! Get the root value of the image.
+    const SnapshotValueType& GetRoot() const {
+        RAPIDJSON_ASSERT(GetSize() > 0);
+        return *SnapshotValueType::Load(GetImage(), GetSize());
+    }
+
+    //! Release the image.
+    void Clear() {
+        image_.Clear();
+        image_.ShrinkToFit();
+    }
+
+private:
+    typedef typename SnapshotValueType::Member Member;
+    typedef typename SnapshotValueType::MemberIndex MemberIndex;
+    typedef typename SnapshotValueType::MemberIndexSlot MemberIndexSlot;
+
+    // Prohibit copy constructor & assignment operator.
+    GenericSnapshotWriter(const GenericSnapshotWriter&);
+    GenericSnapshotWriter& operator=(const GenericSnapshotWriter&);
+
+    SnapshotValueType& Node(size_t offset) { return *reinterpret_cast<SnapshotValueType*>(image_.template Bottom<char>() + offset); }
+
+    //! Append zeroed bytes, keeping the image aligned to 8 bytes, and return their offset.
+    size_t Allocate(size_t size) {
+        size = (size + 7u) & ~static_cast<size_t>(7u);
+        const size_t offset = image_.GetSize();
+        std::memset(image_.template Push<char>(size), 0, size);
+        return offset;
+    }
+
+    //! Write a value into the node at an offset, followed by its contents.
+    template <typename SourceAllocator>
+    void WriteValue(const GenericValue<Encoding, SourceAllocator>& value, size_t node) {
+        uint32_t flags = static_cast<uint32_t>(value.GetType());
+        uint32_t length = 0;
+        size_t data = node;
+        switch (value.GetType()) {
+        case kObjectType: {
+                length = value.MemberCount();
+                const bool indexed = length >= static_cast<SizeType>(RAPIDJSON_MEMBER_INDEX_THRESHOLD);
+                uint32_t slotCount = 1;
+                while (indexed && slotCount < length * 2)     // load factor at most 0.5
+                    slotCount *= 2;
+                data = Allocate(length * sizeof(Member) + (indexed ? sizeof(MemberIndex) + slotCount * sizeof(MemberIndexSlot) : 0));
+                size_t m = data;
+                for (typename GenericValue<Encoding, SourceAllocator>::ConstMemberIterator itr = value.MemberBegin(); itr != value.MemberEnd(); ++itr, m += sizeof(Member)) {
+                    WriteValue(itr->name, m);
+                    WriteValue(itr->value, m + sizeof(SnapshotValueType));
+                }
+                if (indexed) {
+                    flags |= SnapshotValueType::kIndexFlag;
+                    BuildMemberIndex(data, length, slotCount);
+                }
+            }
+            break;
+
+        case kArrayType:
+            length = value.Size();
+            data = Allocate(length * sizeof(SnapshotValueType));
+            for (SizeType i = 0; i < length; i++)
+                WriteValue(value[i], data + i * sizeof(SnapshotValueType));
+            break;
+
+        case kStringType:
+            length = value.GetStringLength();
+            if (length < SnapshotValueType::kInlineCapacity) {
+                flags |= SnapshotValueType::kInlineFlag;
+                std::memcpy(Node(node).n_.str, value.GetString(), length * sizeof(Ch));
+                Node(node).flags_ = flags;
+                Node(node).length_ = length;
+                return;
+            }
+            data = Allocate((length + 1) * sizeof(Ch));
+            std::memcpy(image_.template Bottom<char>() + data, value.GetString(), length * sizeof(Ch));
+            break;
+
+        case kNumberType:
+            if (value.IsInt())      flags |= SnapshotValueType::kIntFlag;
+            if (value.IsUint())     flags |= SnapshotValueType::kUintFlag;
+            if (value.IsInt64())    flags |= SnapshotValueType::kInt64Flag;
+            if (value.IsUint64())   flags |= SnapshotValueType::kUint64Flag;
+            if (value.IsDouble()) {
+                flags |= SnapshotValueType::kDoubleFlag;
+                Node(node).n_.d = value.GetDouble();
+            }
+            else
+                Node(node).n_.u64 = value.IsInt64() ? static_cast<uint64_t>(value.GetInt64()) : value.GetUint64();
+            Node(node).flags_ = flags;
+            return;
+
+        default:
+            Node(node).flags_ = flags;
+            return;
+        }
+        SnapshotValueType& v = Node(node);
+        v.flags_ = flags;
+        v.length_ = length;
+        v.n_.offset = static_cast<int64_t>(data - node);
+    }
+
+    void BuildMemberIndex(size_t data, uint32_t count, uint32_t slotCount) {
+        const Member* members = reinterpret_cast<const Member*>(image_.template Bottom<char>() + data);
+        MemberIndex* index = reinterpret_cast<MemberIndex*>(image_.template Bottom<char>() + data + count * sizeof(Member));
+        MemberIndexSlot* slots = reinterpret_cast<MemberIndexSlot*>(index + 1);
+        index->mask = slotCount - 1;
+        for (uint32_t i = 0; i < count; i++) {
+            const uint32_t hash = static_cast<SizeType>(internal::StrHash(members[i].name.GetString(), members[i].name.length_));
+            uint32_t s = hash & index->mask;
+            while (slots[s].index)
+                s = (s + 1) & index->mask;
+            slots[s].hash = hash;
+            slots[s].index = i + 1;
+        }
+    }
+
+    static const size_t kDefaultCapacity = 65536;
+    internal::Stack<StackAllocator> image_;
+};
+
+//! GenericSnapshotWriter with UTF8 encoding
+typedef GenericSnapshotWriter<UTF8<> > SnapshotWriter;
+
+#if RAPIDJSON_HAS_MMAP
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericSnapshotFile
+
+//! Snapshot image in a file, mapped read-only into memory.
+/*! Opening maps the file without reading it; pages are read by the OS as
+    values are accessed, and are shared by processes mapping the same file.
+    \tparam Encoding Encoding of the strings.
+    \note Requires \ref RAPIDJSON_HAS_MMAP.
+    \see GenericSnapshotValue
+*/
+template <typename Encoding>
+class GenericSnapshotFile {
+public:
+    typedef GenericSnapshotValue<Encoding> ValueType;   //!< Value type of the image.
+
+    GenericSnapshotFile() : image_(0), size_(0), root_(0) {}
+
+    //! Constructor opening a file.
+    /*! \see Open() */
+    explicit GenericSnapshotFile(const char* path) : image_(0), size_(0), root_(0) { Open(path); }
+
+    ~GenericSnapshotFile() { Close(); }
+
+    //! Map a file written from GenericSnapshotWriter::GetImage().
+    /*! \return Whether the file could be mapped and is a snapshot image (see GenericSnapshotValue::Load()).
+    */
+    bool Open(const char* path) {
+        Close();
+        const int fd = open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* image = mmap(0, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (image != MAP_FAILED) {
+                image_ = image;
+                size_ = static_cast<size_t>(st.st_size);
+            }
+        }
+        close(fd);
+        if (image_ && !(root_ = ValueType::Load(image_, size_)))
+            Close();
+        return root_ != 0;
+    }
+
+    //! Unmap the file, invalidating all values.
+    void Close() {
+        if (image_)
+            munmap(image_, size_);
+        image_ = 0;
+        size_ = 0;
+        root_ = 0;
+    }
+
+    bool IsOpen() const { return root_ != 0; }
+
+    //! Get the root value of the image.
+    const ValueType& GetRoot() const { RAPIDJSON_ASSERT(IsOpen()); return *root_; }
+
+    //! Get the size of the file in bytes.
+    size_t GetSize() const { return size_; }
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    GenericSnapshotFile(const GenericSnapshotFile&);
+    GenericSnapshotFile& operator=(const GenericSnapshotFile&);
+
+    void* image_;
+    size_t size_;
+    const ValueType* root_;
+};
+
+//! GenericSnapshotFile with UTF8 encoding
+typedef GenericSnapshotFile<UTF8<> > SnapshotFile;
+
+#endif // RAPIDJSON_HAS_MMAP
+
+RAPIDJSON_NAMESPACE_END
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_SNAPSHOT_H_
@@ -16,6 +16,7 @@
 #define RAPIDJSON_WRITER_H_
 
 #include "stream.h"
+#include "internal/meta.h"
 #include "internal/stack.h"
 #include "internal/strfunc.h"
 #include "internal/dtoa.h"
@@ -27,7 +28,12 @@
 #include <intrin.h>
 #pragma intrinsic(_BitScanForward)
 #endif
-#ifdef RAPIDJSON_SSE42
+#ifdef RAPIDJSON_SIMD
+#include "internal/simd.h"
+#endif
+#ifdef RAPIDJSON_SIMD_DISPATCH
+// All kernels come from internal/simd.h
+#elif defined(RAPIDJSON_SSE42)
 #include <nmmintrin.h>
 #elif defined(RAPIDJSON_SSE2)
 #include <emmintrin.h>
@@ -143,6 +149,11 @@ public:
         return hasRoot_ && level_stack_.Empty();
     }
 
+#if RAPIDJSON_MEMORY_STATS
+    //! Get the highest size in bytes of the stack of nesting levels (see \ref RAPIDJSON_MEMORY_STATS).
+    size_t GetLevelStackPeakSize() const { return level_stack_.GetPeakSize(); }
+#endif
+
     int GetMaxDecimalPlaces() const {
         return maxDecimalPlaces_;
     }
@@ -375,9 +386,16 @@ protected:
         else
             PutReserve(*os_, 2 + length * 12);  // "\uxxxx\uyyyy..."
 
+        bool validate = (writeFlags & kWriteValidateEncodingFlag) != 0;
+#ifdef RAPIDJSON_SIMD
+        // Validate UTF-8 as a whole, after which it can be scanned and copied without checks.
+        if (validate && internal::IsSame<SourceEncoding, UTF8<> >::Value && internal::IsSame<TargetEncoding, UTF8<> >::Value)
+            validate = !internal::ValidateUtf8(reinterpret_cast<const char*>(str), reinterpret_cast<const char*>(str + length));
+#endif
+
         PutUnsafe(*os_, '\"');
         GenericStringStream<SourceEncoding> is(str);
-        while (ScanWriteUnescapedString(is, length)) {
+        while (validate ? RAPIDJSON_LIKELY(is.Tell() < length) : ScanWriteUnescapedString(is, length)) {
             const Ch c = is.Peek();
             if (!TargetEncoding::supportUnicode && static_cast<unsigned>(c) >= 0x80) {
                 // Unicode escaping
@@ -421,7 +439,7 @@ protected:
                     PutUnsafe(*os_, hexDigits[static_cast<unsigned char>(c) & 0xF]);
                 }
             }
-            else if (RAPIDJSON_UNLIKELY(!(writeFlags & kWriteValidateEncodingFlag ? 
+            else if (RAPIDJSON_UNLIKELY(!(validate ?
                 Transcoder<SourceEncoding, TargetEncoding>::Validate(is, *os_) :
                 Transcoder<SourceEncoding, TargetEncoding>::TranscodeUnsafe(is, *os_))))
                 return false;
@@ -548,7 +566,24 @@ inline bool Writer<StringBuffer>::WriteDouble(double d) {
     return true;
 }
 
-#if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
+#if defined(RAPIDJSON_SIMD_DISPATCH)
+template<>
+inline bool Writer<StringBuffer>::ScanWriteUnescapedString(StringStream& is, size_t length) {
+    if (length < 16)
+        return RAPIDJSON_LIKELY(is.Tell() < length);
+
+    if (!RAPIDJSON_LIKELY(is.Tell() < length))
+        return false;
+
+    const char* p = is.src_;
+    const char* q = internal::GetSimdKernels().scanUnescapedBounded(p, is.head_ + length);
+    const size_t len = static_cast<size_t>(q - p);
+    std::memcpy(os_->PushUnsafe(len), p, len);
+
+    is.src_ = q;
+    return RAPIDJSON_LIKELY(is.Tell() < length);
+}
+#elif defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
 template<>
 inline bool Writer<StringBuffer>::ScanWriteUnescapedString(StringStream& is, size_t length) {
     if (length < 16)
@@ -609,7 +644,7 @@ inline bool Writer<StringBuffer>::ScanWriteUnescapedString(StringStream& is, siz
     is.src_ = p;
     return RAPIDJSON_LIKELY(is.Tell() < length);
 }
-#endif // defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
+#endif // defined(RAPIDJSON_SIMD_DISPATCH)
 
 RAPIDJSON_NAMESPACE_END
 
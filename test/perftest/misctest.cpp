@@ -79,6 +79,21 @@ TEST_F(Misc, Hoehrmann_IsUTF8) {
     }
 }
 
+#ifdef RAPIDJSON_SIMD
+TEST_F(Misc, RapidJson_ValidateUtf8_Scalar) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        EXPECT_TRUE(rapidjson::internal::ValidateUtf8_Scalar(json_, json_ + length_));
+    }
+}
+
+// The lookup kernel of the compile-time SIMD level
+TEST_F(Misc, RapidJson_ValidateUtf8) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        EXPECT_TRUE(rapidjson::internal::ValidateUtf8(json_, json_ + length_));
+    }
+}
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 // CountDecimalDigit: Count number of decimal places
 
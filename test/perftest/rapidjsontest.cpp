@@ -18,13 +18,21 @@
 
 #include "rapidjson/rapidjson.h"
 #include "rapidjson/document.h"
+#include "rapidjson/pointer.h"
 #include "rapidjson/prettywriter.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/filereadstream.h"
 #include "rapidjson/encodedstream.h"
 #include "rapidjson/memorystream.h"
-
-#ifdef RAPIDJSON_SSE2
+#include "rapidjson/snapshot.h"
+#include "rapidjson/msgpack.h"
+#include "rapidjson/cbor.h"
+
+#ifdef RAPIDJSON_AVX512
+#define SIMD_SUFFIX(name) name##_AVX512
+#elif defined(RAPIDJSON_AVX2)
+#define SIMD_SUFFIX(name) name##_AVX2
+#elif defined(RAPIDJSON_SSE2)
 #define SIMD_SUFFIX(name) name##_SSE2
 #elif defined(RAPIDJSON_SSE42)
 #define SIMD_SUFFIX(name) name##_SSE42
@@ -133,6 +141,87 @@ TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_FullPrecision)) {
     }
 }
 
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_FullPrecision_Floats)) {
+    for (size_t i = 0; i < kTrialCount * 10; i++) {
+        StringStream s(types_[1]);
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse<kParseFullPrecisionFlag>(s, h));
+    }
+}
+
+// Random 10 to 19 digit integers, like ids and timestamps.
+static std::string LongIntegersJson() {
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    writer.StartArray();
+    uint64_t x = RAPIDJSON_UINT64_C2(0x9E3779B9, 0x7F4A7C15);
+    for (int i = 0; i < 10000; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        writer.Uint64(x % RAPIDJSON_UINT64_C2(0x8AC72304, 0x89E80000) / (i % 10 == 0 ? 1 : 10) + 1000000000u);
+    }
+    writer.EndArray();
+    return std::string(sb.GetString(), sb.GetSize());
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_LongIntegers)) {
+    const std::string json = LongIntegersJson();
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(json.c_str());
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse(s, h));
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParseInsitu_DummyHandler_LongIntegers)) {
+    const std::string json = LongIntegersJson();
+    char* buffer = static_cast<char*>(malloc(json.size() + 1));
+    for (size_t i = 0; i < kTrialCount; i++) {
+        memcpy(buffer, json.c_str(), json.size() + 1);
+        InsituStringStream s(buffer);
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse<kParseInsituFlag>(s, h));
+    }
+    free(buffer);
+}
+
+// Shortest round-trip representations of random doubles, mostly 16-17 digits with large exponents.
+static std::string RandomDoublesJson() {
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    writer.StartArray();
+    uint64_t x = RAPIDJSON_UINT64_C2(0x9E3779B9, 0x7F4A7C15);
+    for (int i = 0; i < 10000; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        internal::Double d(x & RAPIDJSON_UINT64_C2(0x7FEFFFFF, 0xFFFFFFFF));
+        writer.Double(d.Value());
+    }
+    writer.EndArray();
+    return std::string(sb.GetString(), sb.GetSize());
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_FullPrecision_RandomDoubles)) {
+    const std::string json = RandomDoublesJson();
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(json.c_str());
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse<kParseFullPrecisionFlag>(s, h));
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_RandomDoubles)) {
+    const std::string json = RandomDoublesJson();
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(json.c_str());
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse(s, h));
+    }
+}
+
 TEST_F(RapidJson, SIMD_SUFFIX(ReaderParseIterative_DummyHandler)) {
     for (size_t i = 0; i < kTrialCount; i++) {
         StringStream s(json_);
@@ -152,6 +241,25 @@ TEST_F(RapidJson, SIMD_SUFFIX(ReaderParseIterativeInsitu_DummyHandler)) {
     }
 }
 
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParseStructuralIndex_DummyHandler)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(json_);
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse<kParseStructuralIndexFlag>(s, h));
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParseStructuralIndexInsitu_DummyHandler)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        memcpy(temp_, json_, length_ + 1);
+        InsituStringStream s(temp_);
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse<kParseStructuralIndexFlag|kParseInsituFlag>(s, h));
+    }
+}
+
 TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_ValidateEncoding)) {
     for (size_t i = 0; i < kTrialCount; i++) {
         StringStream s(json_);
@@ -161,6 +269,30 @@ TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_ValidateEncoding)) {
     }
 }
 
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderValidate)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(json_);
+        Reader reader;
+        EXPECT_TRUE(reader.Validate(s));
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderValidate_ValidateEncoding)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(json_);
+        Reader reader;
+        EXPECT_TRUE(reader.Validate<kParseValidateEncodingFlag>(s));
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderValidate_StructuralIndex)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(json_);
+        Reader reader;
+        EXPECT_TRUE(reader.Validate<kParseStructuralIndexFlag>(s));
+    }
+}
+
 TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseInsitu_MemoryPoolAllocator)) {
     for (size_t i = 0; i < kTrialCount; i++) {
         memcpy(temp_, json_, length_ + 1);
@@ -214,6 +346,154 @@ TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseIterative_MemoryPoolAllocator)) {
     }
 }
 
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseStructuralIndex_MemoryPoolAllocator)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.Parse<kParseStructuralIndexFlag>(json_);
+        ASSERT_TRUE(doc.IsObject());
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseLazy_MemoryPoolAllocator)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.ParseLazy(json_);
+        ASSERT_TRUE(doc.IsObject());
+    }
+}
+
+// Reading one string member, eagerly and lazily.
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParse_SparseAccess)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.Parse(json_);
+        ASSERT_TRUE(doc["key"].IsString());
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseLazy_SparseAccess)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.ParseLazy(json_);
+        ASSERT_TRUE(doc["key"].IsString());
+    }
+}
+
+// Parsing random doubles and writing them back, with numbers converted eagerly and lazily.
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParse_RandomDoubles)) {
+    const std::string json = RandomDoublesJson();
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.Parse<kParseFullPrecisionFlag>(json.c_str());
+        ASSERT_TRUE(doc.IsArray());
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseLazyNumbers_RandomDoubles)) {
+    const std::string json = RandomDoublesJson();
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.Parse<kParseLazyNumbersFlag>(json.c_str());
+        ASSERT_TRUE(doc.IsArray());
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseWrite_RandomDoubles)) {
+    const std::string json = RandomDoublesJson();
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.Parse<kParseFullPrecisionFlag>(json.c_str());
+        StringBuffer sb;
+        Writer<StringBuffer> writer(sb);
+        doc.Accept(writer);
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseLazyNumbersWrite_RandomDoubles)) {
+    const std::string json = RandomDoublesJson();
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.Parse<kParseLazyNumbersFlag>(json.c_str());
+        StringBuffer sb;
+        Writer<StringBuffer> writer(sb);
+        doc.Accept(writer);
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseLazyNumbers_MemoryPoolAllocator)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.Parse<kParseLazyNumbersFlag>(json_);
+        ASSERT_TRUE(doc.IsObject());
+    }
+}
+
+// Strings without escapes referring to the read-only text, instead of being copied.
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseStringRefs_MemoryPoolAllocator)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.Parse<kParseStringRefsFlag>(json_);
+        ASSERT_TRUE(doc.IsObject());
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParse_Guids)) {
+    for (size_t i = 0; i < kTrialCount * 10; i++) {
+        Document doc;
+        doc.Parse(types_[2]);
+        ASSERT_TRUE(doc.IsArray());
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseStringRefs_Guids)) {
+    for (size_t i = 0; i < kTrialCount * 10; i++) {
+        Document doc;
+        doc.Parse<kParseStringRefsFlag>(types_[2]);
+        ASSERT_TRUE(doc.IsArray());
+    }
+}
+
+// Reading a few members, with the rest of the text skipped by a projection.
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParse_Projection)) {
+    Pointer pointers[] = { Pointer("/key"), Pointer("/a/id"), Pointer("/a/name"), Pointer("/z/id"), Pointer("/z/name") };
+    Projection projection(pointers, sizeof(pointers) / sizeof(pointers[0]));
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.Parse(json_, projection);
+        ASSERT_TRUE(doc["key"].IsString());
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_Projection)) {
+    Pointer pointers[] = { Pointer("/key"), Pointer("/a/id"), Pointer("/a/name"), Pointer("/z/id"), Pointer("/z/name") };
+    Projection projection(pointers, sizeof(pointers) / sizeof(pointers[0]));
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(json_);
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse(s, h, projection));
+    }
+}
+
+// Skips the objects and arrays below the members of the root.
+struct SkipNestedHandler : BaseReaderHandler<UTF8<>, SkipNestedHandler> {
+    SkipNestedHandler() : depth() {}
+    HandlerResult StartObject() { return depth == 2 ? kHandlerSkip : (++depth, kHandlerContinue); }
+    HandlerResult StartArray() { return depth == 2 ? kHandlerSkip : (++depth, kHandlerContinue); }
+    bool EndObject(SizeType) { --depth; return true; }
+    bool EndArray(SizeType) { --depth; return true; }
+    int depth;
+};
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_Skip)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(json_);
+        SkipNestedHandler h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse(s, h));
+    }
+}
+
 TEST_F(RapidJson, SIMD_SUFFIX(DocumentParse_CrtAllocator)) {
     for (size_t i = 0; i < kTrialCount; i++) {
         memcpy(temp_, json_, length_ + 1);
@@ -223,6 +503,60 @@ TEST_F(RapidJson, SIMD_SUFFIX(DocumentParse_CrtAllocator)) {
     }
 }
 
+// Large document of records, where page faults and TLB misses of the DOM matter.
+// It is generated once for the test case, so that its time is not counted in the first test.
+class RapidJsonLarge : public RapidJson {
+public:
+    static void SetUpTestCase() {
+        char buffer[256];
+        largeJson_ = new std::string("[");
+        for (int i = 0; i < 1000000; i++) {
+            sprintf(buffer, "%s{\"id\":%d,\"name\":\"record %d\",\"score\":%d.%d,\"tags\":[\"a\",\"b\",%d],\"ok\":%s}",
+                i ? "," : "", i, i, i % 1000, i % 7, i % 13, i % 2 ? "true" : "false");
+            *largeJson_ += buffer;
+        }
+        *largeJson_ += "]";
+    }
+
+    static void TearDownTestCase() {
+        delete largeJson_;
+        largeJson_ = 0;
+    }
+
+protected:
+    template <typename BaseAllocator>
+    static void ParseLargeDocument(size_t trialCount) {
+        for (size_t i = 0; i < trialCount; i++) {
+            MemoryPoolAllocator<BaseAllocator> allocator(32 * 1024 * 1024);
+            GenericDocument<UTF8<>, MemoryPoolAllocator<BaseAllocator>, BaseAllocator> doc(&allocator);
+            doc.Parse(largeJson_->c_str());
+            ASSERT_TRUE(doc.IsArray());
+        }
+    }
+
+    static std::string* largeJson_;
+};
+
+std::string* RapidJsonLarge::largeJson_;
+
+TEST_F(RapidJsonLarge, DocumentParseLarge_CrtAllocator) {
+    ParseLargeDocument<CrtAllocator>(kTrialCount / 100);
+}
+
+#if RAPIDJSON_HAS_MMAP
+TEST_F(RapidJsonLarge, DocumentParseLarge_MmapAllocator) {
+    ParseLargeDocument<MmapAllocator<> >(kTrialCount / 100);
+}
+
+TEST_F(RapidJsonLarge, DocumentParseLarge_MmapAllocator_HugePage) {
+    ParseLargeDocument<MmapAllocator<kMmapHugeTlbFlag | kMmapTransparentHugePageFlag> >(kTrialCount / 100);
+}
+
+TEST_F(RapidJsonLarge, DocumentParseLarge_MmapAllocator_HugePagePrefault) {
+    ParseLargeDocument<MmapAllocator<kMmapHugeTlbFlag | kMmapTransparentHugePageFlag | kMmapPrefaultFlag> >(kTrialCount / 100);
+}
+#endif
+
 TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseEncodedInputStream_MemoryStream)) {
     for (size_t i = 0; i < kTrialCount; i++) {
         MemoryStream ms(json_, length_);
@@ -275,6 +609,30 @@ TEST_F(RapidJson, DocumentTraverse) {
     }
 }
 
+TEST_F(RapidJson, SnapshotTraverse) {
+    SnapshotWriter writer;
+    writer.Write(doc_);
+    for (size_t i = 0; i < kTrialCount; i++) {
+        size_t count = Traverse(*SnapshotValue::Load(writer.GetImage(), writer.GetSize()));
+        EXPECT_EQ(4339u, count);
+    }
+}
+
+// Startup with a large reference document: parsing vs. loading its snapshot image (see DocumentParseLarge_*).
+TEST_F(RapidJsonLarge, SnapshotLoadLarge) {
+    SnapshotWriter writer;
+    {
+        Document doc;
+        doc.Parse(largeJson_->c_str());
+        writer.Write(doc);
+    }
+    for (size_t i = 0; i < kTrialCount / 100; i++) {
+        const SnapshotValue* root = SnapshotValue::Load(writer.GetImage(), writer.GetSize());
+        ASSERT_TRUE(root && root->IsArray());
+        EXPECT_TRUE(root->Size() > 0 && (*root)[root->Size() - 1].IsObject());
+    }
+}
+
 #ifdef __GNUC__
 RAPIDJSON_DIAG_PUSH
 RAPIDJSON_DIAG_OFF(effc++)
@@ -366,6 +724,116 @@ TEST_F(RapidJson, SIMD_SUFFIX(PrettyWriter_StringBuffer)) {
     }
 }
 
+TEST_F(RapidJson, MsgPackWriter_StringBuffer) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringBuffer s(0, 1024 * 1024);
+        MsgPackWriter<StringBuffer> writer(s);
+        doc_.Accept(writer);
+        EXPECT_TRUE(writer.IsComplete());
+    }
+}
+
+TEST_F(RapidJson, MsgPackReader_ValueCounter) {
+    StringBuffer s;
+    MsgPackWriter<StringBuffer> writer(s);
+    doc_.Accept(writer);
+    for (size_t i = 0; i < kTrialCount; i++) {
+        ValueCounter counter;
+        MsgPackReader reader;
+        EXPECT_FALSE(reader.Parse(s.GetString(), s.GetSize(), counter).IsError());
+        EXPECT_EQ(4339u, counter.count_);
+    }
+}
+
+struct MsgPackSource {
+    MsgPackSource(const StringBuffer& s) : s_(s) {}
+    template <typename Handler>
+    bool operator()(Handler& handler) { return !MsgPackReader().Parse(s_.GetString(), s_.GetSize(), handler).IsError(); }
+    const StringBuffer& s_;
+private:
+    MsgPackSource& operator=(const MsgPackSource&);
+};
+
+TEST_F(RapidJson, MsgPackReader_Document) {
+    StringBuffer s;
+    MsgPackWriter<StringBuffer> writer(s);
+    doc_.Accept(writer);
+    MsgPackSource source(s);
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.Populate(source);
+        EXPECT_TRUE(doc.IsObject());
+    }
+}
+
+TEST_F(RapidJson, CborWriter_StringBuffer) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringBuffer s(0, 1024 * 1024);
+        CborWriter<StringBuffer> writer(s);
+        doc_.Accept(writer);
+        EXPECT_TRUE(writer.IsComplete());
+    }
+}
+
+TEST_F(RapidJson, CborReader_ValueCounter) {
+    StringBuffer s;
+    CborWriter<StringBuffer> writer(s);
+    doc_.Accept(writer);
+    for (size_t i = 0; i < kTrialCount; i++) {
+        ValueCounter counter;
+        CborReader reader;
+        EXPECT_FALSE(reader.Parse(s.GetString(), s.GetSize(), counter).IsError());
+        EXPECT_EQ(4339u, counter.count_);
+    }
+}
+
+template <unsigned parseFlags>
+struct CborSource {
+    CborSource(const StringBuffer& s) : s_(s) {}
+    template <typename Handler>
+    bool operator()(Handler& handler) { return !CborReader().Parse<parseFlags>(s_.GetString(), s_.GetSize(), handler).IsError(); }
+    const StringBuffer& s_;
+private:
+    CborSource& operator=(const CborSource&);
+};
+
+TEST_F(RapidJson, CborReader_Document) {
+    StringBuffer s;
+    CborWriter<StringBuffer> writer(s);
+    doc_.Accept(writer);
+    CborSource<kParseDefaultFlags> source(s);
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.Populate(source);
+        EXPECT_TRUE(doc.IsObject());
+    }
+}
+
+TEST_F(RapidJson, CborReader_DocumentInsitu) {
+    StringBuffer s;
+    CborWriter<StringBuffer> writer(s);
+    doc_.Accept(writer);
+    CborSource<kParseInsituFlag> source(s);
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.Populate(source);
+        EXPECT_TRUE(doc.IsObject());
+    }
+}
+
+// CBOR to JSON
+TEST_F(RapidJson, CborReader_Writer_StringBuffer) {
+    StringBuffer s;
+    CborWriter<StringBuffer> writer(s);
+    doc_.Accept(writer);
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringBuffer json(0, 1024 * 1024);
+        Writer<StringBuffer> jsonWriter(json);
+        CborReader reader;
+        EXPECT_FALSE(reader.Parse(s.GetString(), s.GetSize(), jsonWriter).IsError());
+    }
+}
+
 TEST_F(RapidJson, internal_Pow10) {
     double sum = 0;
     for (size_t i = 0; i < kTrialCount * kTrialCount; i++)
@@ -390,6 +858,64 @@ TEST_F(RapidJson, SIMD_SUFFIX(SkipWhitespace)) {
     }
 }
 
+TEST_F(RapidJson, SIMD_SUFFIX(SkipWhitespace_EncodedMemoryStream)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        MemoryStream ms(whitespace_, whitespace_length_ + 3);
+        EncodedInputStream<UTF8<>, MemoryStream> s(ms);
+        rapidjson::SkipWhitespace(s);
+        ASSERT_EQ('[', s.Peek());
+    }
+}
+
+// Long unescaped string values, where ScanCopyUnescapedString dominates.
+// They are generated once for the test case, like RapidJsonLarge.
+class RapidJsonLongStrings : public RapidJson {
+public:
+    static void SetUpTestCase() {
+        const size_t count = 1024, length = 4096;
+        longStrings_ = new std::string("[");
+        for (size_t i = 0; i < count; i++) {
+            if (i != 0)
+                *longStrings_ += ',';
+            *longStrings_ += '\"';
+            for (size_t j = 0; j < length; j++)
+                *longStrings_ += static_cast<char>('a' + (i + j) % 26);
+            *longStrings_ += '\"';
+        }
+        *longStrings_ += ']';
+    }
+
+    static void TearDownTestCase() {
+        delete longStrings_;
+        longStrings_ = 0;
+    }
+
+protected:
+    static std::string* longStrings_;
+};
+
+std::string* RapidJsonLongStrings::longStrings_;
+
+TEST_F(RapidJsonLongStrings, SIMD_SUFFIX(ReaderParse_DummyHandler_LongStrings)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(longStrings_->c_str());
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse(s, h));
+    }
+}
+
+TEST_F(RapidJsonLongStrings, SIMD_SUFFIX(ReaderParseInsitu_DummyHandler_LongStrings)) {
+    std::string temp;
+    for (size_t i = 0; i < kTrialCount; i++) {
+        temp = *longStrings_;
+        InsituStringStream s(&temp[0]);
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse<kParseInsituFlag>(s, h));
+    }
+}
+
 TEST_F(RapidJson, SkipWhitespace_strspn) {
     for (size_t i = 0; i < kTrialCount; i++) {
         const char* s = whitespace_ + std::strspn(whitespace_, " \t\r\n");
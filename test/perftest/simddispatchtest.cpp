@@ -0,0 +1,109 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// The reader tests of rapidjsontest.cpp with RAPIDJSON_SIMD_DISPATCH, to be compared
+// with the compile-time SIMD code, in particular for the small tokens of bin/types.
+
+#define RAPIDJSON_SIMD_DISPATCH
+#define RAPIDJSON_NAMESPACE rapidjson_simd_dispatch
+
+#include "perftest.h"
+
+#if TEST_RAPIDJSON
+
+#include "rapidjson/reader.h"
+
+using namespace rapidjson_simd_dispatch;
+
+class SimdDispatch : public PerfTest {
+public:
+    SimdDispatch() : temp_() {}
+
+    virtual void SetUp() {
+        PerfTest::SetUp();
+
+        // temp buffer for insitu parsing.
+        temp_ = (char *)malloc(length_ + 1);
+    }
+
+    virtual void TearDown() {
+        PerfTest::TearDown();
+        free(temp_);
+    }
+
+private:
+    SimdDispatch(const SimdDispatch&);
+    SimdDispatch& operator=(const SimdDispatch&);
+
+protected:
+    char *temp_;
+};
+
+TEST_F(SimdDispatch, ReaderParseInsitu_DummyHandler) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        memcpy(temp_, json_, length_);
+        InsituStringStream s(temp_);
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse<kParseInsituFlag>(s, h));
+    }
+}
+
+TEST_F(SimdDispatch, ReaderParse_DummyHandler) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(json_);
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse(s, h));
+    }
+}
+
+#define TEST_TYPED(index, Name)\
+TEST_F(SimdDispatch, ReaderParse_DummyHandler_##Name) {\
+    for (size_t i = 0; i < kTrialCount * 10; i++) {\
+        StringStream s(types_[index]);\
+        BaseReaderHandler<> h;\
+        Reader reader;\
+        EXPECT_TRUE(reader.Parse(s, h));\
+    }\
+}\
+TEST_F(SimdDispatch, ReaderParseInsitu_DummyHandler_##Name) {\
+    for (size_t i = 0; i < kTrialCount * 10; i++) {\
+        memcpy(temp_, types_[index], typesLength_[index] + 1);\
+        InsituStringStream s(temp_);\
+        BaseReaderHandler<> h;\
+        Reader reader;\
+        EXPECT_TRUE(reader.Parse<kParseInsituFlag>(s, h));\
+    }\
+}
+
+TEST_TYPED(0, Booleans)
+TEST_TYPED(1, Floats)
+TEST_TYPED(2, Guids)
+TEST_TYPED(3, Integers)
+TEST_TYPED(4, Mixed)
+TEST_TYPED(5, Nulls)
+TEST_TYPED(6, Paragraphs)
+
+#undef TEST_TYPED
+
+TEST_F(SimdDispatch, SkipWhitespace) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(whitespace_);
+        SkipWhitespace(s);
+        ASSERT_EQ('[', s.Peek());
+    }
+}
+
+#endif // TEST_RAPIDJSON
@@ -16,6 +16,10 @@
 
 #include "rapidjson/allocators.h"
 
+#if RAPIDJSON_HAS_CXX11_ATOMIC
+#include <thread>
+#endif
+
 using namespace rapidjson;
 
 template <typename Allocator>
@@ -62,6 +66,206 @@ TEST(Allocator, MemoryPoolAllocator) {
     }
 }
 
+TEST(Allocator, MemoryPoolAllocator_Reset) {
+    MemoryPoolAllocator<> a(1024);
+    void* first = a.Malloc(100);
+    for (size_t i = 0; i < 100; i++)
+        a.Malloc(100);
+    const size_t capacity = a.Capacity();
+    EXPECT_LE(10u * 1024u, capacity);
+
+    // Chunks are kept, and reused in order.
+    a.Reset();
+    EXPECT_EQ(0u, a.Size());
+    EXPECT_EQ(capacity, a.Capacity());
+    EXPECT_EQ(first, a.Malloc(100));
+    for (size_t i = 0; i < 100; i++)
+        a.Malloc(100);
+    EXPECT_EQ(capacity, a.Capacity());
+
+    // Larger blocks than the kept chunks need a new chunk.
+    EXPECT_TRUE(a.Malloc(4096) != 0);
+    EXPECT_EQ(capacity + 4096, a.Capacity());
+
+    // Trimmed to a maximum capacity
+    a.Reset(3000);
+    EXPECT_EQ(0u, a.Size());
+    EXPECT_GE(3000u, a.Capacity());
+    EXPECT_LT(0u, a.Capacity());
+    a.Reset(0);
+    EXPECT_EQ(0u, a.Capacity());
+
+    // User buffer is kept as well.
+    char buffer[1024];
+    MemoryPoolAllocator<> b(buffer, sizeof(buffer), 256);
+    void* p = b.Malloc(100);
+    for (size_t i = 0; i < 20; i++)
+        b.Malloc(100);
+    b.Reset(0);
+    EXPECT_EQ(p, b.Malloc(100));
+}
+
+TEST(Allocator, MemoryPoolAllocator_ChunkGrowth) {
+    MemoryPoolAllocator<> a(1024);
+    a.SetMaxChunkCapacity(8192);
+    size_t capacity = 0;
+    for (size_t expected = 1024; expected <= 8192 * 4; expected = expected < 8192 ? expected * 2 : expected) {
+        // Fill the current chunk to get a new one.
+        while (a.Capacity() == capacity)
+            a.Malloc(8);
+        EXPECT_EQ(expected, a.Capacity() - capacity);
+        capacity = a.Capacity();
+        if (capacity > 8192 * 4)
+            break;
+    }
+
+    // Capacity starts over after Clear().
+    a.Clear();
+    a.Malloc(8);
+    EXPECT_EQ(1024u, a.Capacity());
+}
+
+#if RAPIDJSON_HAS_MMAP
+
+TEST(Allocator, MmapAllocator) {
+    MmapAllocator<> a;
+    TestAllocator(a);
+    MmapAllocator<kMmapHugeTlbFlag | kMmapPrefaultFlag> b;
+    TestAllocator(b);
+    MmapAllocator<kMmapTransparentHugePageFlag | kMmapPrefaultFlag> c;
+    TestAllocator(c);
+
+    // Growing within the pages mapped
+    uint8_t* p = static_cast<uint8_t*>(a.Malloc(10));
+    p[9] = 9;
+    EXPECT_EQ(p, a.Realloc(p, 10, 100));
+    uint8_t* q = static_cast<uint8_t*>(a.Realloc(p, 100, 1024 * 1024));
+    ASSERT_TRUE(q != 0);
+    EXPECT_EQ(9, q[9]);
+    q[1024 * 1024 - 1] = 1;
+    MmapAllocator<>::Free(q);
+
+    MemoryPoolAllocator<MmapAllocator<kMmapTransparentHugePageFlag> > pool(1024 * 1024);
+    TestAllocator(pool);
+    EXPECT_EQ(1024u * 1024u, pool.Capacity());
+}
+
+#endif // RAPIDJSON_HAS_MMAP
+
+#if RAPIDJSON_HAS_CXX11_ATOMIC
+
+TEST(Allocator, ConcurrentMemoryPoolAllocator) {
+    ConcurrentMemoryPoolAllocator<> a;
+    TestAllocator(a);
+
+    for (size_t i = 1; i < 1000; i++) {
+        EXPECT_TRUE(a.Malloc(i) != 0);
+        EXPECT_LE(a.Size(), a.Capacity());
+    }
+
+    // Blocks larger than a chunk
+    uint8_t* p = static_cast<uint8_t*>(a.Malloc(1024 * 1024));
+    ASSERT_TRUE(p != 0);
+    p[1024 * 1024 - 1] = 1;
+    EXPECT_LE(size_t(1024 * 1024), a.Size());
+
+    void* q = a.Malloc(100);
+    EXPECT_EQ(q, a.Realloc(q, 100, 200));
+    a.Clear();
+    EXPECT_EQ(0u, a.Capacity());
+}
+
+TEST(Allocator, ConcurrentMemoryPoolAllocator_Alternating) {
+    // Allocators used in turn by one thread keep allocating from their current chunks:
+    // two allocators with ids eight apart, then more allocators than the thread caches.
+    ChunkPool<> pool(4096);
+    ConcurrentMemoryPoolAllocator<> a(&pool);
+    ConcurrentMemoryPoolAllocator<> padding[7];
+    ConcurrentMemoryPoolAllocator<> b(&pool);
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_TRUE(a.Malloc(16) != 0);
+        EXPECT_TRUE(b.Malloc(16) != 0);
+    }
+    EXPECT_EQ(16000u, a.Size());
+    EXPECT_EQ(16000u, b.Size());
+    EXPECT_GE(5 * 4096u, a.Capacity());
+    EXPECT_GE(5 * 4096u, b.Capacity());
+
+    const int kAllocatorCount = 20;
+    ConcurrentMemoryPoolAllocator<> many[kAllocatorCount];
+    for (int i = 0; i < 100; i++)
+        for (int j = 0; j < kAllocatorCount; j++)
+            EXPECT_TRUE(many[j].Malloc(16) != 0);
+    for (int j = 0; j < kAllocatorCount; j++) {
+        EXPECT_EQ(1600u, many[j].Size());
+        EXPECT_EQ(many[0].Capacity(), many[j].Capacity());     // a single chunk
+        EXPECT_GT(64 * 1024u, many[j].Capacity());
+    }
+}
+
+// Base allocator which must be called through its own object.
+struct CountingAllocator {
+    static const bool kNeedFree = true;
+    CountingAllocator() : count(0) {}
+    void* Malloc(size_t size) { ++count; return CrtAllocator().Malloc(size); }
+    void* Realloc(void* originalPtr, size_t originalSize, size_t newSize) { return CrtAllocator().Realloc(originalPtr, originalSize, newSize); }
+    void Free(void* ptr) { if (ptr) --count; CrtAllocator::Free(ptr); }
+    int count;
+};
+
+TEST(Allocator, ConcurrentMemoryPoolAllocator_BaseAllocator) {
+    CountingAllocator base;
+    {
+        ChunkPool<CountingAllocator> pool(4096, &base);
+        ConcurrentMemoryPoolAllocator<CountingAllocator> a(&pool);
+        EXPECT_TRUE(a.Malloc(100) != 0);
+        EXPECT_TRUE(a.Malloc(10000) != 0);     // larger than a chunk
+        EXPECT_EQ(2, base.count);
+        a.Clear();
+        EXPECT_EQ(1, base.count);               // the chunk is kept by the pool
+    }
+    EXPECT_EQ(0, base.count);
+}
+
+TEST(Allocator, ConcurrentMemoryPoolAllocator_Threads) {
+    ChunkPool<> pool(4096);
+    ConcurrentMemoryPoolAllocator<> a(&pool);
+    const int kThreadCount = 4;
+    const size_t kBlockCount = 2000;
+    uint8_t* blocks[kThreadCount][kBlockCount];
+    std::thread threads[kThreadCount];
+    for (int t = 0; t < kThreadCount; t++)
+        threads[t] = std::thread([&a, &blocks, t]() {
+            for (size_t i = 0; i < kBlockCount; i++) {
+                const size_t size = i % 61 + 1;
+                blocks[t][i] = static_cast<uint8_t*>(a.Malloc(size));
+                if (blocks[t][i])
+                    std::memset(blocks[t][i], t + 1, size);
+            }
+        });
+    for (int t = 0; t < kThreadCount; t++)
+        threads[t].join();
+
+    // No block was handed out twice.
+    for (int t = 0; t < kThreadCount; t++)
+        for (size_t i = 0; i < kBlockCount; i++) {
+            ASSERT_TRUE(blocks[t][i] != 0);
+            for (size_t j = 0; j < i % 61 + 1; j++)
+                ASSERT_EQ(t + 1, blocks[t][i][j]);
+        }
+    EXPECT_LE(a.Size(), a.Capacity());
+
+    // Chunks are reused after Clear(), also by other allocators of the pool.
+    a.Clear();
+    char* chunk = static_cast<char*>(pool.Acquire());
+    pool.Release(chunk);
+    ConcurrentMemoryPoolAllocator<> b(&pool);
+    char* block = static_cast<char*>(b.Malloc(32));
+    EXPECT_TRUE(block > chunk && block < chunk + pool.ChunkCapacity());
+}
+
+#endif // RAPIDJSON_HAS_CXX11_ATOMIC
+
 TEST(Allocator, Alignment) {
 #if RAPIDJSON_64BIT == 1
     EXPECT_EQ(RAPIDJSON_UINT64_C2(0x00000000, 0x00000000), RAPIDJSON_ALIGN(0));
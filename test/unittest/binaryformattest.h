@@ -0,0 +1,72 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef BINARYFORMATTEST_H_
+#define BINARYFORMATTEST_H_
+
+// Helpers shared by the tests of the binary formats (MessagePack, CBOR).
+
+#include "unittest.h"
+
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include <string>
+
+//! Parses JSON text into a document and writes it with \c BinaryWriter, which outputs to a StringBuffer.
+template <typename BinaryWriter, unsigned parseFlags>
+std::string BinaryEncode(const char* json) {
+    rapidjson::Document d;
+    d.Parse<parseFlags>(json);
+    EXPECT_FALSE(d.HasParseError()) << json;
+    rapidjson::StringBuffer sb;
+    BinaryWriter writer(sb);
+    EXPECT_TRUE(d.Accept(writer));
+    EXPECT_TRUE(writer.IsComplete());
+    return std::string(sb.GetString(), sb.GetSize());
+}
+
+//! Reads binary data with \c BinaryReader and writes it as JSON text.
+template <typename BinaryReader, unsigned writeFlags>
+std::string BinaryDecode(const std::string& data) {
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer, rapidjson::UTF8<>, rapidjson::UTF8<>, rapidjson::CrtAllocator, writeFlags> writer(sb);
+    BinaryReader reader;
+    rapidjson::ParseResult r = reader.Parse(data.data(), data.size(), writer);
+    EXPECT_FALSE(r.IsError()) << r.Code() << " at " << r.Offset();
+    return sb.GetString();
+}
+
+//! Normalizes JSON text as the decoded binary data is written.
+template <unsigned parseFlags>
+std::string BinaryStringify(const char* json) {
+    rapidjson::Document d;
+    d.Parse<parseFlags>(json);
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    d.Accept(writer);
+    return sb.GetString();
+}
+
+// Checks the encoding of JSON text and that decoding it gives the text back.
+// Uses the Encode(), Decode() and Stringify() functions of the test file.
+#define TEST_ENCODE(json, expected) \
+    do { \
+        const std::string e(expected, sizeof(expected) - 1); \
+        EXPECT_EQ(e, Encode(json)) << json; \
+        EXPECT_EQ(Stringify(json), Decode(e)) << json; \
+    } while (false)
+
+#endif // BINARYFORMATTEST_H_
@@ -0,0 +1,417 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "unittest.h"
+#include "binaryformattest.h"
+
+#include "rapidjson/cbor.h"
+
+#include <string>
+#include <vector>
+
+using namespace rapidjson;
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+static std::string Encode(const char* json) { return BinaryEncode<CborWriter<StringBuffer>, kParseFullPrecisionFlag>(json); }
+static std::string Decode(const std::string& cbor) { return BinaryDecode<CborReader, kWriteNanAndInfFlag>(cbor); }
+static std::string Stringify(const char* json) { return BinaryStringify<kParseFullPrecisionFlag>(json); }
+
+#define TEST_DECODE(cbor, json) \
+    EXPECT_EQ(json, Decode(std::string(cbor, sizeof(cbor) - 1)))
+
+template <typename TargetEncoding, unsigned parseFlags>
+struct CborSource {
+    CborSource(const std::string& cbor) : cbor(cbor) {}
+    template <typename Handler>
+    bool operator()(Handler& handler) { return !GenericCborReader<TargetEncoding>().template Parse<parseFlags>(cbor.data(), cbor.size(), handler).IsError(); }
+    std::string cbor;
+};
+
+TEST(Cbor, RoundTrip) {
+    static const char* json[] = {
+        "null", "true", "false", "0", "-1", "1.5", "0.1", "\"\"", "[]", "{}", "\"hello\"",
+        "{ \"hello\" : \"world\", \"t\" : true , \"f\" : false, \"n\": null, \"i\":123, \"pi\": 3.1416, \"a\":[1, 2, 3, 4] } ",
+        "[{\"a\": [[], {}, [{\"b\": \"c\"}]]}, -1, 1e100, \"\\u0000\", \"\\u00e9\\ud834\\udd1e\", [[[[[[]]]]]]]",
+        "[-2147483648, 2147483647, 4294967295, -9223372036854775808, 9223372036854775807, 18446744073709551615, 0.5, -0.0]",
+        "[1e-7, 5.960464477539063e-8, 3.4028234663852886e+38, 1e-45, 65504.0, 65505.0, 0.333333333]"
+    };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++)
+        EXPECT_EQ(Stringify(json[i]), Decode(Encode(json[i])));
+
+    // Large containers and strings
+    std::string json2 = "[";
+    for (int i = 0; i < 70000; i++)
+        json2 += i ? ",{\"k\":[]}" : "{\"k\":[]}";
+    json2 += ",\"" + std::string(70000, 'x') + "\"]";
+    EXPECT_EQ(Stringify(json2.c_str()), Decode(Encode(json2.c_str())));
+}
+
+TEST(Cbor, Encoding) {
+    TEST_ENCODE("0", "\x00");
+    TEST_ENCODE("1", "\x01");
+    TEST_ENCODE("10", "\x0A");
+    TEST_ENCODE("23", "\x17");
+    TEST_ENCODE("24", "\x18\x18");
+    TEST_ENCODE("25", "\x18\x19");
+    TEST_ENCODE("100", "\x18\x64");
+    TEST_ENCODE("1000", "\x19\x03\xE8");
+    TEST_ENCODE("1000000", "\x1A\x00\x0F\x42\x40");
+    TEST_ENCODE("1000000000000", "\x1B\x00\x00\x00\xE8\xD4\xA5\x10\x00");
+    TEST_ENCODE("18446744073709551615", "\x1B\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF");
+    TEST_ENCODE("-1", "\x20");
+    TEST_ENCODE("-10", "\x29");
+    TEST_ENCODE("-100", "\x38\x63");
+    TEST_ENCODE("-1000", "\x39\x03\xE7");
+    TEST_ENCODE("-2147483648", "\x3A\x7F\xFF\xFF\xFF");
+    TEST_ENCODE("-9223372036854775808", "\x3B\x7F\xFF\xFF\xFF\xFF\xFF\xFF\xFF");
+
+    // Shortest floats
+    TEST_ENCODE("0.0", "\xF9\x00\x00");
+    TEST_ENCODE("-0.0", "\xF9\x80\x00");
+    TEST_ENCODE("1.0", "\xF9\x3C\x00");
+    TEST_ENCODE("1.1", "\xFB\x3F\xF1\x99\x99\x99\x99\x99\x9A");
+    TEST_ENCODE("1.5", "\xF9\x3E\x00");
+    TEST_ENCODE("65504.0", "\xF9\x7B\xFF");
+    TEST_ENCODE("100000.0", "\xFA\x47\xC3\x50\x00");
+    TEST_ENCODE("3.4028234663852886e+38", "\xFA\x7F\x7F\xFF\xFF");
+    TEST_ENCODE("1.0e+300", "\xFB\x7E\x37\xE4\x3C\x88\x00\x75\x9C");
+    TEST_ENCODE("5.960464477539063e-8", "\xF9\x00\x01");
+    TEST_ENCODE("0.00006103515625", "\xF9\x04\x00");
+    TEST_ENCODE("-4.0", "\xF9\xC4\x00");
+    TEST_ENCODE("-4.1", "\xFB\xC0\x10\x66\x66\x66\x66\x66\x66");
+
+    TEST_ENCODE("false", "\xF4");
+    TEST_ENCODE("true", "\xF5");
+    TEST_ENCODE("null", "\xF6");
+
+    TEST_ENCODE("\"\"", "\x60");
+    TEST_ENCODE("\"a\"", "\x61" "a");
+    TEST_ENCODE("\"IETF\"", "\x64" "IETF");
+    TEST_ENCODE("\"\\\"\\\\\"", "\x62\x22\x5C");
+    TEST_ENCODE("\"\\u00fc\"", "\x62\xC3\xBC");
+    TEST_ENCODE("\"\\u6c34\"", "\x63\xE6\xB0\xB4");
+    TEST_ENCODE("\"\\ud800\\udd51\"", "\x64\xF0\x90\x85\x91");
+
+    TEST_ENCODE("[]", "\x80");
+    TEST_ENCODE("[1, 2, 3]", "\x83\x01\x02\x03");
+    TEST_ENCODE("[1, [2, 3], [4, 5]]", "\x83\x01\x82\x02\x03\x82\x04\x05");
+    TEST_ENCODE("[1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25]",
+        "\x98\x19\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0A\x0B\x0C\x0D\x0E\x0F\x10\x11\x12\x13\x14\x15\x16\x17\x18\x18\x18\x19");
+    TEST_ENCODE("{}", "\xA0");
+    TEST_ENCODE("{\"a\": 1, \"b\": [2, 3]}", "\xA2\x61" "a" "\x01\x61" "b" "\x82\x02\x03");
+    TEST_ENCODE("[\"a\", {\"b\": \"c\"}]", "\x82\x61" "a" "\xA1\x61" "b" "\x61" "c");
+
+    // 16 and 32-bit lengths
+    const std::string s256(256, 'x');
+    EXPECT_EQ(std::string("\x79\x01\x00", 3) + s256, Encode(("\"" + s256 + "\"").c_str()));
+    const std::string s65536(65536, 'x');
+    EXPECT_EQ(std::string("\x81\x7A\x00\x01\x00\x00", 6) + s65536, Encode(("[\"" + s65536 + "\"]").c_str()));
+    std::string json = "[[";
+    for (int i = 0; i < 65536; i++)
+        json += i ? ",0" : "0";
+    json += "]]";
+    const std::string e = Encode(json.c_str());
+    EXPECT_EQ(std::string("\x81\x9A\x00\x01\x00\x00\x00", 7), e.substr(0, 7));
+    EXPECT_EQ(Stringify(json.c_str()), Decode(e));
+}
+
+TEST(Cbor, Reader) {
+    // Non-shortest forms
+    TEST_DECODE("\x1B\x00\x00\x00\x00\x00\x00\x00\x01", "1");
+    TEST_DECODE("\x39\x00\x00", "-1");
+    TEST_DECODE("\x78\x01" "a", "\"a\"");
+    TEST_DECODE("\x99\x00\x01\x01", "[1]");
+    TEST_DECODE("\xFA\x3F\xC0\x00\x00", "1.5");
+    TEST_DECODE("\xFB\x3F\xF8\x00\x00\x00\x00\x00\x00", "1.5");
+
+    // Examples of RFC 8949 Appendix A
+    TEST_DECODE("\x3B\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF", "-18446744073709553000.0");
+    TEST_DECODE("\xF9\x7C\x00", "Infinity");
+    TEST_DECODE("\xF9\x7E\x00", "NaN");
+    TEST_DECODE("\xF9\xFC\x00", "-Infinity");
+    TEST_DECODE("\xFA\x7F\x80\x00\x00", "Infinity");
+    TEST_DECODE("\xFB\x7F\xF8\x00\x00\x00\x00\x00\x00", "NaN");
+    TEST_DECODE("\xF9\x00\x01", "5.960464477539063e-8");
+    TEST_DECODE("\xF9\x03\xFF", "0.00006097555160522461");
+    TEST_DECODE("\xF7", "null");    // undefined
+    TEST_DECODE("\xC0\x74" "2013-03-21T20:04:00Z", "\"2013-03-21T20:04:00Z\"");
+    TEST_DECODE("\xC1\x1A\x51\x4B\x67\xB0", "1363896240");
+    TEST_DECODE("\xD8\x20\x76" "http://www.example.com", "\"http://www.example.com\"");
+    TEST_DECODE("\xD9\xD9\xF7\x80", "[]");  // self-described CBOR
+
+    // Indefinite lengths
+    TEST_DECODE("\x7F\x65" "strea" "\x64" "ming" "\xFF", "\"streaming\"");
+    TEST_DECODE("\x7F\xFF", "\"\"");
+    TEST_DECODE("\x9F\xFF", "[]");
+    TEST_DECODE("\x9F\x01\x82\x02\x03\x9F\x04\x05\xFF\xFF", "[1,[2,3],[4,5]]");
+    TEST_DECODE("\x9F\x01\x82\x02\x03\x82\x04\x05\xFF", "[1,[2,3],[4,5]]");
+    TEST_DECODE("\x83\x01\x82\x02\x03\x9F\x04\x05\xFF", "[1,[2,3],[4,5]]");
+    TEST_DECODE("\xBF\x61" "a" "\x01\x61" "b" "\x9F\x02\x03\xFF\xFF", "{\"a\":1,\"b\":[2,3]}");
+    TEST_DECODE("\xBF\x63" "Fun" "\xF5\x63" "Amt" "\x21\xFF", "{\"Fun\":true,\"Amt\":-2}");
+    TEST_DECODE("\xA1\x7F\x61" "a" "\x61" "b" "\xFF\x9F\xFF", "{\"ab\":[]}");
+    TEST_DECODE("\xA1\xC0\x61" "a" "\x01", "{\"a\":1}");   // tagged key
+
+    // Types of the events
+    CborSource<UTF8<>, 0> source(Encode("{\"i\": -1, \"u\": 4294967295, \"i64\": -2147483649, \"u64\": 4294967296, \"d\": 0.5, \"s\": \"\\u0000x\"}"));
+    Document d;
+    d.Populate(source);
+    ASSERT_TRUE(d.IsObject());
+    EXPECT_TRUE(d["i"].IsInt());
+    EXPECT_FALSE(d["u"].IsInt());
+    EXPECT_TRUE(d["u"].IsUint());
+    EXPECT_FALSE(d["i64"].IsInt());
+    EXPECT_TRUE(d["i64"].IsInt64());
+    EXPECT_FALSE(d["u64"].IsUint());
+    EXPECT_TRUE(d["u64"].IsUint64());
+    EXPECT_TRUE(d["d"].IsDouble());
+    EXPECT_EQ(std::string("\0x", 2), std::string(d["s"].GetString(), d["s"].GetStringLength()));
+
+    // Transcoding
+    CborSource<UTF16<>, 0> source16(std::string("\xA1\x7F\x62\xC3\xA9\x61" "a" "\xFF\x64\xF0\x9D\x84\x9E", 13));
+    GenericDocument<UTF16<> > d16;
+    d16.Populate(source16);
+    ASSERT_TRUE(d16.IsObject());
+    ASSERT_TRUE(d16.HasMember(L"\x00e9" L"a"));
+    EXPECT_EQ(2u, d16[L"\x00e9" L"a"].GetStringLength());
+    EXPECT_EQ(0xD834, d16[L"\x00e9" L"a"].GetString()[0]);
+    EXPECT_EQ(0xDD1E, d16[L"\x00e9" L"a"].GetString()[1]);
+}
+
+TEST(Cbor, Insitu) {
+    const std::string cbor = Encode("{\"name\": \"value\", \"a\": [\"string\"]}");
+
+    // Strings are copied by default.
+    CborSource<UTF8<>, 0> source(cbor);
+    Document d;
+    d.Populate(source);
+    ASSERT_TRUE(d.IsObject());
+    const char* begin = source.cbor.data();
+    const char* end = begin + source.cbor.size();
+    EXPECT_FALSE(d["name"].GetString() >= begin && d["name"].GetString() < end);
+
+    // The document refers to the strings in the input.
+    CborSource<UTF8<>, kParseInsituFlag> insitu(cbor);
+    d.Populate(insitu);
+    ASSERT_TRUE(d.IsObject());
+    begin = insitu.cbor.data();
+    end = begin + insitu.cbor.size();
+    EXPECT_EQ(std::string("value"), std::string(d["name"].GetString(), d["name"].GetStringLength()));
+    EXPECT_TRUE(d["name"].GetString() >= begin && d["name"].GetString() < end);
+    EXPECT_TRUE(d.MemberBegin()->name.GetString() >= begin && d.MemberBegin()->name.GetString() < end);
+    EXPECT_TRUE(d["a"][0].GetString() >= begin && d["a"][0].GetString() < end);
+    EXPECT_EQ(6u, d["a"][0].GetStringLength());
+
+    // ... unless the strings are transcoded.
+    CborSource<UTF8<>, kParseInsituFlag | kParseValidateEncodingFlag> validated(cbor);
+    d.Populate(validated);
+    ASSERT_TRUE(d.IsObject());
+    begin = validated.cbor.data();
+    end = begin + validated.cbor.size();
+    EXPECT_FALSE(d["name"].GetString() >= begin && d["name"].GetString() < end);
+    EXPECT_STREQ("value", d["name"].GetString());
+}
+
+// Handler which records the sizes of the arrays and objects at their starts.
+struct SizedHandler : BaseReaderHandler<UTF8<>, SizedHandler> {
+    SizedHandler() : sizes() {}
+    bool StartObject() { sizes.push_back(-1); return true; }
+    bool StartObject(SizeType memberCount) { sizes.push_back(static_cast<int>(memberCount)); return true; }
+    bool StartArray() { sizes.push_back(-1); return true; }
+    bool StartArray(SizeType elementCount) { sizes.push_back(static_cast<int>(elementCount)); return true; }
+    std::vector<int> sizes;
+};
+
+// Stack allocator which counts the allocations and growths of the stack.
+struct GrowthCountingAllocator : CrtAllocator {
+    void* Realloc(void* originalPtr, size_t originalSize, size_t newSize) {
+        if (newSize > originalSize)
+            count++;
+        return CrtAllocator::Realloc(originalPtr, originalSize, newSize);
+    }
+    static int count;
+};
+
+int GrowthCountingAllocator::count = 0;
+
+TEST(Cbor, Sizes) {
+    EXPECT_TRUE(internal::IsSizedHandler<Document>::Value);
+    EXPECT_TRUE(internal::IsSizedHandler<SizedHandler>::Value);
+    EXPECT_FALSE(internal::IsSizedHandler<Writer<StringBuffer> >::Value);
+    EXPECT_FALSE(internal::IsSizedHandler<BaseReaderHandler<> >::Value);
+
+    const std::string cbor("\x83\xA2\x61" "a" "\x80\x61" "b" "\xBF\xFF\x9F\xFF\x81\x01", 13);
+    SizedHandler h;
+    CborReader reader;
+    EXPECT_FALSE(reader.Parse(cbor.data(), cbor.size(), h).IsError());
+    static const int expected[] = { 3, 2, 0, -1, -1, 1 };
+    EXPECT_EQ(std::vector<int>(expected, expected + 6), h.sizes);
+
+    // A document reserves its stack for the elements at once.
+    std::string definite("\x99\x03\xE8", 3), indefinite("\x9F", 1);
+    definite.append(1000, '\x00');
+    indefinite.append(1000, '\x00');
+    indefinite += '\xFF';
+    typedef GenericDocument<UTF8<>, MemoryPoolAllocator<>, GrowthCountingAllocator> DocumentType;
+    GrowthCountingAllocator::count = 0;
+    CborSource<UTF8<>, 0> source(indefinite);
+    DocumentType d;
+    d.Populate(source);
+    EXPECT_EQ(1000u, d.Size());
+    EXPECT_GT(GrowthCountingAllocator::count, 2);
+    GrowthCountingAllocator::count = 0;
+    source.cbor = definite;
+    d.Populate(source);
+    EXPECT_EQ(1000u, d.Size());
+    EXPECT_EQ(1, GrowthCountingAllocator::count);
+}
+
+#define TEST_ERROR(flags, cbor, errorCode, errorOffset) \
+    do { \
+        const std::string m(cbor, sizeof(cbor) - 1); \
+        BaseReaderHandler<> h; \
+        CborReader reader; \
+        reader.Parse<flags>(m.data(), m.size(), h); \
+        EXPECT_TRUE(reader.HasParseError()); \
+        EXPECT_EQ(errorCode, reader.GetParseErrorCode()); \
+        EXPECT_EQ(errorOffset, reader.GetErrorOffset()); \
+    } while (false)
+
+TEST(Cbor, Error) {
+    TEST_ERROR(0, "", kParseErrorDocumentEmpty, 0u);
+    TEST_ERROR(0, "\x41" "a", kParseErrorValueInvalid, 0u);         // byte string
+    TEST_ERROR(0, "\x81\x5F\xFF", kParseErrorValueInvalid, 1u);     // indefinite byte string
+    TEST_ERROR(0, "\xF0", kParseErrorValueInvalid, 0u);             // unassigned simple value
+    TEST_ERROR(0, "\xF8\x20", kParseErrorValueInvalid, 0u);         // simple value
+    TEST_ERROR(0, "\x1C", kParseErrorValueInvalid, 0u);             // reserved
+    TEST_ERROR(0, "\x1F", kParseErrorValueInvalid, 0u);             // indefinite integer
+    TEST_ERROR(0, "\xDF\x01", kParseErrorValueInvalid, 0u);         // indefinite tag
+    TEST_ERROR(0, "\xFF", kParseErrorValueInvalid, 0u);             // break without a container
+    TEST_ERROR(0, "\xBF\x61" "a" "\xFF", kParseErrorValueInvalid, 3u);  // break before a value
+
+    // Truncated items
+    TEST_ERROR(0, "\x19\x01", kParseErrorValueInvalid, 0u);
+    TEST_ERROR(0, "\xFB\x00\x00\x00", kParseErrorValueInvalid, 0u);
+    TEST_ERROR(0, "\x62" "a", kParseErrorValueInvalid, 0u);
+    TEST_ERROR(0, "\xC0", kParseErrorValueInvalid, 0u);
+    TEST_ERROR(0, "\x82\x01", kParseErrorValueInvalid, 0u);         // size beyond the data
+    TEST_ERROR(0, "\x82\x82\x01\x01", kParseErrorValueInvalid, 4u);
+    TEST_ERROR(0, "\xA1\x61" "a", kParseErrorValueInvalid, 3u);
+    TEST_ERROR(0, "\x9A\xFF\xFF\xFF\xFF\x01", kParseErrorValueInvalid, 0u);
+    TEST_ERROR(0, "\x9F\x01", kParseErrorValueInvalid, 2u);
+    TEST_ERROR(0, "\x7F\x61" "a", kParseErrorValueInvalid, 0u);
+    TEST_ERROR(0, "\x7F\x01\xFF", kParseErrorValueInvalid, 0u);     // chunk of another type
+    TEST_ERROR(0, "\x7F\x7F\xFF\xFF", kParseErrorValueInvalid, 0u); // nested indefinite chunk
+
+    // Non-string keys
+    TEST_ERROR(0, "\xA1\x01\x01", kParseErrorObjectMissName, 1u);
+    TEST_ERROR(0, "\x81\xBF\x80\x01\xFF", kParseErrorObjectMissName, 2u);
+    TEST_ERROR(0, "\xA1\x41" "a" "\x01", kParseErrorObjectMissName, 1u);
+
+    // Trailing data
+    TEST_ERROR(0, "\x01\x02", kParseErrorDocumentRootNotSingular, 1u);
+    TEST_ERROR(0, "\x9F\xFF\xFF", kParseErrorDocumentRootNotSingular, 2u);
+
+    // Invalid UTF-8 is only detected by validation.
+    TEST_ERROR(kParseValidateEncodingFlag, "\x61\xFF", kParseErrorStringInvalidEncoding, 0u);
+    TEST_ERROR(kParseValidateEncodingFlag, "\xA1\x62\xC3\xA9\x62\xC3\x28", kParseErrorStringInvalidEncoding, 4u);
+    TEST_ERROR(kParseValidateEncodingFlag, "\x7F\x61\xC3\x61\xA9\xFF", kParseErrorStringInvalidEncoding, 0u);  // split sequence
+    {
+        BaseReaderHandler<> h;
+        CborReader reader;
+        EXPECT_FALSE(reader.Parse("\x61\xFF", 2, h).IsError());
+        EXPECT_FALSE(reader.Parse<kParseValidateEncodingFlag>("\x62\xC3\xA9", 3, h).IsError());
+    }
+}
+
+TEST(Cbor, StopWhenDone) {
+    const std::string m("\x81\x01\x82\x02\x03", 5);
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    CborReader reader;
+    ParseResult r = reader.Parse<kParseStopWhenDoneFlag>(m.data(), m.size(), writer);
+    EXPECT_FALSE(r.IsError());
+    EXPECT_STREQ("[1]", sb.GetString());
+}
+
+// Handler which returns false after a number of events.
+struct TerminateHandler : BaseReaderHandler<UTF8<>, TerminateHandler> {
+    TerminateHandler(int count) : count_(count) {}
+    bool Default() { return count_-- > 0; }
+    int count_;
+};
+
+TEST(Cbor, Termination) {
+    const std::string m("\xBF\x61" "a" "\x88\xF6\xF5\x01\x20\x1B\x00\x00\x00\x01\x00\x00\x00\x00\xF9\x3E\x00\x61" "s" "\x7F\xFF"
+                        "\x61" "b" "\xA0\xFF", 28);
+    for (int i = 0; i <= 16; i++) {
+        TerminateHandler h(i);
+        CborReader reader;
+        ParseResult r = reader.Parse(m.data(), m.size(), h);
+        if (i < 16)
+            EXPECT_EQ(kParseErrorTermination, r.Code()) << i;
+        else
+            EXPECT_FALSE(r.IsError());
+    }
+}
+
+TEST(Cbor, Writer) {
+    // Numbers and values given as JSON text
+    const char* json = "[1, -1, 1.5, 18446744073709551615, 1e-400, {\"a\": \"b\"}]";
+    StringBuffer sb;
+    CborWriter<StringBuffer> writer(sb);
+    Reader reader;
+    StringStream s(json);
+    EXPECT_FALSE(reader.Parse<kParseNumbersAsStringsFlag>(s, writer).IsError());
+    EXPECT_TRUE(writer.IsComplete());
+    const std::string m(sb.GetString(), sb.GetSize());
+    EXPECT_EQ(std::string("\x86\x01\x20\xF9\x3E\x00", 6), m.substr(0, 6));
+    EXPECT_EQ("[1,-1,1.5,18446744073709551615,0.0,{\"a\":\"b\"}]", Decode(m));
+
+    writer.Reset(sb);
+    sb.Clear();
+    EXPECT_FALSE(writer.IsComplete());
+    EXPECT_TRUE(writer.StartObject());
+    EXPECT_TRUE(writer.Key("a"));
+    EXPECT_TRUE(writer.RawValue("[1, {\"b\": null}]", 16, kArrayType));
+    EXPECT_FALSE(writer.IsComplete());
+    EXPECT_EQ(0u, sb.GetSize());    // buffered until the root ends
+    EXPECT_TRUE(writer.EndObject());
+    EXPECT_TRUE(writer.IsComplete());
+    EXPECT_EQ("{\"a\":[1,{\"b\":null}]}", Decode(std::string(sb.GetString(), sb.GetSize())));
+
+    // Special doubles
+    writer.Reset(sb);
+    sb.Clear();
+    EXPECT_TRUE(writer.StartArray());
+    EXPECT_TRUE(writer.Double(std::numeric_limits<double>::quiet_NaN()));
+    EXPECT_TRUE(writer.Double(std::numeric_limits<double>::infinity()));
+    EXPECT_TRUE(writer.Double(-std::numeric_limits<double>::infinity()));
+    EXPECT_TRUE(writer.Double(std::numeric_limits<double>::denorm_min()));
+    EXPECT_TRUE(writer.EndArray());
+    EXPECT_EQ(std::string("\x84\xF9\x7E\x00\xF9\x7C\x00\xF9\xFC\x00\xFB\x00\x00\x00\x00\x00\x00\x00\x01", 19), std::string(sb.GetString(), sb.GetSize()));
+
+    writer.Reset(sb);
+    sb.Clear();
+    EXPECT_TRUE(writer.String("root"));
+    EXPECT_TRUE(writer.IsComplete());
+    EXPECT_EQ(std::string("\x64" "root"), std::string(sb.GetString(), sb.GetSize()));
+}
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
@@ -395,6 +395,695 @@ TEST(Document, UTF16_Document) {
     EXPECT_EQ(0, memcmp(L"Wed Oct 30 17:13:20 +0000 2012", s.GetString(), (s.GetStringLength() + 1) * sizeof(wchar_t)));
 }
 
+template <typename DocumentType>
+static std::basic_string<typename DocumentType::Ch> Stringify(const DocumentType& d) {
+    GenericStringBuffer<typename DocumentType::EncodingType> sb;
+    Writer<GenericStringBuffer<typename DocumentType::EncodingType>, typename DocumentType::EncodingType, typename DocumentType::EncodingType> writer(sb);
+    d.Accept(writer);
+    return sb.GetString();
+}
+
+template <unsigned parseFlags, typename DocumentType>
+static void TestParseLazy(const typename DocumentType::Ch* json) {
+    DocumentType expected;
+    expected.template Parse<parseFlags>(json);
+    ASSERT_FALSE(expected.HasParseError()) << json;
+
+    DocumentType lazy;
+    lazy.template ParseLazy<parseFlags>(json);
+    ASSERT_FALSE(lazy.HasParseError()) << json;
+    EXPECT_TRUE(lazy == expected) << json;
+    EXPECT_TRUE(Stringify(lazy) == Stringify(expected)) << json;
+    EXPECT_FALSE(lazy.HasParseError()) << json;
+}
+
+TEST(Document, ParseLazy) {
+    static const char* json[] = {
+        "{}", "[]", " 1 ", "\"str\"", "null",
+        "{ \"hello\" : \"world\", \"t\" : true , \"f\" : false, \"n\": null, \"i\":123, \"pi\": 3.1416, \"a\":[1, 2, 3, 4] } ",
+        "[[[[[]]]], {\"a\": {\"b\": {}}}, [{}, [], {\"c\": [1, {\"d\": []}]}], \"]}\\\"[{\", {\"[\": \"{\"}, 18446744073709551615, -1.5e-30]",
+        "{\"a\\\\\": [\"\\\\\", \"\\\"\"], \"b\": [[1], [2, [3, [4]]]], \"c\": {\"\\u0041\": {}}}"
+    };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+        TestParseLazy<kParseDefaultFlags, Document>(json[i]);
+        TestParseLazy<kParseDefaultFlags, GenericDocument<UTF8<>, CrtAllocator> >(json[i]);
+    }
+
+    // Long enough for several SIMD blocks and refills of the structural index.
+    std::string big = "[";
+    for (int i = 0; i < 20000; i++)
+        big += i % 3 ? "{\"k\\\"]\": [1, \"x\\\\\", {\"y\": [true, null]}]}," : "  \"\\\\\\\"[{\" ,";
+    big += "0]";
+    TestParseLazy<kParseDefaultFlags, Document>(big.c_str());
+
+    TestParseLazy<kParseTrailingCommasFlag, Document>("{\"a\": [1, 2, {\"b\": [],},], \"c\": {},}");
+    TestParseLazy<kParseNumbersAsStringsFlag, Document>("{\"a\": [1, -2.5e10, 12345678901234567890123]}");
+    TestParseLazy<kParseFullPrecisionFlag | kParseNanAndInfFlag, Document>("[[0.1, 3.14159265358979323846], [-Infinity, 1]]");
+    TestParseLazy<kParseValidateEncodingFlag, GenericDocument<UTF16<> > >(L"[{\"created_at\":\"Wed Oct 30 17:13:20 +0000 2012\", \"\\u00e9\": [[]]}]");
+}
+
+TEST(Document, ParseLazy_SparseAccess) {
+    std::string json = "{\"records\": [";
+    for (int i = 0; i < 1000; i++)
+        json += "{\"id\": 12345, \"name\": \"a name long enough to be copied\", \"score\": 0.5, \"active\": true, \"tags\": [\"x\", \"y\", \"z\"]},";
+    json += "{}], \"count\": 1001, \"meta\": {\"version\": 2}}";
+
+    Document full;
+    full.Parse(json.c_str());
+    Document lazy;
+    lazy.ParseLazy(json.c_str());
+    ASSERT_FALSE(lazy.HasParseError());
+    ASSERT_TRUE(lazy.IsObject());
+
+    EXPECT_EQ(2, lazy["meta"]["version"].GetInt());
+    EXPECT_EQ(1001, lazy["count"].GetInt());
+    ASSERT_TRUE(lazy["records"].IsArray());
+    EXPECT_STREQ("y", lazy["records"][500]["tags"][1].GetString());
+
+    // Only the root, "meta", "records" and one of its records have been expanded.
+    EXPECT_LT(lazy.GetAllocator().Size() * 4, full.GetAllocator().Size());
+
+    // Everything else is expanded on demand.
+    EXPECT_EQ(1001u, lazy["records"].Size());
+    EXPECT_TRUE(lazy == full);
+}
+
+TEST(Document, ParseLazy_Error) {
+    // Unbalanced brackets and unterminated strings are found by ParseLazy() itself.
+    {
+        Document d;
+        d.ParseLazy("{\"a\": [1, 2}");
+        EXPECT_EQ(kParseErrorArrayMissCommaOrSquareBracket, d.GetParseError());
+        EXPECT_EQ(11u, d.GetErrorOffset());
+        EXPECT_TRUE(d.IsNull());   // unchanged
+
+        d.ParseLazy("[{\"a\": \"]}");
+        EXPECT_EQ(kParseErrorObjectMissCommaOrCurlyBracket, d.GetParseError());
+        EXPECT_EQ(10u, d.GetErrorOffset());
+
+        d.ParseLazy("[[1]] x");
+        EXPECT_EQ(kParseErrorDocumentRootNotSingular, d.GetParseError());
+        EXPECT_EQ(6u, d.GetErrorOffset());
+
+        d.ParseLazy("");
+        EXPECT_EQ(kParseErrorDocumentEmpty, d.GetParseError());
+
+        d.ParseLazy<kParseStopWhenDoneFlag>("[[1]] x");
+        EXPECT_FALSE(d.HasParseError());
+        EXPECT_EQ(1, d[0][0].GetInt());
+
+        GenericDocument<UTF16<> > w;
+        w.ParseLazy(L"[{\"a\": []]");
+        EXPECT_EQ(kParseErrorObjectMissCommaOrCurlyBracket, w.GetParseError());
+        EXPECT_EQ(9u, w.GetErrorOffset());
+    }
+
+    // Other errors are found when the enclosing container is expanded, with the same code and offset as Parse().
+    static const char* json[] = {
+        "[1, {\"a\": tru}]", "[1, [1 2]]", "[[1,]]", "[{\"a\" 1}]", "[{1: 2}]", "[{\"a\": 1,}]", "[[\"\\x\"]]", "[{\"a\": [[], -]}]"
+    };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+        Document expected;
+        expected.Parse(json[i]);
+        ASSERT_TRUE(expected.HasParseError());
+
+        Document d;
+        d.ParseLazy(json[i]);
+        EXPECT_FALSE(d.HasParseError()) << json[i];
+        Stringify(d);
+        EXPECT_EQ(expected.GetParseError(), d.GetParseError()) << json[i];
+        EXPECT_EQ(expected.GetErrorOffset(), d.GetErrorOffset()) << json[i];
+    }
+
+    // The container with the error is left empty.
+    Document d;
+    d.ParseLazy("[1, {\"a\": 1, \"b\": x}, [2]]");
+    EXPECT_EQ(3u, d.Size());
+    EXPECT_TRUE(d[1].IsObject());
+    EXPECT_TRUE(d[1].ObjectEmpty());
+    EXPECT_TRUE(d.HasParseError());
+    EXPECT_EQ(2, d[2][0].GetInt());
+    EXPECT_EQ(kParseErrorValueInvalid, d.GetParseError());   // the first error is kept
+
+    // Parsing again clears deferred errors.
+    d.Parse("[]");
+    EXPECT_FALSE(d.HasParseError());
+}
+
+TEST(Document, ParseLazy_Ownership) {
+    const char json[] = "{\"a\": {\"b\": [1, 2]}, \"c\": [{\"d\": true}]}";
+    Document d1;
+    d1.ParseLazy(json);
+
+    // Deferred values keep working after the document is moved or swapped.
+    Document d2;
+    d2.Swap(d1);
+    EXPECT_TRUE(d1.IsNull());
+    EXPECT_EQ(2, d2["a"]["b"][1].GetInt());
+
+    // ... or the value is moved elsewhere within the document.
+    Value c;
+    c = d2["c"];
+    EXPECT_TRUE(d2["c"].IsNull());
+    EXPECT_TRUE(c[0]["d"].GetBool());
+
+    // Deep copies are independent of the JSON text.
+    Document copy;
+    copy.CopyFrom(d2, copy.GetAllocator());
+    EXPECT_EQ(Stringify(d2), Stringify(copy));
+
+    // Modifying a deferred container expands it first.
+    Document d3;
+    d3.ParseLazy(json);
+    d3["a"].AddMember("e", 3, d3.GetAllocator());
+    d3["c"].PushBack(4, d3.GetAllocator());
+    d3["a"]["b"].Clear();
+    EXPECT_EQ(std::string("{\"a\":{\"b\":[],\"e\":3},\"c\":[{\"d\":true},4]}"), Stringify(d3));
+
+    // A const document expands just the same.
+    Document d4;
+    d4.ParseLazy(json);
+    const Document& cd = d4;
+    EXPECT_TRUE(cd.HasMember("c"));
+    EXPECT_EQ(1u, cd["c"].Size());
+    EXPECT_EQ(cd["c"].Begin() + 1, cd["c"].End());
+    EXPECT_EQ(2u, cd.MemberCount());
+
+    // Copies made before the document is parsed again stay valid.
+    GenericDocument<UTF8<>, CrtAllocator> d5;
+    d5.ParseLazy(json);
+    GenericValue<UTF8<>, CrtAllocator> a(d5["a"], d5.GetAllocator());
+    d5.Parse("[]");
+    EXPECT_FALSE(d5.HasParseError());
+    d5.ParseLazy("{\"x\": [}");
+    EXPECT_TRUE(d5.HasParseError());
+    d5.ParseLazy(json);
+    EXPECT_FALSE(d5.HasParseError());
+    EXPECT_TRUE(a == d5["a"]);
+    EXPECT_EQ(2, a["b"][1].GetInt());
+}
+
+// Stack allocator counting the live blocks of all instances.
+struct LiveBlockAllocator {
+    static const bool kNeedFree = true;
+    void* Malloc(size_t size) { void* p = CrtAllocator().Malloc(size); if (p) ++Count(); return p; }
+    void* Realloc(void* originalPtr, size_t originalSize, size_t newSize) {
+        if (!originalPtr)
+            return Malloc(newSize);
+        if (!newSize)
+            --Count();
+        return CrtAllocator().Realloc(originalPtr, originalSize, newSize);
+    }
+    static void Free(void* ptr) { if (ptr) --Count(); CrtAllocator::Free(ptr); }
+    static int& Count() { static int count = 0; return count; }
+};
+
+TEST(Document, ParseLazy_Reparse) {
+    // Parsing the same document again frees the state of the previous ParseLazy().
+    std::string json = "[";
+    for (int i = 0; i < 10000; i++)
+        json += "{\"a\": [1, {\"b\": 2}]},";
+    json += "{}]";
+
+    const int initial = LiveBlockAllocator::Count();
+    {
+        LiveBlockAllocator stackAllocator;
+        GenericDocument<UTF8<>, MemoryPoolAllocator<>, LiveBlockAllocator> d(0, 1024, &stackAllocator);
+        d.ParseLazy(json.c_str());
+        EXPECT_EQ(2, d[5000]["a"][1]["b"].GetInt());
+        const int count = LiveBlockAllocator::Count();
+        for (int i = 0; i < 5; i++) {
+            d.ParseLazy(json.c_str());
+            EXPECT_EQ(2, d[5000]["a"][1]["b"].GetInt());
+            EXPECT_EQ(count, LiveBlockAllocator::Count());
+        }
+        d.Parse("[]");
+        EXPECT_GT(count, LiveBlockAllocator::Count());
+    }
+    EXPECT_EQ(initial, LiveBlockAllocator::Count());
+}
+
+template <unsigned parseFlags, typename DocumentType>
+static void TestParseLazyNumbers(const typename DocumentType::Ch* json, const typename DocumentType::Ch* written) {
+    DocumentType expected;
+    expected.template Parse<parseFlags | kParseFullPrecisionFlag>(json);
+    ASSERT_FALSE(expected.HasParseError()) << json;
+
+    // Numbers are written back as they were in the text.
+    DocumentType lazy;
+    lazy.template Parse<parseFlags | kParseLazyNumbersFlag>(json);
+    ASSERT_FALSE(lazy.HasParseError()) << json;
+    EXPECT_TRUE(Stringify(lazy) == written) << json;
+
+    // Converted on access, they equal those of an eager parse.
+    EXPECT_TRUE(lazy == expected) << json;
+    EXPECT_TRUE(Stringify(lazy) == Stringify(expected)) << json;
+}
+
+TEST(Document, ParseLazyNumbers) {
+    TestParseLazyNumbers<kParseDefaultFlags, Document>("0", "0");
+    TestParseLazyNumbers<kParseDefaultFlags, Document>(
+        "[1.50, -0, 1e2, 123, -2147483649, 18446744073709551615, 18446744073709551616, 1.7976931348623157e308, 4.9e-324, 0.1000000000000000055511151231257827]",
+        "[1.50,-0,1e2,123,-2147483649,18446744073709551615,18446744073709551616,1.7976931348623157e308,4.9e-324,0.1000000000000000055511151231257827]");
+    TestParseLazyNumbers<kParseDefaultFlags, Document>("{\"a\": {\"b\": 2.0e-3}, \"c\": [\"1\", 1]}", "{\"a\":{\"b\":2.0e-3},\"c\":[\"1\",1]}");
+    TestParseLazyNumbers<kParseDefaultFlags, GenericDocument<UTF8<>, CrtAllocator> >("[12345678901234567890.5, 3]", "[12345678901234567890.5,3]");
+    TestParseLazyNumbers<kParseDefaultFlags, GenericDocument<UTF16<> > >(L"[1.0E+2, {\"x\": -7}]", L"[1.0E+2,{\"x\":-7}]");
+
+    // Infinity and NaN are converted right away.
+    {
+        Document d;
+        d.Parse<kParseLazyNumbersFlag | kParseNanAndInfFlag>("[-Infinity, NaN, 1.0]");
+        ASSERT_FALSE(d.HasParseError());
+        EXPECT_TRUE(d[0].IsDouble());
+        EXPECT_EQ(-std::numeric_limits<double>::infinity(), d[0].GetDouble());
+        EXPECT_TRUE(internal::Double(d[1].GetDouble()).IsNan());
+        EXPECT_EQ(1.0, d[2].GetDouble());
+    }
+
+    // Containers deferred by ParseLazy() keep the flag when expanded.
+    {
+        Document d;
+        d.ParseLazy<kParseLazyNumbersFlag>("{\"a\": [1.0, [2.50]], \"b\": 3}");
+        ASSERT_FALSE(d.HasParseError());
+        EXPECT_EQ(std::string("{\"a\":[1.0,[2.50]],\"b\":3}"), Stringify(d));
+        EXPECT_EQ(2.5, d["a"][1][0].GetDouble());
+    }
+
+    // Shortest round-trip representations of random doubles.
+    uint64_t x = RAPIDJSON_UINT64_C2(0x9E3779B9, 0x7F4A7C15);
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    writer.StartArray();
+    for (int i = 0; i < 1000; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        writer.Double(internal::Double(x & RAPIDJSON_UINT64_C2(0x7FEFFFFF, 0xFFFFFFFF)).Value());
+        writer.Int64(static_cast<int64_t>(x));
+    }
+    writer.EndArray();
+    TestParseLazyNumbers<kParseDefaultFlags, Document>(sb.GetString(), sb.GetString());
+}
+
+TEST(Document, ParseLazyNumbers_Access) {
+    Document d;
+    d.Parse<kParseLazyNumbersFlag>("[1, -1, 4294967296, -4294967296, 18446744073709551615, 1.5, 100000000000000000000]");
+    ASSERT_FALSE(d.HasParseError());
+
+    // Type queries convert the number too.
+    EXPECT_TRUE(d[0].IsNumber());
+    EXPECT_TRUE(d[0].IsInt());
+    EXPECT_TRUE(d[0].IsUint());
+    EXPECT_EQ(1u, d[0].GetUint());
+    EXPECT_TRUE(d[1].IsInt());
+    EXPECT_FALSE(d[1].IsUint());
+    EXPECT_EQ(-1, d[1].GetInt());
+    EXPECT_FALSE(d[2].IsUint());
+    EXPECT_TRUE(d[2].IsInt64());
+    EXPECT_EQ(static_cast<int64_t>(RAPIDJSON_UINT64_C2(1, 0)), d[2].GetInt64());
+    EXPECT_EQ(-static_cast<int64_t>(RAPIDJSON_UINT64_C2(1, 0)), d[3].GetInt64());
+    EXPECT_TRUE(d[4].IsUint64());
+    EXPECT_FALSE(d[4].IsInt64());
+    EXPECT_EQ(RAPIDJSON_UINT64_C2(0xFFFFFFFF, 0xFFFFFFFF), d[4].GetUint64());
+    EXPECT_EQ(1.5, d[5].GetDouble());
+    EXPECT_TRUE(d[5].IsFloat());
+    EXPECT_TRUE(d[6].IsDouble());
+    EXPECT_EQ(1e20, d[6].GetDouble());
+
+    // Once converted, numbers are written as usual.
+    EXPECT_EQ(std::string("[1,-1,4294967296,-4294967296,18446744073709551615,1.5,100000000000000000000.0]"), Stringify(d));
+}
+
+TEST(Document, ParseLazyNumbers_Ownership) {
+    // Text longer than a short string is copied, shorter text is kept inline and insitu text is referenced.
+    const char json[] = "[0.100000000000000000000000000001, 2.5]";
+    char buffer[sizeof(json)];
+    memcpy(buffer, json, sizeof(json));
+
+    GenericDocument<UTF8<>, CrtAllocator> d1;
+    d1.Parse<kParseLazyNumbersFlag>(json);
+    Document d2;
+    d2.ParseInsitu<kParseLazyNumbersFlag>(buffer);
+    ASSERT_FALSE(d1.HasParseError());
+    ASSERT_FALSE(d2.HasParseError());
+    EXPECT_EQ(std::string("[0.100000000000000000000000000001,2.5]"), Stringify(d1));
+    EXPECT_EQ(std::string("[0.100000000000000000000000000001,2.5]"), Stringify(d2));
+
+    // Copies keep the text unconverted, independent of the source.
+    GenericValue<UTF8<>, CrtAllocator> v1(d1, d1.GetAllocator());
+    Document d3;
+    d3.CopyFrom(d2, d3.GetAllocator());
+    EXPECT_EQ(std::string("[0.100000000000000000000000000001,2.5]"), Stringify(d3));
+    EXPECT_EQ(0.1, d1[0].GetDouble());
+    EXPECT_EQ(std::string("[0.1,2.5]"), Stringify(d1));
+    EXPECT_EQ(std::string("[0.100000000000000000000000000001,2.5]"), Stringify(v1));
+    EXPECT_EQ(2.5, v1[1].GetDouble());
+    EXPECT_EQ(2.5, d3[1].GetDouble());
+
+    // The copied text is counted as memory used by the value.
+    GenericDocument<UTF8<>, CrtAllocator> d4;
+    d4.Parse<kParseLazyNumbersFlag>(json);
+    EXPECT_GT(d4.GetMemoryUsage(), d1.GetMemoryUsage());
+
+    // Numbers with a deferred conversion can be reassigned.
+    d4[0] = 3;
+    d4[1].SetString("x");
+    EXPECT_EQ(std::string("[3,\"x\"]"), Stringify(d4));
+}
+
+TEST(Document, ParseLazyNumbers_Compact) {
+    // Copied text moves to the new allocator, as the old one is released.
+    const char json[] = "{\"a\": [0.100000000000000000000000000001, 2.5], \"b\": 12345678901234567890123}";
+    GenericDocument<UTF8<>, CrtAllocator> d1;
+    d1.Parse<kParseLazyNumbersFlag>(json);
+    ASSERT_FALSE(d1.HasParseError());
+    d1.Compact();
+    EXPECT_EQ(std::string("{\"a\":[0.100000000000000000000000000001,2.5],\"b\":12345678901234567890123}"), Stringify(d1));
+    EXPECT_EQ(0.1, d1["a"][0].GetDouble());
+
+    Document d2;
+    d2.Parse<kParseLazyNumbersFlag>(json);
+    ASSERT_FALSE(d2.HasParseError());
+    d2.Compact();
+    EXPECT_EQ(std::string("{\"a\":[0.100000000000000000000000000001,2.5],\"b\":12345678901234567890123}"), Stringify(d2));
+    EXPECT_EQ(2.5, d2["a"][1].GetDouble());
+}
+
+TEST(Document, ParseStringRefs) {
+    const char json[] = "{\"name\": \"a string long enough to be copied\", \"tags\": [\"x\", \"tab\\there\"], \"n\": 1}";
+    Document expected;
+    expected.Parse(json);
+
+    // Strings without escapes refer to the input, the others are copied.
+    Document d;
+    d.Parse<kParseStringRefsFlag>(json);
+    ASSERT_FALSE(d.HasParseError());
+    EXPECT_TRUE(d == expected);
+    EXPECT_EQ(json + 10, d["name"].GetString());
+    EXPECT_EQ(json + 56, d["tags"][0].GetString());
+    EXPECT_STREQ("tab\there", d["tags"][1].GetString());
+    EXPECT_TRUE(d.HasMember("n"));
+    EXPECT_LT(d.GetMemoryUsage(), expected.GetMemoryUsage());
+    EXPECT_EQ(Stringify(expected), Stringify(d));
+
+    // Like other constant strings, they are not copied by deep copies either.
+    Document copy;
+    copy.CopyFrom(d, copy.GetAllocator());
+    EXPECT_EQ(d["name"].GetString(), copy["name"].GetString());
+    EXPECT_TRUE(copy == expected);
+
+    // The same with ParseLazy() and kParseInternKeysFlag.
+    Document lazy;
+    lazy.ParseLazy<kParseStringRefsFlag | kParseInternKeysFlag>(json);
+    EXPECT_EQ(json + 56, lazy["tags"][0].GetString());
+    EXPECT_TRUE(lazy == expected);
+}
+
+template <unsigned parseFlags, typename DocumentType>
+static void TestParseInternKeys(const typename DocumentType::Ch* json) {
+    DocumentType expected;
+    expected.template Parse<parseFlags>(json);
+    DocumentType interned;
+    interned.template Parse<parseFlags | kParseInternKeysFlag>(json);
+    EXPECT_EQ(expected.GetParseError(), interned.GetParseError());
+    if (!expected.HasParseError()) {
+        EXPECT_TRUE(interned == expected);
+        EXPECT_TRUE(Stringify(interned) == Stringify(expected));
+    }
+}
+
+TEST(Document, ParseInternKeys) {
+    static const char* json[] = {
+        "{}", "[]", "{\"\": 1}",
+        "{ \"hello\" : \"world\", \"t\" : true , \"f\" : false, \"n\": null, \"i\":123, \"pi\": 3.1416, \"a\":[1, 2, 3, 4] } ",
+        "[{\"a longer name of a record\": 1, \"b\": {\"a longer name of a record\": [2]}}, {\"b\": 3, \"a longer name of a record\": 4}]",
+        "[{\"a\\u0000b long enough to be pooled\": 1}, {\"a\\u0000c long enough to be pooled\": 2}]",
+        "[{\"a\": 1}, {\"a\": ", "{\"name which is not short\": 1, \"name which is not short\" 2}"
+    };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+        TestParseInternKeys<kParseDefaultFlags, Document>(json[i]);
+        TestParseInternKeys<kParseDefaultFlags, GenericDocument<UTF8<>, CrtAllocator> >(json[i]);
+        TestParseInternKeys<kParseIterativeFlag, Document>(json[i]);
+    }
+    TestParseInternKeys<kParseDefaultFlags, GenericDocument<UTF16<> > >(L"[{\"created_at\": 1, \"\\u00e9\": 2}, {\"created_at\": 3}]");
+
+    // Equal names share one copy.
+    std::string records = "[";
+    char buffer[64];
+    for (int i = 0; i < 1000; i++) {
+        sprintf(buffer, "%s{\"identifier\": %d, \"description of item %d\": true}", i ? "," : "", i, i % 10);
+        records += buffer;
+    }
+    records += "]";
+    Document d;
+    d.Parse<kParseInternKeysFlag>(records.c_str());
+    ASSERT_FALSE(d.HasParseError());
+    const char* identifier = d[0].MemberBegin()->name.GetString();
+    for (SizeType i = 0; i < d.Size(); i++) {
+        EXPECT_EQ(identifier, d[i].MemberBegin()->name.GetString());
+        EXPECT_EQ(static_cast<int>(i), d[i][RAPIDJSON_KEY("identifier")].GetInt());
+        EXPECT_EQ((d[i % 10].MemberBegin() + 1)->name.GetString(), (d[i].MemberBegin() + 1)->name.GetString());
+        sprintf(buffer, "description of item %u", i % 10);
+        EXPECT_TRUE(d[i].HasMember(buffer));
+        sprintf(buffer, "description of item %u", (i + 1) % 10);
+        EXPECT_FALSE(d[i].HasMember(buffer));
+    }
+    Document copy;
+    copy.CopyFrom(d, copy.GetAllocator());
+    EXPECT_NE(identifier, copy[0].MemberBegin()->name.GetString());
+    EXPECT_TRUE(copy == d);
+
+    // Names parsed in situ are not copied.
+    char insitu[] = "{\"a name in the text\": [{\"a name in the text\": 1}]}";
+    d.ParseInsitu<kParseInternKeysFlag>(insitu);
+    ASSERT_FALSE(d.HasParseError());
+    EXPECT_TRUE(d.MemberBegin()->name.GetString() >= insitu && d.MemberBegin()->name.GetString() < insitu + sizeof(insitu));
+    EXPECT_EQ(1, d[RAPIDJSON_KEY("a name in the text")][0][RAPIDJSON_KEY("a name in the text")].GetInt());
+}
+
+#if RAPIDJSON_HAS_CXX11_ATOMIC
+TEST(Document, ConcurrentMemoryPoolAllocator) {
+    ChunkPool<> pool;
+    for (int i = 0; i < 3; i++) {
+        ConcurrentMemoryPoolAllocator<> allocator(&pool);
+        GenericDocument<UTF8<>, ConcurrentMemoryPoolAllocator<> > d(&allocator);
+        d.Parse("{\"hello\":\"world\",\"a\":[1,2,3.5,{\"b\":null}]}");
+        ASSERT_FALSE(d.HasParseError());
+        EXPECT_EQ(std::string("{\"hello\":\"world\",\"a\":[1,2,3.5,{\"b\":null}]}"), Stringify(d));
+    }
+}
+#endif
+
+template <typename DocumentType>
+static void TestCompact(const typename DocumentType::Ch* json) {
+    DocumentType d;
+    d.Parse(json);
+    ASSERT_FALSE(d.HasParseError());
+    const std::basic_string<typename DocumentType::Ch> expected = Stringify(d);
+    DocumentType copy;
+    copy.CopyFrom(d, copy.GetAllocator());
+    d.Compact();
+    EXPECT_TRUE(d == copy);
+    EXPECT_TRUE(Stringify(d) == expected);
+}
+
+TEST(Document, Compact) {
+    static const char* json[] = {
+        "null", "[]", "{}", "\"a string which is long enough to be copied\"",
+        "{ \"hello\" : \"world\", \"t\" : true , \"f\" : false, \"n\": null, \"i\":123, \"pi\": 3.1416, \"a\":[1, 2, 3, 4] } ",
+        "[{\"a\": [[], {}, [{\"b\": \"a string which is long enough to be copied\"}]]}, -1, 1e100, \"\\u0000\"]"
+    };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+        TestCompact<Document>(json[i]);
+        TestCompact<GenericDocument<UTF8<>, CrtAllocator> >(json[i]);
+    }
+
+    // Releases the memory left behind by modifications.
+    Document d;
+    d.SetObject();
+    char buffer[64];
+    for (int i = 0; i < 100; i++) {
+        sprintf(buffer, "member name number %d", i);
+        Value a(kArrayType);
+        for (int j = 0; j < i; j++)
+            a.PushBack(Value(buffer, d.GetAllocator()).Move(), d.GetAllocator());
+        d.AddMember(Value(buffer, d.GetAllocator()).Move(), a, d.GetAllocator());
+    }
+    for (int i = 0; i < 100; i += 2) {
+        sprintf(buffer, "member name number %d", i);
+        d.RemoveMember(buffer);
+    }
+    const std::string expected = Stringify(d);
+    const size_t size = d.GetAllocator().Size();
+    const size_t usage = d.GetMemoryUsage() - sizeof(Value);
+    EXPECT_LT(usage, size / 2);
+    d.Compact();
+    EXPECT_EQ(expected, Stringify(d));
+    EXPECT_GT(usage, d.GetMemoryUsage() - sizeof(Value));   // exact capacities
+    EXPECT_LE(d.GetMemoryUsage() - sizeof(Value), d.GetAllocator().Size());
+    EXPECT_GT(size / 2, d.GetAllocator().Size());
+
+    // Members are laid out depth-first.
+    const char* previous = reinterpret_cast<const char*>(&*d.MemberBegin());
+    for (Value::ConstMemberIterator m = d.MemberBegin(); m != d.MemberEnd(); ++m) {
+        EXPECT_LT(previous, m->name.GetString());
+        previous = m->name.GetString();
+        if (!m->value.Empty()) {
+            EXPECT_LT(previous, reinterpret_cast<const char*>(m->value.Begin()));
+            previous = m->value[m->value.Size() - 1].GetString();
+        }
+    }
+
+    // The document can be modified further, and found by name with the member index.
+    d.AddMember("x", 1, d.GetAllocator());
+    EXPECT_TRUE(d.HasMember("member name number 99"));
+    EXPECT_FALSE(d.HasMember("member name number 98"));
+    EXPECT_EQ(1, d["x"].GetInt());
+
+    // Into a given allocator
+    MemoryPoolAllocator<> allocator;
+    d.Compact(&allocator);
+    EXPECT_EQ(&allocator, &d.GetAllocator());
+    EXPECT_EQ(1, d["x"].GetInt());
+    d.Compact();
+    EXPECT_NE(&allocator, &d.GetAllocator());
+    allocator.Clear();
+    EXPECT_TRUE(d.HasMember("member name number 99"));
+
+    // Interned names stay shared, constant strings are not copied.
+    const char records[] = "[{\"a name long enough to be pooled\": \"a string in the text\"}, {\"a name long enough to be pooled\": 2}]";
+    d.Parse<kParseInternKeysFlag>(records);
+    d.Compact();
+    EXPECT_EQ(d[0].MemberBegin()->name.GetString(), d[1].MemberBegin()->name.GetString());
+    EXPECT_EQ(2, d[1][RAPIDJSON_KEY("a name long enough to be pooled")].GetInt());
+    char insitu[sizeof(records)];
+    std::memcpy(insitu, records, sizeof(records));
+    d.ParseInsitu(insitu);
+    d.Compact();
+    EXPECT_TRUE(d[0]["a name long enough to be pooled"].GetString() >= insitu && d[0]["a name long enough to be pooled"].GetString() < insitu + sizeof(insitu));
+    EXPECT_EQ(std::string("a string in the text"), d[0]["a name long enough to be pooled"].GetString());
+
+    // Deferred values are expanded.
+    const char lazy[] = "{\"a\": {\"b\": [1, 2]}, \"c\": [{\"d\": true}]}";
+    d.ParseLazy(lazy);
+    d.Compact();
+    EXPECT_EQ(std::string("{\"a\":{\"b\":[1,2]},\"c\":[{\"d\":true}]}"), Stringify(d));
+}
+
+TEST(Document, ColumnarDocument) {
+    ColumnarDocument d;
+    d.Parse("[{\"id\": 1, \"price\": 2, \"name\": \"a\", \"ok\": true, \"none\": null},"
+            " {\"id\": 2, \"price\": 3.5, \"ok\": false, \"none\": null},"
+            " {\"name\": \"c\", \"price\": null, \"id\": -3, \"extra\": \"x\"}]");
+    ASSERT_FALSE(d.HasParseError());
+    EXPECT_FALSE(d.HasShapeError());
+    EXPECT_EQ(3u, d.Size());
+    ASSERT_EQ(6u, d.ColumnCount());
+
+    const ColumnarDocument::Column& id = d.GetColumn(0);
+    EXPECT_STREQ("id", id.GetName());
+    EXPECT_EQ(ColumnarDocument::kInt64Column, id.GetType());
+    EXPECT_EQ(3u, id.Size());
+    EXPECT_EQ(0u, id.NullCount());
+    EXPECT_EQ(-3, id.GetInt64Values()[2]);
+    EXPECT_EQ(0.0, id.Sum());
+
+    // Integers are converted when a double follows.
+    const ColumnarDocument::Column* price = d.FindColumn("price");
+    ASSERT_TRUE(price != 0);
+    EXPECT_EQ(ColumnarDocument::kDoubleColumn, price->GetType());
+    EXPECT_EQ(2.0, price->GetDoubleValues()[0]);
+    EXPECT_EQ(3.5, price->GetDouble(1));
+    EXPECT_TRUE(price->IsNull(2));
+    EXPECT_FALSE(price->IsMissing(2));
+    EXPECT_EQ(5.5, price->Sum());
+
+    const ColumnarDocument::Column* name = d.FindColumn("name");
+    ASSERT_TRUE(name != 0);
+    EXPECT_EQ(ColumnarDocument::kStringColumn, name->GetType());
+    EXPECT_STREQ("a", name->GetString(0));
+    EXPECT_TRUE(name->IsMissing(1));
+    EXPECT_EQ(1u, name->NullCount());
+    EXPECT_EQ(1u, name->GetStringLength(2));
+
+    EXPECT_EQ(ColumnarDocument::kBoolColumn, d.FindColumn("ok")->GetType());
+    EXPECT_FALSE(d.FindColumn("ok")->GetBool(1));
+    EXPECT_TRUE(d.FindColumn("ok")->IsMissing(2));
+    EXPECT_EQ(ColumnarDocument::kNullColumn, d.FindColumn("none")->GetType());
+    EXPECT_EQ(3u, d.FindColumn("none")->NullCount());
+    EXPECT_TRUE(d.FindColumn("extra")->IsMissing(0));
+    EXPECT_TRUE(d.FindColumn("nothing") == 0);
+
+    // Members of each row are written in the order of the columns.
+    EXPECT_EQ(std::string(
+        "[{\"id\":1,\"price\":2.0,\"name\":\"a\",\"ok\":true,\"none\":null},"
+        "{\"id\":2,\"price\":3.5,\"ok\":false,\"none\":null},"
+        "{\"id\":-3,\"price\":null,\"name\":\"c\",\"extra\":\"x\"}]"), Stringify(d));
+
+    d.Parse("[]");
+    EXPECT_FALSE(d.HasParseError());
+    EXPECT_EQ(0u, d.Size());
+    EXPECT_EQ(0u, d.ColumnCount());
+    EXPECT_EQ(std::string("[]"), Stringify(d));
+
+    static const char* notColumnar[] = {
+        "{}", "1", "[1]", "[{}, []]", "[{\"a\": [1]}]", "[{\"a\": {}}]",
+        "[{\"a\": 1}, {\"a\": \"1\"}]", "[{\"a\": true}, {\"a\": 1.5}]", "[{\"a\": 1, \"a\": 2}]"
+    };
+    for (size_t i = 0; i < sizeof(notColumnar) / sizeof(notColumnar[0]); i++) {
+        d.Parse(notColumnar[i]);
+        EXPECT_EQ(kParseErrorTermination, d.GetParseError()) << notColumnar[i];
+        EXPECT_TRUE(d.HasShapeError()) << notColumnar[i];
+        EXPECT_EQ(0u, d.Size());
+    }
+    d.Parse("[{\"a\": 1}");
+    EXPECT_TRUE(d.HasParseError());
+    EXPECT_FALSE(d.HasShapeError());
+    EXPECT_EQ(0u, d.ColumnCount());
+}
+
+TEST(Document, ColumnarDocument_Records) {
+    std::string records = "[";
+    char buffer[128];
+    for (int i = 0; i < 1000; i++) {
+        if (i % 7 == 0)
+            sprintf(buffer, "%s{\"key\": %d, \"tag\": \"t%d\"}", i ? "," : "", i, i % 5);
+        else
+            sprintf(buffer, "%s{\"tag\": \"t%d\", \"key\": %d, \"value\": %s}", i ? "," : "", i % 5, i, i % 3 ? "0.25" : "null");
+        records += buffer;
+    }
+    records += "]";
+
+    Document expected;
+    expected.Parse(records.c_str());
+    GenericColumnarDocument<UTF8<>, CrtAllocator> d;
+    d.Parse(records.c_str());
+    ASSERT_FALSE(d.HasParseError());
+    ASSERT_EQ(1000u, d.Size());
+    ASSERT_EQ(3u, d.ColumnCount());
+    const GenericColumnarDocument<UTF8<>, CrtAllocator>::Column& key = *d.FindColumn("key");
+    const GenericColumnarDocument<UTF8<>, CrtAllocator>::Column& value = *d.FindColumn("value");
+    EXPECT_EQ(999.0 * 1000 / 2, key.Sum());
+    for (SizeType i = 0; i < d.Size(); i++) {
+        EXPECT_EQ(expected[i]["key"].GetInt64(), key.GetInt64Values()[i]);
+        EXPECT_STREQ(expected[i]["tag"].GetString(), d.FindColumn("tag")->GetString(i));
+        EXPECT_EQ(!expected[i].HasMember("value"), value.IsMissing(i));
+        EXPECT_EQ(!expected[i].HasMember("value") || expected[i]["value"].IsNull(), value.IsNull(i));
+    }
+    Document roundtrip;
+    roundtrip.Parse(Stringify(d).c_str());
+    ASSERT_FALSE(roundtrip.HasParseError());
+    EXPECT_TRUE(roundtrip == expected);
+
+    // Names and strings parsed in situ are not copied.
+    std::vector<char> insitu(records.begin(), records.end());
+    insitu.push_back('\0');
+    ColumnarDocument di;
+    di.ParseInsitu(&insitu[0]);
+    ASSERT_FALSE(di.HasParseError());
+    const char* tag = di.GetColumn(1).GetString(999);
+    EXPECT_TRUE(tag >= &insitu[0] && tag < &insitu[0] + insitu.size());
+    EXPECT_STREQ("t4", tag);
+}
+
 #if RAPIDJSON_HAS_CXX11_RVALUE_REFS
 
 #if 0 // Many old compiler does not support these. Turn it off temporaily.
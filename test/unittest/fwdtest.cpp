@@ -68,6 +68,9 @@ struct Foo {
     BaseReaderHandler<UTF8<char>, void>* basereaderhandler;
     Reader* reader;
 
+    // pushreader.h
+    PushReader* pushreader;
+
     // writer.h
     Writer<StringBuffer, UTF8<char>, UTF8<char>, CrtAllocator, 0>* writer;
 
@@ -77,9 +80,23 @@ struct Foo {
     // document.h
     Value* value;
     Document* document;
+    ColumnarDocument* columnardocument;
+
+    // snapshot.h
+    SnapshotValue* snapshotvalue;
+    SnapshotWriter* snapshotwriter;
+
+    // msgpack.h
+    MsgPackReader* msgpackreader;
+    MsgPackWriter<StringBuffer, CrtAllocator>* msgpackwriter;
+
+    // cbor.h
+    CborReader* cborreader;
+    CborWriter<StringBuffer, CrtAllocator>* cborwriter;
 
     // pointer.h
     Pointer* pointer;
+    Projection* projection;
 
     // schema.h
     SchemaDocument* schemadocument;
@@ -98,6 +115,10 @@ struct Foo {
 #include "rapidjson/document.h" // -> reader.h
 #include "rapidjson/writer.h"
 #include "rapidjson/prettywriter.h"
+#include "rapidjson/pushreader.h"
+#include "rapidjson/snapshot.h"
+#include "rapidjson/msgpack.h"
+#include "rapidjson/cbor.h"
 #include "rapidjson/schema.h"   // -> pointer.h
 
 Foo::Foo() : 
@@ -140,6 +161,9 @@ Foo::Foo() :
     basereaderhandler(RAPIDJSON_NEW((BaseReaderHandler<UTF8<>, void>))),
     reader(RAPIDJSON_NEW(Reader)),
 
+    // pushreader.h
+    pushreader(RAPIDJSON_NEW(PushReader)),
+
     // writer.h
     writer(RAPIDJSON_NEW((Writer<StringBuffer>))),
 
@@ -149,9 +173,23 @@ Foo::Foo() :
     // document.h
     value(RAPIDJSON_NEW(Value)),
     document(RAPIDJSON_NEW(Document)),
+    columnardocument(RAPIDJSON_NEW(ColumnarDocument)),
+
+    // snapshot.h
+    snapshotvalue(0),
+    snapshotwriter(RAPIDJSON_NEW(SnapshotWriter)),
+
+    // msgpack.h
+    msgpackreader(RAPIDJSON_NEW(MsgPackReader)),
+    msgpackwriter(RAPIDJSON_NEW(MsgPackWriter<StringBuffer>)),
+
+    // cbor.h
+    cborreader(RAPIDJSON_NEW(CborReader)),
+    cborwriter(RAPIDJSON_NEW(CborWriter<StringBuffer>)),
 
     // pointer.h
     pointer(RAPIDJSON_NEW(Pointer)),
+    projection(RAPIDJSON_NEW(Projection)),
 
     // schema.h
     schemadocument(RAPIDJSON_NEW(SchemaDocument(*document))),
@@ -200,6 +238,9 @@ Foo::~Foo() {
     RAPIDJSON_DELETE(basereaderhandler);
     RAPIDJSON_DELETE(reader);
 
+    // pushreader.h
+    RAPIDJSON_DELETE(pushreader);
+
     // writer.h
     RAPIDJSON_DELETE(writer);
 
@@ -209,9 +250,22 @@ Foo::~Foo() {
     // document.h
     RAPIDJSON_DELETE(value);
     RAPIDJSON_DELETE(document);
+    RAPIDJSON_DELETE(columnardocument);
+
+    // snapshot.h
+    RAPIDJSON_DELETE(snapshotwriter);
+
+    // msgpack.h
+    RAPIDJSON_DELETE(msgpackreader);
+    RAPIDJSON_DELETE(msgpackwriter);
+
+    // cbor.h
+    RAPIDJSON_DELETE(cborreader);
+    RAPIDJSON_DELETE(cborwriter);
 
     // pointer.h
     RAPIDJSON_DELETE(pointer);
+    RAPIDJSON_DELETE(projection);
 
     // schema.h
     RAPIDJSON_DELETE(schemadocument);
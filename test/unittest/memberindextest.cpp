@@ -0,0 +1,183 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+// 
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed 
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR 
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the 
+// specific language governing permissions and limitations under the License.
+
+// Built as a separate test program with RAPIDJSON_MEMBER_INDEX=1, which changes the layout of objects.
+
+#include "unittest.h"
+#include "rapidjson/document.h"
+#include <algorithm>
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(c++98-compat)
+#endif
+
+using namespace rapidjson;
+
+// Checks every member of a big object (with a member index) against a linear search.
+template <typename V>
+static void CheckMemberIndex(V& x) {
+    const V& cx = x;
+    for (typename V::ConstMemberIterator m = cx.MemberBegin(); m != cx.MemberEnd(); ++m) {
+        typename V::ConstMemberIterator linear = cx.MemberBegin();
+        while (!(linear->name == m->name))
+            ++linear;
+        EXPECT_TRUE(x.FindMember(m->name) == linear);
+        EXPECT_TRUE(cx.FindMember(m->name) == linear);
+        EXPECT_TRUE(cx.HasMember(m->name.GetString()));
+    }
+}
+
+struct NameComparator {
+    template <typename M>
+    bool operator()(const M& lhs, const M& rhs) const {
+        return lhs.name.GetStringLength() < rhs.name.GetStringLength() ||
+            (lhs.name.GetStringLength() == rhs.name.GetStringLength() && strcmp(lhs.name.GetString(), rhs.name.GetString()) < 0);
+    }
+};
+
+template <typename Allocator>
+static void TestMemberIndex() {
+    typedef GenericValue<UTF8<>, Allocator> V;
+    Allocator allocator;
+    V x(kObjectType);
+    const int n = 1000;
+    char name[16];
+
+    for (int i = 0; i < n; i++) {
+        sprintf(name, "m%d", i);
+        x.AddMember(V(name, allocator).Move(), V(i).Move(), allocator);
+    }
+    EXPECT_EQ(static_cast<SizeType>(n), x.MemberCount());
+    for (int i = 0; i < n; i++) {
+        sprintf(name, "m%d", i);
+        typename V::MemberIterator m = x.FindMember(name);
+        ASSERT_TRUE(m != x.MemberEnd());
+        EXPECT_EQ(i, m->value.GetInt());
+        EXPECT_EQ(i, x[name].GetInt());
+    }
+    EXPECT_TRUE(x.FindMember("m1000") == x.MemberEnd());
+    EXPECT_FALSE(x.HasMember(""));
+    EXPECT_FALSE(x.HasMember(V("m1\0", 3).Move()));     // embedded null character
+    CheckMemberIndex(x);
+
+    // Remove every third member by name and by iterator, moving the last one into its place.
+    for (int i = 0; i < n; i += 3) {
+        sprintf(name, "m%d", i);
+        if (i % 2)
+            EXPECT_TRUE(x.RemoveMember(name));
+        else
+            x.RemoveMember(x.FindMember(name));
+        EXPECT_FALSE(x.HasMember(name));
+    }
+    for (int i = 0; i < n; i++) {
+        sprintf(name, "m%d", i);
+        EXPECT_EQ(i % 3 != 0, x.HasMember(name));
+    }
+    CheckMemberIndex(x);
+
+    // Erase a range and single members, keeping the order of the others.
+    x.EraseMember(x.MemberBegin() + 10, x.MemberBegin() + 100);
+    for (int i = 0; i < 50; i++) {
+        sprintf(name, "m%d", 3 * i + 1);
+        x.EraseMember(name);
+    }
+    CheckMemberIndex(x);
+    for (int i = 0; i < 50; i++) {
+        sprintf(name, "m%d", 3 * i + 1);
+        EXPECT_FALSE(x.HasMember(name));
+    }
+
+    // Sorting through the iterators requires rebuilding the index.
+    std::sort(x.MemberBegin(), x.MemberEnd(), NameComparator());
+    x.RebuildMemberIndex();
+    const V& cx = x;
+    for (typename V::ConstMemberIterator m = cx.MemberBegin(); m != cx.MemberEnd(); ++m)
+        EXPECT_EQ(m->value.GetInt(), cx[m->name].GetInt());
+    CheckMemberIndex(x);
+    for (typename V::ConstMemberIterator m = cx.MemberBegin() + 1; m != cx.MemberEnd(); ++m)
+        EXPECT_FALSE(NameComparator()(*m, *(m - 1)));
+
+    // Renaming through the iterators.
+    for (typename V::MemberIterator m = x.MemberBegin(); m != x.MemberEnd(); ++m) {
+        sprintf(name, "r%d", m->value.GetInt());
+        m->name.SetString(name, allocator);
+    }
+    x.RebuildMemberIndex();
+    x.AddMember("added", 1, allocator);
+    EXPECT_FALSE(x.HasMember("m2"));
+    EXPECT_TRUE(x.HasMember("r2"));
+    EXPECT_TRUE(x.HasMember("added"));
+    CheckMemberIndex(x);
+
+    // Plain iteration through non-const iterators keeps the index.
+    for (typename V::MemberIterator m = x.MemberBegin(); m != x.MemberEnd(); ++m) {
+        typename V::MemberIterator found = x.FindMember(m->name);
+        ASSERT_TRUE(found == m);
+        m->value.SetInt(m->value.GetInt() + 1);
+    }
+    EXPECT_EQ(3, x["r2"].GetInt());
+    CheckMemberIndex(x);
+
+    x.RemoveAllMembers();
+    EXPECT_FALSE(x.HasMember("r2"));
+    x.AddMember("a", 1, allocator);
+    EXPECT_TRUE(x.HasMember("a"));
+    EXPECT_FALSE(x.HasMember("r2"));
+}
+
+TEST(Value, MemberIndex) {
+    TestMemberIndex<MemoryPoolAllocator<> >();
+    TestMemberIndex<CrtAllocator>();
+}
+
+TEST(Value, MemberIndex_Parse) {
+    std::string json = "{";
+    char name[16];
+    for (int i = 0; i < 500; i++) {
+        sprintf(name, "%s\"k%d\":%d", i ? "," : "", i, i);
+        json += name;
+    }
+    json += ",\"k7\":\"duplicate\"}";
+
+    // The index is built by the first lookup, also through a const reference.
+    Document d;
+    d.Parse(json.c_str());
+    ASSERT_FALSE(d.HasParseError());
+    const Document& cd = d;
+    for (int i = 0; i < 500; i++) {
+        sprintf(name, "k%d", i);
+        EXPECT_EQ(i, cd[name].GetInt());
+    }
+    EXPECT_FALSE(cd.HasMember("k500"));
+    CheckMemberIndex(d);
+
+    d.Compact();
+    EXPECT_EQ(499, cd["k499"].GetInt());
+    EXPECT_EQ(7, d["k7"].GetInt());
+    CheckMemberIndex(d);
+
+    // Copies and small objects.
+    Document copy;
+    copy.CopyFrom(d, copy.GetAllocator());
+    EXPECT_EQ(499, copy["k499"].GetInt());
+    EXPECT_EQ(7, copy["k7"].GetInt());
+    d.Parse("{\"a\":1,\"b\":2}");
+    EXPECT_EQ(2, d["b"].GetInt());
+    EXPECT_FALSE(d.HasMember("k1"));
+}
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
@@ -0,0 +1,107 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+// 
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed 
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR 
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the 
+// specific language governing permissions and limitations under the License.
+
+// Built as a separate test program with RAPIDJSON_MEMORY_STATS=1, which changes the layout of allocators, stacks and writers.
+
+#include "unittest.h"
+#include "rapidjson/document.h"
+#include "rapidjson/reader.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(c++98-compat)
+#endif
+
+using namespace rapidjson;
+
+TEST(Allocator, MemoryPoolAllocator_Stats) {
+    MemoryPoolAllocator<> a(1024);
+    AllocatorStats stats = a.GetStats();
+    EXPECT_EQ(0u, stats.allocationCount);
+    EXPECT_EQ(0u, stats.chunkCount);
+
+    void* p = a.Malloc(3);
+    stats = a.GetStats();
+    EXPECT_EQ(1u, stats.allocationCount);
+    EXPECT_EQ(3u, stats.requestedBytes);
+    EXPECT_EQ(RAPIDJSON_ALIGN(3u) - 3u, stats.wastedBytes);
+    EXPECT_EQ(1u, stats.chunkCount);
+    EXPECT_EQ(a.Size(), stats.peakSize);
+
+    // Expanding in place, then moving
+    p = a.Realloc(p, 3, 16);
+    EXPECT_EQ(1u, a.GetStats().allocationCount);
+    a.Malloc(8);
+    a.Realloc(p, 16, 32);
+    stats = a.GetStats();
+    EXPECT_EQ(3u, stats.allocationCount);
+    EXPECT_EQ(RAPIDJSON_ALIGN(3u) - 3u + 16u, stats.wastedBytes);
+    EXPECT_EQ(a.Size(), stats.peakSize);
+
+    // The end of the first chunk is wasted when starting a new one.
+    const size_t size = a.Size();
+    a.Malloc(1000);
+    stats = a.GetStats();
+    EXPECT_EQ(2u, stats.chunkCount);
+    EXPECT_EQ(RAPIDJSON_ALIGN(3u) - 3u + 16u + 1024u - size, stats.wastedBytes);
+
+    const size_t peak = a.Size();
+    a.Reset();
+    a.Malloc(8);
+    stats = a.GetStats();
+    EXPECT_EQ(peak, stats.peakSize);
+    EXPECT_EQ(2u, stats.chunkCount);
+    a.Clear();
+    EXPECT_EQ(0u, a.GetStats().chunkCount);
+}
+
+TEST(Document, GetStackPeakSize) {
+    Document d;
+    EXPECT_EQ(0u, d.GetStackPeakSize());
+    d.Parse("[1, 2, [3]]"); // [ 1 2 [ 3 are on the stack at once
+    EXPECT_EQ(5 * sizeof(Value), d.GetStackPeakSize());
+    d.Parse("{}");
+    EXPECT_EQ(5 * sizeof(Value), d.GetStackPeakSize());
+
+    // Parsed containers are sized exactly
+    d.Parse("{\"a\": [1, 2, 3], \"a longer name which is copied\": true}");
+    const size_t usage = d.GetMemoryUsage();
+    EXPECT_EQ(sizeof(Value) + 2 * sizeof(Value::Member) + 3 * sizeof(Value) + 30, usage);
+    const AllocatorStats stats = d.GetAllocator().GetStats();
+    EXPECT_LE(usage - sizeof(Value), stats.requestedBytes);
+    EXPECT_EQ(stats.peakSize, d.GetAllocator().Size());
+}
+
+TEST(Writer, GetLevelStackPeakSize) {
+    StringBuffer buffer;
+    Writer<StringBuffer> writer(buffer);
+    EXPECT_EQ(0u, writer.GetLevelStackPeakSize());
+    writer.StartArray();
+    writer.EndArray();
+    const size_t level = writer.GetLevelStackPeakSize();
+    EXPECT_LT(0u, level);
+
+    buffer.Clear();
+    writer.Reset(buffer);
+    StringStream s("[{\"a\":[1]}, 2]");
+    Reader reader;
+    reader.Parse(s, writer);
+    EXPECT_EQ(3 * level, writer.GetLevelStackPeakSize());
+}
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
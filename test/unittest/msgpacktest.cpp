@@ -0,0 +1,279 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "unittest.h"
+#include "binaryformattest.h"
+
+#include "rapidjson/msgpack.h"
+
+#include <string>
+
+using namespace rapidjson;
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+static std::string Encode(const char* json) { return BinaryEncode<MsgPackWriter<StringBuffer>, kParseDefaultFlags>(json); }
+static std::string Decode(const std::string& msgpack) { return BinaryDecode<MsgPackReader, kWriteDefaultFlags>(msgpack); }
+static std::string Stringify(const char* json) { return BinaryStringify<kParseDefaultFlags>(json); }
+
+TEST(MsgPack, RoundTrip) {
+    static const char* json[] = {
+        "null", "true", "false", "0", "-1", "1.5", "\"\"", "[]", "{}", "\"hello\"",
+        "{ \"hello\" : \"world\", \"t\" : true , \"f\" : false, \"n\": null, \"i\":123, \"pi\": 3.1416, \"a\":[1, 2, 3, 4] } ",
+        "[{\"a\": [[], {}, [{\"b\": \"c\"}]]}, -1, 1e100, \"\\u0000\", \"\\u00e9\\ud834\\udd1e\", [[[[[[]]]]]]]",
+        "[-2147483648, 2147483647, 4294967295, -9223372036854775808, 9223372036854775807, 18446744073709551615, 0.5, -0.0]"
+    };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++)
+        EXPECT_EQ(Stringify(json[i]), Decode(Encode(json[i])));
+
+    // Large containers and strings
+    std::string json2 = "[";
+    for (int i = 0; i < 70000; i++)
+        json2 += i ? ",{\"k\":[]}" : "{\"k\":[]}";
+    json2 += ",\"" + std::string(70000, 'x') + "\"]";
+    EXPECT_EQ(Stringify(json2.c_str()), Decode(Encode(json2.c_str())));
+}
+
+TEST(MsgPack, Encoding) {
+    TEST_ENCODE("null", "\xC0");
+    TEST_ENCODE("false", "\xC2");
+    TEST_ENCODE("true", "\xC3");
+
+    // Integers in the smallest format
+    TEST_ENCODE("0", "\x00");
+    TEST_ENCODE("127", "\x7F");
+    TEST_ENCODE("128", "\xCC\x80");
+    TEST_ENCODE("255", "\xCC\xFF");
+    TEST_ENCODE("256", "\xCD\x01\x00");
+    TEST_ENCODE("65535", "\xCD\xFF\xFF");
+    TEST_ENCODE("65536", "\xCE\x00\x01\x00\x00");
+    TEST_ENCODE("4294967295", "\xCE\xFF\xFF\xFF\xFF");
+    TEST_ENCODE("4294967296", "\xCF\x00\x00\x00\x01\x00\x00\x00\x00");
+    TEST_ENCODE("18446744073709551615", "\xCF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF");
+    TEST_ENCODE("-1", "\xFF");
+    TEST_ENCODE("-32", "\xE0");
+    TEST_ENCODE("-33", "\xD0\xDF");
+    TEST_ENCODE("-128", "\xD0\x80");
+    TEST_ENCODE("-129", "\xD1\xFF\x7F");
+    TEST_ENCODE("-32768", "\xD1\x80\x00");
+    TEST_ENCODE("-32769", "\xD2\xFF\xFF\x7F\xFF");
+    TEST_ENCODE("-2147483648", "\xD2\x80\x00\x00\x00");
+    TEST_ENCODE("-2147483649", "\xD3\xFF\xFF\xFF\xFF\x7F\xFF\xFF\xFF");
+    TEST_ENCODE("-9223372036854775808", "\xD3\x80\x00\x00\x00\x00\x00\x00\x00");
+
+    TEST_ENCODE("1.5", "\xCB\x3F\xF8\x00\x00\x00\x00\x00\x00");
+    TEST_ENCODE("-0.0", "\xCB\x80\x00\x00\x00\x00\x00\x00\x00");
+
+    // Strings
+    TEST_ENCODE("\"\"", "\xA0");
+    TEST_ENCODE("\"a\"", "\xA1" "a");
+    TEST_ENCODE("\"\\u0000\"", "\xA1\x00");
+    TEST_ENCODE("\"\\u00e9\"", "\xA2\xC3\xA9");
+    TEST_ENCODE("\"0123456789012345678901234567890\"", "\xBF" "0123456789012345678901234567890");
+    TEST_ENCODE("\"01234567890123456789012345678901\"", "\xD9\x20" "01234567890123456789012345678901");
+
+    // Arrays and maps
+    TEST_ENCODE("[]", "\x90");
+    TEST_ENCODE("{}", "\x80");
+    TEST_ENCODE("[1, [2, []], {}]", "\x93\x01\x92\x02\x90\x80");
+    TEST_ENCODE("{\"a\": 1, \"b\": {\"c\": [null]}}", "\x82\xA1" "a" "\x01\xA1" "b" "\x81\xA1" "c" "\x91\xC0");
+    TEST_ENCODE("[0,0,0,0,0,0,0,0,0,0,0,0,0,0,0]", "\x9F\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00");
+    TEST_ENCODE("[0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0]", "\xDC\x00\x10\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00");
+    TEST_ENCODE("[[0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0],{}]", "\x92\xDC\x00\x10\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x80");
+
+    // 8, 16 and 32-bit lengths
+    const std::string s256(256, 'x');
+    std::string e = Encode(("\"" + s256 + "\"").c_str());
+    EXPECT_EQ(std::string("\xDA\x01\x00", 3) + s256, e);
+    const std::string s65536(65536, 'x');
+    e = Encode(("[\"" + s65536 + "\"]").c_str());
+    EXPECT_EQ(std::string("\x91\xDB\x00\x01\x00\x00", 6) + s65536, e);
+
+    std::string json = "{";
+    for (int i = 0; i < 65536; i++) {
+        char buffer[32];
+        sprintf(buffer, "%s\"%d\":0", i ? "," : "", i);
+        json += buffer;
+    }
+    json += "}";
+    e = Encode(json.c_str());
+    EXPECT_EQ(std::string("\xDF\x00\x01\x00\x00", 5), e.substr(0, 5));
+    EXPECT_EQ(Stringify(json.c_str()), Decode(e));
+}
+
+template <typename TargetEncoding>
+struct MsgPackSource {
+    MsgPackSource(const std::string& msgpack) : msgpack(msgpack) {}
+    template <typename Handler>
+    bool operator()(Handler& handler) { return !GenericMsgPackReader<TargetEncoding>().Parse(msgpack.data(), msgpack.size(), handler).IsError(); }
+    std::string msgpack;
+};
+
+TEST(MsgPack, Reader) {
+    // Non-minimal formats
+    EXPECT_EQ("1", Decode(std::string("\xCD\x00\x01", 3)));
+    EXPECT_EQ("1", Decode(std::string("\xD3\x00\x00\x00\x00\x00\x00\x00\x01", 9)));
+    EXPECT_EQ("-1", Decode(std::string("\xD1\xFF\xFF", 3)));
+    EXPECT_EQ("-128", Decode(std::string("\xD0\x80", 2)));
+    EXPECT_EQ("127", Decode(std::string("\xD0\x7F", 2)));
+    EXPECT_EQ("4294967296", Decode(std::string("\xD3\x00\x00\x00\x01\x00\x00\x00\x00", 9)));
+    EXPECT_EQ("\"a\"", Decode(std::string("\xD9\x01" "a", 3)));
+    EXPECT_EQ("[1]", Decode(std::string("\xDD\x00\x00\x00\x01\x01", 6)));
+    EXPECT_EQ("{\"a\":1}", Decode(std::string("\xDE\x00\x01\xDA\x00\x01" "a" "\x01", 8)));
+    EXPECT_EQ("1.5", Decode(std::string("\xCA\x3F\xC0\x00\x00", 5)));  // float 32
+
+    // Types of the events
+    MsgPackSource<UTF8<> > source(Encode("{\"i\": -1, \"u\": 4294967295, \"i64\": -2147483649, \"u64\": 4294967296, \"d\": 0.5, \"s\": \"\\u0000x\"}"));
+    Document d;
+    d.Populate(source);
+    ASSERT_FALSE(d.HasParseError());
+    EXPECT_TRUE(d["i"].IsInt());
+    EXPECT_FALSE(d["u"].IsInt());
+    EXPECT_TRUE(d["u"].IsUint());
+    EXPECT_FALSE(d["i64"].IsInt());
+    EXPECT_TRUE(d["i64"].IsInt64());
+    EXPECT_FALSE(d["u64"].IsUint());
+    EXPECT_TRUE(d["u64"].IsUint64());
+    EXPECT_TRUE(d["d"].IsDouble());
+    EXPECT_EQ(2u, d["s"].GetStringLength());
+    EXPECT_EQ(std::string("\0x", 2), std::string(d["s"].GetString(), d["s"].GetStringLength()));
+
+    // Transcoding
+    MsgPackSource<UTF16<> > source16(Encode("{\"\\u00e9\": \"\\ud834\\udd1e\"}"));
+    GenericDocument<UTF16<> > d16;
+    d16.Populate(source16);
+    ASSERT_TRUE(d16.IsObject());
+    EXPECT_TRUE(d16.HasMember(L"\x00e9"));
+    EXPECT_EQ(2u, d16[L"\x00e9"].GetStringLength());
+    EXPECT_EQ(0xD834, d16[L"\x00e9"].GetString()[0]);
+    EXPECT_EQ(0xDD1E, d16[L"\x00e9"].GetString()[1]);
+}
+
+#define TEST_ERROR(flags, msgpack, errorCode, errorOffset) \
+    do { \
+        const std::string m(msgpack, sizeof(msgpack) - 1); \
+        BaseReaderHandler<> h; \
+        MsgPackReader reader; \
+        reader.Parse<flags>(m.data(), m.size(), h); \
+        EXPECT_TRUE(reader.HasParseError()); \
+        EXPECT_EQ(errorCode, reader.GetParseErrorCode()); \
+        EXPECT_EQ(errorOffset, reader.GetErrorOffset()); \
+    } while (false)
+
+TEST(MsgPack, Error) {
+    TEST_ERROR(0, "", kParseErrorDocumentEmpty, 0u);
+    TEST_ERROR(0, "\xC1", kParseErrorValueInvalid, 0u);             // never used
+    TEST_ERROR(0, "\xC4\x01" "a", kParseErrorValueInvalid, 0u);     // bin 8
+    TEST_ERROR(0, "\xD4\x01\x00", kParseErrorValueInvalid, 0u);     // fixext 1
+    TEST_ERROR(0, "\x91\xC7\x00\x01", kParseErrorValueInvalid, 1u); // ext 8
+
+    // Truncated values
+    TEST_ERROR(0, "\xCD\x01", kParseErrorValueInvalid, 0u);
+    TEST_ERROR(0, "\xCB\x00\x00\x00", kParseErrorValueInvalid, 0u);
+    TEST_ERROR(0, "\xA2" "a", kParseErrorValueInvalid, 0u);
+    TEST_ERROR(0, "\xDA\x00", kParseErrorValueInvalid, 0u);
+    TEST_ERROR(0, "\x92\x01", kParseErrorValueInvalid, 0u);             // count beyond the data
+    TEST_ERROR(0, "\x92\x92\x01\x01", kParseErrorValueInvalid, 4u);
+    TEST_ERROR(0, "\x81\xA1" "a", kParseErrorValueInvalid, 3u);
+    TEST_ERROR(0, "\xDD\xFF\xFF\xFF\xFF\x01", kParseErrorValueInvalid, 0u);   // count beyond the data
+    TEST_ERROR(0, "\xDF\x00\x00\x00\x02\xA0\x00", kParseErrorValueInvalid, 0u);
+
+    // Non-string keys
+    TEST_ERROR(0, "\x81\x01\x01", kParseErrorObjectMissName, 1u);
+    TEST_ERROR(0, "\x91\x81\x90\x01", kParseErrorObjectMissName, 2u);
+
+    // Trailing data
+    TEST_ERROR(0, "\x01\x02", kParseErrorDocumentRootNotSingular, 1u);
+    TEST_ERROR(0, "\x90\x90", kParseErrorDocumentRootNotSingular, 1u);
+
+    // Invalid UTF-8 is only detected by validation.
+    TEST_ERROR(kParseValidateEncodingFlag, "\xA1\xFF", kParseErrorStringInvalidEncoding, 0u);
+    TEST_ERROR(kParseValidateEncodingFlag, "\x81\xA2\xC3\xA9\xA2\xC3\x28", kParseErrorStringInvalidEncoding, 4u);
+    TEST_ERROR(kParseValidateEncodingFlag, "\xA1\xC3", kParseErrorStringInvalidEncoding, 0u);  // truncated sequence
+    {
+        BaseReaderHandler<> h;
+        MsgPackReader reader;
+        EXPECT_FALSE(reader.Parse("\xA1\xFF", 2, h).IsError());
+        EXPECT_FALSE(reader.Parse<kParseValidateEncodingFlag>("\xA2\xC3\xA9", 3, h).IsError());
+    }
+}
+
+TEST(MsgPack, StopWhenDone) {
+    const std::string m("\x91\x01\x92\x02\x03", 5);
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    MsgPackReader reader;
+    ParseResult r = reader.Parse<kParseStopWhenDoneFlag>(m.data(), m.size(), writer);
+    EXPECT_FALSE(r.IsError());
+    EXPECT_STREQ("[1]", sb.GetString());
+}
+
+// Handler which returns false after a number of events.
+struct TerminateHandler : BaseReaderHandler<UTF8<>, TerminateHandler> {
+    TerminateHandler(int count) : count_(count) {}
+    bool Default() { return count_-- > 0; }
+    int count_;
+};
+
+TEST(MsgPack, Termination) {
+    const std::string m = Encode("{\"a\": [null, true, 1, -1, 4294967296, -4294967296, 1.5, \"s\"], \"b\": {}}");
+    for (int i = 0; i <= 16; i++) {
+        TerminateHandler h(i);
+        MsgPackReader reader;
+        ParseResult r = reader.Parse(m.data(), m.size(), h);
+        if (i < 16)
+            EXPECT_EQ(kParseErrorTermination, r.Code()) << i;
+        else
+            EXPECT_FALSE(r.IsError());
+    }
+}
+
+TEST(MsgPack, Writer) {
+    // Numbers and values given as JSON text
+    const char* json = "[1, -1, 1.5, 18446744073709551615, 1e-400, {\"a\": \"b\"}]";
+    StringBuffer sb;
+    MsgPackWriter<StringBuffer> writer(sb);
+    Reader reader;
+    StringStream s(json);
+    EXPECT_FALSE(reader.Parse<kParseNumbersAsStringsFlag>(s, writer).IsError());
+    EXPECT_TRUE(writer.IsComplete());
+    const std::string m(sb.GetString(), sb.GetSize());
+    EXPECT_EQ(std::string("\x96\x01\xFF\xCB\x3F\xF8", 6), m.substr(0, 6));
+    EXPECT_EQ("[1,-1,1.5,18446744073709551615,0.0,{\"a\":\"b\"}]", Decode(m));
+
+    writer.Reset(sb);
+    sb.Clear();
+    EXPECT_FALSE(writer.IsComplete());
+    EXPECT_TRUE(writer.StartObject());
+    EXPECT_TRUE(writer.Key("a"));
+    EXPECT_TRUE(writer.RawValue("[1, {\"b\": null}]", 16, kArrayType));
+    EXPECT_FALSE(writer.IsComplete());
+    EXPECT_EQ(0u, sb.GetSize());    // buffered until the root ends
+    EXPECT_TRUE(writer.EndObject());
+    EXPECT_TRUE(writer.IsComplete());
+    EXPECT_EQ("{\"a\":[1,{\"b\":null}]}", Decode(std::string(sb.GetString(), sb.GetSize())));
+
+    writer.Reset(sb);
+    sb.Clear();
+    EXPECT_TRUE(writer.String("root"));
+    EXPECT_TRUE(writer.IsComplete());
+    EXPECT_EQ(std::string("\xA4" "root"), std::string(sb.GetString(), sb.GetSize()));
+}
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
@@ -15,6 +15,9 @@
 #include "unittest.h"
 #include "rapidjson/pointer.h"
 #include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/memorystream.h"
+#include "rapidjson/encodedstream.h"
 #include <sstream>
 
 using namespace rapidjson;
@@ -1522,3 +1525,271 @@ TEST(Pointer, Issue483) {
     value.SetString(mystr.c_str(), static_cast<SizeType>(mystr.length()), document.GetAllocator());
     myjson::Pointer(path.c_str()).Set(document, value, document.GetAllocator());
 }
+
+static std::string StringifyValue(const Value& v) {
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    v.Accept(writer);
+    return sb.GetString();
+}
+
+// Project with the reader, from null-terminated text (skipped by blocks) and from a memory stream (skipped by characters).
+static std::string ProjectJson(const char* json, const Projection& projection, ParseErrorCode* code = 0, size_t* offset = 0) {
+    Reader reader;
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    StringStream s(json);
+    ParseResult r = reader.Parse<kParseDefaultFlags>(s, writer, projection);
+
+    StringBuffer sb2;
+    Writer<StringBuffer> writer2(sb2);
+    MemoryStream ms(json, strlen(json));
+    EncodedInputStream<UTF8<>, MemoryStream> is(ms);
+    ParseResult r2 = reader.Parse<kParseDefaultFlags>(is, writer2, projection);
+    EXPECT_EQ(r.Code(), r2.Code());
+    EXPECT_EQ(r.Offset(), r2.Offset());
+
+    std::vector<char> buffer(json, json + strlen(json) + 1);
+    StringBuffer sb3;
+    Writer<StringBuffer> writer3(sb3);
+    InsituStringStream is3(&buffer[0]);
+    ParseResult r3 = reader.Parse<kParseInsituFlag>(is3, writer3, projection);
+    EXPECT_EQ(r.Code(), r3.Code());
+    EXPECT_EQ(r.Offset(), r3.Offset());
+
+    if (code)
+        *code = r.Code();
+    if (offset)
+        *offset = r.Offset();
+    if (!r)
+        return std::string();
+    EXPECT_STREQ(sb.GetString(), sb2.GetString());
+    EXPECT_STREQ(sb.GetString(), sb3.GetString());
+    return sb.GetString();
+}
+
+static std::string ProjectJson(const char* json, const char* path0, const char* path1 = 0, const char* path2 = 0) {
+    Projection projection;
+    projection.Add(Pointer(path0));
+    if (path1)
+        projection.Add(Pointer(path1));
+    if (path2)
+        projection.Add(Pointer(path2));
+    return ProjectJson(json, projection);
+}
+
+TEST(Pointer, Projection) {
+    Pointer pointers[] = { Pointer("/foo/1"), Pointer("/m~0n") };
+    Projection projection(pointers, 2);
+    Document d;
+    d.Parse(kJson, projection);
+    ASSERT_FALSE(d.HasParseError());
+    EXPECT_EQ("{\"foo\":[null,\"baz\"],\"m~n\":8}", StringifyValue(d));
+    EXPECT_STREQ("baz", pointers[0].Get(d)->GetString());
+    EXPECT_EQ(8, pointers[1].Get(d)->GetInt());
+
+    EXPECT_EQ(StringifyValue(d), ProjectJson(kJson, projection));
+
+    // ParseStream() with other flags
+    StringStream s(kJson);
+    Document d2;
+    d2.ParseStream<kParseIterativeFlag>(s, projection);
+    ASSERT_FALSE(d2.HasParseError());
+    EXPECT_TRUE(d == d2);
+}
+
+TEST(Pointer, Projection_Paths) {
+    const char* json = "{ \"a\": { \"b\": [1, 2, {\"c\": \"x\", \"d\": true}], \"e\": null }, \"f\": \"a\\\"}]\", \"a\": 5 }";
+
+    // The whole document.
+    EXPECT_EQ("{\"a\":{\"b\":[1,2,{\"c\":\"x\",\"d\":true}],\"e\":null},\"f\":\"a\\\"}]\",\"a\":5}", ProjectJson(json, ""));
+
+    // Selected values keep everything within them, the paths to them keep the rest out.
+    EXPECT_EQ("{\"a\":{\"b\":[1,2,{\"c\":\"x\",\"d\":true}]},\"a\":5}", ProjectJson(json, "/a/b"));
+    EXPECT_EQ("{\"a\":{\"b\":[1,2,{\"c\":\"x\",\"d\":true}]},\"a\":5}", ProjectJson(json, "/a/b/2", "/a/b"));
+    EXPECT_EQ("{\"a\":{\"b\":[null,null,{\"d\":true}],\"e\":null},\"a\":5}", ProjectJson(json, "/a/b/2/d", "/a/e"));
+    EXPECT_EQ("{\"a\":{\"b\":[1]},\"a\":5}", ProjectJson(json, "/a/b/0"));
+    EXPECT_EQ("{\"f\":\"a\\\"}]\"}", ProjectJson(json, "/f"));
+
+    // Paths which do not match keep the containers on them.
+    EXPECT_EQ("{\"a\":{\"b\":[]},\"a\":5}", ProjectJson(json, "/a/b/x"));
+    EXPECT_EQ("{\"a\":{\"b\":[]},\"a\":5}", ProjectJson(json, "/a/b/-"));
+    EXPECT_EQ("{\"a\":{},\"a\":5}", ProjectJson(json, "/a/x/y"));
+    EXPECT_EQ("{}", ProjectJson(json, "/x"));
+    EXPECT_EQ("{}", ProjectJson(json, Projection()));
+
+    // A scalar root is kept.
+    EXPECT_EQ("12", ProjectJson(" 12 ", "/x"));
+    EXPECT_EQ("[null,[3]]", ProjectJson("[[1, 2], [3, 4], [5]]", "/1/0"));
+
+    // Names are compared after unescaping, indices of objects are names.
+    EXPECT_EQ("{\"ab\":1}", ProjectJson("{\"\\u0061b\": 1, \"a\\\\\": 2}", "/ab"));
+    EXPECT_EQ("{\"a\\\\\":2}", ProjectJson("{\"\\u0061b\": 1, \"a\\\\\": 2}", "/a\\"));
+    EXPECT_EQ("{\"1\":{\"0\":true}}", ProjectJson("{\"0\": false, \"1\": {\"0\": true}}", "/1/0"));
+}
+
+TEST(Pointer, Projection_Skip) {
+    // Skipped values are not decoded or converted.
+    EXPECT_EQ("{\"b\":1}", ProjectJson("{\"a\": \"\\q\\u12\", \"a\": 1e99999, \"a\": [tru, {\"x\" 1,,}], \"b\": 1}", "/b"));
+
+    // Skipped strings and brackets must be closed.
+    struct Error {
+        const char* json;
+        ParseErrorCode code;
+        size_t offset;
+    };
+    const Error errors[] = {
+        { "{\"a\": \"x", kParseErrorStringMissQuotationMark, 8 },
+        { "{\"a\": \"x\\\"", kParseErrorStringMissQuotationMark, 10 },
+        { "{\"a\": [\"x\", {\"y\": \"]", kParseErrorStringMissQuotationMark, 20 },
+        { "{\"a\": [1, {}", kParseErrorArrayMissCommaOrSquareBracket, 12 },
+        { "{\"a\": [1, {]}", kParseErrorObjectMissCommaOrCurlyBracket, 11 },
+        { "{\"a\": {\"b\": [}]}", kParseErrorArrayMissCommaOrSquareBracket, 13 },
+        { "{\"a\": }", kParseErrorValueInvalid, 6 },
+        { "{\"a\": 1 \"b\": 2}", kParseErrorObjectMissCommaOrCurlyBracket, 8 },
+        { "[1, 2 3]", kParseErrorArrayMissCommaOrSquareBracket, 6 },
+        { "{\"b\": [1, 2}", kParseErrorArrayMissCommaOrSquareBracket, 11 },
+        { "{\"b\": 1} x", kParseErrorDocumentRootNotSingular, 9 },
+    };
+    Projection projection;
+    projection.Add(Pointer("/b/0"));
+    for (size_t i = 0; i < sizeof(errors) / sizeof(errors[0]); i++) {
+        ParseErrorCode code;
+        size_t offset;
+        ProjectJson(errors[i].json, projection, &code, &offset);
+        EXPECT_EQ(errors[i].code, code) << errors[i].json;
+        EXPECT_EQ(errors[i].offset, offset) << errors[i].json;
+    }
+
+    // Flags apply to the parsed values.
+    Document d;
+    d.Parse<kParseTrailingCommasFlag | kParseCommentsFlag>("{\"a\": [1, /* ] */ 2,], /* \" */ \"b\": [1, 2,],}", projection);
+    ASSERT_FALSE(d.HasParseError());
+    EXPECT_EQ("{\"b\":[1]}", StringifyValue(d));
+}
+
+// Reference projection of a DOM.
+static void ProjectValue(const Value& v, const std::vector<const Pointer*>& pointers, size_t depth, Value& result, Document::AllocatorType& allocator) {
+    for (size_t i = 0; i < pointers.size(); i++)
+        if (pointers[i]->GetTokenCount() == depth) {
+            result.CopyFrom(v, allocator);
+            return;
+        }
+    if (v.IsObject()) {
+        result.SetObject();
+        for (Value::ConstMemberIterator m = v.MemberBegin(); m != v.MemberEnd(); ++m) {
+            std::vector<const Pointer*> sub;
+            for (size_t i = 0; i < pointers.size(); i++) {
+                const Pointer::Token& t = pointers[i]->GetTokens()[depth];
+                if (t.length == m->name.GetStringLength() && memcmp(t.name, m->name.GetString(), t.length) == 0)
+                    sub.push_back(pointers[i]);
+            }
+            if (!sub.empty()) {
+                Value member;
+                ProjectValue(m->value, sub, depth + 1, member, allocator);
+                result.AddMember(Value(m->name, allocator), member, allocator);
+            }
+        }
+    }
+    else if (v.IsArray()) {
+        result.SetArray();
+        for (SizeType e = 0; e < v.Size(); e++) {
+            std::vector<const Pointer*> sub;
+            for (size_t i = 0; i < pointers.size(); i++)
+                if (pointers[i]->GetTokens()[depth].index == e)
+                    sub.push_back(pointers[i]);
+            if (!sub.empty()) {
+                while (result.Size() < e)
+                    result.PushBack(Value(), allocator);
+                Value element;
+                ProjectValue(v[e], sub, depth + 1, element, allocator);
+                result.PushBack(element, allocator);
+            }
+        }
+    }
+    else
+        result.CopyFrom(v, allocator);
+}
+
+static void RandomJson(Random& r, std::string& json, std::vector<std::string>& paths, const std::string& path, int depth) {
+    static const char* const kNames[] = { "a", "b", "c", "\\\\", "\\\"]", "\\u0061" };
+    static const char* const kPathNames[] = { "a", "b", "c", "\\", "\"]", "a" };
+    static const char* const kPieces[] = { "x", "{", "]", "\\\\", "\\\"", "\\\\\\\"", "\\u00e9", " ", "\xC3\xA9" };
+    paths.push_back(path);
+    json.append(r() % 4 == 0 ? "  \n" : "");
+    const unsigned kind = depth > 4 ? r() % 3 : r() % 5;
+    if (kind == 0) {
+        json.push_back('"');
+        for (unsigned n = (r() >> 16) % 40; n > 0; n--)
+            json.append(kPieces[(r() >> 16) % 9]);
+        json.push_back('"');
+    }
+    else if (kind == 1)
+        json.append((r() >> 16) % 2 ? "-12.5e3" : "true");
+    else if (kind == 2)
+        json.append("null");
+    else if (kind == 3) {
+        json.push_back('{');
+        for (unsigned n = (r() >> 16) % 6, i = 0; i < n; i++) {
+            const unsigned k = (r() >> 16) % 6;
+            json.append(i ? ", \"" : "\"").append(kNames[k]).append("\": ");
+            std::string name(kPathNames[k]);
+            std::string escaped;
+            for (size_t j = 0; j < name.size(); j++)
+                escaped.append(name[j] == '~' ? "~0" : name[j] == '/' ? "~1" : std::string(1, name[j]));
+            RandomJson(r, json, paths, path + "/" + escaped, depth + 1);
+        }
+        json.push_back('}');
+    }
+    else {
+        json.push_back('[');
+        for (unsigned n = (r() >> 16) % 6, i = 0; i < n; i++) {
+            json.append(i ? ", " : "");
+            char index[16];
+            sprintf(index, "/%u", i);
+            RandomJson(r, json, paths, path + index, depth + 1);
+        }
+        json.push_back(']');
+    }
+}
+
+TEST(Pointer, Projection_Random) {
+    Random r;
+    for (int trial = 0; trial < 2000; trial++) {
+        std::string json;
+        std::vector<std::string> paths;
+        RandomJson(r, json, paths, "", 0);
+
+        std::vector<Pointer> pointers;
+        for (unsigned n = 1 + (r() >> 16) % 3; n > 0; n--) {
+            std::string path = paths[(r() >> 16) % paths.size()];
+            if ((r() >> 16) % 4 == 0)
+                path.append("/b");  // may not exist
+            pointers.push_back(Pointer(path.c_str()));
+            ASSERT_TRUE(pointers.back().IsValid()) << path;
+        }
+
+        Document full;
+        full.Parse(json.c_str());
+        ASSERT_FALSE(full.HasParseError()) << json;
+        std::vector<const Pointer*> selected;
+        for (size_t i = 0; i < pointers.size(); i++)
+            selected.push_back(&pointers[i]);
+        Document expected;
+        ProjectValue(full, selected, 0, expected, expected.GetAllocator());
+
+        Projection projection(&pointers[0], pointers.size());
+        EXPECT_EQ(StringifyValue(expected), ProjectJson(json.c_str(), projection)) << json;
+        Document d;
+        d.Parse(json.c_str(), projection);
+        EXPECT_EQ(StringifyValue(expected), StringifyValue(d)) << json;  // operator== does not handle duplicate names
+        for (size_t i = 0; i < pointers.size(); i++) {
+            const Value* v = pointers[i].Get(full);
+            const Value* p = pointers[i].Get(d);
+            ASSERT_EQ(v == 0, p == 0) << json;
+            if (v) {
+                EXPECT_EQ(StringifyValue(*v), StringifyValue(*p)) << json;
+            }
+        }
+    }
+}
@@ -0,0 +1,290 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "unittest.h"
+
+#include "rapidjson/pushreader.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include <algorithm>
+#include <string>
+
+using namespace rapidjson;
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+// Feeding the text in chunks of any size must give the same events and errors as parsing it at once.
+template <unsigned parseFlags>
+static void TestPushReader(const char* json) {
+    StringBuffer expected;
+    ParseResult r;
+    {
+        Writer<StringBuffer> writer(expected);
+        StringStream s(json);
+        Reader reader;
+        r = reader.Parse<kParseIterativeFlag | parseFlags>(s, writer);
+    }
+
+    const size_t length = strlen(json);
+    for (size_t chunkSize = 1; chunkSize <= length + 1; chunkSize++) {
+        StringBuffer actual;
+        Writer<StringBuffer> writer(actual);
+        PushReader reader;
+        for (size_t i = 0; i < length; i += chunkSize)
+            if (!reader.Feed<parseFlags>(json + i, (std::min)(chunkSize, length - i), writer))
+                break;
+        ParseResult q = reader.HasParseError() ? ParseResult(reader.GetParseErrorCode(), reader.GetErrorOffset()) : reader.Finish<parseFlags>(writer);
+        EXPECT_EQ(r.Code(), q.Code()) << json << " chunk " << chunkSize;
+        EXPECT_EQ(r.Offset(), q.Offset()) << json << " chunk " << chunkSize;
+        if (!r.IsError()) {
+            EXPECT_STREQ(expected.GetString(), actual.GetString()) << json << " chunk " << chunkSize;
+            EXPECT_TRUE(reader.IsRootComplete());
+            EXPECT_EQ(0u, reader.GetPendingLength());
+        }
+    }
+}
+
+TEST(PushReader, Valid) {
+    static const char* json[] = {
+        "{}", "[]", " 1 ", "-1.5e-30", "true", "false", "null", "\"\"", "\"\\\\\"", "\"\\\"\\\\\\/\\b\\f\\n\\r\\t\\u0041\\uD834\\uDD1E\"",
+        "{ \"hello\" : \"world\", \"t\" : true , \"f\" : false, \"n\": null, \"i\":123, \"pi\": 3.1416, \"a\":[1, 2, 3, 4] } ",
+        "[[[[[]]]], {\"a\": {\"b\": {}}}, \"\\u00e9\\u4e2d\", \"\xC3\xA9\", 18446744073709551615, -9223372036854775808]",
+        "[1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40]",
+        " \n\t\r[ \"a long string which will certainly be split across several small chunks\" ] \n"
+    };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++)
+        TestPushReader<kParseDefaultFlags>(json[i]);
+}
+
+TEST(PushReader, Error) {
+    static const char* json[] = {
+        "", "   ", "[", "[1", "[1,", "[1 2]", "{\"a\" 1}", "{\"a\":1,}", "{1:2}", "[tru]", "[nul", "tr", "1 2",
+        "[1]x", "[1]  [2]", "\"abc", "\"\\", "\"\\x\"", "[\"a\tb\"]", "[-]", "[1.]", "[01]", "]", ",", "[,]",
+        "{\"a\":", "{\"a\"", "{\"a", "{", "[\"\\uD800\"]"
+    };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++)
+        TestPushReader<kParseDefaultFlags>(json[i]);
+}
+
+TEST(PushReader, Flags) {
+    TestPushReader<kParseTrailingCommasFlag>("[1, 2, {\"a\": 3,},]");
+    TestPushReader<kParseNumbersAsStringsFlag>("[1, -2.5e10, 12345678901234567890123]");
+    TestPushReader<kParseNanAndInfFlag>("[NaN, -Infinity, Inf, 1]");
+    TestPushReader<kParseFullPrecisionFlag>("[0.1, 3.14159265358979323846]");
+    TestPushReader<kParseValidateEncodingFlag>("[\"\xC3\xA9\", \"\xE4\xB8\xAD\"]");
+    TestPushReader<kParseValidateEncodingFlag>("[\"\xC3\"]");
+    TestPushReader<kParseCommentsFlag>("// head\n[1, /* two */ 2, // three\n 3 /**/ ] /* tail **/ // end");
+    TestPushReader<kParseCommentsFlag>("[1 /* unterminated ]");
+    TestPushReader<kParseCommentsFlag>("[1 / 2]");
+    TestPushReader<kParseCommentsFlag>("[1] /* x */ 2");
+}
+
+TEST(PushReader, Random) {
+    static const char* tokens[] = {
+        "{", "}", "[", "]", ":", ",", "\"\"", "\"a\"", "\"\\\\\"", "\"\\\"\"", "\"}{][,:\"", "0", "-12.5e-3",
+        "true", "false", "null", "x", " ", "\n", "/*/", "*/", "//", "/"
+    };
+    const size_t tokenCount = sizeof(tokens) / sizeof(tokens[0]);
+    unsigned seed = 4321;
+    std::string json;
+    for (int n = 0; n < 500; n++) {
+        json.clear();
+        for (int i = 0; i < 12; i++) {
+            seed = seed * 1103515245u + 12345u;
+            json += tokens[(seed >> 16) % tokenCount];
+        }
+        TestPushReader<kParseDefaultFlags>(json.c_str());
+        TestPushReader<kParseCommentsFlag>(json.c_str());
+    }
+}
+
+// Writes each root of a sequence, separated by '|'.
+struct PushReaderRootsHandler {
+    PushReaderRootsHandler() : sb(), writer(sb), roots() {}
+
+    bool Null() { return Done(writer.Null()); }
+    bool Bool(bool b) { return Done(writer.Bool(b)); }
+    bool Int(int i) { return Done(writer.Int(i)); }
+    bool Uint(unsigned u) { return Done(writer.Uint(u)); }
+    bool Int64(int64_t i) { return Done(writer.Int64(i)); }
+    bool Uint64(uint64_t u) { return Done(writer.Uint64(u)); }
+    bool Double(double d) { return Done(writer.Double(d)); }
+    bool RawNumber(const char* str, SizeType length, bool copy) { return Done(writer.RawNumber(str, length, copy)); }
+    bool String(const char* str, SizeType length, bool copy) { return Done(writer.String(str, length, copy)); }
+    bool StartObject() { return Done(writer.StartObject()); }
+    bool Key(const char* str, SizeType length, bool copy) { return Done(writer.Key(str, length, copy)); }
+    bool EndObject(SizeType memberCount) { return Done(writer.EndObject(memberCount)); }
+    bool StartArray() { return Done(writer.StartArray()); }
+    bool EndArray(SizeType elementCount) { return Done(writer.EndArray(elementCount)); }
+
+    bool Done(bool result) {
+        if (writer.IsComplete()) {
+            roots += sb.GetString();
+            roots += '|';
+            sb.Clear();
+            writer.Reset(sb);
+        }
+        return result;
+    }
+
+    StringBuffer sb;
+    Writer<StringBuffer> writer;
+    std::string roots;
+};
+
+TEST(PushReader, MultipleRoot) {
+    static const char json[] = "{\"a\":1}\n[2]\n 3 \"four\"\n// not a comment";
+    const size_t length = sizeof(json) - 1 - 17;    // without the comment
+    for (size_t chunkSize = 1; chunkSize <= length; chunkSize++) {
+        PushReaderRootsHandler h;
+        PushReader reader;
+        for (size_t i = 0; i < length; i += chunkSize)
+            EXPECT_TRUE(reader.Feed<kParseStopWhenDoneFlag>(json + i, (std::min)(chunkSize, length - i), h));
+        EXPECT_TRUE(reader.Finish<kParseStopWhenDoneFlag>(h));
+        EXPECT_STREQ("{\"a\":1}|[2]|3|\"four\"|", h.roots.c_str()) << " chunk " << chunkSize;
+    }
+
+    // Anything but whitespace after the root is an error without kParseStopWhenDoneFlag,
+    // even before Finish().
+    {
+        StringBuffer sb;
+        Writer<StringBuffer> writer(sb);
+        PushReader reader;
+        EXPECT_TRUE(reader.Feed<kParseDefaultFlags>(json, 8, writer));
+        EXPECT_TRUE(reader.IsRootComplete());
+        EXPECT_FALSE(reader.Feed<kParseDefaultFlags>(json + 8, 1, writer));
+        EXPECT_EQ(kParseErrorDocumentRootNotSingular, reader.GetParseErrorCode());
+        EXPECT_EQ(8u, reader.GetErrorOffset());
+    }
+}
+
+TEST(PushReader, PendingAndReset) {
+    std::string json = "[\"";
+    json.append(10000, 'x');
+    json += "\", 1]";
+
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    PushReader reader;
+    size_t maxPending = 0;
+    for (size_t i = 0; i < json.size(); i += 7) {
+        EXPECT_TRUE(reader.Feed<kParseDefaultFlags>(json.data() + i, (std::min)(size_t(7), json.size() - i), writer));
+        maxPending = (std::max)(maxPending, reader.GetPendingLength());
+    }
+    EXPECT_TRUE(reader.Finish<kParseDefaultFlags>(writer));
+    EXPECT_EQ(json.size() - 1, sb.GetSize());   // without the space
+    EXPECT_LE(maxPending, 10001u);              // only the split string is buffered
+
+    // Start over after an error.
+    reader.Reset();
+    BaseReaderHandler<> h;
+    EXPECT_FALSE(reader.Feed<kParseDefaultFlags>("[1}", 3, h));
+    EXPECT_EQ(kParseErrorArrayMissCommaOrSquareBracket, reader.GetParseErrorCode());
+    EXPECT_EQ(2u, reader.GetErrorOffset());
+    EXPECT_FALSE(reader.Feed<kParseDefaultFlags>("]", 1, h));
+
+    reader.Reset();
+    StringBuffer sb2;
+    Writer<StringBuffer> writer2(sb2);
+    EXPECT_TRUE(reader.Feed<kParseDefaultFlags>("{\"k\":", 5, writer2));
+    EXPECT_TRUE(reader.Feed<kParseDefaultFlags>("[]}", 3, writer2));
+    EXPECT_TRUE(reader.Finish<kParseDefaultFlags>(writer2));
+    EXPECT_STREQ("{\"k\":[]}", sb2.GetString());
+}
+
+struct PushReaderLengthHandler : BaseReaderHandler<UTF8<>, PushReaderLengthHandler> {
+    PushReaderLengthHandler() : length(0), count(0) {}
+    bool String(const char* str, SizeType len, bool) { length += len; count += str[len - 1] == 'y'; return true; }
+    bool RawNumber(const char*, SizeType len, bool) { length += len; return true; }
+    size_t length;
+    int count;
+};
+
+TEST(PushReader, LongToken) {
+    // A token over many small chunks is scanned where the previous chunk left off, in linear time.
+    std::string json = "[\"";
+    json.append(4 * 1024 * 1024, 'x');
+    json += "\\\"y\", 0.";
+    json.append(100000, '7');
+    json += "]";
+
+    PushReader reader;
+    PushReaderLengthHandler h;
+    for (size_t i = 0; i < json.size(); i += 64)
+        ASSERT_TRUE(reader.Feed<kParseNumbersAsStringsFlag>(json.data() + i, (std::min)(size_t(64), json.size() - i), h));
+    EXPECT_TRUE(reader.Finish<kParseNumbersAsStringsFlag>(h));
+    EXPECT_EQ(4u * 1024 * 1024 + 2 + 2 + 100000, h.length);
+    EXPECT_EQ(1, h.count);
+    EXPECT_EQ(0u, reader.GetPendingLength());
+}
+
+TEST(PushReader, DefaultFlags) {
+    // A number at the end of a chunk is reported only when the next chunk shows where it ends.
+    StringBuffer sb;
+    Writer<StringBuffer> writer(sb);
+    PushReader reader;
+    EXPECT_TRUE(reader.Feed("[12", 3, writer));
+    EXPECT_STREQ("[", sb.GetString());
+    EXPECT_EQ(2u, reader.GetPendingLength());
+    EXPECT_TRUE(reader.Feed("3, tr", 5, writer));
+    EXPECT_STREQ("[123", sb.GetString());
+    EXPECT_FALSE(reader.Feed("ue]  4", 6, writer));
+    EXPECT_STREQ("[123,true]", sb.GetString());
+    EXPECT_EQ(kParseErrorDocumentRootNotSingular, reader.GetParseErrorCode());
+    EXPECT_EQ(13u, reader.GetErrorOffset());
+
+    reader.Reset();
+    sb.Clear();
+    writer.Reset(sb);
+    EXPECT_TRUE(reader.Feed(" -4", 3, writer));
+    EXPECT_STREQ("", sb.GetString());
+    EXPECT_TRUE(reader.Finish(writer));
+    EXPECT_STREQ("-4", sb.GetString());
+}
+
+struct PushReaderTerminateHandler : BaseReaderHandler<UTF8<>, PushReaderTerminateHandler> {
+    PushReaderTerminateHandler() : count(0) {}
+    bool Default() { return ++count < 3; }
+    int count;
+};
+
+TEST(PushReader, Termination) {
+    PushReader reader;
+    PushReaderTerminateHandler h;
+    EXPECT_TRUE(reader.Feed<kParseDefaultFlags>("[1, ", 4, h));
+    EXPECT_FALSE(reader.Feed<kParseDefaultFlags>("2, 3, 4]", 8, h));
+    EXPECT_EQ(kParseErrorTermination, reader.GetParseErrorCode());
+    EXPECT_EQ(3, h.count);
+}
+
+struct PushReaderSkipHandler : BaseReaderHandler<UTF8<>, PushReaderSkipHandler> {
+    HandlerResult Key(const char*, SizeType, bool) { return kHandlerSkip; }
+};
+
+TEST(PushReader, HandlerSkip) {
+    // The value to skip may span chunks, so skipping terminates the parse.
+    PushReader reader;
+    PushReaderSkipHandler h;
+    EXPECT_FALSE(reader.Feed<kParseDefaultFlags>("{\"a\": [1, 2]}", 14, h));
+    EXPECT_EQ(kParseErrorTermination, reader.GetParseErrorCode());
+    EXPECT_EQ(4u, reader.GetErrorOffset());
+}
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
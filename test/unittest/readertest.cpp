@@ -18,8 +18,11 @@
 #include "rapidjson/internal/dtoa.h"
 #include "rapidjson/internal/itoa.h"
 #include "rapidjson/memorystream.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
 
 #include <limits>
+#include <vector>
 
 using namespace rapidjson;
 
@@ -931,6 +934,11 @@ TEST(Reader, ParseInsituIterative_MultipleRoot) {
     TestInsituMultipleRoot<kParseIterativeFlag | kParseStopWhenDoneFlag>();
 }
 
+TEST(Reader, ParseStructuralIndex_MultipleRoot) {
+    TestMultipleRoot<kParseStructuralIndexFlag | kParseStopWhenDoneFlag>();
+    TestInsituMultipleRoot<kParseStructuralIndexFlag | kParseStopWhenDoneFlag>();
+}
+
 #define TEST_ERROR(errorCode, str, errorOffset) \
     { \
         int streamPos = errorOffset; \
@@ -1060,6 +1068,83 @@ TEST(Reader, CustomStringStream) {
     EXPECT_EQ(20u, h.step_);
 }
 
+// Records number events with their exact values, the parse error and the stream position.
+struct NumberEventHandler : BaseReaderHandler<UTF8<>, NumberEventHandler> {
+    bool Int(int i) { return Record("Int", static_cast<uint64_t>(i)); }
+    bool Uint(unsigned u) { return Record("Uint", u); }
+    bool Int64(int64_t i) { return Record("Int64", static_cast<uint64_t>(i)); }
+    bool Uint64(uint64_t u) { return Record("Uint64", u); }
+    bool Double(double d) { return Record("Double", internal::Double(d).Uint64Value()); }
+    bool RawNumber(const char* str, SizeType length, bool) {
+        events += std::string(str, length) + ";";
+        return true;
+    }
+    bool Record(const char* type, uint64_t value) {
+        char buffer[32];
+        *internal::u64toa(value, buffer) = '\0';
+        events += std::string(type) + " " + buffer + ";";
+        return true;
+    }
+
+    std::string events;
+};
+
+template <unsigned parseFlags, typename InputStream>
+static std::string ParseNumberEvents(InputStream& is) {
+    NumberEventHandler h;
+    Reader reader;
+    reader.Parse<parseFlags>(is, h);
+    char buffer[32];
+    sprintf(buffer, "error %d at %u, tell %u", static_cast<int>(reader.GetParseErrorCode()),
+        static_cast<unsigned>(reader.GetErrorOffset()), static_cast<unsigned>(is.Tell()));
+    return h.events + buffer;
+}
+
+template <unsigned parseFlags>
+static void TestParseNumberDigits8(const char* json, char* buffer) {
+    CustomStringStream<UTF8<> > cs(json);
+    const std::string expected = ParseNumberEvents<parseFlags>(cs);
+
+    StringStream ss(json);
+    EXPECT_EQ(expected, ParseNumberEvents<parseFlags>(ss)) << json;
+
+    const size_t length = strlen(json);
+    memcpy(buffer, json, length + 1);
+    InsituStringStream is(buffer);
+    EXPECT_EQ(expected, ParseNumberEvents<parseFlags | kParseInsituFlag>(is)) << json;
+
+    MemoryStream ms(json, length);
+    EXPECT_EQ(expected, ParseNumberEvents<parseFlags>(ms)) << json;
+
+    MemoryStream ms2(json, length);
+    EncodedInputStream<UTF8<>, MemoryStream> es(ms2);
+    EXPECT_EQ(expected, ParseNumberEvents<parseFlags>(es)) << json;
+}
+
+TEST(Reader, ParseNumber_Digits8) {
+    static const char* numbers[] = {
+        "0", "7", "12345678", "123456789", "1234567890", "4294967295", "4294967296", "-2147483648", "-2147483649",
+        "12345678901234567", "123456789012345678", "1234567890123456789", "18446744073709551615",
+        "18446744073709551616", "-9223372036854775808", "-9223372036854775809", "99999999999999999999999",
+        "1234567890123456789012345678901234567890", "0.12345678", "0.000000001234567890123", "0.00000000",
+        "135.747111636", "-0.9007199254740993", "9007199254.740993", "1.2345678901234567890123e10",
+        "123456789.123456789e-5", "12345678e5", "[12345678,87654321]", "12345678.", "1234567a8", "-", "0123456789"
+    };
+    // Every alignment of the number, with nothing or a non-digit following it in the same word.
+    char storage[128 + 8];
+    char* aligned = reinterpret_cast<char*>((reinterpret_cast<size_t>(storage) + 7) & ~static_cast<size_t>(7));
+    char buffer[128];
+    for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++)
+        for (size_t offset = 0; offset < 8; offset++)
+            for (int suffix = 0; suffix < 2; suffix++) {
+                char* json = aligned + offset;
+                sprintf(json, suffix ? "%s " : "%s", numbers[i]);
+                TestParseNumberDigits8<kParseDefaultFlags>(json, buffer);
+                TestParseNumberDigits8<kParseFullPrecisionFlag>(json, buffer);
+                TestParseNumberDigits8<kParseNumbersAsStringsFlag>(json, buffer);
+            }
+}
+
 #include <sstream>
 
 class IStreamWrapper {
@@ -1289,6 +1374,109 @@ TEST(Reader, IterativeParsing_Count) {
     }
 }
 
+TEST(Reader, IterativePullParsing_General) {
+    {
+        int e[] = {
+            IterativeParsingReaderHandler<>::LOG_STARTARRAY,
+            IterativeParsingReaderHandler<>::LOG_INT,
+            IterativeParsingReaderHandler<>::LOG_STARTOBJECT,
+            IterativeParsingReaderHandler<>::LOG_KEY,
+            IterativeParsingReaderHandler<>::LOG_STARTARRAY,
+            IterativeParsingReaderHandler<>::LOG_INT,
+            IterativeParsingReaderHandler<>::LOG_INT,
+            IterativeParsingReaderHandler<>::LOG_ENDARRAY, 2,
+            IterativeParsingReaderHandler<>::LOG_ENDOBJECT, 1,
+            IterativeParsingReaderHandler<>::LOG_NULL,
+            IterativeParsingReaderHandler<>::LOG_BOOL,
+            IterativeParsingReaderHandler<>::LOG_BOOL,
+            IterativeParsingReaderHandler<>::LOG_STRING,
+            IterativeParsingReaderHandler<>::LOG_DOUBLE,
+            IterativeParsingReaderHandler<>::LOG_ENDARRAY, 7
+        };
+
+        StringStream is("[1, {\"k\": [1, 2]}, null, false, true, \"string\", 1.2]");
+        Reader reader;
+        IterativeParsingReaderHandler<> handler;
+
+        reader.IterativeParseInit();
+        while (!reader.IterativeParseComplete()) {
+            size_t oldLogCount = handler.LogCount;
+            EXPECT_TRUE(oldLogCount < sizeof(e) / sizeof(int)) << "overrun";
+
+            EXPECT_TRUE(reader.IterativeParseNext<kParseDefaultFlags>(is, handler)) << "parse fail";
+            EXPECT_EQ(handler.LogCount, oldLogCount + ((e[oldLogCount] == IterativeParsingReaderHandler<>::LOG_ENDARRAY || e[oldLogCount] == IterativeParsingReaderHandler<>::LOG_ENDOBJECT) ? 2 : 1)) << "handler should be invoked exactly once each time";
+            for (size_t i = oldLogCount; i < handler.LogCount; ++i)
+                EXPECT_EQ(e[i], handler.Logs[i]) << "i = " << i;
+        }
+
+        EXPECT_EQ(sizeof(e) / sizeof(int), handler.LogCount);
+        EXPECT_FALSE(reader.HasParseError());
+        EXPECT_TRUE(reader.IterativeParseNext<kParseDefaultFlags>(is, handler)) << "parsing after completion is a no-op";
+        EXPECT_EQ(sizeof(e) / sizeof(int), handler.LogCount);
+    }
+}
+
+TEST(Reader, IterativePullParsing_Error) {
+#define TEST_PULL_ERROR(text, events, errorCode, errorOffset) \
+    { \
+        StringStream is(text); \
+        Reader reader; \
+        IterativeParsingReaderHandler<> handler; \
+        reader.IterativeParseInit(); \
+        unsigned calls = 0; \
+        while (reader.IterativeParseNext<kParseDefaultFlags>(is, handler) && !reader.IterativeParseComplete()) \
+            calls++; \
+        EXPECT_EQ(events, calls); \
+        EXPECT_TRUE(reader.IterativeParseComplete()); \
+        EXPECT_EQ(errorCode, reader.GetParseErrorCode()); \
+        EXPECT_EQ(errorOffset, reader.GetErrorOffset()); \
+        EXPECT_FALSE(reader.IterativeParseNext<kParseDefaultFlags>(is, handler)); \
+    }
+
+    TEST_PULL_ERROR("", 0u, kParseErrorDocumentEmpty, 0u);
+    TEST_PULL_ERROR("   ", 0u, kParseErrorDocumentEmpty, 3u);
+    TEST_PULL_ERROR("[1, 2", 3u, kParseErrorArrayMissCommaOrSquareBracket, 5u);
+    TEST_PULL_ERROR("{\"a\" 1}", 2u, kParseErrorObjectMissColon, 5u);
+    TEST_PULL_ERROR("[1] x", 2u, kParseErrorDocumentRootNotSingular, 4u);
+    TEST_PULL_ERROR("[tru]", 1u, kParseErrorValueInvalid, 4u);
+#undef TEST_PULL_ERROR
+}
+
+TEST(Reader, IterativePullParsing_Partial) {
+    // Read only the first member, then abandon the document and reuse the reader.
+    StringStream first("{\"id\": 42, \"payload\": [1, 2, 3, {\"x\": \"y\"}]}");
+    Reader reader;
+    IterativeParsingReaderHandler<> handler;
+    reader.IterativeParseInit();
+    for (int i = 0; i < 3; i++)
+        EXPECT_TRUE(reader.IterativeParseNext<kParseDefaultFlags>(first, handler));
+    EXPECT_FALSE(reader.IterativeParseComplete());
+    ASSERT_EQ(3u, handler.LogCount);
+    EXPECT_TRUE(handler.Logs[2] == handler.LOG_INT);
+    EXPECT_EQ(9u, first.Tell());
+
+    StringStream second("[[]]");
+    IterativeParsingReaderHandler<> handler2;
+    reader.IterativeParseInit();
+    while (!reader.IterativeParseComplete())
+        EXPECT_TRUE(reader.IterativeParseNext<kParseDefaultFlags>(second, handler2));
+    EXPECT_EQ(6u, handler2.LogCount);   // StartArray, StartArray, EndArray 0, EndArray 1
+}
+
+TEST(Reader, IterativePullParsing_MultipleRoot) {
+    StringStream s("{}[] a");
+    IterativeParsingReaderHandler<> handler;
+    Reader reader;
+    for (int root = 0; root < 2; root++) {
+        reader.IterativeParseInit();
+        while (!reader.IterativeParseComplete())
+            EXPECT_TRUE(reader.IterativeParseNext<kParseStopWhenDoneFlag>(s, handler));
+    }
+    EXPECT_EQ(6u, handler.LogCount);
+    EXPECT_EQ(' ', s.Take());
+    EXPECT_EQ('a', s.Take());
+}
+
 // Test iterative parsing on kParseErrorTermination.
 struct HandlerTerminateAtStartObject : public IterativeParsingReaderHandler<> {
     bool StartObject() { return false; }
@@ -1411,6 +1599,239 @@ TEST(Reader, ParseTerminationByHandler) {
     TEST_TERMINATION(13, "{\"a\":[1]"); // non-empty array
 }
 
+// Drops the members named "skip", the arrays within arrays and the objects within arrays
+// after an odd number of kept elements (and the root if asked to), with kHandlerSkip or,
+// for reference, by ignoring the events of the dropped values.
+template <bool useSkip>
+struct SkippingHandler : BaseReaderHandler<UTF8<>, SkippingHandler<useSkip> > {
+    explicit SkippingHandler(bool skipRoot = false) : sb(), writer(sb), open(), counts(), ignored(0), ignoreNext(false), skipRoot_(skipRoot) {}
+
+    bool Null() { return Drop() || writer.Null(); }
+    bool Bool(bool b) { return Drop() || writer.Bool(b); }
+    bool Int(int i) { return Drop() || writer.Int(i); }
+    bool Uint(unsigned u) { return Drop() || writer.Uint(u); }
+    bool Int64(int64_t i) { return Drop() || writer.Int64(i); }
+    bool Uint64(uint64_t u) { return Drop() || writer.Uint64(u); }
+    bool Double(double d) { return Drop() || writer.Double(d); }
+    bool String(const char* str, SizeType length, bool copy) { return Drop() || writer.String(str, length, copy); }
+
+    HandlerResult StartObject() {
+        if (!Enter('{'))
+            return Ignore();
+        return writer.StartObject() ? kHandlerContinue : kHandlerTerminate;
+    }
+    HandlerResult StartArray() {
+        if (!Enter('['))
+            return Ignore();
+        return writer.StartArray() ? kHandlerContinue : kHandlerTerminate;
+    }
+    HandlerResult Key(const char* str, SizeType length, bool copy) {
+        if (ignored > 0)
+            return kHandlerContinue;
+        if (length == 4 && std::memcmp(str, "skip", 4) == 0) {
+            if (useSkip)
+                return kHandlerSkip;
+            ignoreNext = true;
+            return kHandlerContinue;
+        }
+        return writer.Key(str, length, copy) ? kHandlerContinue : kHandlerTerminate;
+    }
+    bool EndObject(SizeType memberCount) { return Leave(memberCount) || writer.EndObject(memberCount); }
+    bool EndArray(SizeType elementCount) { return Leave(elementCount) || writer.EndArray(elementCount); }
+
+    // Whether a scalar is dropped; otherwise count it.
+    bool Drop() {
+        if (ignored > 0)
+            return true;
+        if (ignoreNext) {
+            ignoreNext = false;
+            return true;
+        }
+        if (!counts.empty())
+            ++counts.back();
+        return false;
+    }
+    // Whether an object or array is kept; if so, count and enter it.
+    bool Enter(char c) {
+        if (ignored > 0 || ignoreNext) {
+            ignoreNext = false;
+            return false;
+        }
+        if (open.empty() ? skipRoot_ : open.back() == '[' && (c == '[' || counts.back() % 2 == 1))
+            return false;
+        if (!counts.empty())
+            ++counts.back();
+        open.push_back(c);
+        counts.push_back(0);
+        return true;
+    }
+    HandlerResult Ignore() {
+        if (useSkip)
+            return kHandlerSkip;
+        ++ignored;
+        return kHandlerContinue;
+    }
+    // Whether the end of an object or array is dropped; otherwise check its count and leave it.
+    bool Leave(SizeType count) {
+        if (ignored > 0) {
+            --ignored;
+            return true;
+        }
+        if (useSkip)
+            EXPECT_EQ(counts.back(), count);
+        open.pop_back();
+        counts.pop_back();
+        return false;
+    }
+
+    StringBuffer sb;
+    Writer<StringBuffer> writer;
+    std::string open;
+    std::vector<SizeType> counts;
+    int ignored;
+    bool ignoreNext;
+    bool skipRoot_;
+};
+
+// Parse with kHandlerSkip through the recursive (over the SIMD and the generic skips),
+// iterative, structural index and token-by-token parsers, which must agree.
+template <unsigned parseFlags>
+static ParseResult ParseSkipping(const char* json, std::string& out, bool skipRoot = false) {
+    ParseResult result;
+    for (int path = 0; path < 6; path++) {
+        SkippingHandler<true> h(skipRoot);
+        Reader reader;
+        ParseResult r;
+        std::vector<char> buffer(json, json + strlen(json) + 1);
+        switch (path) {
+        case 0: { StringStream s(json); r = reader.Parse<parseFlags>(s, h); break; }
+        case 1: { MemoryStream s(json, strlen(json)); r = reader.Parse<parseFlags>(s, h); break; }
+        case 2: { InsituStringStream s(&buffer[0]); r = reader.Parse<parseFlags | kParseInsituFlag>(s, h); break; }
+        case 3: { StringStream s(json); r = reader.Parse<parseFlags | kParseIterativeFlag>(s, h); break; }
+        case 4: { StringStream s(json); r = reader.Parse<parseFlags | kParseStructuralIndexFlag>(s, h); break; }
+        default: {
+            StringStream s(json);
+            reader.IterativeParseInit();
+            while (!reader.IterativeParseComplete())
+                if (!reader.IterativeParseNext<parseFlags>(s, h))
+                    break;
+            r = ParseResult(reader.GetParseErrorCode(), reader.GetErrorOffset());
+        }
+        }
+        if (path == 0) {
+            result = r;
+            out = h.sb.GetString();
+        }
+        else {
+            EXPECT_EQ(result.Code(), r.Code()) << json << " path " << path;
+            EXPECT_EQ(result.Offset(), r.Offset()) << json << " path " << path;
+            EXPECT_EQ(out, h.sb.GetString()) << json << " path " << path;
+        }
+    }
+    return result;
+}
+
+TEST(Reader, HandlerSkip) {
+    static const struct { const char* json; const char* expected; } cases[] = {
+        { "{\"a\":1,\"skip\":{\"x\":[1,2]},\"b\":2}", "{\"a\":1,\"b\":2}" },
+        { "{\"skip\":1}", "{}" },
+        { "{ \"skip\" : \"]}\\\"\" , \"a\" : [ [ 1 ] , 2 ] , \"skip\" : null }", "{\"a\":[2]}" },
+        { "[[1,[2,{\"a\":\"]\"}]],1,{\"a\":1},{\"b\":2},[3],4,{\"c\":{}}]", "[1,4,{\"c\":{}}]" },
+        { "[{\"a\":[[1]]},{\"b\":2},3,{\"c\":3}]", "[{\"a\":[]},3,{\"c\":3}]" },
+        { "[[],[[]],{}]", "[{}]" },
+        { "[\"\\\\\",[\"\\\\\\\"]\"],\"[\"]", "[\"\\\\\",\"[\"]" },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        std::string out;
+        EXPECT_FALSE(ParseSkipping<kParseNoFlags>(cases[i].json, out).IsError()) << cases[i].json;
+        EXPECT_EQ(std::string(cases[i].expected), out) << cases[i].json;
+    }
+
+    // The root.
+    std::string out;
+    EXPECT_FALSE(ParseSkipping<kParseNoFlags>(" {\"a\":[1,{}]} ", out, true).IsError());
+    EXPECT_EQ("", out);
+    EXPECT_EQ(kParseErrorDocumentRootNotSingular, ParseSkipping<kParseNoFlags>("[1] 2", out, true).Code());
+    EXPECT_FALSE(ParseSkipping<kParseStopWhenDoneFlag>("[1] 2", out, true).IsError());
+
+    // Trailing commas and comments, which are skipped by the generic skip.
+    EXPECT_FALSE(ParseSkipping<kParseTrailingCommasFlag>("[1,[2,],{\"skip\":[3,],},{\"a\":4},5,{},]", out).IsError());
+    EXPECT_EQ("[1,5,{}]", out);
+    EXPECT_FALSE(ParseSkipping<kParseCommentsFlag>("{\"skip\"/*:*/:[1,/*]*/2//]\n],\"a\":[[/*[*/]]}", out).IsError());
+    EXPECT_EQ("{\"a\":[]}", out);
+}
+
+TEST(Reader, HandlerSkip_Error) {
+    // Only unmatched brackets and unterminated strings are errors in a skipped value.
+    static const struct { const char* json; ParseErrorCode code; size_t offset; } cases[] = {
+        { "{\"skip\":[1,x]}", kParseErrorNone, 0 },
+        { "[[1 2 :]]", kParseErrorNone, 0 },
+        { "{\"skip\":[1,2}", kParseErrorArrayMissCommaOrSquareBracket, 12 },
+        { "{\"skip\":{\"a\":1]", kParseErrorObjectMissCommaOrCurlyBracket, 14 },
+        { "{\"skip\":\"abc", kParseErrorStringMissQuotationMark, 12 },
+        { "{\"skip\":[\"]", kParseErrorStringMissQuotationMark, 11 },
+        { "{\"skip\":[[1]", kParseErrorArrayMissCommaOrSquareBracket, 12 },
+        { "[[1,{]]", kParseErrorObjectMissCommaOrCurlyBracket, 5 },
+        { "[[1,[]", kParseErrorArrayMissCommaOrSquareBracket, 6 },
+        { "{\"skip\" 1}", kParseErrorObjectMissColon, 8 },
+        { "{\"skip\":}", kParseErrorValueInvalid, 8 },
+        { "{\"skip\":", kParseErrorValueInvalid, 8 },
+        { "{\"skip\":1]", kParseErrorObjectMissCommaOrCurlyBracket, 9 },
+        { "[1,[2]", kParseErrorArrayMissCommaOrSquareBracket, 6 },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        std::string out;
+        ParseResult r = ParseSkipping<kParseNoFlags>(cases[i].json, out);
+        EXPECT_EQ(cases[i].code, r.Code()) << cases[i].json;
+        EXPECT_EQ(cases[i].offset, r.Offset()) << cases[i].json;
+    }
+}
+
+static void RandomSkipJson(Random& r, std::string& json, int depth) {
+    static const char* const kNames[] = { "\"a\"", "\"skip\"", "\"sk\\u0069p\"", "\"skip\\\\\"" };
+    static const char* const kScalars[] = { "1", "-2.5e3", "true", "null", "\"\"", "\"]}\"", "\"\\\"[\"", "\"\\\\\"", "\"{\\\\\\\"\"" };
+    static const char* const kSpaces[] = { "", "", " ", "\n\t " };
+    json += kSpaces[(r() >> 16) % 4];
+    const unsigned kind = depth > 5 ? 2 : (r() >> 16) % 3;
+    if (kind == 2)
+        json += kScalars[(r() >> 16) % (sizeof(kScalars) / sizeof(kScalars[0]))];
+    else {
+        json += kind ? '[' : '{';
+        for (unsigned i = 0, n = (r() >> 16) % 5; i < n; i++) {
+            if (i > 0)
+                json += ',';
+            if (!kind) {
+                json += kNames[(r() >> 16) % 4];
+                json += kSpaces[(r() >> 16) % 4];
+                json += ':';
+            }
+            RandomSkipJson(r, json, depth + 1);
+            if ((r() >> 16) % 8 == 0)
+                json.append((r() >> 16) % 100, ' ');     // cross 64-byte blocks
+        }
+        json += kind ? ']' : '}';
+    }
+    json += kSpaces[(r() >> 16) % 4];
+}
+
+TEST(Reader, HandlerSkip_Random) {
+    Random r;
+    for (int trial = 0; trial < 3000; trial++) {
+        std::string json;
+        RandomSkipJson(r, json, 0);
+        const bool skipRoot = trial % 16 == 0;
+
+        SkippingHandler<false> expected(skipRoot);
+        StringStream s(json.c_str());
+        Reader reader;
+        ASSERT_FALSE(reader.Parse(s, expected).IsError()) << json;
+
+        std::string out;
+        EXPECT_FALSE(ParseSkipping<kParseNoFlags>(json.c_str(), out, skipRoot).IsError()) << json;
+        EXPECT_EQ(std::string(expected.sb.GetString()), out) << json;
+    }
+}
+
 TEST(Reader, ParseComments) {
     const char* json =
     "// Here is a one-line comment.\n"
@@ -1564,6 +1985,15 @@ struct NumbersAsStringsHandler {
     size_t expected_len_;
 };
 
+struct NumbersAsStringsUTF16Handler : BaseReaderHandler<UTF16<>, NumbersAsStringsUTF16Handler> {
+    bool RawNumber(const wchar_t* str, SizeType length, bool) {
+        numbers_.append(str, length);
+        numbers_ += L',';
+        return true;
+    }
+    std::wstring numbers_;
+};
+
 TEST(Reader, NumbersAsStrings) {
     {
         const char* json = "{ \"pi\": 3.1416 } ";
@@ -1633,6 +2063,14 @@ TEST(Reader, NumbersAsStrings) {
         Reader reader;
         EXPECT_TRUE(reader.Parse<kParseNumbersAsStringsFlag>(s, h));
     }
+    {
+        // Transcoded to the target encoding.
+        StringStream s("[3.1416, -1.0e9, 0]");
+        NumbersAsStringsUTF16Handler h;
+        GenericReader<UTF8<>, UTF16<> > reader;
+        EXPECT_TRUE(reader.Parse<kParseNumbersAsStringsFlag>(s, h));
+        EXPECT_TRUE(h.numbers_ == L"3.1416,-1.0e9,0,");
+    }
 }
 
 template <unsigned extraFlags>
@@ -1778,6 +2216,273 @@ TEST(Reader, TrailingCommaHandlerTerminationIterative) {
     TestTrailingCommaHandlerTermination<kParseIterativeFlag>();
 }
 
+// kParseStructuralIndexFlag must produce the same events, errors and error offsets as kParseIterativeFlag.
+template <unsigned extraFlags>
+static void TestStructuralIndexParse(const char* json) {
+    StringBuffer expected, actual;
+    Writer<StringBuffer> expectedWriter(expected), actualWriter(actual);
+    Reader expectedReader, actualReader;
+    {
+        StringStream s(json);
+        ParseResult r = expectedReader.Parse<kParseIterativeFlag | extraFlags>(s, expectedWriter);
+        StringStream t(json);
+        ParseResult q = actualReader.Parse<kParseStructuralIndexFlag | extraFlags>(t, actualWriter);
+        EXPECT_EQ(r.Code(), q.Code()) << json;
+        EXPECT_EQ(r.Offset(), q.Offset()) << json;
+        EXPECT_EQ(s.Tell(), t.Tell()) << json;
+        EXPECT_STREQ(expected.GetString(), actual.GetString()) << json;
+    }
+    {
+        char* buffer = StrDup(json);
+        InsituStringStream s(buffer);
+        StringBuffer sb;
+        Writer<StringBuffer> writer(sb);
+        ParseResult q = actualReader.Parse<kParseStructuralIndexFlag | kParseInsituFlag | extraFlags>(s, writer);
+        EXPECT_EQ(expectedReader.GetParseErrorCode(), q.Code()) << json;
+        EXPECT_EQ(expectedReader.GetErrorOffset(), q.Offset()) << json;
+        EXPECT_STREQ(expected.GetString(), sb.GetString()) << json;
+        free(buffer);
+    }
+}
+
+TEST(Reader, ParseStructuralIndex) {
+    static const char* json[] = {
+        "", " ", "\t\r\n ", "{}", "[]", "1", "-1.5e3", "true", " false ", "null", "\"\"",
+        "{\"a\":1,\"b\":[true,false,null],\"c\":{\"d\":\"e\"}}",
+        " { \"a\" : [ 1 , 2 , { } , [ ] ] , \"b\" : \"\\\"\" } ",
+        "[\"\\\\\",\"\\\\\\\"]\"]", "[\"{[,:]}\" ,\" \"]",
+        "[\"\\u0041\\n\"]", "[1,2,]", "[1 2]", "{\"a\" 1}", "{\"a\":1 \"b\":2}", "{1:2}",
+        "[tru]", "[nul]", "[1,", "[\"abc", "{\"a\":", "1 2", "[]]", "[1]x", "[-]", "[1.]", "[\"\\x\"]",
+        "[\"a\tb\"]", "\"\\", "[1]\"", "[\\\"a\"]", "[01]", "{\"a\":1,}", "[,]"
+    };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+        TestStructuralIndexParse<0>(json[i]);
+        TestStructuralIndexParse<kParseTrailingCommasFlag>(json[i]);
+    }
+}
+
+TEST(Reader, ParseStructuralIndex_Random) {
+    // Random token sequences around 64-byte block boundaries and across index refills.
+    static const char* tokens[] = {
+        "{", "}", "[", "]", ":", ",", "\"\"", "\"a\"", "\"\\\\\"", "\"\\\"\"", "\"\\\\\\\"[\"",
+        "\"}{][,:\"", "0", "-12.5e-3", "true", "false", "null", "x", "\\", "\"\xC3\xA9\"", " ", "\n\t\r "
+    };
+    const size_t tokenCount = sizeof(tokens) / sizeof(tokens[0]);
+    unsigned seed = 12345;
+    std::string json;
+    for (int n = 0; n < 3000; n++) {
+        json.clear();
+        json.append((seed >> 8) % 70, ' ');
+        const int count = n < 2990 ? 64 : 40000;
+        for (int i = 0; i < count; i++) {
+            seed = seed * 1103515245u + 12345u;
+            json += tokens[(seed >> 16) % tokenCount];
+            if ((seed >> 12) % 8 == 0)
+                json.append((seed >> 4) % 130, ' ');
+        }
+        TestStructuralIndexParse<0>(json.c_str());
+
+        // Valid documents: an array of the same tokens as strings, numbers and literals.
+        json = "[";
+        for (int i = 0; i < count; i++) {
+            seed = seed * 1103515245u + 12345u;
+            const char* t = tokens[6 + (seed >> 16) % 11];
+            if (i > 0)
+                json += (seed >> 8) % 2 ? "," : " ,\n";
+            json.append((seed >> 4) % 100, ' ');
+            json += t;
+        }
+        json += "]";
+        TestStructuralIndexParse<0>(json.c_str());
+    }
+}
+
+template <unsigned parseFlags>
+static void TestValidate(const char* json) {
+    Reader reader;
+    BaseReaderHandler<> h;
+    {
+        StringStream s(json);
+        const ParseResult expected = reader.Parse<parseFlags>(s, h);
+        StringStream t(json);
+        const ParseResult r = reader.Validate<parseFlags>(t);
+        EXPECT_EQ(expected.Code(), r.Code()) << json;
+        EXPECT_EQ(expected.Offset(), r.Offset()) << json;
+
+        char* buffer = StrDup(json);
+        InsituStringStream u(buffer);
+        const ParseResult q = reader.Validate<parseFlags | kParseInsituFlag>(u);
+        EXPECT_EQ(expected.Code(), q.Code()) << json;
+        EXPECT_EQ(expected.Offset(), q.Offset()) << json;
+        EXPECT_STREQ(json, buffer);
+        free(buffer);
+    }
+    {
+        MemoryStream s(json, strlen(json));
+        const ParseResult expected = reader.Parse<parseFlags>(s, h);
+        MemoryStream t(json, strlen(json));
+        const ParseResult r = reader.Validate<parseFlags>(t);
+        EXPECT_EQ(expected.Code(), r.Code()) << json;
+        EXPECT_EQ(expected.Offset(), r.Offset()) << json;
+    }
+}
+
+template <unsigned extraFlags>
+static void TestValidateAllFlags(const char* json) {
+    TestValidate<extraFlags>(json);
+    TestValidate<kParseValidateEncodingFlag | extraFlags>(json);
+    TestValidate<kParseIterativeFlag | extraFlags>(json);
+    TestValidate<kParseStructuralIndexFlag | kParseValidateEncodingFlag | extraFlags>(json);
+    TestValidate<kParseFullPrecisionFlag | extraFlags>(json);
+    TestValidate<kParseNumbersAsStringsFlag | extraFlags>(json);
+    TestValidate<kParseCommentsFlag | kParseNanAndInfFlag | kParseTrailingCommasFlag | extraFlags>(json);
+}
+
+TEST(Reader, Validate) {
+    static const char* json[] = {
+        "", " ", "{}", "[]", "0", "-1.5e3", "true", " false ", "null", "\"\"",
+        "{\"a\":1,\"b\":[true,false,null],\"c\":{\"d\":\"e\"}}",
+        "[\"\\u0041\\n\\\"\\\\\\/\\b\\f\\r\\t\"]", "[\"\\uD834\\uDD1E\"]", "[\"\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80\"]",
+        "[4294967295,4294967296,18446744073709551615,18446744073709551616,-9223372036854775808,-9223372036854775809]",
+        "[1.7976931348623157e308,4.9e-324,1e-400,0.1e309,123456789012345678901234567890]",
+        "[1e309]", "[1e400]", "[-1e309]",
+        "[1000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+        "0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000]",
+        "[-]", "[1.]", "[1e]", "[1e+]", "[01]", "[.5]", "[+1]", "[-a]",
+        "[\"\\x\"]", "[\"\\u12\"]", "[\"\\uD800\"]", "[\"\\uD800\\u0041\"]", "[\"\\uDC00\"]",
+        "[\"a\tb\"]", "[\"\x01\"]", "[\"\xFF\"]", "[\"\xC3\"]", "[\"\xED\xA0\x80\"]", "[\"\xF0\x9F\x98\"]",
+        "[\"abc", "\"\\", "[tru]", "[nul]", "[1,", "{\"a\":", "{\"a\" 1}", "{1:2}", "1 2", "[]]", "[1 2]",
+        "[1,2,]", "{\"a\":1,}", "[,]", "[1]/* c */", "[1]// c", "[NaN,Infinity,-Infinity]", "[Nan]", "[-Inf]"
+    };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+        TestValidateAllFlags<0>(json[i]);
+        TestValidateAllFlags<kParseStopWhenDoneFlag>(json[i]);
+    }
+}
+
+TEST(Reader, Validate_Random) {
+    static const char kMutations[] = " \"\\{}[],:01-.eE+tfnu\x01\x80\xC3\xFF";
+    Random r;
+    for (int trial = 0; trial < 2000; trial++) {
+        std::string json;
+        RandomSkipJson(r, json, 0);
+        if (trial % 2)
+            json[(r() >> 16) % json.size()] = kMutations[(r() >> 16) % (sizeof(kMutations) - 1)];
+        TestValidateAllFlags<0>(json.c_str());
+    }
+}
+
+template <unsigned parseFlags>
+static void TestStringRefs(const char* json) {
+    Reader reader;
+    StringBuffer expected, actual;
+    Writer<StringBuffer> expectedWriter(expected), actualWriter(actual);
+    StringStream s(json);
+    const ParseResult r = reader.Parse<parseFlags>(s, expectedWriter);
+    StringStream t(json);
+    const ParseResult q = reader.Parse<parseFlags | kParseStringRefsFlag>(t, actualWriter);
+    EXPECT_EQ(r.Code(), q.Code()) << json;
+    EXPECT_EQ(r.Offset(), q.Offset()) << json;
+    EXPECT_STREQ(expected.GetString(), actual.GetString()) << json;
+}
+
+template <unsigned extraFlags>
+static void TestStringRefsAllFlags(const char* json) {
+    TestStringRefs<extraFlags>(json);
+    TestStringRefs<kParseValidateEncodingFlag | extraFlags>(json);
+    TestStringRefs<kParseIterativeFlag | extraFlags>(json);
+    TestStringRefs<kParseStructuralIndexFlag | extraFlags>(json);
+    TestStringRefs<kParseStructuralIndexFlag | kParseValidateEncodingFlag | extraFlags>(json);
+}
+
+// Counts the strings referring to the input, which must be followed by their closing quote.
+template <typename Encoding = UTF8<> >
+struct StringRefsHandler : BaseReaderHandler<Encoding, StringRefsHandler<Encoding> > {
+    typedef typename Encoding::Ch Ch;
+
+    explicit StringRefsHandler(const Ch* json) : json_(json), refs_(), copies_() {}
+
+    bool String(const Ch* str, SizeType length, bool copy) {
+        if (copy)
+            ++copies_;
+        else {
+            ++refs_;
+            EXPECT_TRUE(str > json_ && str[length] == '"');
+        }
+        return true;
+    }
+    bool Key(const Ch* str, SizeType length, bool copy) { return String(str, length, copy); }
+
+    const Ch* json_;
+    unsigned refs_;
+    unsigned copies_;
+};
+
+TEST(Reader, StringRefs) {
+    {
+        const char* json = "{\"a\": \"hello\", \"b\\n\": [\"x\\ty\", \"\xC3\xA9t\xC3\xA9\", \"\", \"\\u0041\"]}";
+        StringStream s(json);
+        StringRefsHandler<> h(json);
+        Reader reader;
+        EXPECT_TRUE(reader.Parse<kParseStringRefsFlag | kParseValidateEncodingFlag>(s, h));
+        EXPECT_EQ(4u, h.refs_);     // "a", "hello", the one in UTF-8 and ""
+        EXPECT_EQ(3u, h.copies_);   // with escapes
+    }
+    {
+        const wchar_t* json = L"[\"abc\", \"\\u0041\"]";
+        GenericStringStream<UTF16<> > s(json);
+        StringRefsHandler<UTF16<> > h(json);
+        GenericReader<UTF16<>, UTF16<> > reader;
+        EXPECT_TRUE(reader.Parse<kParseStringRefsFlag | kParseValidateEncodingFlag>(s, h));
+        EXPECT_EQ(1u, h.refs_);
+        EXPECT_EQ(1u, h.copies_);
+    }
+    {
+        // Strings which are transcoded, or not in a StringStream, are copied.
+        const char* json = "[\"abc\", \"def\"]";
+        StringStream s(json);
+        StringRefsHandler<UTF16<> > h(0);
+        GenericReader<UTF8<>, UTF16<> > reader;
+        EXPECT_TRUE(reader.Parse<kParseStringRefsFlag>(s, h));
+        EXPECT_EQ(0u, h.refs_);
+        EXPECT_EQ(2u, h.copies_);
+
+        MemoryStream ms(json, strlen(json));
+        StringRefsHandler<> h2(json);
+        Reader reader2;
+        EXPECT_TRUE(reader2.Parse<kParseStringRefsFlag>(ms, h2));
+        EXPECT_EQ(0u, h2.refs_);
+        EXPECT_EQ(2u, h2.copies_);
+    }
+
+    // The same values and errors as strings which are copied.
+    static const char* json[] = {
+        "\"\"", "[\"abc\",\"\"]", "{\"a\":\"b\",\"\\u0063\":[\"d\"]}",
+        "[\"\\u0041\\n\\\"\\\\\\/\\b\\f\\r\\t\"]", "[\"\\uD834\\uDD1E\"]", "[\"\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80\"]",
+        "[\"\\x\"]", "[\"\\u12\"]", "[\"\\uD800\"]", "[\"a\tb\"]", "[\"\x01\"]", "[\"\xFF\"]", "[\"\xC3\"]",
+        "[\"\xED\xA0\x80\"]", "[\"\xF0\x9F\x98\"]", "[\"abc", "\"\\", "{\"a\xFF\":1}", "{\"a\x01\":1}",
+        "[\"a long string which spans more than one block of sixty-four bytes of the input\"]"
+    };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+        TestStringRefsAllFlags<0>(json[i]);
+        TestStringRefsAllFlags<kParseStopWhenDoneFlag>(json[i]);
+    }
+}
+
+TEST(Reader, StringRefs_Random) {
+    static const char kMutations[] = " \"\\{}[],:01-.eE+tfnu\x01\x80\xC3\xFF";
+    Random r;
+    for (int trial = 0; trial < 2000; trial++) {
+        std::string json;
+        RandomSkipJson(r, json, 0);
+        if (trial % 2)
+            json[(r() >> 16) % json.size()] = kMutations[(r() >> 16) % (sizeof(kMutations) - 1)];
+        TestStringRefsAllFlags<0>(json.c_str());
+    }
+}
+
 TEST(Reader, ParseNanAndInfinity) {
 #define TEST_NAN_INF(str, x) \
     { \
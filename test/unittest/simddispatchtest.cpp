@@ -0,0 +1,323 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+// The unit tests prefix with SIMD should be skipped by Valgrind test
+
+#define RAPIDJSON_SIMD_DISPATCH
+#define RAPIDJSON_NAMESPACE rapidjson_simd_dispatch
+
+#include "unittest.h"
+
+#include "rapidjson/reader.h"
+#include "rapidjson/writer.h"
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+using namespace rapidjson_simd_dispatch;
+using namespace rapidjson_simd_dispatch::internal;
+
+TEST(SIMD, Dispatch_Detect) {
+    const SimdKernels& k = GetSimdKernels();
+    EXPECT_EQ(GetSimdLevel(), k.level);
+    EXPECT_EQ(&k, &GetSimdKernels()); // bound once
+    EXPECT_TRUE(k.skipWhitespace != 0);
+    EXPECT_TRUE(k.scanUnescaped != 0);
+}
+
+// Compare every kernel the running CPU supports against the scalar version.
+TEST(SIMD, Dispatch_Kernels) {
+    char buffer[256 + 64 + 1];
+    for (int level = kSimdNone; level <= GetSimdLevel(); level++) {
+        const SimdKernels k = MakeSimdKernels(static_cast<SimdLevel>(level));
+        for (size_t offset = 0; offset < 64; offset++) {
+            // Bytes before p share its aligned block and must be ignored, including a null
+            // character as left by in situ parsing.
+            memset(buffer, '\"', offset);
+            if (offset > 0)
+                buffer[offset - 1] = '\0';
+            for (size_t stop = 0; stop <= 256; stop++) {
+                char* p = buffer + offset;
+                for (size_t i = 0; i < stop; i++)
+                    p[i] = " \t\r\n"[i % 4];
+                p[stop] = 'X';
+                p[stop + 1] = '\0';
+                EXPECT_EQ(p + stop, k.skipWhitespace(p));
+                EXPECT_EQ(p + stop, k.skipWhitespaceBounded(p, p + stop + 1));
+                EXPECT_EQ(p + stop, k.skipWhitespaceBounded(p, p + stop));
+
+                for (size_t i = 0; i < stop; i++)
+                    p[i] = "ABC\x7F\xC3\xA9"[i % 6];
+                p[stop] = "\"\\\n\x01"[stop % 4];
+                EXPECT_EQ(p + stop, k.scanUnescaped(p));
+                EXPECT_EQ(p + stop, k.scanUnescapedBounded(p, p + stop + 1));
+                EXPECT_EQ(p + stop, k.scanUnescapedBounded(p, p + stop));
+            }
+        }
+    }
+}
+
+// Reference validation with UTF8<>::Decode().
+static bool ValidateUtf8_Decode(const char* p, const char* end) {
+    MemoryStream ms(p, static_cast<size_t>(end - p));
+    while (ms.Tell() < static_cast<size_t>(end - p)) {
+        unsigned codepoint;
+        if (!UTF8<>::Decode(ms, &codepoint))
+            return false;
+    }
+    return true;
+}
+
+// Compare the UTF-8 validation of every kernel the running CPU supports against the reference.
+TEST(SIMD, Dispatch_ValidateUtf8) {
+    SimdKernels kernels[kSimdAVX512 + 1];
+    int levels = 0;
+    for (int level = kSimdNone; level <= GetSimdLevel(); level++)
+        kernels[levels++] = MakeSimdKernels(static_cast<SimdLevel>(level));
+
+    // All sequences of up to four boundary bytes, crossing a 16 and 32-byte block boundary,
+    // followed by ASCII or ending the input.
+    static const unsigned char bytes[] = {
+        0x41, 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF, 0xC1, 0xC2, 0xDF, 0xE0, 0xED, 0xEF, 0xF0, 0xF4, 0xF5, 0xFF };
+    const size_t n = sizeof(bytes) / sizeof(bytes[0]);
+    char buffer[30 + 4 + 10];
+    memset(buffer, 'a', sizeof(buffer));
+    for (size_t length = 1; length <= 4; length++) {
+        size_t count = 1;
+        for (size_t i = 0; i < length; i++)
+            count *= n;
+        for (size_t c = 0; c < count; c++) {
+            size_t x = c;
+            for (size_t i = 0; i < length; i++, x /= n)
+                buffer[30 + i] = static_cast<char>(bytes[x % n]);
+            for (int tail = 0; tail < 2; tail++) {
+                const char* end = tail ? buffer + 30 + length + 10 : buffer + 30 + length;
+                if (tail)
+                    memset(buffer + 30 + length, 'a', 10);
+                const bool expected = ValidateUtf8_Decode(buffer, end);
+                EXPECT_EQ(expected, ValidateUtf8_Scalar(buffer, end));
+                EXPECT_EQ(expected, FindInvalidUtf8_Scalar(buffer, end) == end);
+                for (int k = 0; k < levels; k++)
+                    EXPECT_EQ(expected, kernels[k].validateUtf8(buffer, end)) << "level " << k;
+            }
+        }
+    }
+
+    // Random text, then with one byte replaced.
+    Random r;
+    for (int trial = 0; trial < 2000; trial++) {
+        StringBuffer sb;
+        const unsigned length = (r() >> 16) % 300;
+        while (sb.GetSize() < length) {
+            static const unsigned kMax[] = { 0x7F, 0x7FF, 0xFFFF, 0x10FFFF };
+            unsigned codepoint = (r() >> 8) % (kMax[(r() >> 16) % 4] + 1);
+            if (codepoint >= 0xD800 && codepoint <= 0xDFFF)
+                codepoint = 'b';
+            UTF8<>::Encode(sb, codepoint);
+        }
+        std::string text(sb.GetString(), sb.GetSize());
+        for (int k = 0; k < levels; k++)
+            EXPECT_TRUE(kernels[k].validateUtf8(text.data(), text.data() + text.size())) << "level " << k;
+        if (text.empty())
+            continue;
+        text[(r() >> 16) % text.size()] = static_cast<char>(r() >> 16);
+        const bool expected = ValidateUtf8_Decode(text.data(), text.data() + text.size());
+        for (int k = 0; k < levels; k++)
+            EXPECT_EQ(expected, kernels[k].validateUtf8(text.data(), text.data() + text.size())) << "level " << k;
+    }
+}
+
+struct DispatchStringHandler : BaseReaderHandler<UTF8<>, DispatchStringHandler> {
+    bool String(const char* str, size_t length, bool) {
+        memcpy(buffer, str, length + 1);
+        return true;
+    }
+    char buffer[2048 + 8 + 64];
+};
+
+template <unsigned parseFlags, typename StreamType>
+void TestDispatchScanCopyUnescapedString() {
+    char buffer[2048 + 8 + 64];
+    char backup[2048 + 8 + 64];
+
+    for (size_t offset = 0; offset < 64; offset += 7) {
+        for (size_t step = 0; step < 1024; step += 3) {
+            char* json = buffer + offset;
+            char *p = json;
+            *p++ = ' ';
+            *p++ = '\"';
+            for (size_t i = 0; i < step; i++)
+                *p++ = "ABCD"[i % 4];
+            *p++ = '\\';
+            *p++ = 'n';
+            for (size_t i = 0; i < step; i++)
+                *p++ = "EFGH"[i % 4];
+            *p++ = '\"';
+            *p++ = '\0';
+            strcpy(backup, json); // insitu parsing will overwrite buffer, so need to backup first
+
+            StreamType v(json);
+            Reader reader;
+            EXPECT_TRUE(reader.Validate<parseFlags>(v));
+            EXPECT_EQ(strlen(json), v.Tell());
+            StreamType s(json);
+            DispatchStringHandler h;
+            EXPECT_TRUE(reader.Parse<parseFlags>(s, h));
+            EXPECT_TRUE(memcmp(h.buffer, backup + 2, step) == 0);
+            EXPECT_EQ('\n', h.buffer[step]);
+            EXPECT_TRUE(memcmp(h.buffer + step + 1, backup + 2 + step + 2, step) == 0);
+            EXPECT_EQ('\0', h.buffer[step * 2 + 1]);
+        }
+    }
+}
+
+TEST(SIMD, Dispatch_ScanCopyUnescapedString) {
+    TestDispatchScanCopyUnescapedString<kParseDefaultFlags, StringStream>();
+    TestDispatchScanCopyUnescapedString<kParseInsituFlag, InsituStringStream>();
+}
+
+TEST(SIMD, Dispatch_SkipWhitespace_EncodedMemoryStream) {
+    char buffer[1024];
+    for (size_t i = 0; i < 1024; i++)
+        buffer[i] = " \t\r\n"[i % 4];
+    buffer[1000] = 'X';
+
+    MemoryStream ms(buffer, 1024);
+    EncodedInputStream<UTF8<>, MemoryStream> s(ms);
+    SkipWhitespace(s);
+    EXPECT_EQ('X', s.Take());
+    SkipWhitespace(s);
+    EXPECT_EQ('\0', s.Peek());
+}
+
+TEST(SIMD, Dispatch_ScanWriteUnescapedString) {
+    char buffer[2048 + 1 + 64];
+    for (size_t offset = 0; offset < 64; offset += 5) {
+        for (size_t step = 0; step < 1024; step += 3) {
+            char* s = buffer + offset;
+            char* p = s;
+            for (size_t i = 0; i < step; i++)
+                *p++ = "ABCD"[i % 4];
+            *p++ = '\"';
+            for (size_t i = 0; i < step; i++)
+                *p++ = "ABCD"[i % 4];
+
+            StringBuffer sb;
+            Writer<StringBuffer> writer(sb);
+            writer.String(s, SizeType(step * 2 + 1));
+            const char* q = sb.GetString();
+            EXPECT_EQ('\"', *q++);
+            for (size_t i = 0; i < step; i++)
+                EXPECT_EQ("ABCD"[i % 4], *q++);
+            EXPECT_EQ('\\', *q++);
+            EXPECT_EQ('\"', *q++);
+            for (size_t i = 0; i < step; i++)
+                EXPECT_EQ("ABCD"[i % 4], *q++);
+            EXPECT_EQ('\"', *q++);
+            EXPECT_EQ('\0', *q++);
+        }
+    }
+}
+
+template <unsigned parseFlags, typename StreamType>
+void TestDispatchScanCopyValidUnescapedString() {
+    static const char multibyte[] = "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80";   // U+00E9 U+20AC U+1F600
+    char buffer[2 * 100 + 32 + 32];
+    char expected[2 * 100 + 32];
+
+    for (size_t offset = 0; offset < 32; offset += 3) {
+        for (size_t step = 0; step < 100; step++) {
+            // "AAA...<multibyte>\\nBBB..."
+            char* json = buffer + offset;
+            char* p = json;
+            char* e = expected;
+            *p++ = '\"';
+            for (size_t i = 0; i < step; i++)
+                *p++ = *e++ = "ABCD"[i % 4];
+            for (size_t i = 0; i < 9; i++)
+                *p++ = *e++ = multibyte[i];
+            *p++ = '\\';
+            *p++ = 'n';
+            *e++ = '\n';
+            for (size_t i = 0; i < step; i++)
+                *p++ = *e++ = "EFGH"[i % 4];
+            *p++ = '\"';
+            *p++ = '\0';
+            *e++ = '\0';
+            char backup[sizeof(buffer)];
+            strcpy(backup, json);
+
+            {
+                StreamType v(json);
+                Reader reader;
+                EXPECT_TRUE(reader.Validate<parseFlags | kParseValidateEncodingFlag>(v));
+                StreamType s(json);
+                DispatchStringHandler h;
+                EXPECT_TRUE(reader.Parse<parseFlags | kParseValidateEncodingFlag>(s, h));
+                EXPECT_STREQ(expected, h.buffer);
+            }
+
+            // Invalid byte, surrogate in place of U+20AC and truncated U+1F600 before the escape
+            static const struct { const char* bytes; size_t position; } invalid[] = {
+                { "\xFF", 0 }, { "\xED\xA0\x80", 2 }, { "\xF0\x9F\x98\\", 5 }
+            };
+            for (size_t k = 0; k < 3; k++) {
+                strcpy(json, backup);
+                memcpy(json + 1 + step + invalid[k].position, invalid[k].bytes, strlen(invalid[k].bytes));
+                StreamType v(json);
+                Reader reader;
+                EXPECT_FALSE(reader.Validate<parseFlags | kParseValidateEncodingFlag>(v));
+                EXPECT_EQ(kParseErrorStringInvalidEncoding, reader.GetParseErrorCode());
+                EXPECT_EQ(1 + step + invalid[k].position, reader.GetErrorOffset());
+                StreamType s(json);
+                DispatchStringHandler h;
+                EXPECT_FALSE(reader.Parse<parseFlags | kParseValidateEncodingFlag>(s, h));
+                EXPECT_EQ(kParseErrorStringInvalidEncoding, reader.GetParseErrorCode());
+                EXPECT_EQ(1 + step + invalid[k].position, reader.GetErrorOffset());
+            }
+        }
+    }
+}
+
+TEST(SIMD, Dispatch_ScanCopyValidUnescapedString) {
+    TestDispatchScanCopyValidUnescapedString<kParseDefaultFlags, StringStream>();
+    TestDispatchScanCopyValidUnescapedString<kParseInsituFlag, InsituStringStream>();
+}
+
+TEST(SIMD, Dispatch_WriteValidateEncoding) {
+    typedef Writer<StringBuffer, UTF8<>, UTF8<>, CrtAllocator, kWriteValidateEncodingFlag> ValidatingWriter;
+    for (size_t step = 0; step < 100; step++) {
+        std::string s(step, 'A');
+        s += "\xC3\xA9\"\xF0\x9F\x98\x80";
+        s += std::string(step, 'B');
+        {
+            StringBuffer sb;
+            ValidatingWriter writer(sb);
+            EXPECT_TRUE(writer.String(s.c_str(), SizeType(s.size())));
+            EXPECT_EQ("\"" + std::string(step, 'A') + "\xC3\xA9\\\"\xF0\x9F\x98\x80" + std::string(step, 'B') + "\"", std::string(sb.GetString()));
+        }
+        s[step + 3] = '\x80';   // lead byte of U+1F600
+        {
+            StringBuffer sb;
+            ValidatingWriter writer(sb);
+            EXPECT_FALSE(writer.String(s.c_str(), SizeType(s.size())));
+        }
+    }
+}
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
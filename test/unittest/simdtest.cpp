@@ -15,9 +15,13 @@
 // Since Travis CI installs old Valgrind 3.7.0, which fails with some SSE4.2
 // The unit tests prefix with SIMD should be skipped by Valgrind test
 
-// __SSE2__ and __SSE4_2__ are recognized by gcc, clang, and the Intel compiler.
-// We use -march=native with gmake to enable -msse2 and -msse4.2, if supported.
-#if defined(__SSE4_2__)
+// __SSE2__, __SSE4_2__, __AVX2__ and __AVX512BW__ are recognized by gcc, clang, and the Intel compiler.
+// We use -march=native with gmake to enable -msse2, -msse4.2, -mavx2 and -mavx512bw, if supported.
+#if defined(__AVX512BW__)
+#  define RAPIDJSON_AVX512
+#elif defined(__AVX2__)
+#  define RAPIDJSON_AVX2
+#elif defined(__SSE4_2__)
 #  define RAPIDJSON_SSE42
 #elif defined(__SSE2__)
 #  define RAPIDJSON_SSE2
@@ -37,7 +41,11 @@ RAPIDJSON_DIAG_OFF(effc++)
 
 using namespace rapidjson_simd;
 
-#ifdef RAPIDJSON_SSE2
+#ifdef RAPIDJSON_AVX512
+#define SIMD_SUFFIX(name) name##_AVX512
+#elif defined(RAPIDJSON_AVX2)
+#define SIMD_SUFFIX(name) name##_AVX2
+#elif defined(RAPIDJSON_SSE2)
 #define SIMD_SUFFIX(name) name##_SSE2
 #elif defined(RAPIDJSON_SSE42)
 #define SIMD_SUFFIX(name) name##_SSE42
@@ -210,6 +218,136 @@ TEST(SIMD, SIMD_SUFFIX(ScanWriteUnescapedString)) {
     }
 }
 
+template <unsigned parseFlags, typename StreamType>
+void TestScanCopyValidUnescapedString() {
+    static const char multibyte[] = "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80";   // U+00E9 U+20AC U+1F600
+    char buffer[2 * 100 + 32 + 32];
+    char expected[2 * 100 + 32];
+
+    for (size_t offset = 0; offset < 32; offset += 3) {
+        for (size_t step = 0; step < 100; step++) {
+            // "AAA...<multibyte>\\nBBB..."
+            char* json = buffer + offset;
+            char* p = json;
+            char* e = expected;
+            *p++ = '\"';
+            for (size_t i = 0; i < step; i++)
+                *p++ = *e++ = "ABCD"[i % 4];
+            for (size_t i = 0; i < 9; i++)
+                *p++ = *e++ = multibyte[i];
+            *p++ = '\\';
+            *p++ = 'n';
+            *e++ = '\n';
+            for (size_t i = 0; i < step; i++)
+                *p++ = *e++ = "EFGH"[i % 4];
+            *p++ = '\"';
+            *p++ = '\0';
+            *e++ = '\0';
+            char backup[sizeof(buffer)];
+            strcpy(backup, json);
+
+            {
+                StreamType s(json);
+                Reader reader;
+                ScanCopyUnescapedStringHandler h;
+                EXPECT_TRUE(reader.Parse<parseFlags | kParseValidateEncodingFlag>(s, h));
+                EXPECT_STREQ(expected, h.buffer);
+            }
+
+            // Invalid byte, surrogate in place of U+20AC and truncated U+1F600 before the escape
+            static const struct { const char* bytes; size_t position; } invalid[] = {
+                { "\xFF", 0 }, { "\xED\xA0\x80", 2 }, { "\xF0\x9F\x98\\", 5 }
+            };
+            for (size_t k = 0; k < 3; k++) {
+                strcpy(json, backup);
+                memcpy(json + 1 + step + invalid[k].position, invalid[k].bytes, strlen(invalid[k].bytes));
+                StreamType s(json);
+                Reader reader;
+                ScanCopyUnescapedStringHandler h;
+                EXPECT_FALSE(reader.Parse<parseFlags | kParseValidateEncodingFlag>(s, h));
+                EXPECT_EQ(kParseErrorStringInvalidEncoding, reader.GetParseErrorCode());
+                EXPECT_EQ(1 + step + invalid[k].position, reader.GetErrorOffset());
+            }
+        }
+    }
+}
+
+TEST(SIMD, SIMD_SUFFIX(ScanCopyValidUnescapedString)) {
+    TestScanCopyValidUnescapedString<kParseDefaultFlags, StringStream>();
+    TestScanCopyValidUnescapedString<kParseInsituFlag, InsituStringStream>();
+}
+
+TEST(SIMD, SIMD_SUFFIX(WriteValidateEncoding)) {
+    typedef Writer<StringBuffer, UTF8<>, UTF8<>, CrtAllocator, kWriteValidateEncodingFlag> ValidatingWriter;
+    for (size_t step = 0; step < 100; step++) {
+        std::string s(step, 'A');
+        s += "\xC3\xA9\"\xF0\x9F\x98\x80";
+        s += std::string(step, 'B');
+        {
+            StringBuffer sb;
+            ValidatingWriter writer(sb);
+            EXPECT_TRUE(writer.String(s.c_str(), SizeType(s.size())));
+            EXPECT_EQ("\"" + std::string(step, 'A') + "\xC3\xA9\\\"\xF0\x9F\x98\x80" + std::string(step, 'B') + "\"", std::string(sb.GetString()));
+        }
+        s[step + 3] = '\x80';   // lead byte of U+1F600
+        {
+            StringBuffer sb;
+            ValidatingWriter writer(sb);
+            EXPECT_FALSE(writer.String(s.c_str(), SizeType(s.size())));
+        }
+    }
+}
+
+// Strings which stage one of kParseStructuralIndexFlag indexes to be taken at once, or not.
+static void TestStructuralIndexStrings(const char* json) {
+    StringBuffer expected, actual, actualInsitu;
+    Writer<StringBuffer> expectedWriter(expected), actualWriter(actual), insituWriter(actualInsitu);
+    Reader reader;
+    StringStream s(json);
+    const ParseResult r = reader.Parse<kParseIterativeFlag>(s, expectedWriter);
+    StringStream t(json);
+    const ParseResult q = reader.Parse<kParseStructuralIndexFlag>(t, actualWriter);
+    EXPECT_EQ(r.Code(), q.Code()) << json;
+    EXPECT_EQ(r.Offset(), q.Offset()) << json;
+    EXPECT_EQ(s.Tell(), t.Tell()) << json;
+    EXPECT_STREQ(expected.GetString(), actual.GetString()) << json;
+
+    std::string buffer(json);
+    InsituStringStream u(&buffer[0]);
+    const ParseResult v = reader.Parse<kParseStructuralIndexFlag | kParseInsituFlag>(u, insituWriter);
+    EXPECT_EQ(r.Code(), v.Code()) << json;
+    EXPECT_EQ(r.Offset(), v.Offset()) << json;
+    EXPECT_STREQ(expected.GetString(), actualInsitu.GetString()) << json;
+}
+
+TEST(SIMD, SIMD_SUFFIX(ParseStructuralIndex_Strings)) {
+    // Strings across block boundaries and index refills, with and without escapes or control characters.
+    static const char* fillers[] = { "", "a", "\\", "\\\\", "\\n", "\t", "\n", "\xC3\xA9", "\x01", "\x10", " ", "\"" };
+    const size_t fillerCount = sizeof(fillers) / sizeof(fillers[0]);
+    unsigned seed = 54321;
+    for (int n = 0; n < 200; n++) {
+        std::string json = "{";
+        for (int i = 0; i < (n < 190 ? 20 : 2000); i++) {
+            seed = seed * 1103515245u + 12345u;
+            json += i ? ",\"" : "\"";
+            json.append((seed >> 20) % 70, 'k');
+            json += "\": \"";
+            json.append((seed >> 8) % 140, 'v');
+            if ((seed >> 4) % 4 == 0)
+                json += fillers[(seed >> 16) % fillerCount];
+            json.append((seed >> 12) % 10, 'w');
+            json += "\"";
+        }
+        json += "}";
+        TestStructuralIndexStrings(json.c_str());
+    }
+
+    // Text which ends within a string or in its first block.
+    static const char* json[] = { "[\"abc\", \"de", "\"a\\u0000b\"", "[\"a\"]  \"", "[\"\\\", \"\"]", "\"\"" };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++)
+        TestStructuralIndexStrings(json[i]);
+}
+
 #ifdef __GNUC__
 RAPIDJSON_DIAG_POP
 #endif
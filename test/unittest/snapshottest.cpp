@@ -0,0 +1,225 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "unittest.h"
+
+#include "rapidjson/snapshot.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include <string>
+#include <vector>
+
+using namespace rapidjson;
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(effc++)
+#endif
+
+template <typename ValueType>
+static std::basic_string<typename ValueType::Ch> Stringify(const ValueType& v) {
+    typedef typename ValueType::EncodingType Encoding;
+    GenericStringBuffer<Encoding> sb;
+    Writer<GenericStringBuffer<Encoding>, Encoding, Encoding> writer(sb);
+    v.Accept(writer);
+    return sb.GetString();
+}
+
+template <typename Encoding>
+static void TestSnapshot(const typename Encoding::Ch* json) {
+    GenericDocument<Encoding> d;
+    d.Parse(json);
+    ASSERT_FALSE(d.HasParseError());
+    GenericSnapshotWriter<Encoding> writer;
+    writer.Write(d);
+    const GenericSnapshotValue<Encoding>* root = GenericSnapshotValue<Encoding>::Load(writer.GetImage(), writer.GetSize());
+    ASSERT_TRUE(root != 0);
+    EXPECT_EQ(root, &writer.GetRoot());
+    EXPECT_TRUE(Stringify(*root) == Stringify(d));
+}
+
+TEST(Snapshot, RoundTrip) {
+    static const char* json[] = {
+        "null", "true", "false", "0", "\"\"", "[]", "{}", "\"short\"", "\"a string which is not inline\"",
+        "{ \"hello\" : \"world\", \"t\" : true , \"f\" : false, \"n\": null, \"i\":123, \"pi\": 3.1416, \"a\":[1, 2, 3, 4] } ",
+        "[{\"a\": [[], {}, [{\"b\": \"a string which is not inline\"}]]}, -1, 1e100, \"\\u0000\", \"1234567\", \"12345678\"]",
+        "[-2147483648, 2147483647, 4294967295, -9223372036854775808, 9223372036854775807, 18446744073709551615, 0.5]"
+    };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++)
+        TestSnapshot<UTF8<> >(json[i]);
+    TestSnapshot<UTF16<> >(L"{\"\\u00e9\": [\"a\", \"ab\", \"abc\", \"abcd\"], \"b\": 1}");
+}
+
+TEST(Snapshot, Value) {
+    Document d;
+    d.Parse("{\"n\": null, \"t\": true, \"f\": false, \"i\": -1, \"u\": 4294967295, \"i64\": -9223372036854775808,"
+            " \"u64\": 18446744073709551615, \"d\": 1.5, \"s\": \"a string\\u0000with null\", \"a\": [1, \"x\", [2]]}");
+    SnapshotWriter writer;
+    writer.Write(d);
+    const SnapshotValue& v = writer.GetRoot();
+
+    ASSERT_TRUE(v.IsObject());
+    EXPECT_EQ(d.MemberCount(), v.MemberCount());
+    EXPECT_FALSE(v.ObjectEmpty());
+    EXPECT_TRUE(v["n"].IsNull());
+    EXPECT_TRUE(v["t"].IsTrue());
+    EXPECT_TRUE(v["t"].GetBool());
+    EXPECT_TRUE(v["f"].IsFalse());
+    EXPECT_FALSE(v["f"].GetBool());
+
+    // Numbers have the same types as in the document.
+    static const char* numbers[] = { "i", "u", "i64", "u64", "d" };
+    for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++) {
+        const Value& expected = d[numbers[i]];
+        const SnapshotValue& n = v[numbers[i]];
+        EXPECT_TRUE(n.IsNumber());
+        EXPECT_EQ(expected.IsInt(), n.IsInt()) << numbers[i];
+        EXPECT_EQ(expected.IsUint(), n.IsUint()) << numbers[i];
+        EXPECT_EQ(expected.IsInt64(), n.IsInt64()) << numbers[i];
+        EXPECT_EQ(expected.IsUint64(), n.IsUint64()) << numbers[i];
+        EXPECT_EQ(expected.IsDouble(), n.IsDouble()) << numbers[i];
+        EXPECT_EQ(expected.GetDouble(), n.GetDouble()) << numbers[i];
+    }
+    EXPECT_EQ(-1, v["i"].GetInt());
+    EXPECT_EQ(-1, v["i"].GetInt64());
+    EXPECT_EQ(4294967295u, v["u"].GetUint());
+    EXPECT_EQ(RAPIDJSON_UINT64_C2(0x80000000, 0), static_cast<uint64_t>(v["i64"].GetInt64()));
+    EXPECT_EQ(RAPIDJSON_UINT64_C2(0xFFFFFFFF, 0xFFFFFFFF), v["u64"].GetUint64());
+    EXPECT_EQ(1.5f, v["d"].GetFloat());
+
+    EXPECT_TRUE(v["s"].IsString());
+    EXPECT_EQ(18u, v["s"].GetStringLength());
+    EXPECT_EQ(0, memcmp(v["s"].GetString(), "a string\0with null", 18));
+
+    const SnapshotValue& a = v["a"];
+    ASSERT_TRUE(a.IsArray());
+    EXPECT_EQ(3u, a.Size());
+    EXPECT_FALSE(a.Empty());
+    EXPECT_EQ(1, a[0].GetInt());
+    EXPECT_STREQ("x", a[1].GetString());
+    EXPECT_EQ(2, a[2][0].GetInt());
+    EXPECT_EQ(a.Begin() + 3, a.End());
+    EXPECT_EQ(&a[1], a.Begin() + 1);
+
+    // Member lookup
+    SnapshotValue::ConstMemberIterator m = v.MemberBegin();
+    EXPECT_STREQ("n", m->name.GetString());
+    EXPECT_EQ(v.MemberBegin() + 10, v.MemberEnd());
+    EXPECT_EQ(v.MemberBegin() + 9, v.FindMember("a"));
+    EXPECT_EQ(v.MemberEnd(), v.FindMember("b"));
+    EXPECT_EQ(v.MemberEnd(), v.FindMember("x"));
+    EXPECT_TRUE(v.HasMember(RAPIDJSON_KEY("u64")));
+    EXPECT_TRUE(v.HasMember(Value("d")));
+    EXPECT_TRUE(v.HasMember(Value("a string\0with null", 18)) == false);
+    EXPECT_EQ(v.MemberBegin() + 1, v.FindMember(v.MemberBegin()[1].name));
+#if RAPIDJSON_HAS_STDSTRING
+    EXPECT_TRUE(v.HasMember(std::string("i64")));
+    EXPECT_EQ(-1, v[std::string("i")].GetInt());
+#endif
+}
+
+TEST(Snapshot, MemberIndex) {
+    Document d;
+    d.SetObject();
+    char buffer[64];
+    for (int i = 0; i < 100; i++) {
+        sprintf(buffer, "member %d", i);
+        d.AddMember(Value(buffer, d.GetAllocator()).Move(), i, d.GetAllocator());
+    }
+    d.AddMember("member 0", 100, d.GetAllocator());
+    SnapshotWriter writer;
+    writer.Write(d);
+    const SnapshotValue& v = writer.GetRoot();
+    EXPECT_EQ(101u, v.MemberCount());
+    for (int i = 0; i < 100; i++) {
+        sprintf(buffer, "member %d", i);
+        EXPECT_EQ(i, v[buffer].GetInt());
+        EXPECT_EQ(v.MemberBegin() + i, v.FindMember(buffer));
+    }
+    EXPECT_EQ(v.MemberEnd(), v.FindMember("member 100"));
+    EXPECT_EQ(v.MemberEnd(), v.FindMember(""));
+    EXPECT_EQ(42, v[RAPIDJSON_KEY("member 42")].GetInt());
+    EXPECT_EQ(Stringify(d), Stringify(v));
+}
+
+TEST(Snapshot, Load) {
+    Document d;
+    d.Parse("{\"a\": [1, \"a string which is not inline\", {\"b\": null}]}");
+    SnapshotWriter writer;
+    writer.Write(d);
+    const std::string expected = Stringify(d);
+
+    // The image is position-independent.
+    std::vector<uint64_t> image(writer.GetSize() / sizeof(uint64_t) + 1);
+    std::memcpy(&image[0], writer.GetImage(), writer.GetSize());
+    writer.Clear();
+    EXPECT_EQ(0u, writer.GetSize());
+    const SnapshotValue* root = SnapshotValue::Load(&image[0], image.size() * sizeof(uint64_t));
+    ASSERT_TRUE(root != 0);
+    EXPECT_EQ(expected, Stringify(*root));
+    EXPECT_STREQ("a string which is not inline", (*root)["a"][1].GetString());
+
+    // Invalid images
+    const size_t size = image.size() * sizeof(uint64_t);
+    EXPECT_TRUE(SnapshotValue::Load(0, size) == 0);
+    EXPECT_TRUE(SnapshotValue::Load(&image[0], 16) == 0);   // header only
+    EXPECT_TRUE(SnapshotValue::Load(&image[0], size - 16) == 0);  // truncated
+    EXPECT_TRUE(SnapshotValue::Load(reinterpret_cast<char*>(&image[0]) + 4, size - 4) == 0);   // misaligned
+    EXPECT_TRUE(GenericSnapshotValue<UTF16<> >::Load(&image[0], size) == 0);
+    reinterpret_cast<char*>(&image[0])[0] = 'X';
+    EXPECT_TRUE(SnapshotValue::Load(&image[0], size) == 0);
+}
+
+#if RAPIDJSON_HAS_MMAP
+TEST(Snapshot, SnapshotFile) {
+    Document d;
+    d.Parse("{\"hello\": \"world\", \"a\": [1, 2.5, \"a string which is not inline\", {\"b\": null}]}");
+    SnapshotWriter writer;
+    writer.Write(d);
+
+    char filename[L_tmpnam];
+    FILE* fp = TempFile(filename);
+    ASSERT_TRUE(fp != 0);
+    EXPECT_EQ(writer.GetSize(), fwrite(writer.GetImage(), 1, writer.GetSize(), fp));
+    fclose(fp);
+    writer.Clear();
+
+    SnapshotFile file(filename);
+    ASSERT_TRUE(file.IsOpen());
+    EXPECT_EQ(Stringify(d), Stringify(file.GetRoot()));
+    EXPECT_STREQ("world", file.GetRoot()["hello"].GetString());
+    EXPECT_EQ(2.5, file.GetRoot()["a"][1].GetDouble());
+
+    // Reading the image as a document
+    Document copy;
+    copy.Parse(Stringify(file.GetRoot()).c_str());
+    EXPECT_TRUE(copy == d);
+    file.Close();
+    EXPECT_FALSE(file.IsOpen());
+    EXPECT_EQ(0u, file.GetSize());
+
+    // A JSON text is not an image.
+    fp = fopen(filename, "wb");
+    fputs("{\"hello\": \"world\", \"padding\": \"to be longer than a header\"}", fp);
+    fclose(fp);
+    EXPECT_FALSE(file.Open(filename));
+    remove(filename);
+    EXPECT_FALSE(file.Open(filename));
+}
+#endif
+
+#ifdef __GNUC__
+RAPIDJSON_DIAG_POP
+#endif
@@ -15,6 +15,11 @@
 #include "unittest.h"
 
 #include "rapidjson/internal/strtod.h"
+#include "rapidjson/internal/itoa.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 #ifdef __clang__
 RAPIDJSON_DIAG_PUSH
@@ -127,6 +132,92 @@ TEST(Strtod, CheckApproximationCase) {
     EXPECT_EQ(-1, delta.Compare(hS));
 }
 
+static uint64_t StrtodBits(const char* str) {
+    return Double(strtod(str, 0)).Uint64Value();
+}
+
+static void FormatDecimal(char* buffer, uint64_t w, int q) {
+    sprintf(u64toa(w, buffer), "e%d", q);
+}
+
+TEST(Strtod, EiselLemire) {
+    static const struct {
+        uint64_t w;
+        int q;
+    } cases[] = {
+        { 1, 0 }, { 1, -1 }, { 3, -1 }, { 17864, -49 }, { 9007199254740993u, 0 }, { 9007199254740995u, 0 },
+        { 22250738585072011u, -324 }, { 22250738585072012u, -324 }, { 24703282292062327u, -340 },
+        { 49406564584124654u, -340 }, { 17976931348623157u, 292 }, { 7038531, -32 }, { 7450580596923828u, -24 },
+        { RAPIDJSON_UINT64_C2(0x8AC72304, 0x89E7FFFF), 0 }, { RAPIDJSON_UINT64_C2(0x8AC72304, 0x89E7FFFF), -342 },
+        { 1, -324 }, { 3, -324 }, { 5, -324 }, { 1, 308 }, { 1, 22 }, { 1, 23 }, { 123456789, 300 }
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        char buffer[64];
+        FormatDecimal(buffer, cases[i].w, cases[i].q);
+        double d;
+        ASSERT_TRUE(StrtodEiselLemire(cases[i].w, cases[i].q, &d)) << buffer;
+        EXPECT_EQ(StrtodBits(buffer), Double(d).Uint64Value()) << buffer;
+    }
+
+    double d;
+    EXPECT_TRUE(StrtodEiselLemire(0, 100, &d));
+    EXPECT_EQ(0u, Double(d).Uint64Value());
+    EXPECT_TRUE(StrtodEiselLemire(1, -400, &d));
+    EXPECT_EQ(0u, Double(d).Uint64Value());
+    EXPECT_FALSE(StrtodEiselLemire(1, 309, &d));    // overflow
+    EXPECT_FALSE(StrtodEiselLemire(17976931348623159u, 292, &d));
+
+    // Random significands and exponents
+    Random r;
+    unsigned inRange = 0, decided = 0;
+    for (unsigned i = 0; i < 100000; i++) {
+        uint64_t w = uint64_t(r()) << 32;
+        w |= r();
+        w >>= r() % 64;
+        const int q = static_cast<int>(r() % 660) - 345;
+        char buffer[64];
+        FormatDecimal(buffer, w, q);
+        const bool normal = q >= -300 && q <= 288;    // neither overflow nor deep underflow
+        inRange += normal;
+        if (StrtodEiselLemire(w, q, &d)) {
+            decided += normal;
+            EXPECT_EQ(StrtodBits(buffer), Double(d).Uint64Value()) << buffer;
+        }
+    }
+    EXPECT_GT(decided, inRange * 99 / 100);
+}
+
+TEST(Strtod, EiselLemireDecimals) {
+    // More than 19 digits
+    static const char* decimals[] = {
+        "100000000000000011102230246251565404236316680908203125",   // 1 + 2^-53, half way
+        "100000000000000011102230246251565404236316680908203126",
+        "100000000000000011102230246251565404236316680908203124",
+        "2225073858507201136057409796709131975934819546351645648",
+        "1797693134862315708145274237317043567980705675258449965989174768"
+    };
+    static const int exps[] = { -53, -53, -53, -326, -63 };
+    for (size_t i = 0; i < sizeof(decimals) / sizeof(decimals[0]); i++) {
+        const size_t length = strlen(decimals[i]);
+        char buffer[128];
+        sprintf(buffer, "%se%d", decimals[i], exps[i]);
+        const double expected = strtod(buffer, 0);
+        double d;
+        if (StrtodEiselLemire(decimals[i], length, length, exps[i], &d)) {
+            EXPECT_EQ(Double(expected).Uint64Value(), Double(d).Uint64Value()) << buffer;
+        }
+        d = StrtodFullPrecision(0.0, 1000, decimals[i], length, length, exps[i]);
+        EXPECT_EQ(Double(expected).Uint64Value(), Double(d).Uint64Value()) << buffer;
+    }
+
+    // The first 19 digits decide most results.
+    double d;
+    const char* pi = "31415926535897932384626433832795028841971";
+    EXPECT_TRUE(StrtodEiselLemire(pi, strlen(pi), 1, 0, &d));
+    EXPECT_EQ(StrtodBits("3.1415926535897932384626433832795028841971"), Double(d).Uint64Value());
+    EXPECT_FALSE(StrtodEiselLemire(decimals[0], strlen(decimals[0]), 1, 0, &d));   // half way
+}
+
 #ifdef __clang__
 RAPIDJSON_DIAG_POP
 #endif
@@ -1615,6 +1615,66 @@ TEST(Value, BigNestedObject) {
     }
 }
 
+TEST(Value, KeyRef) {
+    const uint32_t hash = internal::StrHash("identifier", 10);
+    EXPECT_EQ(hash, KeyRef("identifier").hash);
+    EXPECT_EQ(hash, RAPIDJSON_KEY("identifier").hash);
+    EXPECT_EQ(10u, RAPIDJSON_KEY("identifier").length);
+#if RAPIDJSON_HAS_CXX11_CONSTEXPR
+    const uint32_t constant = internal::StrHashConstant<internal::StrHashLiteral("identifier", 10)>::Value;
+    EXPECT_EQ(hash, constant);
+#endif
+    EXPECT_EQ(internal::StrHash(L"\u00e9\u4e2d", 2), RAPIDJSON_KEY(L"\u00e9\u4e2d").hash);
+
+    Value k(RAPIDJSON_KEY("identifier"));
+    EXPECT_TRUE(k.IsString());
+    EXPECT_STREQ("identifier", k.GetString());
+    EXPECT_EQ(Value("identifier"), k);
+    EXPECT_NE(Value("identifieR"), k);
+
+    // Small objects (linear search) and big ones (member index).
+    Value::AllocatorType allocator;
+    char name[16];
+    for (int n = 1; n < 100; n *= 3) {
+        Value o(kObjectType);
+        for (int i = 0; i < n; i++) {
+            sprintf(name, "name%d", i);
+            o.AddMember(Value(name, allocator).Move(), i, allocator);
+        }
+        o.AddMember(Value(RAPIDJSON_KEY("identifier")).Move(), n, allocator);
+        o.AddMember("identifieR", -1, allocator);
+        const Value& co = o;
+        EXPECT_EQ(n, o[RAPIDJSON_KEY("identifier")].GetInt());
+        EXPECT_EQ(n, co[RAPIDJSON_KEY("identifier")].GetInt());
+        EXPECT_EQ(n, o["identifier"].GetInt());
+        EXPECT_EQ(-1, o[RAPIDJSON_KEY("identifieR")].GetInt());
+        EXPECT_TRUE(co.FindMember(RAPIDJSON_KEY("identifier")) == co.MemberEnd() - 2);
+        EXPECT_TRUE(o.HasMember(RAPIDJSON_KEY("name0")));
+        EXPECT_FALSE(o.HasMember(RAPIDJSON_KEY("Identifier")));
+        EXPECT_TRUE(o.FindMember(RAPIDJSON_KEY("")) == o.MemberEnd());
+    }
+}
+
+TEST(Value, GetMemoryUsage) {
+    Value::AllocatorType allocator;
+    EXPECT_EQ(sizeof(Value), Value(1).GetMemoryUsage());
+    EXPECT_EQ(sizeof(Value), Value("a constant string which is long").GetMemoryUsage());
+    EXPECT_EQ(sizeof(Value), Value("ab", allocator).GetMemoryUsage()); // inline
+    EXPECT_EQ(sizeof(Value) + 32, Value("a copied string which is long..", allocator).GetMemoryUsage());
+
+    Value a(kArrayType);
+    EXPECT_EQ(sizeof(Value), a.GetMemoryUsage());
+    a.Reserve(10, allocator);
+    a.PushBack(1, allocator);
+    a.PushBack(Value("a copied string which is long..", allocator).Move(), allocator);
+    EXPECT_EQ(sizeof(Value) + 10 * sizeof(Value) + 32, a.GetMemoryUsage());
+
+    Value o(kObjectType);
+    o.AddMember(Value("a copied name which is long....", allocator).Move(), a, allocator);
+    o.AddMember("b", true, allocator);
+    EXPECT_EQ(sizeof(Value) + 16 * sizeof(Value::Member) + 32 + 10 * sizeof(Value) + 32, o.GetMemoryUsage());
+}
+
 // Issue 18: Error removing last element of object
 // http://code.google.com/p/rapidjson/issues/detail?id=18
 TEST(Value, RemoveLastElement) {